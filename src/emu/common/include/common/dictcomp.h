@@ -34,35 +34,53 @@ namespace eka2l1::common {
         This is just a reimplementation by throwing out old-way optimization in the source code and write easy-to-understand code
     */
 
-    /*! \brief A dictionary compress stream
+    /*! \brief A dictionary compressed bit stream.
+     *
+     * The stream is a sequence of tokens. A token starting with an on bit is the index of a dictionary entry,
+     * which is itself another dictionary compressed stream. Else it's a run of literal bytes, with its length
+     * encoded in a prefix code. Bits are read from the least significant bit of each byte.
+     *
+     * Tokens are at most 13 bits long, so each one is decoded from a single 32-bit window of the buffer.
     */
     struct dictcomp {
+        struct token {
+            bool is_dict_entry;
+            int dict_index; ///< Index of the dictionary entry, for dictionary token.
+            int literal_size; ///< Number of literal bytes following the token, for literal token.
+        };
+
+        const std::uint8_t *buffer;
+        int buffer_size; ///< Size of the buffer in bytes
+
         int num_bits_used_for_dict_tokens;
         int off_beg; ///< Begin offset in bit
-        int off_cur; ///< End offset in bit
-        int off_end;
-        bool owns_bit_buffer;
+        int off_cur; ///< Current offset in bit
+        int off_end; ///< End offset in bit
 
-        std::uint8_t *buffer;
+        explicit dictcomp(const std::uint8_t *buf, const int buf_size, const int off_beg, const int off_end,
+            const int num_bits_used_for_dict_tokens);
 
-        // Check if the current bit the stream pointing to is 1
-        bool is_cur_bit_on();
+        bool eos() const {
+            return off_cur >= off_end;
+        }
 
-        explicit dictcomp(std::uint8_t *buf, const int off_beg, const int off_end,
-            const int num_bits_used_for_dict_tokens);
+        /*! \brief Get the next 32 bits of the stream, without advancing. Bits past the buffer are zero.
+        */
+        std::uint32_t peek_bits() const;
 
-        /*! \brief Calculate the size of the buffer, when finish decompressing
+        /*! \brief Decode the next token and advance past it.
          *
-         * Size is in bytes.
+         * \param tok     The decoded token.
+         * \param calypso True if the stream is from a Calypso resource file.
+         *
+         * \returns False if the token goes past the end of the stream.
         */
-        int calculate_decompress_size(const bool calypso, bool reset_when_done = true);
+        bool next_token(token &tok, const bool calypso);
 
-        /*! \brief Reading specific number of bit, store it in a stream
+        /*! \brief Copy literal bytes following a literal token, and advance past them.
+         *
+         * \returns False if the bytes go past the end of the stream.
         */
-        int read_int(int num_bit);
-
-        int index_of_current_directory_entry();
-
-        int read(std::uint8_t *dest, int &dest_size, const bool calypso);
+        bool read_literal(std::uint8_t *dest, const int size);
     };
 }
\ No newline at end of file
@@ -20,7 +20,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 namespace eka2l1::common {
@@ -34,12 +36,23 @@ namespace eka2l1::common {
      * are saved as an UCS2 file.
      */
     class dynamic_ifile {
-        std::ifstream stream_;
+        std::ifstream file_stream_;
+        std::istringstream memory_stream_;
+        std::istream *stream_;
         int ucs2_;
 
+        void detect_encoding();
+
     public:
         explicit dynamic_ifile(const std::string &name);
 
+        /**
+         * \brief Read from a copy of the file content already in memory.
+         *
+         * Used for files that only live in the emulated filesystem, such as those in ROM images.
+         */
+        explicit dynamic_ifile(const std::uint8_t *data, const std::size_t size);
+
         /**
          * \brief Read a line to an 8-bit string
          *
@@ -61,11 +74,11 @@ namespace eka2l1::common {
         void seek(int mode, const std::size_t offset);
 
         bool eof() {
-            return stream_.eof();
+            return stream_->eof();
         }
 
         bool fail() {
-            return stream_.fail();
+            return stream_->fail();
         }
 
         inline bool is_ucs2() {
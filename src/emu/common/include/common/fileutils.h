@@ -90,7 +90,10 @@ namespace eka2l1::common {
     bool is_system_case_insensitive();
 
     struct dir_entry {
+        // Always filled, may be FILE_UNKN when the iterator is not in detail mode
         file_type type;
+
+        // Only filled in detail mode
         std::size_t size;
 
         std::string name;
@@ -300,7 +300,11 @@ namespace eka2l1::common {
         }
     };
 
+    class dynamic_ifile;
+
     class ini_file : public ini_section {
+        int load(dynamic_ifile &ifile, bool ignore_spaces);
+
     public:
         /*! \brief Load an INI file given a path
          * \returns 0 if success.
@@ -309,6 +313,11 @@ namespace eka2l1::common {
         */
         int load(const char *path, bool ignore_spaces = true);
 
+        /*! \brief Load an INI file from its content in memory
+         * \returns 0 if success, -2 if file is invalid (syntax invalid).
+        */
+        int load(const std::uint8_t *data, const std::size_t size, bool ignore_spaces = true);
+
         /*! \brief Save an ini file
         */
         // void save(const char *path);
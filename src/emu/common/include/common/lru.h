@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace eka2l1::common {
+    /**
+     * @brief Thread-safe least-recently-used cache, bounded by the total cost of its entries.
+     * 
+     * The cost of an entry is given on insertion, usually its size in bytes. When the total cost
+     * goes over the capacity, least recently used entries are evicted. The number of entries can
+     * also be bounded, for values that hold on to a limited resource.
+     */
+    template <typename K, typename V>
+    class lru_cache {
+        struct entry {
+            K key_;
+            V value_;
+            std::size_t cost_;
+        };
+
+        std::mutex lock_;
+        std::list<entry> entries_;
+        std::map<K, typename std::list<entry>::iterator> lookup_;
+
+        std::size_t capacity_;
+        std::size_t max_entries_;
+        std::size_t total_cost_;
+
+        std::size_t hits_;
+        std::size_t misses_;
+        std::size_t evictions_;
+
+        void evict_to(const std::size_t target, const std::size_t target_entries) {
+            while (((total_cost_ > target) || (entries_.size() > target_entries)) && !entries_.empty()) {
+                entry &last = entries_.back();
+
+                total_cost_ -= last.cost_;
+                lookup_.erase(last.key_);
+                entries_.pop_back();
+
+                evictions_++;
+            }
+        }
+
+    public:
+        explicit lru_cache(const std::size_t capacity, const std::size_t max_entries = std::numeric_limits<std::size_t>::max())
+            : capacity_(capacity)
+            , max_entries_(max_entries)
+            , total_cost_(0)
+            , hits_(0)
+            , misses_(0)
+            , evictions_(0) {
+        }
+
+        /**
+         * @brief   Get a copy of a cached value, and mark it as most recently used.
+         * @returns The value, or nullopt if it's not cached.
+         */
+        std::optional<V> get(const K &key) {
+            const std::lock_guard<std::mutex> guard(lock_);
+            auto ite = lookup_.find(key);
+
+            if (ite == lookup_.end()) {
+                misses_++;
+                return std::nullopt;
+            }
+
+            hits_++;
+            entries_.splice(entries_.begin(), entries_, ite->second);
+
+            return ite->second->value_;
+        }
+
+        /**
+         * @brief   Add or replace a value in the cache.
+         * 
+         * Values costing more than the whole capacity are not cached.
+         */
+        void put(const K &key, const V &value, const std::size_t cost) {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            auto ite = lookup_.find(key);
+            if (ite != lookup_.end()) {
+                total_cost_ -= ite->second->cost_;
+                entries_.erase(ite->second);
+                lookup_.erase(ite);
+            }
+
+            if ((cost > capacity_) || (max_entries_ == 0)) {
+                return;
+            }
+
+            evict_to(capacity_ - cost, max_entries_ - 1);
+
+            entries_.push_front({ key, value, cost });
+            lookup_.emplace(key, entries_.begin());
+            total_cost_ += cost;
+        }
+
+        void set_capacity(const std::size_t capacity) {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            capacity_ = capacity;
+            evict_to(capacity_, max_entries_);
+        }
+
+        void clear() {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            entries_.clear();
+            lookup_.clear();
+            total_cost_ = 0;
+        }
+
+        std::size_t total_cost() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            return total_cost_;
+        }
+
+        std::size_t count() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            return entries_.size();
+        }
+
+        std::size_t hits() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            return hits_;
+        }
+
+        std::size_t misses() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            return misses_;
+        }
+
+        std::size_t evictions() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            return evictions_;
+        }
+    };
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace eka2l1::common {
+    /**
+     * @brief Lock-free ring buffer for one producer thread and one consumer thread.
+     * 
+     * Storage is allocated once on construction, push and pop never allocate nor block, so
+     * this is safe to use from real-time threads (such as audio callbacks).
+     * 
+     * Read and write positions keep increasing and are never wrapped, so they can also be used
+     * as the total number of elements that has gone through the buffer.
+     */
+    template <typename T>
+    class ring_buffer {
+        static_assert(std::is_trivially_copyable_v<T>, "Ring buffer element must be trivially copyable");
+
+        std::vector<T> data_;
+        std::size_t mask_;
+
+        alignas(64) std::atomic<std::size_t> read_pos_;
+        alignas(64) std::atomic<std::size_t> write_pos_;
+
+    public:
+        /**
+         * @brief   Construct the ring buffer.
+         * @param   capacity    Minimum number of elements the buffer can hold. Rounded up to power of two.
+         */
+        explicit ring_buffer(const std::size_t capacity)
+            : read_pos_(0)
+            , write_pos_(0) {
+            std::size_t real_capacity = 1;
+
+            while (real_capacity < capacity) {
+                real_capacity <<= 1;
+            }
+
+            data_.resize(real_capacity);
+            mask_ = real_capacity - 1;
+        }
+
+        std::size_t capacity() const {
+            return data_.size();
+        }
+
+        /**
+         * @brief   Get number of elements available to be popped.
+         */
+        std::size_t size() const {
+            return write_pos_.load(std::memory_order_acquire) - read_pos_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief   Get number of elements that can be pushed.
+         */
+        std::size_t free_space() const {
+            return capacity() - size();
+        }
+
+        std::size_t read_position() const {
+            return read_pos_.load(std::memory_order_acquire);
+        }
+
+        std::size_t write_position() const {
+            return write_pos_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief   Push elements to the buffer. Only call this from the producer thread.
+         * 
+         * @param   data        Elements to push.
+         * @param   count       Number of elements to push.
+         * 
+         * @returns Number of elements pushed, may be smaller than requested if the buffer is full.
+         */
+        std::size_t push(const T *data, std::size_t count) {
+            const std::size_t write = write_pos_.load(std::memory_order_relaxed);
+            const std::size_t read = read_pos_.load(std::memory_order_acquire);
+
+            count = std::min(count, capacity() - (write - read));
+
+            const std::size_t start = write & mask_;
+            const std::size_t first_part = std::min(count, capacity() - start);
+
+            std::memcpy(data_.data() + start, data, first_part * sizeof(T));
+            std::memcpy(data_.data(), data + first_part, (count - first_part) * sizeof(T));
+
+            write_pos_.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief   Pop elements from the buffer. Only call this from the consumer thread.
+         * 
+         * @param   dest        Destination to copy elements to.
+         * @param   count       Maximum number of elements to pop.
+         * 
+         * @returns Number of elements popped.
+         */
+        std::size_t pop(T *dest, std::size_t count) {
+            const std::size_t read = read_pos_.load(std::memory_order_relaxed);
+            const std::size_t write = write_pos_.load(std::memory_order_acquire);
+
+            count = std::min(count, write - read);
+
+            const std::size_t start = read & mask_;
+            const std::size_t first_part = std::min(count, capacity() - start);
+
+            std::memcpy(dest, data_.data() + start, first_part * sizeof(T));
+            std::memcpy(dest + first_part, data_.data(), (count - first_part) * sizeof(T));
+
+            read_pos_.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief   Drop elements until the read position reaches the given position. Only call this from the consumer thread.
+         * 
+         * @param   position    The position to skip to. Clamped to the current write position.
+         */
+        void skip_to(const std::size_t position) {
+            const std::size_t read = read_pos_.load(std::memory_order_relaxed);
+            const std::size_t write = write_pos_.load(std::memory_order_acquire);
+
+            if (position <= read) {
+                return;
+            }
+
+            read_pos_.store(std::min(position, write), std::memory_order_release);
+        }
+    };
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace eka2l1::common {
+    /**
+     * @brief Process-wide cache of immutable resources, shared between emulator instances.
+     * 
+     * The cache only keeps weak references. A resource lives as long as one instance still
+     * uses it, and is created again the next time it's requested after that.
+     * 
+     * Resources handed out must not be modified.
+     */
+    template <typename K, typename T>
+    class shared_cache {
+        std::mutex lock_;
+        std::unordered_map<K, std::weak_ptr<T>> entries_;
+
+        void remove_expired() {
+            for (auto ite = entries_.begin(); ite != entries_.end();) {
+                if (ite->second.expired()) {
+                    ite = entries_.erase(ite);
+                } else {
+                    ite++;
+                }
+            }
+        }
+
+    public:
+        /**
+         * @brief   Get a resource from the cache, or create it if nobody is using it.
+         * 
+         * Creation runs with the cache locked, so instances requesting the same resource at the
+         * same time wait for a single creation instead of doing the same work.
+         * 
+         * @param   key         The key of the resource.
+         * @param   factory     Function to create the resource. May return null on failure, which is not cached.
+         * 
+         * @returns The shared resource, or null if it can't be created.
+         */
+        std::shared_ptr<T> get_or_create(const K &key, const std::function<std::shared_ptr<T>()> &factory) {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            auto ite = entries_.find(key);
+
+            if (ite != entries_.end()) {
+                if (std::shared_ptr<T> existing = ite->second.lock()) {
+                    return existing;
+                }
+            }
+
+            std::shared_ptr<T> created = factory();
+
+            if (created) {
+                remove_expired();
+                entries_[key] = created;
+            }
+
+            return created;
+        }
+
+        /**
+         * @brief   Get number of resources currently alive.
+         */
+        std::size_t size() {
+            const std::lock_guard<std::mutex> guard(lock_);
+            remove_expired();
+
+            return entries_.size();
+        }
+    };
+}
@@ -27,6 +27,9 @@ namespace eka2l1::common {
     /**
      * \brief Map memory with defined size.
      *
+     * The memory is only reserved, commit it before use. Regions of 2 MiB or more are aligned to
+     * 2 MiB and hinted to be backed by huge pages when the host supports it.
+     *
      * \returns A valid pointer on success. Nullptr is fail.
     */
     void *map_memory(const std::size_t size);
@@ -57,12 +60,29 @@ namespace eka2l1::common {
     /**
      * \brief Decommit memory region.
      *
+     * The physical pages are returned to the host. Their content is lost, and they read as zero
+     * when committed again.
+     *
      * \param ptr Pointer to the target region.
      * \param size Size of the memory to be decommitted.
+     * \param file_view True if part of the region was mapped with map_memory_file_private. The view
+     *                  is then replaced with anonymous memory, instead of only dropping its pages.
      * 
      * \returns True on success, false on failure.
     */
-    bool decommit(void *ptr, const std::size_t size);
+    bool decommit(void *ptr, const std::size_t size, const bool file_view = false);
+
+    /**
+     * \brief Get how much of a memory region is backed by physical host memory.
+     *
+     * Committed memory only takes physical memory once it is touched.
+     *
+     * \param ptr Pointer to the target region. Must be aligned to host page size.
+     * \param size Size of the region.
+     *
+     * \returns Resident size in bytes. 0 if the host does not support querying it.
+    */
+    std::size_t get_resident_size(void *ptr, const std::size_t size);
 
     /**
      * \brief Change protection of committed region
@@ -95,12 +115,49 @@ namespace eka2l1::common {
     void *map_file(const std::string &file_name, const prot perm = prot_read, const std::size_t size = 0,
         const bool is_private = false);
 
+    /**
+     * \brief Create an anonymous host file holding a copy of some memory.
+     *
+     * The file can later be mapped copy-on-write with map_memory_file_private. All places it's mapped
+     * to share the same host pages, until they are written to.
+     *
+     * \param data Pointer to the memory to copy.
+     * \param size Size of the memory to copy.
+     *
+     * \returns Handle to the file on success. -1 on failure, or if the host does not support it.
+    */
+    std::int64_t create_memory_file(const void *data, const std::size_t size);
+
+    /**
+     * \brief Map a file created by create_memory_file over an existing reserved memory region, copy-on-write.
+     *
+     * Decommit the region with file_view set, so the view is dropped along with its pages.
+     *
+     * \param dest Host page-aligned pointer to the region to be replaced.
+     * \param size Size of the region. Must not exceed the size of the file.
+     * \param handle Handle returned by create_memory_file.
+     * \param perm The permission of mapped pages.
+     *
+     * \returns True on success.
+    */
+    bool map_memory_file_private(void *dest, const std::size_t size, const std::int64_t handle, const prot perm);
+
+    /**
+     * \brief Close a file created by create_memory_file.
+     *
+     * Regions that the file was mapped to stay valid.
+    */
+    void close_memory_file(const std::int64_t handle);
+
     /**
      * \brief Unmap a file mapped to memory
      *
+     * \param ptr  Pointer returned by map_file.
+     * \param size Size of the mapped region. Required for the mapping to be released on POSIX systems.
+     *
      * \returns True on success.
     */
-    bool unmap_file(void *ptr);
+    bool unmap_file(void *ptr, const std::size_t size = 0);
 
     /**
      * @param   Align address to host page size
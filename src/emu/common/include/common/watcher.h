@@ -44,7 +44,7 @@ namespace eka2l1::common {
     };
 
     struct directory_change {
-        std::string filename_;
+        std::string filename_; ///< Empty if the change is on the watched directory itself.
         std::uint32_t change_;
     };
 
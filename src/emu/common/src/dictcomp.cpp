@@ -25,135 +25,112 @@
 #include <common/dictcomp.h>
 #include <common/log.h>
 
+#include <cstring>
+
 namespace eka2l1::common {
-    dictcomp::dictcomp(std::uint8_t *buf, const int off_beg, const int off_end,
+    dictcomp::dictcomp(const std::uint8_t *buf, const int buf_size, const int off_beg, const int off_end,
         const int num_bits_used_for_dict_tokens)
-        : num_bits_used_for_dict_tokens(num_bits_used_for_dict_tokens)
+        : buffer(buf)
+        , buffer_size(buf_size)
+        , num_bits_used_for_dict_tokens(num_bits_used_for_dict_tokens)
         , off_beg(off_beg)
-        , off_end(off_end)
-        , buffer(buf) {
+        , off_cur(off_beg)
+        , off_end(common::min(off_end, buf_size * 8)) {
     }
 
-    bool dictcomp::is_cur_bit_on() {
-        return buffer[off_cur / 8] & (1 << (off_cur) % 8);
-    }
+    std::uint32_t dictcomp::peek_bits() const {
+        const int byte_off = off_cur >> 3;
+        std::uint32_t window = 0;
 
-    int dictcomp::index_of_current_directory_entry() {
-        if (is_cur_bit_on()) {
-            ++off_cur;
-            return read_int(num_bits_used_for_dict_tokens);
+        if (byte_off + 4 <= buffer_size) {
+            std::memcpy(&window, buffer + byte_off, 4);
+        } else {
+            for (int i = 0; byte_off + i < buffer_size; i++) {
+                window |= static_cast<std::uint32_t>(buffer[byte_off + i]) << (i * 8);
+            }
         }
 
-        return -1;
+        // At least 25 valid bits left after the shift, enough for any token
+        return window >> (off_cur & 7);
     }
 
-    int dictcomp::read_int(int num_bit) {
-        int result = 0;
-
-        auto do_read_bits_seperately = [&]() {
-            // If the offset is not aligned, we can't read this properly
-            // We need to do some bits tweaking, to read these byte to an integer, then align the bit offset to 8
-            if (off_cur % 8 != 0) {
-                int num_bit_to_read_next = common::min(num_bit, 8 - off_cur % 8);
-                char me = buffer[off_cur % 8];
-
-                // Example:
-                // 0b11110000, from bit 1, size = 3
-                // => 0b11100000
-                // 0b11111111 << 5 = 0b11100000
-                // => 0b11100000 & 0b11100000 => 0b111
-                result = (result << 8) | (me << (off_cur % 8) & (0xFF << (8 - num_bit_to_read_next)));
-
-                off_cur += num_bit_to_read_next;
-                num_bit -= num_bit_to_read_next;
-            }
-        };
-
-        // Do align if neccessary
-        do_read_bits_seperately();
+    bool dictcomp::next_token(token &tok, const bool calypso) {
+        std::uint32_t bits = peek_bits();
 
-        if (num_bit <= 0) {
-            return result;
-        }
-
-        // Read byte by byte
-        for (int i = 0; i < num_bit / 8; i++) {
-            result = (result << 8) | buffer[off_cur / 8];
-            off_cur += 8;
-        }
+        if (bits & 1) {
+            tok.is_dict_entry = true;
+            tok.dict_index = static_cast<int>((bits >> 1) & ((1 << num_bits_used_for_dict_tokens) - 1));
+            tok.literal_size = 0;
 
-        if (num_bit <= 0) {
-            return result;
+            off_cur += 1 + num_bits_used_for_dict_tokens;
+            return off_cur <= off_end;
         }
 
-        // Try to read left-out bits, if we haven't read them all
-        do_read_bits_seperately();
+        // Prefix code of the literal size: up to four on bits, terminated by an off bit if there are less than four
+        bits >>= 1;
 
-        return result;
-    }
-
-    int dictcomp::calculate_decompress_size(const bool calypso, bool reset_when_done) {
-        int last_off_cur = off_cur;
         int num_consecutive_prefix_bits = 0;
+        while ((num_consecutive_prefix_bits < 4) && (bits & 1)) {
+            num_consecutive_prefix_bits++;
+            bits >>= 1;
+        }
 
-        for (std::uint8_t i = 0; i < 4; i++) {
-            bool cur_bit_on = is_cur_bit_on();
-            off_cur++;
-
-            if (!cur_bit_on) {
-                break;
-            }
+        int consumed = 1 + num_consecutive_prefix_bits;
 
-            num_consecutive_prefix_bits++;
+        if (num_consecutive_prefix_bits < 4) {
+            bits >>= 1;
+            consumed++;
         }
 
-        int num_bytes_to_read = 0;
+        tok.is_dict_entry = false;
+        tok.dict_index = -1;
+
+        switch (num_consecutive_prefix_bits) {
+        case 3:
+            tok.literal_size = 4 + static_cast<int>(bits & 0b111);
+            consumed += 3;
+            break;
 
-        if (num_consecutive_prefix_bits == 3) {
-            num_bytes_to_read = 3 + read_int(3);
-        } else if (num_consecutive_prefix_bits == 4) {
-            num_bytes_to_read = 4 + read_int(8);
+        case 4:
+            tok.literal_size = static_cast<int>(bits & 0xFF);
+            consumed += 8;
 
             if (!calypso) {
-                num_bytes_to_read = 3 + (1 << 3);
+                tok.literal_size += 3 + (1 << 3) + 1;
             }
-        } else {
-            num_bytes_to_read = num_consecutive_prefix_bits;
-        }
 
-        if (reset_when_done) {
-            off_cur = last_off_cur;
+            break;
+
+        default:
+            tok.literal_size = num_consecutive_prefix_bits + 1;
+            break;
         }
 
-        return num_bytes_to_read;
+        off_cur += consumed;
+        return off_cur <= off_end;
     }
 
-    int dictcomp::read(std::uint8_t *dest, int &dest_size, const bool calypso) {
-        // These size in bytes
-        int size = calculate_decompress_size(calypso, false);
-        int *dest_i = reinterpret_cast<int *>(dest);
-
-        if (size > dest_size) {
-            LOG_ERROR(COMMON, "Can't decompress: unsufficent memory (needed: 0x{:X} vs provided 0x{:X})", size, dest_size);
-            return -1;
+    bool dictcomp::read_literal(std::uint8_t *dest, const int size) {
+        if (off_cur + size * 8 > off_end) {
+            LOG_ERROR(COMMON, "Literal run of {} bytes goes past the end of dictionary compressed stream", size);
+            return false;
         }
 
-        const int num_bits_off_byte_bound = off_cur % 8;
-        const std::uint8_t *cur_byte = buffer + (off_cur / 8);
+        const int num_bits_off_byte_bound = off_cur & 7;
+        const std::uint8_t *cur_byte = buffer + (off_cur >> 3);
 
-        for (int i = 0; i < size; i++, ++cur_byte) {
-            int b = *cur_byte;
+        if (num_bits_off_byte_bound == 0) {
+            std::memcpy(dest, cur_byte, size);
+        } else {
+            const int last_byte_off = buffer_size - 1 - (off_cur >> 3);
 
-            if (num_bits_off_byte_bound > 0) {
-                b >>= num_bits_off_byte_bound;
-                b |= (*(cur_byte) + 1) << (8 - num_bits_off_byte_bound);
-                b &= 0xFF;
+            for (int i = 0; i < size; i++) {
+                const std::uint32_t high = (i < last_byte_off) ? cur_byte[i + 1] : 0;
+                dest[i] = static_cast<std::uint8_t>((cur_byte[i] >> num_bits_off_byte_bound) | (high << (8 - num_bits_off_byte_bound)));
             }
-
-            *(dest_i++) = b;
         }
 
         off_cur += size * 8;
-        return size;
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -23,11 +23,22 @@
 
 namespace eka2l1::common {
     dynamic_ifile::dynamic_ifile(const std::string &name)
-        : stream_(name, std::ios::binary) {
+        : file_stream_(name, std::ios::binary)
+        , stream_(&file_stream_) {
+        detect_encoding();
+    }
+
+    dynamic_ifile::dynamic_ifile(const std::uint8_t *data, const std::size_t size)
+        : memory_stream_(std::string(reinterpret_cast<const char *>(data), size), std::ios::binary)
+        , stream_(&memory_stream_) {
+        detect_encoding();
+    }
+
+    void dynamic_ifile::detect_encoding() {
         // Read the POM
         std::uint16_t pom = 0;
 
-        stream_.read(reinterpret_cast<char *>(&pom), sizeof(pom));
+        stream_->read(reinterpret_cast<char *>(&pom), sizeof(pom));
 
         if (pom == 0xFEFF) {
             // Little-endian
@@ -37,7 +48,7 @@ namespace eka2l1::common {
             ucs2_ = 1;
         } else {
             ucs2_ = -1;
-            stream_.seekg(0, std::ios::beg);
+            stream_->seekg(0, std::ios::beg);
         }
     }
 
@@ -53,20 +64,20 @@ namespace eka2l1::common {
         }
 
         // Read it until we get a newline
-        return bool(std::getline(stream_, line));
+        return bool(std::getline(*stream_, line));
     }
 
     bool dynamic_ifile::getline(std::u16string &line) {
         if (ucs2_ == -1) {
             std::string line_utf8;
-            bool result(std::getline(stream_, line_utf8));
+            bool result(std::getline(*stream_, line_utf8));
 
             line = common::utf8_to_ucs2(line_utf8);
 
             return result;
         }
 
-        if (stream_.fail() || stream_.eof()) {
+        if (stream_->fail() || stream_->eof()) {
             return false;
         }
 
@@ -77,15 +88,15 @@ namespace eka2l1::common {
             char hi = 0;
 
             if (ucs2_ == 1) {
-                stream_.read(&hi, 1);
-                stream_.read(&lo, 1);
+                stream_->read(&hi, 1);
+                stream_->read(&lo, 1);
             } else {
-                stream_.read(&lo, 1);
-                stream_.read(&hi, 1);
+                stream_->read(&lo, 1);
+                stream_->read(&hi, 1);
             }
 
-            if ((static_cast<char16_t>((hi << 8) | lo) == u'\n') || (stream_.fail()) ||
-                (stream_.eof())) {
+            if ((static_cast<char16_t>((hi << 8) | lo) == u'\n') || (stream_->fail()) ||
+                (stream_->eof())) {
                 return true;
             }
 
@@ -97,7 +108,7 @@ namespace eka2l1::common {
 
     void dynamic_ifile::read(std::string &line, const std::size_t len) {
         if (ucs2_ < 0) {
-            stream_.read(&line[0], len);
+            stream_->read(&line[0], len);
             return;
         }
 
@@ -113,7 +124,7 @@ namespace eka2l1::common {
             std::string d;
             d.resize(len);
 
-            stream_.read(&d[0], len);
+            stream_->read(&d[0], len);
             line = common::utf8_to_ucs2(d);
         }
 
@@ -124,18 +135,18 @@ namespace eka2l1::common {
             char hi = 0;
 
             if (ucs2_ == 1) {
-                stream_.read(&hi, 1);
-                stream_.read(&lo, 1);
+                stream_->read(&hi, 1);
+                stream_->read(&lo, 1);
             } else {
-                stream_.read(&lo, 1);
-                stream_.read(&hi, 1);
+                stream_->read(&lo, 1);
+                stream_->read(&hi, 1);
             }
 
             if (static_cast<char16_t>((hi << 8) | lo) == u'\n') {
                 break;
             }
 
-            if (stream_.fail() || stream_.eof()) {
+            if (stream_->fail() || stream_->eof()) {
                 return;
             }
 
@@ -157,11 +168,11 @@ namespace eka2l1::common {
         if (ucs2_ >= 0) {
             // Append 2 to skip POM
             // offset * 2 because it's an ucs2 file (4 bytes / character)
-            stream_.seekg(2 + offset * 2, dir);
+            stream_->seekg(2 + offset * 2, dir);
             return;
         }
 
-        stream_.seekg(offset, dir);
+        stream_->seekg(offset, dir);
         return;
     }
 }
\ No newline at end of file
@@ -133,6 +133,7 @@ namespace eka2l1::common {
 
     dir_iterator::dir_iterator(const std::string &name)
         : handle(nullptr)
+        , find_data(nullptr)
         , eof(false)
         , detail(false)
         , dir_name(name) {
@@ -229,10 +230,10 @@ namespace eka2l1::common {
         LPWIN32_FIND_DATA fdata_win32 = reinterpret_cast<decltype(fdata_win32)>(find_data);
 
         entry.name = fdata_win32->cFileName;
+        entry.type = get_file_type_from_attrib_platform_specific(fdata_win32->dwFileAttributes);
 
         if (detail) {
             entry.size = (fdata_win32->nFileSizeLow | (__int64)fdata_win32->nFileSizeHigh << 32);
-            entry.type = get_file_type_from_attrib_platform_specific(fdata_win32->dwFileAttributes);
         }
 
         cycles_to_next_entry();
@@ -244,6 +245,21 @@ namespace eka2l1::common {
         if (detail) {
             entry.size = file_size(dir_name + "/" + entry.name);
             entry.type = get_file_type(dir_name + "/" + entry.name);
+        } else {
+            // Free to get from the directory stream, but not every filesystem fills it
+            switch (d->d_type) {
+            case DT_DIR:
+                entry.type = FILE_DIRECTORY;
+                break;
+
+            case DT_REG:
+                entry.type = FILE_REGULAR;
+                break;
+
+            default:
+                entry.type = FILE_UNKN;
+                break;
+            }
         }
 
         do {
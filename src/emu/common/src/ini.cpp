@@ -345,6 +345,15 @@ namespace eka2l1::common {
             return -1;
         }
 
+        return load(ifile, ignore_spaces);
+    }
+
+    int ini_file::load(const std::uint8_t *data, const std::size_t size, bool ignore_spaces) {
+        common::dynamic_ifile ifile(data, size);
+        return load(ifile, ignore_spaces);
+    }
+
+    int ini_file::load(dynamic_ifile &ifile, bool ignore_spaces) {
         ini_section *sec = reinterpret_cast<ini_section *>(this);
         std::string line;
 
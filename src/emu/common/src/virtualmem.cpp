@@ -21,6 +21,8 @@
 #include <common/platform.h>
 #include <common/virtualmem.h>
 
+#include <vector>
+
 #if EKA2L1_PLATFORM(WIN32)
 #include <Windows.h>
 #elif EKA2L1_PLATFORM(UNIX) || EKA2L1_PLATFORM(DARWIN)
@@ -29,16 +31,59 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 #endif
 
 namespace eka2l1::common {
+    static constexpr std::size_t HUGE_PAGE_SIZE = 0x200000;
+
+#if !EKA2L1_PLATFORM(WIN32)
+    static void hint_huge_pages(void *ptr, const std::size_t size) {
+#ifdef MADV_HUGEPAGE
+        // Only a hint. Large heaps and framebuffers get fewer faults and TLB misses when honored
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+#endif
+
     void *map_memory(const std::size_t size) {
 #if EKA2L1_PLATFORM(WIN32)
         return VirtualAlloc(nullptr, size,
             MEM_RESERVE, PAGE_NOACCESS);
 #else
-        return mmap(nullptr, size, PROT_NONE,
-            MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+        if (size < HUGE_PAGE_SIZE) {
+            void *result = mmap(nullptr, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+            return (result == MAP_FAILED) ? nullptr : result;
+        }
+
+        // Reserve more, so that the region can start at a huge page boundary, then give back the excess
+        const std::size_t reserve_size = size + HUGE_PAGE_SIZE;
+        void *reserved = mmap(nullptr, reserve_size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+
+        if (reserved == MAP_FAILED) {
+            return nullptr;
+        }
+
+        std::uint8_t *reserved_start = reinterpret_cast<std::uint8_t *>(reserved);
+        std::uint8_t *aligned_start = reinterpret_cast<std::uint8_t *>((reinterpret_cast<std::uintptr_t>(reserved)
+            + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+
+        const std::size_t head = aligned_start - reserved_start;
+        const std::size_t tail = reserve_size - head - size;
+
+        if (head) {
+            munmap(reserved_start, head);
+        }
+
+        if (tail) {
+            munmap(aligned_start + size, tail);
+        }
+
+        hint_huge_pages(aligned_start, size);
+        return aligned_start;
 #endif
     }
 
@@ -77,22 +122,71 @@ namespace eka2l1::common {
         return true;
     }
 
-    bool decommit(void *ptr, const std::size_t size) {
+    bool decommit(void *ptr, const std::size_t size, const bool file_view) {
 #if EKA2L1_PLATFORM(WIN32)
         const auto res = VirtualFree(ptr, size, MEM_DECOMMIT);
 
         if (!res) {
+            return false;
+        }
 #else
-        const auto result = mprotect(ptr, size, PROT_NONE);
-
-        if (result == -1) {
+#if !EKA2L1_PLATFORM(DARWIN)
+        if (!file_view) {
+            // Private anonymous pages read as zero after this. The mapping stays, with its huge page hint
+            if ((madvise(ptr, size, MADV_DONTNEED) == -1) || (mprotect(ptr, size, PROT_NONE) == -1)) {
+                return false;
+            }
+
+            return true;
+        }
 #endif
+
+        // A file view would bring the file content back, and Darwin may keep the content of advised pages.
+        // Map fresh anonymous memory over the range, so the pages read as zero when committed again.
+        const void *result = mmap(ptr, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0);
+
+        if (result == MAP_FAILED) {
             return false;
         }
 
+        // The new mapping does not inherit the hint of the one it replaced
+        hint_huge_pages(ptr, size);
+#endif
+
         return true;
     }
 
+    std::size_t get_resident_size(void *ptr, const std::size_t size) {
+#if EKA2L1_PLATFORM(POSIX)
+        const std::size_t page_size = static_cast<std::size_t>(get_host_page_size());
+        const std::size_t page_count = (size + page_size - 1) / page_size;
+
+        std::vector<std::uint8_t> page_states(page_count);
+
+#if EKA2L1_PLATFORM(DARWIN)
+        char *states_ptr = reinterpret_cast<char *>(page_states.data());
+#else
+        unsigned char *states_ptr = page_states.data();
+#endif
+
+        if (mincore(ptr, size, states_ptr) == -1) {
+            return 0;
+        }
+
+        std::size_t resident = 0;
+
+        for (const std::uint8_t state : page_states) {
+            if (state & 1) {
+                resident += page_size;
+            }
+        }
+
+        return resident;
+#else
+        return 0;
+#endif
+    }
+
     bool change_protection(void *ptr, const std::size_t size,
         const prot new_prot) {
 #if EKA2L1_PLATFORM(WIN32)
@@ -243,14 +337,88 @@ namespace eka2l1::common {
         }
 
         auto map_ptr = mmap(nullptr, map_size, prot_mode, MAP_PRIVATE, file_handle, 0);
+
+        // The mapping keeps its own reference to the file
+        close(file_handle);
+
+        if (map_ptr == MAP_FAILED) {
+            return nullptr;
+        }
 #endif
 
         return map_ptr;
     }
 
-    bool unmap_file(void *ptr) {
+    std::int64_t create_memory_file(const void *data, const std::size_t size) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+        // Call through syscall, the libc wrapper is missing on older glibc and Android
+        const int file_handle = static_cast<int>(syscall(SYS_memfd_create, "eka2l1-memfile", 0));
+
+        if (file_handle == -1) {
+            return -1;
+        }
+
+        if (ftruncate(file_handle, static_cast<off_t>(size)) == -1) {
+            close(file_handle);
+            return -1;
+        }
+
+        const std::uint8_t *source = reinterpret_cast<const std::uint8_t *>(data);
+        std::size_t written = 0;
+
+        while (written < size) {
+            const ssize_t result = pwrite(file_handle, source + written, size - written, static_cast<off_t>(written));
+
+            if (result <= 0) {
+                close(file_handle);
+                return -1;
+            }
+
+            written += static_cast<std::size_t>(result);
+        }
+
+        return file_handle;
+#else
+        // Views of a pagefile-backed section can't be placed over a reserved region on Windows,
+        // and there is no anonymous file to rely on elsewhere
+        return -1;
+#endif
+    }
+
+    bool map_memory_file_private(void *dest, const std::size_t size, const std::int64_t handle, const prot perm) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+        if (handle < 0) {
+            return false;
+        }
+
+        void *map_ptr = mmap(dest, size, translate_protection(perm), MAP_PRIVATE | MAP_FIXED, static_cast<int>(handle), 0);
+
+        if (map_ptr == MAP_FAILED) {
+            return false;
+        }
+
+        hint_huge_pages(dest, size);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close_memory_file(const std::int64_t handle) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+        if (handle >= 0) {
+            close(static_cast<int>(handle));
+        }
+#endif
+    }
+
+    bool unmap_file(void *ptr, const std::size_t size) {
 #if EKA2L1_PLATFORM(WIN32)
         UnmapViewOfFile(ptr);
+#else
+        if (size != 0) {
+            return munmap(ptr, size) == 0;
+        }
 #endif
 
         return true;
@@ -20,13 +20,16 @@
 #include "watcher_unix.h"
 #include <common/log.h>
 
+#include <errno.h>
+#include <poll.h>
 #include <sys/inotify.h>
 
 namespace eka2l1::common {
     static constexpr std::size_t EVENT_MAX_SIZE = sizeof(struct inotify_event) + 16;
 
     directory_watcher_impl::directory_watcher_impl()
-        : should_stop(false) {
+        : should_stop(false)
+        , stop_event_(-1) {
         instance_ = inotify_init();
 
         if (instance_ == -1) {
@@ -34,6 +37,9 @@ namespace eka2l1::common {
             return;
         }
 
+        // Used to wake the wait thread up on destruction, even when nothing is watched
+        stop_event_ = eventfd(0, 0);
+
         // 512 is maximum event count
         events_.resize(EVENT_MAX_SIZE * 512);
 
@@ -41,18 +47,48 @@ namespace eka2l1::common {
             std::vector<directory_change> changes;
 
             auto flush_changes = [&](const int wd) {
-                // Flush changes
-                auto ite = std::find(container_.begin(), container_.end(), wd);
+                directory_watcher_callback_pair callback_pair;
+
+                {
+                    // Copy the callback out, so that the callback itself can do watch/unwatch
+                    const std::lock_guard<std::mutex> guard(lock_);
+                    auto ite = std::find(container_.begin(), container_.end(), wd);
 
-                if (ite != container_.end()) {
-                    auto &callback = callbacks_[std::distance(container_.begin(), ite)];
-                    callback.callback_pair_.first(callback.callback_pair_.second, changes);
+                    if (ite == container_.end()) {
+                        changes.clear();
+                        return;
+                    }
 
-                    changes.clear();
+                    callback_pair = callbacks_[std::distance(container_.begin(), ite)].callback_pair_;
                 }
+
+                callback_pair.first(callback_pair.second, changes);
+                changes.clear();
             };
 
+            struct pollfd fds[2];
+            fds[0].fd = instance_;
+            fds[0].events = POLLIN;
+            fds[1].fd = stop_event_;
+            fds[1].events = POLLIN;
+
             while (!should_stop) {
+                fds[0].revents = 0;
+                fds[1].revents = 0;
+
+                if (poll(fds, (stop_event_ == -1) ? 1 : 2, -1) == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    LOG_ERROR(COMMON, "Error polling notify event!");
+                    break;
+                }
+
+                if (should_stop || (fds[1].revents & POLLIN)) {
+                    break;
+                }
+
                 const ssize_t length = read(instance_, &events_[0], events_.size());
 
                 if (length == -1) {
@@ -68,6 +104,11 @@ namespace eka2l1::common {
                 while (i < length) {
                     struct inotify_event *evt = reinterpret_cast<struct inotify_event *>(&events_[i]);
 
+                    // Changes are grouped per watch, flush the previous group before starting a new one
+                    if ((last_wd != -1) && (last_wd != evt->wd) && !changes.empty()) {
+                        flush_changes(last_wd);
+                    }
+
                     directory_change change;
                     change.change_ = 0;
                     change.filename_.assign(evt->name, evt->name + evt->len);
@@ -100,14 +141,38 @@ namespace eka2l1::common {
                         change.change_ |= directory_change_action_modified;
                     }
 
-                    changes.push_back(change);
+                    // The watched directory itself is gone. Reported with an empty file name.
+                    if (evt->mask & IN_DELETE_SELF) {
+                        change.change_ |= directory_change_action_delete;
+                    }
+
+                    if (evt->mask & IN_MOVE_SELF) {
+                        change.change_ |= directory_change_action_moved_from;
+                    }
 
-                    if ((last_wd != -1) && (last_wd != evt->wd)) {
-                        flush_changes(evt->wd);
+                    if (change.change_ != 0) {
+                        changes.push_back(change);
                     }
 
                     last_wd = evt->wd;
                     i += evt->len + sizeof(struct inotify_event);
+
+                    if (evt->mask & IN_IGNORED) {
+                        // The host dropped the watch (directory deleted, or unmounted). Nothing more comes from it.
+                        if (!changes.empty()) {
+                            flush_changes(last_wd);
+                        }
+
+                        const std::lock_guard<std::mutex> guard(lock_);
+                        auto ite = std::find(container_.begin(), container_.end(), last_wd);
+
+                        if (ite != container_.end()) {
+                            callbacks_.erase(callbacks_.begin() + std::distance(container_.begin(), ite));
+                            container_.erase(ite);
+                        }
+
+                        last_wd = -1;
+                    }
                 }
 
                 if (changes.size() != 0) {
@@ -118,17 +183,35 @@ namespace eka2l1::common {
     }
 
     directory_watcher_impl::~directory_watcher_impl() {
-        for (auto &wd : container_) {
-            inotify_rm_watch(instance_, wd);
+        {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            for (auto &wd : container_) {
+                inotify_rm_watch(instance_, wd);
+            }
         }
 
         should_stop = true;
-        wait_thread_->join();
+
+        if (stop_event_ != -1) {
+            const std::uint64_t signal_value = 1;
+            [[maybe_unused]] const ssize_t written = write(stop_event_, &signal_value, sizeof(signal_value));
+        }
+
+        if (wait_thread_) {
+            wait_thread_->join();
+        }
+
+        if (stop_event_ != -1) {
+            close(stop_event_);
+        }
 
         close(instance_);
     }
 
     bool directory_watcher_impl::unwatch(const std::int32_t watch_handle) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
         // Find in container
         auto ite = std::find(container_.begin(), container_.end(), watch_handle);
 
@@ -174,13 +257,16 @@ namespace eka2l1::common {
 
     std::int32_t directory_watcher_impl::watch(const std::string &folder, directory_watcher_callback callback,
         void *callback_userdata, const std::uint32_t mask) {
-        const int wd_handle = inotify_add_watch(instance_, folder.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY);
+        const int wd_handle = inotify_add_watch(instance_, folder.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY
+            | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
 
         if (wd_handle == -1) {
             LOG_ERROR(COMMON, "Error creating new inotify watch!");
             return 0;
         }
 
+        const std::lock_guard<std::mutex> guard(lock_);
+
         container_.push_back(wd_handle);
         callbacks_.emplace_back(callback, callback_userdata, convert_to_unix_notify_mask(mask));
 
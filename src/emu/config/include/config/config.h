@@ -61,6 +61,9 @@ namespace eka2l1::config {
         bool log_passed{ false };
         bool log_exports{ false };
 
+        std::string mem_trace_path;
+        std::string mem_trace_ranges;
+
         std::string cpu_backend{ "dynarmic" };
         int device{ 0 };
         int language{ -1 };
@@ -93,7 +96,9 @@ namespace eka2l1::config {
         bool hide_mouse_in_screen_space { false };
         bool nearest_neighbor_filtering { true };
         bool integer_scaling { true };
+        bool present_on_thread { false };
         bool cpu_load_save { true };
+        bool codeseg_cow_templates { false };
 
         std::atomic<bool> stepping { false };
         std::string rtos_level;
@@ -35,6 +35,8 @@ OPTION(log-ipc, log_ipc, false)
 OPTION(log-svc, log_svc, false)
 OPTION(log-passed, log_passed, false)
 OPTION(log-exports, log_exports, false)
+OPTION(mem-trace-path, mem_trace_path, "")
+OPTION(mem-trace-ranges, mem_trace_ranges, "")
 OPTION(cpu, cpu_backend, 0)
 OPTION(device, device, 0)
 OPTION(language, language, -1)
@@ -62,7 +64,9 @@ OPTION(dump-imb-range-code, dump_imb_range_code, false)
 OPTION(hide-mouse-in-screen-space, hide_mouse_in_screen_space, false)
 OPTION(enable-nearest-neighbor-filter, nearest_neighbor_filtering, true)
 OPTION(integer-scaling, integer_scaling, true)
+OPTION(present-on-thread, present_on_thread, false)
 OPTION(cpu-load-save, cpu_load_save, true)
+OPTION(codeseg-cow-templates, codeseg_cow_templates, false)
 OPTION(rtos-level, rtos_level, "mid")
 OPTION(ui-new-style, ui_new_style, true)
 OPTION(cenrep-reset, cenrep_reset, false)
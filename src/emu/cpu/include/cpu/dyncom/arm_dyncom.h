@@ -32,6 +32,10 @@ namespace eka2l1::arm {
             return &mem_cache_;
         }
 
+        const dyncom_trans_cache &trans_cache() const {
+            return state_->trans_cache;
+        }
+
         void run(const std::uint32_t instruction_count) override;
         void stop() override;
 
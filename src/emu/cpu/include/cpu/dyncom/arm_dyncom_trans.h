@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <common/types.h>
+#include <cpu/dyncom/arm_dyncom_trans_cache.h>
 
 struct ARMul_State;
 typedef unsigned int (*shtop_fp_t)(ARMul_State* cpu, unsigned int sht_oper);
@@ -88,6 +89,8 @@ struct bbl_inst {
     int signed_immed_24;
     unsigned int next_addr;
     unsigned int jmp_addr;
+    eka2l1::arm::dyncom_block_link taken_link;
+    eka2l1::arm::dyncom_block_link next_link;
 };
 
 struct bx_inst {
@@ -100,6 +103,8 @@ struct blx_inst {
         std::uint32_t Rm;
     } val;
     unsigned int inst;
+    eka2l1::arm::dyncom_block_link taken_link;
+    eka2l1::arm::dyncom_block_link next_link;
 };
 
 struct clz_inst {
@@ -451,10 +456,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    eka2l1::arm::dyncom_block_link taken_link;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    eka2l1::arm::dyncom_block_link taken_link;
+    eka2l1::arm::dyncom_block_link next_link;
 };
 
 struct bl_1_thumb {
@@ -462,10 +470,14 @@ struct bl_1_thumb {
 };
 struct bl_2_thumb {
     unsigned int imm;
+    eka2l1::arm::dyncom_block_link taken_link;
+    eka2l1::arm::dyncom_block_link next_link;
 };
 struct blx_1_thumb {
     unsigned int imm;
     unsigned int instr;
+    eka2l1::arm::dyncom_block_link taken_link;
+    eka2l1::arm::dyncom_block_link next_link;
 };
 
 struct pkh_inst {
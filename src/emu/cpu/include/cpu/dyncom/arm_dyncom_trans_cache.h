@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace eka2l1::arm {
+    /**
+     * \brief Remembers the translated block a branch went to last time.
+     *
+     * The link is only followed while the guest PC matches and the cache generation has not changed
+     * since it was made, so that no evicted or invalidated block is ever entered through it.
+     */
+    struct dyncom_block_link {
+        std::uint32_t pc_;
+        std::uint32_t generation_;
+        char *target_;
+    };
+
+    /**
+     * \brief Translation cache of the dyncom interpreter.
+     *
+     * Translated blocks are laid out contiguously in chunks of host memory, which are only allocated
+     * when needed. A block never crosses a chunk. When the cache is at its chunk budget, the oldest chunk
+     * is recycled together with every block translated in it.
+     *
+     * Memory of invalidated blocks is only released when the next block is translated, since the interpreter
+     * may still be running the current block when it's invalidated (e.g. by a system call).
+     */
+    class dyncom_trans_cache {
+    public:
+        static constexpr std::size_t CHUNK_SIZE = 1024 * 1024;
+        static constexpr std::size_t DEFAULT_MAX_CHUNKS = 32;
+        static constexpr std::size_t FAST_LOOKUP_SIZE = 4096;
+
+        /**
+         * \brief Size a block may grow to before the translator must end it.
+         *
+         * Well below a chunk, so the instruction that crosses it still fits in a fresh chunk together with
+         * the rest of the block.
+         */
+        static constexpr std::size_t MAX_BLOCK_SIZE = CHUNK_SIZE / 4;
+
+    private:
+        struct block_info {
+            std::uint32_t start_pc_;
+            std::uint32_t end_pc_;
+            char *data_;
+        };
+
+        struct chunk {
+            std::unique_ptr<char[]> data_;
+            std::size_t top_;
+            std::vector<block_info> blocks_;
+        };
+
+        struct fast_entry {
+            std::uint32_t pc_;
+            char *data_;
+        };
+
+        std::deque<chunk> chunks_;
+        std::size_t max_chunks_;
+
+        std::unordered_map<std::uint32_t, char *> lookup_;
+        std::array<fast_entry, FAST_LOOKUP_SIZE> fast_lookup_;
+
+        std::size_t block_start_;
+        bool trim_pending_;
+
+        std::uint32_t generation_;
+
+        std::size_t evicted_chunks_;
+        std::size_t lookups_;
+
+        static std::size_t fast_index(const std::uint32_t pc) {
+            return (pc >> 1) & (FAST_LOOKUP_SIZE - 1);
+        }
+
+        void forget_block(const block_info &block);
+        void recycle_oldest_chunk();
+        void new_chunk();
+        void trim();
+
+    public:
+        explicit dyncom_trans_cache(const std::size_t max_chunks = DEFAULT_MAX_CHUNKS);
+
+        /**
+         * \brief Find the translated block starting at the given PC.
+         * \returns Pointer to the first instruction of the block, nullptr if not translated.
+         */
+        char *find(const std::uint32_t pc) {
+            lookups_++;
+
+            fast_entry &entry = fast_lookup_[fast_index(pc)];
+
+            if (entry.data_ && (entry.pc_ == pc)) {
+                return entry.data_;
+            }
+
+            auto ite = lookup_.find(pc);
+
+            if (ite == lookup_.end()) {
+                return nullptr;
+            }
+
+            entry.pc_ = pc;
+            entry.data_ = ite->second;
+
+            return ite->second;
+        }
+
+        /**
+         * \brief Get the current generation of the cache.
+         *
+         * The generation changes every time a translated block is evicted, invalidated or its memory is released.
+         */
+        std::uint32_t generation() const {
+            return generation_;
+        }
+
+        /**
+         * \brief Check if a block link can be followed to get to the given PC.
+         */
+        bool is_linked(const dyncom_block_link &link, const std::uint32_t pc) const {
+            return (link.generation_ == generation_) && (link.pc_ == pc);
+        }
+
+        /**
+         * \brief Point a block link to the given block.
+         */
+        void link(dyncom_block_link &link, const std::uint32_t pc, char *target) const {
+            link.pc_ = pc;
+            link.generation_ = generation_;
+            link.target_ = target;
+        }
+
+        /**
+         * \brief Start translating a new block.
+         */
+        void begin_block();
+
+        /**
+         * \brief Allocate memory for an instruction of the block being translated.
+         *
+         * If the current chunk is full, the part of the block translated so far is moved to a new chunk.
+         * Previously returned pointers of the block must not be used after this call.
+         *
+         * The translator must end the block once block_size() reaches MAX_BLOCK_SIZE, so this never fails.
+         */
+        char *alloc(const std::size_t size);
+
+        /**
+         * \brief Get the number of bytes allocated so far for the block being translated.
+         */
+        std::size_t block_size() const {
+            return chunks_.back().top_ - block_start_;
+        }
+
+        /**
+         * \brief Finish the block being translated, and register it.
+         *
+         * \param start_pc The guest address of the first instruction.
+         * \param end_pc   The guest address past the last instruction.
+         *
+         * \returns Pointer to the first instruction of the block.
+         */
+        char *end_block(const std::uint32_t start_pc, const std::uint32_t end_pc);
+
+        /**
+         * \brief Invalidate blocks overlapping with the given guest range.
+         */
+        void invalidate_range(const std::uint32_t addr, const std::size_t size);
+
+        /**
+         * \brief Invalidate all blocks.
+         */
+        void clear();
+
+        std::size_t committed_size() const {
+            return chunks_.size() * CHUNK_SIZE;
+        }
+
+        std::size_t evicted_chunks() const {
+            return evicted_chunks_;
+        }
+
+        /**
+         * \brief Get the number of blocks looked up by the dispatcher. Chained branches skip the lookup.
+         */
+        std::size_t lookups() const {
+            return lookups_;
+        }
+    };
+}
@@ -21,6 +21,7 @@
 #include <unordered_map>
 #include <common/types.h>
 
+#include <cpu/dyncom/arm_dyncom_trans_cache.h>
 #include <cpu/dyncom/arm_regformat.h>
 
 namespace eka2l1::arm {
@@ -29,8 +30,6 @@ namespace eka2l1::arm {
     class exclusive_monitor;
 }
 
-#define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-
 // Signal levels
 enum { LOW = 0, HIGH = 1, LOWHIGH = 1, HIGHLOW = 2 };
 
@@ -192,6 +191,24 @@ public:
         return TFlag ? 2 : 4;
     }
 
+    // Remember where a call should return to, and the link of the call instruction that leads there.
+    void PushReturnPrediction(std::uint32_t return_pc, eka2l1::arm::dyncom_block_link *link) {
+        return_stack_top = (return_stack_top + 1) % RETURN_STACK_SIZE;
+        return_stack[return_stack_top] = { return_pc, trans_cache.generation(), link };
+    }
+
+    // Get the link to follow for a return to the given address, nullptr if the prediction missed.
+    eka2l1::arm::dyncom_block_link *PopReturnPrediction(std::uint32_t return_pc) {
+        ReturnPrediction &prediction = return_stack[return_stack_top];
+        return_stack_top = (return_stack_top + RETURN_STACK_SIZE - 1) % RETURN_STACK_SIZE;
+
+        if ((prediction.pc != return_pc) || (prediction.generation != trans_cache.generation())) {
+            return nullptr;
+        }
+
+        return prediction.link;
+    }
+
     std::array<std::uint32_t, 16> Reg{}; // The current register file
     std::array<std::uint32_t, 2> Reg_usr{};
     std::array<std::uint32_t, 2> Reg_svc{};   // R13_SVC R14_SVC
@@ -235,12 +252,20 @@ public:
     unsigned bigendSig;
     unsigned syscallSig;
     
-    char trans_cache_buf[TRANS_CACHE_SIZE];
-    size_t trans_cache_buf_top = 0;
-
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<std::uint32_t, std::size_t> instruction_cache;
+    eka2l1::arm::dyncom_trans_cache trans_cache;
+
+    struct ReturnPrediction {
+        std::uint32_t pc;
+        std::uint32_t generation;
+        eka2l1::arm::dyncom_block_link *link;
+    };
+
+    static constexpr std::size_t RETURN_STACK_SIZE = 16;
+
+    std::array<ReturnPrediction, RETURN_STACK_SIZE> return_stack{};
+    std::size_t return_stack_top = 0;
 
 private:
     void ResetMPCoreCP15Registers();
@@ -151,12 +151,11 @@ namespace eka2l1::arm {
     }
 
     void dyncom_core::clear_instruction_cache() {
-        state_->instruction_cache.clear();
-        state_->trans_cache_buf_top = 0;
+        state_->trans_cache.clear();
     }
 
     void dyncom_core::imb_range(address addr, std::size_t size) {
-        clear_instruction_cache();
+        state_->trans_cache.invalidate_range(addr, size);
     }
 
     std::uint32_t dyncom_core::get_num_instruction_executed() {
@@ -834,7 +834,7 @@ static unsigned int InterpreterTranslateInstruction(ARMul_State* cpu, const std:
     return inst_size;
 }
 
-static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, std::uint32_t addr) {
+static int InterpreterTranslateBlock(ARMul_State* cpu, char*& bb_start, std::uint32_t addr) {
     // Decode instruction, get index
     // Allocate memory and init InsCream
     // Go on next, until terminal instruction
@@ -842,7 +842,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, st
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
-    bb_start = cpu->trans_cache_buf_top;
+    cpu->trans_cache.begin_block();
 
     std::uint32_t phys_addr = addr;
     std::uint32_t pc_start = cpu->Reg[15];
@@ -854,31 +854,33 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, st
 
         phys_addr += inst_size;
 
-        if ((phys_addr & 0xfff) == 0) {
+        // Also end the block before it gets too large to move to a fresh translation cache chunk
+        if (((phys_addr & 0xfff) == 0) ||
+            (cpu->trans_cache.block_size() >= eka2l1::arm::dyncom_trans_cache::MAX_BLOCK_SIZE)) {
             inst_base->br = TransExtData::END_OF_PAGE;
         }
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->trans_cache.end_block(pc_start, pc_start + (phys_addr - addr));
 
     return KEEP_GOING;
 }
 
-static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, std::uint32_t addr) {
+static int InterpreterTranslateSingle(ARMul_State* cpu, char*& bb_start, std::uint32_t addr) {
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = cpu->trans_cache_buf_top;
+    cpu->trans_cache.begin_block();
 
     std::uint32_t phys_addr = addr;
     std::uint32_t pc_start = cpu->Reg[15];
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    const unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->trans_cache.end_block(pc_start, pc_start + inst_size);
 
     return KEEP_GOING;
 }
@@ -930,10 +932,34 @@ unsigned InterpreterMainLoop(ARMul_State* cpu, std::uint32_t &num_instrs) {
 #define FETCH_INST                                                                                 \
     if (inst_base->br != TransExtData::NON_BRANCH)                                                 \
         goto DISPATCH;                                                                             \
-    inst_base = (arm_inst*)&cpu->trans_cache_buf[ptr]
-
-#define INC_PC(l) ptr += sizeof(arm_inst) + l
-#define INC_PC_STUB ptr += sizeof(arm_inst)
+    inst_base = (arm_inst*)ptr
+
+// Instructions are allocated with 8-byte alignment in the translation cache, see AllocBuffer
+#define ALIGNED_INST_SIZE(l) (((sizeof(arm_inst) + (l) + 7) >> 3) << 3)
+#define INC_PC(l) ptr += ALIGNED_INST_SIZE(l)
+#define INC_PC_STUB ptr += ALIGNED_INST_SIZE(0)
+
+// Jump straight to the block the link points to if it is still where we are going. Otherwise, let
+// the dispatcher look the block up and update the link for next time.
+#define CHAIN_DISPATCH(block_link)                                                                 \
+    if (cpu->NirqSig && cpu->trans_cache.is_linked(block_link, cpu->Reg[15])) {                    \
+        ptr = (block_link).target_;                                                                \
+        inst_base = (arm_inst*)ptr;                                                                \
+        GOTO_NEXT_INST;                                                                            \
+    }                                                                                              \
+    pending_link = &(block_link);                                                                  \
+    pending_link_generation = cpu->trans_cache.generation();                                       \
+    goto DISPATCH
+
+// Returns are chained through the link of the call instruction, if the return address was predicted.
+#define RETURN_DISPATCH                                                                            \
+    {                                                                                              \
+        eka2l1::arm::dyncom_block_link* return_link = cpu->PopReturnPrediction(cpu->Reg[15]);      \
+        if (return_link) {                                                                         \
+            CHAIN_DISPATCH(*return_link);                                                          \
+        }                                                                                          \
+        goto DISPATCH;                                                                             \
+    }
 
 // GCC and Clang have a C++ extension to support a lookup table of labels. Otherwise, fallback to a
 // clunky switch statement.
@@ -1591,7 +1617,10 @@ unsigned InterpreterMainLoop(ARMul_State* cpu, std::uint32_t &num_instrs) {
     arm_inst* inst_base;
     unsigned int addr;
 
-    std::size_t ptr;
+    char* ptr;
+
+    eka2l1::arm::dyncom_block_link* pending_link = nullptr;
+    std::uint32_t pending_link_generation = 0;
 
     LOAD_NZCVT;
 DISPATCH : {
@@ -1607,18 +1636,27 @@ DISPATCH : {
         cpu->Reg[15] &= 0xfffffffc;
 
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
-    } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    ptr = cpu->trans_cache.find(cpu->Reg[15]);
+    if (!ptr) {
+        if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
     }
 
-    inst_base = (arm_inst*)&cpu->trans_cache_buf[ptr];
+    if (pending_link) {
+        // The branch that wanted the link is gone if the translation above evicted its block
+        if (pending_link_generation == cpu->trans_cache.generation()) {
+            cpu->trans_cache.link(*pending_link, cpu->Reg[15], ptr);
+        }
+
+        pending_link = nullptr;
+    }
+
+    inst_base = (arm_inst*)ptr;
     GOTO_NEXT_INST;
 }
 ADC_INST : {
@@ -1735,18 +1773,19 @@ AND_INST : {
     GOTO_NEXT_INST;
 }
 BBL_INST : {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
+            cpu->PushReturnPrediction(cpu->Reg[14], &inst_cream->next_link);
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        CHAIN_DISPATCH(inst_cream->taken_link);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->next_link);
 }
 BIC_INST : {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -1808,12 +1847,14 @@ BLX_INST : {
         if (BITS(inst, 20, 27) == 0x12 && BITS(inst, 4, 7) == 0x3) {
             const std::uint32_t jump_address = cpu->Reg[inst_cream->val.Rm];
             cpu->Reg[14] = (cpu->Reg[15] + cpu->GetInstructionSize());
+            cpu->PushReturnPrediction(cpu->Reg[14], &inst_cream->next_link);
             if (cpu->TFlag)
                 cpu->Reg[14] |= 0x1;
             cpu->Reg[15] = jump_address & 0xfffffffe;
             cpu->TFlag = jump_address & 0x1;
         } else {
             cpu->Reg[14] = (cpu->Reg[15] + cpu->GetInstructionSize());
+            cpu->PushReturnPrediction(cpu->Reg[14], &inst_cream->next_link);
             cpu->TFlag = 0x1;
             int signed_int = inst_cream->val.signed_immed_24;
             signed_int = (signed_int & 0x800000) ? (0x3F000000 | signed_int) : signed_int;
@@ -1821,11 +1862,11 @@ BLX_INST : {
             cpu->Reg[15] = cpu->Reg[15] + 8 + signed_int + (BIT(inst, 24) << 1);
         }
         INC_PC(sizeof(blx_inst));
-        goto DISPATCH;
+        CHAIN_DISPATCH(inst_cream->taken_link);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(blx_inst));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->next_link);
 }
 
 BX_INST:
@@ -1849,6 +1890,11 @@ BXJ_INST : {
         cpu->TFlag = address & 1;
         cpu->Reg[15] = address & 0xfffffffe;
         INC_PC(sizeof(bx_inst));
+
+        if (inst_cream->Rm == 14) {
+            RETURN_DISPATCH;
+        }
+
         goto DISPATCH;
     }
 
@@ -2078,6 +2124,11 @@ LDM_INST : {
 
         if (BIT(inst, 15)) {
             INC_PC(sizeof(ldst_inst));
+
+            if (!BIT(inst, 22)) {
+                RETURN_DISPATCH;
+            }
+
             goto DISPATCH;
         }
     }
@@ -4283,18 +4334,20 @@ B_2_THUMB : {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->taken_link);
 }
 B_COND_THUMB : {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
+        INC_PC(sizeof(b_cond_thumb));
+        CHAIN_DISPATCH(inst_cream->taken_link);
+    }
 
+    cpu->Reg[15] += 2;
     INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->next_link);
 }
 BL_1_THUMB : {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
@@ -4307,20 +4360,22 @@ BL_1_THUMB : {
 BL_2_THUMB : {
     bl_2_thumb* inst_cream = (bl_2_thumb*)inst_base->component;
     int tmp = ((cpu->Reg[15] + 2) | 1);
+    cpu->PushReturnPrediction(cpu->Reg[15] + 2, &inst_cream->next_link);
     cpu->Reg[15] = (cpu->Reg[14] + inst_cream->imm);
     cpu->Reg[14] = tmp;
     INC_PC(sizeof(bl_2_thumb));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->taken_link);
 }
 BLX_1_THUMB : {
     // BLX 1 for armv5t and above
     std::uint32_t tmp = cpu->Reg[15];
     blx_1_thumb* inst_cream = (blx_1_thumb*)inst_base->component;
+    cpu->PushReturnPrediction(tmp + 2, &inst_cream->next_link);
     cpu->Reg[15] = (cpu->Reg[14] + inst_cream->imm) & 0xFFFFFFFC;
     cpu->Reg[14] = ((tmp + 2) | 1);
     cpu->TFlag = 0;
     INC_PC(sizeof(blx_1_thumb));
-    goto DISPATCH;
+    CHAIN_DISPATCH(inst_cream->taken_link);
 }
 
 UQADD8_INST:
@@ -8,10 +8,7 @@
 #include <cpu/dyncom/vfp/vfp.h>
 
 static void* AllocBuffer(ARMul_State *state, std::size_t size) {
-    std::size_t start = state->trans_cache_buf_top;
-    state->trans_cache_buf_top += ((size + 7) >> 3) << 3;
-    assert(state->trans_cache_buf_top <= TRANS_CACHE_SIZE && "Translation cache is full!");
-    return static_cast<void*>(&state->trans_cache_buf[start]);
+    return static_cast<void*>(state->trans_cache.alloc(((size + 7) >> 3) << 3));
 }
 
 #define glue(x, y) x##y
@@ -97,6 +94,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(ARMul_State *state, unsigned int
 
     inst_cream->L = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
+    inst_cream->taken_link = {};
+    inst_cream->next_link = {};
 
     return inst_base;
 }
@@ -148,6 +147,9 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(blx)(ARMul_State *state, unsigned int
         inst_cream->val.signed_immed_24 = BITS(inst, 0, 23);
     }
 
+    inst_cream->taken_link = {};
+    inst_cream->next_link = {};
+
     return inst_base;
 }
 static ARM_INST_PTR INTERPRETER_TRANSLATE(bx)(ARMul_State *state, unsigned int inst, int index) {
@@ -1644,6 +1646,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(ARMul_State *state, unsigne
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
 
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
+    inst_cream->taken_link = {};
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -1657,6 +1660,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(ARMul_State *state, unsi
 
     inst_cream->imm = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ? 0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->taken_link = {};
+    inst_cream->next_link = {};
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
 
@@ -1678,6 +1683,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bl_2_thumb)(ARMul_State *state, unsign
     bl_2_thumb* inst_cream = (bl_2_thumb*)inst_base->component;
 
     inst_cream->imm = (tinst & 0x07FF) << 1;
+    inst_cream->taken_link = {};
+    inst_cream->next_link = {};
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -1689,6 +1696,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(blx_1_thumb)(ARMul_State *state, unsig
 
     inst_cream->imm = (tinst & 0x07FF) << 1;
     inst_cream->instr = tinst;
+    inst_cream->taken_link = {};
+    inst_cream->next_link = {};
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cpu/dyncom/arm_dyncom_trans_cache.h>
+
+#include <common/algorithm.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace eka2l1::arm {
+    dyncom_trans_cache::dyncom_trans_cache(const std::size_t max_chunks)
+        : max_chunks_(common::max<std::size_t>(max_chunks, 2))
+        , block_start_(0)
+        , trim_pending_(false)
+        , generation_(1)
+        , evicted_chunks_(0)
+        , lookups_(0) {
+        fast_lookup_.fill({ 0, nullptr });
+    }
+
+    void dyncom_trans_cache::forget_block(const block_info &block) {
+        auto ite = lookup_.find(block.start_pc_);
+
+        // The same address may have been translated again in a newer chunk
+        if ((ite != lookup_.end()) && (ite->second == block.data_)) {
+            lookup_.erase(ite);
+        }
+
+        fast_entry &entry = fast_lookup_[fast_index(block.start_pc_)];
+
+        if (entry.data_ == block.data_) {
+            entry.data_ = nullptr;
+        }
+    }
+
+    void dyncom_trans_cache::recycle_oldest_chunk() {
+        chunk oldest = std::move(chunks_.front());
+        chunks_.pop_front();
+
+        for (const block_info &block : oldest.blocks_) {
+            forget_block(block);
+        }
+
+        oldest.blocks_.clear();
+        oldest.top_ = 0;
+
+        chunks_.push_back(std::move(oldest));
+        evicted_chunks_++;
+        generation_++;
+    }
+
+    void dyncom_trans_cache::new_chunk() {
+        if (chunks_.size() >= max_chunks_) {
+            recycle_oldest_chunk();
+            return;
+        }
+
+        chunk new_one;
+        new_one.data_ = std::make_unique<char[]>(CHUNK_SIZE);
+        new_one.top_ = 0;
+
+        chunks_.push_back(std::move(new_one));
+    }
+
+    void dyncom_trans_cache::trim() {
+        // Nothing is referenced anymore, keep one chunk around for the next translations
+        while (chunks_.size() > 1) {
+            chunks_.pop_back();
+        }
+
+        if (!chunks_.empty()) {
+            chunks_.front().top_ = 0;
+            chunks_.front().blocks_.clear();
+        }
+
+        trim_pending_ = false;
+
+        // Links made since the clear may point into the released memory
+        generation_++;
+    }
+
+    void dyncom_trans_cache::begin_block() {
+        if (trim_pending_) {
+            trim();
+        }
+
+        if (chunks_.empty()) {
+            new_chunk();
+        }
+
+        block_start_ = chunks_.back().top_;
+    }
+
+    char *dyncom_trans_cache::alloc(const std::size_t size) {
+        chunk *current = &chunks_.back();
+
+        if (current->top_ + size > CHUNK_SIZE) {
+            // Blocks must stay contiguous, move what has been translated so far to a new chunk
+            const char *prefix = current->data_.get() + block_start_;
+            const std::size_t prefix_size = current->top_ - block_start_;
+
+            // Blocks are ended at MAX_BLOCK_SIZE, far from a whole chunk
+            assert(prefix_size + size <= CHUNK_SIZE);
+
+            current->top_ = block_start_;
+
+            new_chunk();
+            current = &chunks_.back();
+
+            std::memcpy(current->data_.get(), prefix, prefix_size);
+            current->top_ = prefix_size;
+            block_start_ = 0;
+        }
+
+        char *result = current->data_.get() + current->top_;
+        current->top_ += size;
+
+        return result;
+    }
+
+    char *dyncom_trans_cache::end_block(const std::uint32_t start_pc, const std::uint32_t end_pc) {
+        chunk &current = chunks_.back();
+        char *data = current.data_.get() + block_start_;
+
+        current.blocks_.push_back({ start_pc, end_pc, data });
+        lookup_[start_pc] = data;
+
+        fast_entry &entry = fast_lookup_[fast_index(start_pc)];
+        entry.pc_ = start_pc;
+        entry.data_ = data;
+
+        return data;
+    }
+
+    void dyncom_trans_cache::invalidate_range(const std::uint32_t addr, const std::size_t size) {
+        const std::uint64_t end_addr = static_cast<std::uint64_t>(addr) + size;
+        bool removed_any = false;
+
+        for (chunk &target : chunks_) {
+            auto should_remove = [&](const block_info &block) {
+                if ((block.start_pc_ < end_addr) && (addr < block.end_pc_)) {
+                    forget_block(block);
+                    removed_any = true;
+                    return true;
+                }
+
+                return false;
+            };
+
+            target.blocks_.erase(std::remove_if(target.blocks_.begin(), target.blocks_.end(), should_remove),
+                target.blocks_.end());
+        }
+
+        if (removed_any) {
+            generation_++;
+        }
+    }
+
+    void dyncom_trans_cache::clear() {
+        lookup_.clear();
+        fast_lookup_.fill({ 0, nullptr });
+
+        for (chunk &target : chunks_) {
+            target.blocks_.clear();
+        }
+
+        trim_pending_ = true;
+        generation_++;
+    }
+}
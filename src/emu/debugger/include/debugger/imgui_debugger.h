@@ -21,6 +21,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -59,6 +60,7 @@ namespace eka2l1 {
         bool should_show_threads;
         bool should_show_mutexs;
         bool should_show_chunks;
+        bool should_show_render_stats;
         bool should_show_window_tree;
         bool should_show_rendered_bitmap;
 
@@ -110,6 +112,9 @@ namespace eka2l1 {
 
         std::uint32_t active_screen;
 
+        std::map<std::uint32_t, std::size_t> chunk_resident_sizes; ///< Keyed by chunk ID. Refreshed once a second, asking the host is slow.
+        std::uint64_t chunk_resident_refresh_time{ 0 };
+
         struct key_binder {
             std::vector<bool> need_key;
             static constexpr int BIND_NUM = 20;
@@ -184,6 +189,7 @@ namespace eka2l1 {
         void show_threads();
         void show_mutexs();
         void show_chunks();
+        void show_render_stats();
         void show_timers();
         void show_disassembler();
         void show_menu();
@@ -33,9 +33,13 @@
 #include <kernel/timer.h>
 
 #include <cpu/arm_utils.h>
+#include <dispatch/dispatcher.h>
+#include <dispatch/present.h>
 #include <disasm/disasm.h>
+#include <drivers/graphics/graphics.h>
 #include <system/epoc.h>
 #include <common/cvt.h>
+#include <common/time.h>
 #include <imgui.h>
 
 #include <mutex>
@@ -166,6 +170,14 @@ namespace eka2l1 {
         epoc::screen *scr = reinterpret_cast<epoc::screen *>(userdata);
         ImGui::Text("Screen number      %d", scr->number);
 
+        const epoc::compose_stats &stats = scr->stats;
+        ImGui::Text("Frames composed    %llu (%llu skipped)", static_cast<unsigned long long>(stats.frames_composed),
+            static_cast<unsigned long long>(stats.frames_skipped));
+        ImGui::Text("Last damage        %u rects, %llu pixels", stats.last_damage_rects,
+            static_cast<unsigned long long>(stats.last_damaged_pixels));
+        ImGui::Text("Last pixels drawn  %llu", static_cast<unsigned long long>(stats.last_pixels_drawn));
+        ImGui::Text("Last windows       %u drawn, %u culled", stats.last_windows_drawn, stats.last_windows_culled);
+
         if (scr->screen_texture) {
             eka2l1::vec2 size = scr->size();
             ImGui::Image(reinterpret_cast<ImTextureID>(scr->screen_texture), ImVec2(static_cast<float>(size.x), static_cast<float>(size.y)));
@@ -244,8 +256,8 @@ namespace eka2l1 {
     void imgui_debugger::show_threads() {
         if (ImGui::Begin("Threads", &should_show_threads)) {
             // Only the stack are created by the OS
-            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s    %-32s", "ID",
-                "Thread name", "State");
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s    %-32s    %-8s    %-16s", "ID",
+                "Thread name", "State", "Handles", "Handle memory");
 
             const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
 
@@ -253,8 +265,9 @@ namespace eka2l1 {
                 kernel::thread *thr = reinterpret_cast<kernel::thread *>(thr_obj.get());
                 chunk_ptr chnk = thr->get_stack_chunk();
 
-                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s    %-32s", thr->unique_id(),
-                    thr->name().c_str(), thread_state_to_string(thr->current_state()));
+                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s    %-32s    %-8zu    %zu KB", thr->unique_id(),
+                    thr->name().c_str(), thread_state_to_string(thr->current_state()), thr->get_total_open_handles(),
+                    thr->get_handle_table_memory() / 1024);
             }
         }
 
@@ -263,14 +276,20 @@ namespace eka2l1 {
 
     void imgui_debugger::show_mutexs() {
         if (ImGui::Begin("Mutexs", &should_show_mutexs)) {
-            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s", "ID",
-                "Mutex name");
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s    %-16s    %-8s    %-8s    %-16s    %-16s    %-8s", "ID",
+                "Mutex name", "Holder", "Waiting", "Waits", "Total wait (ms)", "Max wait (ms)", "Inversions");
 
             const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
 
-            for (const auto &mutex : sys->get_kernel_system()->mutexes_) {
-                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s", mutex->unique_id(),
-                    mutex->name().c_str());
+            for (const auto &mutex_obj : sys->get_kernel_system()->mutexes_) {
+                kernel::mutex *mut = reinterpret_cast<kernel::mutex *>(mutex_obj.get());
+                const kernel::contention_stats &stats = mut->get_contention_stats();
+                kernel::thread *holder = mut->holder();
+
+                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s    %-16s    %-8d    %-8llu    %-16llu    %-16llu    %-8llu", mut->unique_id(),
+                    mut->name().c_str(), holder ? holder->name().c_str() : "None", mut->count(),
+                    static_cast<unsigned long long>(stats.wait_count), static_cast<unsigned long long>(stats.total_wait_us / 1000),
+                    static_cast<unsigned long long>(stats.max_wait_us / 1000), static_cast<unsigned long long>(stats.inversions));
             }
         }
 
@@ -279,17 +298,70 @@ namespace eka2l1 {
 
     void imgui_debugger::show_chunks() {
         if (ImGui::Begin("Chunks", &should_show_chunks)) {
-            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-24s         %-8s        %-8s      %-32s", "ID",
-                "Chunk name", "Committed", "Max", "Creator process");
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-24s         %-8s        %-8s        %-8s      %-32s", "ID",
+                "Chunk name", "Committed", "Resident", "Max", "Creator process");
 
             const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
 
+            const std::uint64_t now = common::get_current_time_in_microseconds_since_epoch();
+            const bool refresh_resident = (now - chunk_resident_refresh_time >= 1000000);
+
+            if (refresh_resident) {
+                chunk_resident_sizes.clear();
+                chunk_resident_refresh_time = now;
+            }
+
             for (const auto &chnk_obj : sys->get_kernel_system()->chunks_) {
                 kernel::chunk *chnk = reinterpret_cast<kernel::chunk *>(chnk_obj.get());
                 std::string process_name = chnk->get_own_process() ? chnk->get_own_process()->name() : "Unknown";
 
-                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s      0x%08lX        0x%08lX      %-32s",
-                    chnk->unique_id(), chnk->name().c_str(), chnk->committed(), chnk->max_size(), process_name.c_str());
+                auto resident_ite = chunk_resident_sizes.find(chnk->unique_id());
+
+                if (resident_ite == chunk_resident_sizes.end()) {
+                    resident_ite = chunk_resident_sizes.emplace(chnk->unique_id(), chnk->resident()).first;
+                }
+
+                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s      0x%08lX        0x%08lX        0x%08lX      %-32s",
+                    chnk->unique_id(), chnk->name().c_str(), chnk->committed(), resident_ite->second, chnk->max_size(),
+                    process_name.c_str());
+            }
+        }
+
+        ImGui::End();
+    }
+
+    void imgui_debugger::show_render_stats() {
+        if (ImGui::Begin("Rendering statistics", &should_show_render_stats)) {
+            drivers::graphics_driver *driver = sys->get_graphics_driver();
+
+            if (driver) {
+                const drivers::graphics_driver_stats stats = driver->get_last_frame_stats();
+
+                ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "Last frame");
+                ImGui::Separator();
+
+                ImGui::TextColored(GUI_COLOR_TEXT, "Draw calls:              %u", stats.draw_calls);
+                ImGui::TextColored(GUI_COLOR_TEXT, "State changes:           %u", stats.state_changes);
+                ImGui::TextColored(GUI_COLOR_TEXT, "Bitmap draws:            %u", stats.bitmap_draws);
+                ImGui::TextColored(GUI_COLOR_TEXT, "Batched bitmap draws:    %u", stats.batched_bitmap_draws);
+            }
+
+            dispatch::dispatcher *dispatcher = sys->get_dispatcher();
+            epoc::screen *scr = winserv ? winserv->get_screens() : nullptr;
+
+            for (; dispatcher && scr; scr = scr->next) {
+                const dispatch::screen_present_stats present_stats = dispatcher->get_screen_presenter()->get_stats(scr->number);
+
+                ImGui::NewLine();
+                ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "Screen %d presentation", scr->number);
+                ImGui::Separator();
+
+                ImGui::TextColored(GUI_COLOR_TEXT, "Updates submitted:       %llu", static_cast<unsigned long long>(present_stats.submitted));
+                ImGui::TextColored(GUI_COLOR_TEXT, "Uploads presented:       %llu", static_cast<unsigned long long>(present_stats.presented));
+                ImGui::TextColored(GUI_COLOR_TEXT, "Updates superseded:      %llu", static_cast<unsigned long long>(present_stats.superseded));
+                ImGui::TextColored(GUI_COLOR_TEXT, "Pixels uploaded:         %llu", static_cast<unsigned long long>(present_stats.pixels_uploaded));
+                ImGui::TextColored(GUI_COLOR_TEXT, "Last latency:            %llu us", static_cast<unsigned long long>(present_stats.last_latency_us));
+                ImGui::TextColored(GUI_COLOR_TEXT, "Max latency:             %llu us", static_cast<unsigned long long>(present_stats.max_latency_us));
             }
         }
 
@@ -149,6 +149,7 @@ namespace eka2l1 {
         , should_show_threads(false)
         , should_show_mutexs(false)
         , should_show_chunks(false)
+        , should_show_render_stats(false)
         , should_show_window_tree(false)
         , should_show_disassembler(false)
         , should_show_logger(true)
@@ -480,7 +481,11 @@ namespace eka2l1 {
                 const std::string object_submenu_name = common::get_localised_string(localised_strings,
                     "debugger_menu_objects_item_name");
 
+                const std::string render_stats_item_name = common::get_localised_string(localised_strings,
+                    "debugger_menu_render_stats_item_name");
+
                 ImGui::MenuItem(disassembler_item_name.c_str(), nullptr, &should_show_disassembler);
+                ImGui::MenuItem(render_stats_item_name.c_str(), nullptr, &should_show_render_stats);
 
                 if (ImGui::BeginMenu(object_submenu_name.c_str())) {
                     const std::string threads_item_name = common::get_localised_string(localised_strings,
@@ -642,6 +647,10 @@ namespace eka2l1 {
             show_chunks();
         }
 
+        if (should_show_render_stats) {
+            show_render_stats();
+        }
+
         if (should_show_window_tree) {
             show_windows_tree();
         }
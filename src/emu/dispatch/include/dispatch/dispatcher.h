@@ -51,6 +51,7 @@ namespace eka2l1 {
 namespace eka2l1::dispatch {
     struct patch_info;
     struct dsp_epoc_audren_sema;
+    class screen_presenter;
 
     struct dsp_epoc_stream {
         std::unique_ptr<drivers::dsp_stream> ll_stream_;
@@ -70,7 +71,7 @@ namespace eka2l1::dispatch {
 
     struct dsp_epoc_player {
     public:
-        std::unique_ptr<epoc::rw_des_stream> custom_stream_;
+        std::shared_ptr<common::rw_stream> custom_stream_;
         std::unique_ptr<drivers::player> impl_;
         std::uint32_t flags_;
 
@@ -103,6 +104,7 @@ namespace eka2l1::dispatch {
     struct dispatcher {
     private:
         std::unique_ptr<dsp_epoc_audren_sema> audren_sema_;
+        std::unique_ptr<screen_presenter> presenter_;
 
         kernel::chunk *trampoline_chunk_;
 
@@ -121,13 +123,14 @@ namespace eka2l1::dispatch {
 
         ntimer *timing_;
 
-        explicit dispatcher(kernel_system *kern, ntimer *timing);
+        explicit dispatcher(kernel_system *kern, ntimer *timing, const bool present_on_thread = false);
         ~dispatcher();
 
         bool patch_libraries(const std::u16string &path, patch_info *patches,
             const std::size_t patch_count);
 
         dsp_epoc_audren_sema *get_audren_sema();
+        screen_presenter *get_screen_presenter();
 
         void resolve(eka2l1::system *sys, const std::uint32_t function_ord);
         void update_all_screens(eka2l1::system *sys);
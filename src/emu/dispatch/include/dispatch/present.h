@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/vecx.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace eka2l1 {
+    class kernel_system;
+    class ntimer;
+
+    namespace drivers {
+        class graphics_driver;
+    }
+
+    namespace epoc {
+        struct screen;
+    }
+}
+
+namespace eka2l1::dispatch {
+    struct screen_present_stats {
+        std::uint64_t submitted = 0; ///< Number of screen updates requested by the guest.
+        std::uint64_t presented = 0; ///< Number of uploads done to the host.
+        std::uint64_t superseded = 0; ///< Number of updates merged into an upload that was already pending.
+        std::uint64_t pixels_uploaded = 0;
+        std::uint64_t last_latency_us = 0; ///< Time between the first merged update and its upload.
+        std::uint64_t max_latency_us = 0;
+        std::uint64_t total_latency_us = 0;
+    };
+
+    /**
+     * \brief Part of a screen buffer to upload.
+     */
+    struct screen_upload_region {
+        eka2l1::rect area; ///< Area to update in the screen texture, in pixels.
+        std::size_t offset = 0; ///< Offset of the first byte to upload in the screen buffer.
+        std::size_t size = 0; ///< Number of bytes to upload.
+        std::size_t pixels_per_line = 0; ///< Length of a buffer line, in pixels.
+    };
+
+    /**
+     * \brief Get the size in bytes of a line of a screen buffer.
+     *
+     * Modes with less than 8 bits per pixel pad each line to a 32-bit word.
+     */
+    std::size_t get_screen_buffer_pitch(const int width, const int bpp);
+
+    /**
+     * \brief Get what to upload of a screen buffer to refresh the given dirty area.
+     *
+     * For modes with less than 8 bits per pixel, whole lines are uploaded, since a line can't start in the middle of a byte.
+     */
+    screen_upload_region get_screen_upload_region(const eka2l1::rect &dirty, const eka2l1::vec2 &screen_size, const int bpp);
+
+    /**
+     * \brief Dirty area of a screen, accumulated between two uploads.
+     */
+    class screen_dirty_tracker {
+        eka2l1::rect dirty_;
+        bool scheduled_ = false;
+
+    public:
+        enum submit_result {
+            submit_nothing_dirty, ///< The update was empty or off the screen.
+            submit_schedule, ///< An upload must be scheduled for the update.
+            submit_superseded ///< The update was merged into the upload already pending.
+        };
+
+        /**
+         * \brief Merge updated rectangles into the dirty area.
+         *
+         * \param screen_size   Size of the screen. Rectangles are clipped to it.
+         * \param rects         Updated rectangles, in screen coordinates. Can be null to update everything.
+         * \param rect_count    Number of rectangles.
+         */
+        submit_result submit(const eka2l1::vec2 &screen_size, const eka2l1::rect *rects, const std::uint32_t rect_count);
+
+        /**
+         * \brief Take the dirty area for upload, and allow the next update to schedule a new one.
+         */
+        eka2l1::rect take();
+
+        bool scheduled() const {
+            return scheduled_;
+        }
+    };
+
+    /**
+     * \brief Upload guest screen buffers to the host, at most once per screen refresh.
+     *
+     * Updates that arrive before the next refresh are merged into one dirty rectangle, so frames
+     * that the host would never get to show are not uploaded. The upload can optionally be done
+     * on a separate thread, which keeps the guest from waiting on the copy.
+     */
+    class screen_presenter {
+        /**
+         * \brief What a timer event needs to reach the presenter.
+         *
+         * Outlives the presenter for as long as an event is in flight, so an event that fires
+         * while the presenter is being destroyed finds it gone instead of touching freed memory.
+         */
+        struct present_link {
+            std::mutex lock_;
+            screen_presenter *presenter_ = nullptr;
+            kernel_system *kern_ = nullptr;
+            bool use_thread_ = false;
+        };
+
+        /**
+         * \brief A scheduled upload. Owned by the timer event until it fires or is unscheduled.
+         */
+        struct present_ticket {
+            std::shared_ptr<present_link> link_;
+            int screen_number_ = 0;
+        };
+
+        struct screen_present_state {
+            epoc::screen *scr_ = nullptr;
+            drivers::graphics_driver *driver_ = nullptr;
+
+            screen_dirty_tracker dirty_;
+            present_ticket *ticket_ = nullptr; ///< The pending upload event, if any.
+
+            std::uint64_t first_submit_us_ = 0;
+            std::uint64_t last_present_us_ = 0;
+
+            screen_present_stats stats_;
+        };
+
+        ntimer *timing_;
+        int present_evt_;
+
+        std::shared_ptr<present_link> link_;
+
+        std::mutex lock_;
+        std::map<int, screen_present_state> states_;
+
+        bool use_thread_;
+        bool stopping_;
+
+        std::thread worker_;
+        std::condition_variable worker_cond_;
+        std::deque<screen_present_state *> ready_;
+
+        static void on_present_due(std::uint64_t userdata, const int cycles_late);
+
+        void present_due(const int screen_number);
+        void present(screen_present_state *state);
+        void worker_loop();
+
+    public:
+        explicit screen_presenter(kernel_system *kern, ntimer *timing, const bool use_thread);
+        ~screen_presenter();
+
+        /**
+         * \brief Queue part of a screen for upload on the next refresh.
+         *
+         * \param driver        The graphics driver to upload with.
+         * \param scr           The screen that was updated.
+         * \param rects         Updated rectangles, in screen coordinates. Can be null to update everything.
+         * \param rect_count    Number of rectangles.
+         */
+        void submit(drivers::graphics_driver *driver, epoc::screen *scr, const eka2l1::rect *rects,
+            const std::uint32_t rect_count);
+
+        screen_present_stats get_stats(const int screen_number);
+    };
+}
@@ -36,6 +36,19 @@
 #include <utils/des.h>
 
 namespace eka2l1::dispatch {
+    /**
+     * \brief Stream over a file of the emulated filesystem, keeping the file open while it's used.
+     */
+    class dsp_epoc_file_stream : public rw_file_stream {
+        symfile file_;
+
+    public:
+        explicit dsp_epoc_file_stream(symfile &f)
+            : rw_file_stream(f.get())
+            , file_(std::move(f)) {
+        }
+    };
+
     dsp_epoc_audren_sema::dsp_epoc_audren_sema()
         : own_(0) {
     }
@@ -105,27 +118,31 @@ namespace eka2l1::dispatch {
         const std::uint16_t *url, const std::uint32_t url_length) {
         std::u16string url_str(reinterpret_cast<const char16_t *>(url), url_length);
 
+        dispatch::dispatcher *dispatcher = sys->get_dispatcher();
+        dsp_epoc_player *eplayer = dispatcher->audio_players_.get_object(handle.ptr_address());
+
+        if (!eplayer) {
+            return epoc::error_bad_handle;
+        }
+
         // Check if the URL references to a local path (drive)
         const std::u16string root = eka2l1::root_path(url_str, true);
 
         if ((root.length() >= 2) && (root[1] == u':')) {
-            // It should be a local path. Transform it to host path
-            std::optional<std::u16string> host_path = sys->get_io_system()->get_raw_path(url_str);
+            // It should be a local path. Read it through the VFS, it may only be in a ROM image
+            // and not have a host path.
+            symfile local_file = sys->get_io_system()->open_file(url_str, READ_MODE | BIN_MODE);
 
-            if (host_path.has_value()) {
-                url_str = std::move(host_path.value());
+            if (!local_file) {
+                return epoc::error_not_found;
             }
-        }
 
-        // Proceed with the current URL
-        dispatch::dispatcher *dispatcher = sys->get_dispatcher();
-        dsp_epoc_player *eplayer = dispatcher->audio_players_.get_object(handle.ptr_address());
+            eplayer->custom_stream_ = std::make_shared<dsp_epoc_file_stream>(local_file);
 
-        if (!eplayer) {
-            return epoc::error_bad_handle;
-        }
-
-        if (!eplayer->impl_->queue_url(common::ucs2_to_utf8(url_str))) {
+            if (!eplayer->impl_->queue_custom(eplayer->custom_stream_.get())) {
+                return epoc::error_not_supported;
+            }
+        } else if (!eplayer->impl_->queue_url(common::ucs2_to_utf8(url_str))) {
             return epoc::error_not_supported;
         }
 
@@ -149,8 +166,8 @@ namespace eka2l1::dispatch {
             return epoc::error_bad_handle;
         }
 
-        eplayer->custom_stream_ = std::make_unique<epoc::rw_des_stream>(buffer, pr);
-        if (!eplayer->impl_->queue_custom(reinterpret_cast<common::rw_stream*>(eplayer->custom_stream_.get()))) {
+        eplayer->custom_stream_ = std::make_shared<epoc::rw_des_stream>(buffer, pr);
+        if (!eplayer->impl_->queue_custom(eplayer->custom_stream_.get())) {
             return epoc::error_not_supported;
         }
 
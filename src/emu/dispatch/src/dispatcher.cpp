@@ -18,6 +18,7 @@
  */
 
 #include <dispatch/dispatcher.h>
+#include <dispatch/present.h>
 #include <dispatch/register.h>
 #include <dispatch/libraries/register.h>
 #include <dispatch/screen.h>
@@ -35,7 +36,7 @@
 namespace eka2l1::dispatch {
     static std::uint32_t MAX_TRAMPOLINE_CHUNK_SIZE = 0x4000;
 
-    dispatcher::dispatcher(kernel_system *kern, ntimer *timing)
+    dispatcher::dispatcher(kernel_system *kern, ntimer *timing, const bool present_on_thread)
         : winserv_(nullptr)
         , trampoline_chunk_(nullptr)
         , libmngr_(nullptr)
@@ -49,6 +50,7 @@ namespace eka2l1::dispatch {
             eka2l1::get_winserv_name_by_epocver(kern->get_epoc_version())));
 
         audren_sema_ = std::make_unique<dsp_epoc_audren_sema>();
+        presenter_ = std::make_unique<screen_presenter>(kern, timing, present_on_thread);
 
         // Set global variables
         timing_ = timing;
@@ -72,6 +74,7 @@ namespace eka2l1::dispatch {
     }
 
     void dispatcher::shutdown() {
+        presenter_.reset();
     }
 
     void dispatcher::update_all_screens(eka2l1::system *sys) {
@@ -91,6 +94,10 @@ namespace eka2l1::dispatch {
         return audren_sema_.get();
     }
 
+    screen_presenter *dispatcher::get_screen_presenter() {
+        return presenter_.get();
+    }
+
     bool dispatcher::patch_libraries(const std::u16string &path, patch_info *patches,
         const std::size_t patch_count) {
         codeseg_ptr seg = libmngr_->load(path);
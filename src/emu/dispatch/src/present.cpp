@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dispatch/present.h>
+
+#include <common/log.h>
+#include <common/thread.h>
+#include <common/time.h>
+
+#include <drivers/graphics/graphics.h>
+#include <kernel/kernel.h>
+#include <kernel/timing.h>
+#include <services/window/common.h>
+#include <services/window/screen.h>
+
+#include <algorithm>
+
+namespace eka2l1::dispatch {
+    std::size_t get_screen_buffer_pitch(const int width, const int bpp) {
+        if (bpp < 8) {
+            return (width * bpp + 31) / 32 * 4;
+        }
+
+        return width * ((bpp + 7) / 8);
+    }
+
+    screen_upload_region get_screen_upload_region(const eka2l1::rect &dirty, const eka2l1::vec2 &screen_size, const int bpp) {
+        screen_upload_region region;
+        region.area = dirty;
+
+        const std::size_t pitch = get_screen_buffer_pitch(screen_size.x, bpp);
+
+        if (bpp < 8) {
+            region.area.top.x = 0;
+            region.area.size.x = screen_size.x;
+
+            region.offset = region.area.top.y * pitch;
+            region.size = region.area.size.y * pitch;
+            region.pixels_per_line = pitch * 8 / bpp;
+
+            return region;
+        }
+
+        const std::size_t bytes_per_pixel = (bpp + 7) / 8;
+
+        region.offset = region.area.top.y * pitch + region.area.top.x * bytes_per_pixel;
+        region.size = (region.area.size.y - 1) * pitch + region.area.size.x * bytes_per_pixel;
+        region.pixels_per_line = screen_size.x;
+
+        return region;
+    }
+
+    screen_dirty_tracker::submit_result screen_dirty_tracker::submit(const eka2l1::vec2 &screen_size, const eka2l1::rect *rects,
+        const std::uint32_t rect_count) {
+        const eka2l1::rect screen_rect({ 0, 0 }, screen_size);
+        eka2l1::rect updated;
+
+        for (std::uint32_t i = 0; i < rect_count; i++) {
+            const eka2l1::rect clipped = rects[i].intersect(screen_rect);
+
+            if ((clipped.size.x <= 0) || (clipped.size.y <= 0)) {
+                continue;
+            }
+
+            if (updated.empty()) {
+                updated = clipped;
+            } else {
+                updated.merge(clipped);
+            }
+        }
+
+        // No rectangle list means the whole screen
+        if (!rects || !rect_count) {
+            updated = screen_rect;
+        }
+
+        if (updated.empty()) {
+            return submit_nothing_dirty;
+        }
+
+        if (dirty_.empty()) {
+            dirty_ = updated;
+        } else {
+            dirty_.merge(updated);
+        }
+
+        if (scheduled_) {
+            // The upload that is already pending will pick up this update too
+            return submit_superseded;
+        }
+
+        scheduled_ = true;
+        return submit_schedule;
+    }
+
+    eka2l1::rect screen_dirty_tracker::take() {
+        eka2l1::rect result = dirty_;
+
+        dirty_.make_empty();
+        scheduled_ = false;
+
+        return result;
+    }
+
+    void screen_presenter::on_present_due(std::uint64_t userdata, const int cycles_late) {
+        std::unique_ptr<present_ticket> ticket(reinterpret_cast<present_ticket *>(userdata));
+        present_link &link = *ticket->link_;
+
+        // The kernel lock goes first, like everywhere else. The presenter can be destroyed with the kernel
+        // lock held, so nothing taken before it may be waited on by the destructor.
+        if (!link.use_thread_) {
+            link.kern_->lock();
+        }
+
+        {
+            const std::lock_guard<std::mutex> guard(link.lock_);
+
+            if (link.presenter_) {
+                link.presenter_->present_due(ticket->screen_number_);
+            }
+        }
+
+        if (!link.use_thread_) {
+            link.kern_->unlock();
+        }
+    }
+
+    screen_presenter::screen_presenter(kernel_system *kern, ntimer *timing, const bool use_thread)
+        : timing_(timing)
+        , link_(std::make_shared<present_link>())
+        , use_thread_(use_thread)
+        , stopping_(false) {
+        link_->presenter_ = this;
+        link_->kern_ = kern;
+        link_->use_thread_ = use_thread;
+
+        present_evt_ = timing_->register_event("dispatch_screen_present_evt", on_present_due);
+
+        if (use_thread_) {
+            worker_ = std::thread([this]() {
+                common::set_thread_name("Screen presenter thread");
+                worker_loop();
+            });
+        }
+    }
+
+    screen_presenter::~screen_presenter() {
+        // Waits for an upload done by the timer thread to finish, which does not need the kernel lock
+        // from here. Events that fire after this find the presenter gone.
+        {
+            const std::lock_guard<std::mutex> guard(link_->lock_);
+            link_->presenter_ = nullptr;
+        }
+
+        {
+            const std::lock_guard<std::mutex> guard(lock_);
+            stopping_ = true;
+
+            // Queued for the worker, but never going to be presented now
+            ready_.clear();
+
+            for (auto &[number, state] : states_) {
+                // If the timer thread already took the event, it frees the ticket itself
+                if (state.ticket_ && timing_->unschedule_event(present_evt_, reinterpret_cast<std::uint64_t>(state.ticket_))) {
+                    delete state.ticket_;
+                }
+
+                state.ticket_ = nullptr;
+                state.dirty_.take();
+
+                if (state.stats_.presented) {
+                    LOG_INFO(HLE_DISPATCHER, "Screen {}: {} updates submitted, {} presented, {} superseded, average latency {}us (max {}us)",
+                        number, state.stats_.submitted, state.stats_.presented, state.stats_.superseded,
+                        state.stats_.total_latency_us / state.stats_.presented, state.stats_.max_latency_us);
+                }
+            }
+        }
+
+        // The worker finishes the upload it is doing, if any, before leaving
+        if (worker_.joinable()) {
+            worker_cond_.notify_one();
+            worker_.join();
+        }
+
+        timing_->remove_event(present_evt_);
+    }
+
+    void screen_presenter::submit(drivers::graphics_driver *driver, epoc::screen *scr, const eka2l1::rect *rects,
+        const std::uint32_t rect_count) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        if (stopping_) {
+            return;
+        }
+
+        screen_present_state &state = states_[scr->number];
+        state.scr_ = scr;
+        state.driver_ = driver;
+        state.stats_.submitted++;
+
+        switch (state.dirty_.submit(scr->size(), rects, rect_count)) {
+        case screen_dirty_tracker::submit_superseded:
+            state.stats_.superseded++;
+            return;
+
+        case screen_dirty_tracker::submit_nothing_dirty:
+            return;
+
+        default:
+            break;
+        }
+
+        const std::uint64_t now = common::get_current_time_in_microseconds_since_epoch();
+        const std::uint64_t microsecs_a_frame = 1000000 / std::max<std::uint8_t>(scr->refresh_rate, 1);
+        const std::uint64_t next_present = state.last_present_us_ + microsecs_a_frame;
+
+        auto ticket = std::make_unique<present_ticket>();
+        ticket->link_ = link_;
+        ticket->screen_number_ = scr->number;
+
+        state.first_submit_us_ = now;
+        state.ticket_ = ticket.release();
+
+        timing_->schedule_event((next_present > now) ? static_cast<std::int64_t>(next_present - now) : 0,
+            present_evt_, reinterpret_cast<std::uint64_t>(state.ticket_));
+    }
+
+    void screen_presenter::present_due(const int screen_number) {
+        screen_present_state *state = nullptr;
+
+        {
+            const std::lock_guard<std::mutex> guard(lock_);
+            auto result = states_.find(screen_number);
+
+            if (result == states_.end()) {
+                return;
+            }
+
+            state = &result->second;
+            state->ticket_ = nullptr;
+
+            if (use_thread_) {
+                ready_.push_back(state);
+                worker_cond_.notify_one();
+
+                return;
+            }
+        }
+
+        // Called with the kernel lock held
+        present(state);
+    }
+
+    void screen_presenter::worker_loop() {
+        while (true) {
+            screen_present_state *state = nullptr;
+
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                worker_cond_.wait(guard, [this]() { return stopping_ || !ready_.empty(); });
+
+                if (stopping_) {
+                    break;
+                }
+
+                state = ready_.front();
+                ready_.pop_front();
+            }
+
+            // The guest may still be drawing to the buffer meanwhile. Same as on real hardware,
+            // the screen can tear, but the guest does not have to wait for the copy.
+            present(state);
+        }
+    }
+
+    void screen_presenter::present(screen_present_state *state) {
+        eka2l1::rect dirty;
+        std::uint64_t first_submit = 0;
+
+        {
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            dirty = state->dirty_.take();
+            first_submit = state->first_submit_us_;
+        }
+
+        epoc::screen *scr = state->scr_;
+        drivers::graphics_driver *driver = state->driver_;
+
+        {
+            const std::lock_guard<std::mutex> guard(scr->screen_mutex);
+
+            if (!scr->dsa_texture || dirty.empty()) {
+                return;
+            }
+
+            const eka2l1::vec2 screen_size = scr->size();
+            const screen_upload_region region = get_screen_upload_region(dirty, screen_size,
+                epoc::get_bpp_from_display_mode(scr->disp_mode));
+
+            dirty = region.area;
+            const std::uint8_t *upload_data = scr->screen_buffer_ptr() + region.offset;
+
+            auto command_list = driver->new_command_list();
+            auto command_builder = driver->new_command_builder(command_list.get());
+
+            command_builder->update_bitmap(scr->dsa_texture, reinterpret_cast<const char *>(upload_data), region.size,
+                dirty.top, dirty.size, region.pixels_per_line);
+
+            // NOTE: This is a hack for some apps that dont fill alpha
+            // TODO: Figure out why or better solution (maybe the display mode is not really correct?)
+            switch (scr->disp_mode) {
+            case epoc::display_mode::color16m:
+            case epoc::display_mode::color16mu:
+            case epoc::display_mode::color16ma:
+                command_builder->set_swizzle(scr->dsa_texture, drivers::channel_swizzle::red, drivers::channel_swizzle::green,
+                    drivers::channel_swizzle::blue, drivers::channel_swizzle::one);
+
+                break;
+
+            default:
+                break;
+            }
+
+            driver->submit_command_list(*command_list);
+        }
+
+        const std::uint64_t now = common::get_current_time_in_microseconds_since_epoch();
+        const std::uint64_t latency = (now > first_submit) ? (now - first_submit) : 0;
+
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        state->last_present_us_ = now;
+        state->stats_.presented++;
+        state->stats_.pixels_uploaded += static_cast<std::uint64_t>(dirty.size.x) * dirty.size.y;
+        state->stats_.last_latency_us = latency;
+        state->stats_.total_latency_us += latency;
+        state->stats_.max_latency_us = std::max(state->stats_.max_latency_us, latency);
+    }
+
+    screen_present_stats screen_presenter::get_stats(const int screen_number) {
+        const std::lock_guard<std::mutex> guard(lock_);
+        auto result = states_.find(screen_number);
+
+        if (result == states_.end()) {
+            return screen_present_stats{};
+        }
+
+        return result->second.stats_;
+    }
+}
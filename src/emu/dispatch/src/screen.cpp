@@ -19,6 +19,7 @@
 
 #include <common/log.h>
 #include <dispatch/dispatcher.h>
+#include <dispatch/present.h>
 #include <dispatch/screen.h>
 
 #include <drivers/graphics/graphics.h>
@@ -28,6 +29,7 @@
 #include <services/window/window.h>
 
 #include <fstream>
+#include <vector>
 
 namespace eka2l1::dispatch {
     static constexpr std::uint32_t FPS_LIMIT = 60;
@@ -43,7 +45,6 @@ namespace eka2l1::dispatch {
             if (scr->number == screen_number) {
                 // Update the DSA screen texture
                 const eka2l1::vec2 screen_size = scr->size();
-                const std::size_t buffer_size = scr->size().x * scr->size().y * 4;
 
                 std::uint64_t next_vsync_us = 0;
                 scr->vsync(sys->get_ntimer(), next_vsync_us);
@@ -52,42 +53,34 @@ namespace eka2l1::dispatch {
                     kern->crr_thread()->sleep(static_cast<std::uint32_t>(next_vsync_us));
                 }
 
-                std::unique_lock<std::mutex> guard(scr->screen_mutex);
+                {
+                    std::unique_lock<std::mutex> guard(scr->screen_mutex);
 
-                if (!scr->dsa_texture) {
-                    kern->unlock();
-                    guard.unlock();
+                    if (!scr->dsa_texture) {
+                        kern->unlock();
+                        guard.unlock();
 
-                    drivers::handle bitmap_handle = drivers::create_bitmap(driver, screen_size, epoc::get_bpp_from_display_mode(scr->disp_mode));
-                    
-                    kern->lock();
-                    guard.lock();
+                        drivers::handle bitmap_handle = drivers::create_bitmap(driver, screen_size, epoc::get_bpp_from_display_mode(scr->disp_mode));
 
-                    scr->dsa_texture = bitmap_handle;
-                }
-
-                auto command_list = driver->new_command_list();
-                auto command_builder = driver->new_command_builder(command_list.get());
+                        kern->lock();
+                        guard.lock();
 
-                command_builder->update_bitmap(scr->dsa_texture, reinterpret_cast<const char*>(scr->screen_buffer_ptr()),
-                    buffer_size, { 0, 0 }, screen_size);
+                        scr->dsa_texture = bitmap_handle;
+                    }
+                }
 
-                // NOTE: This is a hack for some apps that dont fill alpha
-                // TODO: Figure out why or better solution (maybe the display mode is not really correct?)
-                switch (scr->disp_mode) {
-                case epoc::display_mode::color16m:
-                case epoc::display_mode::color16mu:
-                case epoc::display_mode::color16ma:
-                    command_builder->set_swizzle(scr->dsa_texture, drivers::channel_swizzle::red, drivers::channel_swizzle::green,
-                        drivers::channel_swizzle::blue, drivers::channel_swizzle::one);
+                std::vector<eka2l1::rect> rects;
 
-                    break;
+                if (rect_list) {
+                    rects.assign(rect_list, rect_list + num_rects);
 
-                default:
-                    break;
+                    for (eka2l1::rect &rect : rects) {
+                        rect.transform_from_symbian_rectangle();
+                    }
                 }
 
-                driver->submit_command_list(*command_list);
+                // Uploaded at the next refresh, merged with any other update coming before that
+                dispatcher->get_screen_presenter()->submit(driver, scr, rects.data(), static_cast<std::uint32_t>(rects.size()));
             }
 
             scr = scr->next;
@@ -23,11 +23,18 @@
 #include <drivers/driver.h>
 
 #include <cstdint>
+#include <memory>
 
 namespace eka2l1::drivers {
+    class audio_mixer;
+
     class audio_driver : public driver {
+    protected:
+        std::unique_ptr<audio_mixer> mixer_;
+
     public:
-        virtual ~audio_driver() {}
+        explicit audio_driver();
+        virtual ~audio_driver();
 
         void run() override {}
         void abort() override {}
@@ -39,15 +46,34 @@ namespace eka2l1::drivers {
          * \param channels          The number of channels of the stream.
          * \param callback          The callback that the stream will use to retrive data.
          * 
+         * The stream is mixed with other guest streams into a single host stream. Any sample rate
+         * is accepted, and is resampled to the native sample rate.
+         * 
          * \returns Instance to the stream on success.
          * 
          * \see     native_sample_rate
          */
-        virtual std::unique_ptr<audio_output_stream> new_output_stream(const std::uint32_t sample_rate,
+        std::unique_ptr<audio_output_stream> new_output_stream(const std::uint32_t sample_rate,
+            const std::uint8_t channels, data_callback callback);
+
+        /**
+         * \brief Create a signed 16-bit LE output stream directly on the host backend.
+         * 
+         * Used by the mixer. Guest streams should use new_output_stream.
+         */
+        virtual std::unique_ptr<audio_output_stream> new_host_output_stream(const std::uint32_t sample_rate,
             const std::uint8_t channels, data_callback callback)
             = 0;
 
         virtual std::uint32_t native_sample_rate() = 0;
+
+        /**
+         * \brief Get the mixer guest streams go through.
+         * \returns Nullptr if no guest stream has been created yet.
+         */
+        audio_mixer *get_mixer() {
+            return mixer_.get();
+        }
     };
 
     enum class audio_driver_backend {
@@ -32,7 +32,7 @@ namespace eka2l1::drivers {
         explicit cubeb_audio_driver();
 
         ~cubeb_audio_driver() override;
-        std::unique_ptr<audio_output_stream> new_output_stream(const std::uint32_t sample_rate,
+        std::unique_ptr<audio_output_stream> new_host_output_stream(const std::uint32_t sample_rate,
             const std::uint8_t channels, data_callback callback) override;
         std::uint32_t native_sample_rate() override;
     };
@@ -43,5 +43,6 @@ namespace eka2l1::drivers {
         bool is_playing() override;
 
         bool set_volume(const float volume) override;
+        std::uint32_t latency_frames() override;
     };
 }
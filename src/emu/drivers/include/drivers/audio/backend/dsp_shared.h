@@ -22,38 +22,93 @@
 #include <drivers/audio/audio.h>
 #include <drivers/audio/dsp.h>
 
-#include <common/queue.h>
+#include <common/ringbuf.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace eka2l1::drivers {
     using dsp_buffer = std::vector<std::uint8_t>;
 
+    /**
+     * \brief Marks where a guest buffer starts and ends in the PCM ring buffer.
+     * 
+     * The buffer copied notification is sent when the audio callback starts consuming it.
+     */
+    struct dsp_buffer_mark {
+        std::size_t start_;
+        std::size_t end_;
+    };
+
     struct dsp_output_stream_shared : public dsp_output_stream {
     protected:
+        static constexpr std::size_t RING_BUFFER_SIZE = 1 << 17;
+        static constexpr std::size_t MAX_FREE_BUFFERS = 8;
+
         drivers::audio_driver *aud_;
         std::unique_ptr<drivers::audio_output_stream> stream_;
 
-        threadsafe_cn_queue<dsp_buffer> buffers_;
+        // Decoded PCM data, produced under worker_lock_ and consumed by the audio callback without any lock
+        common::ring_buffer<std::uint8_t> ring_;
+
+        std::atomic<std::size_t> flush_target_;
+        std::atomic<bool> flush_requested_;
+
+        // Set while the worker waits for the audio callback to consume something. The callback then
+        // bumps the wake sequence under worker_lock_ and wakes it up.
+        std::atomic<bool> wake_on_consume_;
+
+        // All below are guarded by worker_lock_, format_ included
+        std::uint32_t wake_seq_;
+        std::deque<dsp_buffer> pending_;
+        std::vector<dsp_buffer> free_buffers_;
+        std::deque<dsp_buffer_mark> marks_;
 
         dsp_buffer decoded_;
         std::size_t pointer_;
+        std::uint32_t generation_;
+        bool decoding_;
+
+        std::thread worker_;
+        std::mutex worker_lock_;
+        std::condition_variable worker_cond_;
+        bool worker_quit_;
 
-        std::int16_t last_frame_[2];
         std::mutex callback_lock_;
 
-        bool virtual_stop;
+        std::atomic<bool> virtual_stop;
+
+        void worker_loop();
+        void start_worker_no_lock();
+
+        bool push_decoded_no_lock();
+        void recycle_buffer_no_lock(dsp_buffer &buffer);
+
+        /**
+         * \brief Stop the decode worker.
+         * 
+         * Derived classes implementing decode_data must call this in their destructor, before
+         * their decoding state is destroyed.
+         */
+        void stop_worker();
 
     public:
         explicit dsp_output_stream_shared(drivers::audio_driver *aud);
         ~dsp_output_stream_shared() override;
 
+        /**
+         * \brief Decode a guest buffer to PCM16. Called on the decode worker thread.
+         */
         virtual void decode_data(dsp_buffer &original, std::vector<std::uint8_t> &dest) = 0;
         std::size_t data_callback(std::int16_t *buffer, const std::size_t frame_count);
 
         bool write(const std::uint8_t *data, const std::uint32_t data_size) override;
 
+        bool format(const four_cc fmt) override;
         void volume(const std::uint32_t new_volume) override;
         bool set_properties(const std::uint32_t freq, const std::uint8_t channels) override;
 
@@ -72,4 +127,4 @@ namespace eka2l1::drivers {
             return (stream_ && stream_->is_playing());
         }
     };
-}
\ No newline at end of file
+}
@@ -25,12 +25,23 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 }
 
+struct SwrContext;
+
 namespace eka2l1::drivers {
     struct dsp_output_stream_ffmpeg : public dsp_output_stream_shared {
     protected:
         AVCodecContext *codec_;
         std::uint64_t timestamp_in_base_;
 
+        // Conversion context is kept around until the source or target format changes
+        SwrContext *swr_;
+        std::uint64_t swr_in_layout_;
+        int swr_in_format_;
+        int swr_in_rate_;
+        std::uint32_t swr_out_rate_;
+
+        bool prepare_resampler(AVFrame *frame);
+
     public:
         explicit dsp_output_stream_ffmpeg(drivers::audio_driver *aud);
         ~dsp_output_stream_ffmpeg() override;
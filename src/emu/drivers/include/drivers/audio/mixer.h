@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <drivers/audio/stream.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eka2l1::drivers {
+    class audio_driver;
+    class audio_mixer;
+
+    struct audio_mixer_stream_stats {
+        std::uint64_t frames_mixed_; ///< Total frames mixed to the host stream, in host sample rate.
+        std::uint64_t underruns_; ///< Number of times the stream supplied less frames than requested.
+        std::uint32_t latency_us_; ///< Estimated time between supplying a frame and it being heard.
+    };
+
+    /**
+     * \brief A guest audio stream that goes through the mixer.
+     * 
+     * Data is pulled from the callback in the stream's own format, then converted to stereo and resampled
+     * to the host rate. The resampler state persists for the stream's whole lifetime.
+     * 
+     * The callback runs on the host audio thread, without any mixer lock held, so it may take other locks
+     * such as the kernel lock. Stopping does not wait for it, and may be done from inside the callback.
+     * Destroying the stream does wait, so it must not be destroyed from inside its own callback.
+     * 
+     * Supplying less frames than requested counts as an underrun. The missing part is mixed as silence and
+     * the stream keeps playing. A stream whose source has ended must stop itself.
+     */
+    struct audio_mixer_stream : public audio_output_stream {
+    private:
+        friend class audio_mixer;
+
+        audio_mixer *mixer_;
+        data_callback callback_;
+
+        std::uint32_t sample_rate_;
+        std::uint8_t channels_;
+
+        std::atomic<float> volume_;
+        std::atomic<bool> playing_;
+        std::atomic<bool> mixing_; ///< Set while the stream is in the mixer's current pass.
+        std::atomic<bool> reset_pending_; ///< Set by start, the resampler is reset by the next render.
+
+        // Resampler state, only touched while mixing
+        std::vector<std::int16_t> source_buffer_;
+        std::size_t source_frames_;
+        std::size_t source_pos_;
+
+        std::uint64_t step_; ///< Source frames advanced per host frame, in 32.32 fixed point.
+        std::uint64_t fraction_;
+
+        std::int16_t previous_frame_[2];
+        std::int16_t current_frame_[2];
+
+        std::atomic<std::uint64_t> frames_mixed_;
+        std::atomic<std::uint64_t> underruns_;
+        std::atomic<std::uint32_t> buffered_frames_;
+
+        bool fetch_source_frame();
+        std::size_t render(std::int16_t *dest, const std::size_t frames, const std::uint32_t host_rate);
+
+    public:
+        explicit audio_mixer_stream(audio_mixer *mixer, const std::uint32_t sample_rate, const std::uint8_t channels,
+            data_callback callback);
+        ~audio_mixer_stream() override;
+
+        bool start() override;
+        bool stop() override;
+
+        bool is_playing() override;
+        bool set_volume(const float volume) override;
+
+        audio_mixer_stream_stats stats() const;
+    };
+
+    /**
+     * \brief Mix all guest audio streams into a single host stream.
+     * 
+     * The host stream is stereo at the driver's native sample rate, created when the first stream starts.
+     * It is stopped when the last stream is destroyed, and destroyed with the mixer.
+     * 
+     * The mixing thread never blocks. It only tries the stream list lock to take a snapshot of the streams
+     * to mix, and skips the pass if a stream is being added or removed at that moment.
+     */
+    class audio_mixer {
+        friend struct audio_mixer_stream;
+
+    public:
+        static constexpr std::size_t MAX_MIX_FRAMES = 1024;
+        static constexpr std::size_t MAX_STREAMS = 32;
+
+    private:
+
+        audio_driver *driver_;
+        std::unique_ptr<audio_output_stream> host_stream_;
+        std::uint32_t host_rate_;
+        std::mutex host_lock_;
+
+        std::mutex streams_lock_;
+        std::vector<audio_mixer_stream *> streams_;
+
+        // Only touched by the mixing thread
+        std::array<audio_mixer_stream *, MAX_STREAMS> snapshot_;
+        std::size_t snapshot_count_;
+
+        std::vector<float> mix_buffer_;
+        std::vector<std::int16_t> scratch_;
+
+        std::atomic<std::uint64_t> skipped_passes_;
+
+        void add_stream(audio_mixer_stream *stream);
+        void remove_stream(audio_mixer_stream *stream);
+
+        bool start_host_stream();
+
+    public:
+        explicit audio_mixer(audio_driver *driver);
+        ~audio_mixer();
+
+        std::unique_ptr<audio_output_stream> new_stream(const std::uint32_t sample_rate, const std::uint8_t channels,
+            data_callback callback);
+
+        /**
+         * \brief Mix all playing streams. Called by the host stream.
+         * 
+         * \param output   Stereo signed 16-bit output.
+         * \param frames   Number of frames to mix.
+         */
+        std::size_t mix(std::int16_t *output, const std::size_t frames);
+
+        /**
+         * \brief Get the statistics of all streams currently attached to the mixer.
+         */
+        std::vector<audio_mixer_stream_stats> stream_stats();
+
+        /**
+         * \brief Get the number of passes output as silence because the stream list was being modified.
+         */
+        std::uint64_t skipped_passes() const {
+            return skipped_passes_;
+        }
+
+        std::uint32_t host_sample_rate() const {
+            return host_rate_;
+        }
+    };
+}
@@ -34,5 +34,13 @@ namespace eka2l1::drivers {
         virtual bool is_playing() = 0;
 
         virtual bool set_volume(const float volume) = 0;
+
+        /**
+         * \brief Get the number of frames between the callback and the speaker.
+         * \returns Latency in frames, 0 if unknown.
+         */
+        virtual std::uint32_t latency_frames() {
+            return 0;
+        }
     };
 };
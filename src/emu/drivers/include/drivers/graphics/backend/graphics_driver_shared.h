@@ -32,6 +32,8 @@
 #include <common/queue.h>
 #include <common/vecx.h>
 
+#include <mutex>
+
 namespace eka2l1::drivers {
     /**
      * \brief Bitmap is basically a texture. It can be drawn into and can be taken to draw.
@@ -54,6 +56,11 @@ namespace eka2l1::drivers {
     using bitmap_ptr = std::unique_ptr<bitmap>;
     using graphics_object_instance = std::unique_ptr<graphics_object>;
 
+    /**
+     * \brief Check if a command changes the render state that draws depend on.
+     */
+    bool is_render_state_command(const std::uint16_t opcode);
+
     class shared_graphics_driver : public graphics_driver {
     protected:
         std::vector<bitmap_ptr> bmp_textures;
@@ -68,6 +75,15 @@ namespace eka2l1::drivers {
         glm::mat4 projection_matrix;
         eka2l1::vecx<float, 4> brush_color;
 
+        graphics_driver_stats frame_stats;
+        graphics_driver_stats last_frame_stats;
+        mutable std::mutex stats_lock;
+
+        /**
+         * \brief Publish statistics of the frame being displayed, and start counting a new one.
+         */
+        void finish_frame_stats();
+
         drivers::handle append_graphics_object(graphics_object_instance &instance);
         bool delete_graphics_object(const drivers::handle handle);
         graphics_object *get_graphics_object(const drivers::handle num);
@@ -109,5 +125,7 @@ namespace eka2l1::drivers {
         virtual void dispatch(command *cmd);
 
         virtual void bind_swapchain_framebuf() = 0;
+
+        graphics_driver_stats get_last_frame_stats() const override;
     };
 }
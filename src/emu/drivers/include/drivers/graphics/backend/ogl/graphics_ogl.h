@@ -21,6 +21,7 @@
 #pragma once
 
 #include <drivers/graphics/backend/graphics_driver_shared.h>
+#include <drivers/graphics/backend/sprite_batch.h>
 #include <drivers/graphics/backend/ogl/shader_ogl.h>
 #include <drivers/graphics/backend/ogl/texture_ogl.h>
 
@@ -65,6 +66,14 @@ namespace eka2l1::drivers {
         GLuint fill_vao;
         GLuint fill_vbo;
 
+        // Streaming buffer that batched sprites are written into, orphaned when full
+        GLuint batch_vao;
+        GLuint batch_vbo;
+        GLuint batch_ibo;
+        std::size_t batch_buffer_offset;
+
+        sprite_batch sprites;
+
         GLint color_loc;
         GLint proj_loc;
         GLint model_loc;
@@ -92,6 +101,8 @@ namespace eka2l1::drivers {
 
         void clear(command_helper &helper);
         void draw_bitmap(command_helper &helper);
+        void queue_sprite(bitmap *bmp, eka2l1::rect dest_rect, eka2l1::rect source_rect, const GLfloat *color, const GLfloat flip);
+        void flush_sprite_batch();
         void draw_rectangle(command_helper &helper);
         void set_clipping(command_helper &helper);
         void clip_rect(command_helper &helper);
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/vecx.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eka2l1::drivers {
+    struct sprite_vertex {
+        float top[2];
+        float coord[2];
+    };
+
+    /**
+     * \brief Consecutive bitmap draws waiting to be issued as one draw call.
+     *
+     * Draws can only join the batch if they use the same texture, color and flip as the ones already in it.
+     * The backend flushes the batch before any other command, so blend, clip and target state never change
+     * under it.
+     *
+     * Each sprite is four vertices, in the corner order bottom left, top right, top left, bottom right.
+     */
+    class sprite_batch {
+        std::vector<sprite_vertex> vertices_;
+        std::uint64_t texture_;
+        float color_[4];
+        float flip_;
+
+    public:
+        /**
+         * \brief Maximum number of sprites in a batch, so indices fit in 16 bits.
+         */
+        static constexpr std::size_t MAX_SPRITES = 4096;
+
+        explicit sprite_batch();
+
+        /**
+         * \brief Check if a draw with the given state can be appended to the batch.
+         *
+         * \returns False if the batch is empty, full or uses different state. The batch must then be
+         *          flushed before queueing the draw.
+         */
+        bool can_join(const std::uint64_t texture, const float *color, const float flip) const;
+
+        /**
+         * \brief Append a sprite. If the batch is empty, it takes the state of this sprite.
+         *
+         * \param texture       Handle of the texture to draw.
+         * \param tex_size      Size of the texture in pixels.
+         * \param dest_rect     Destination in pixels. Empty size means the size of the source.
+         * \param source_rect   Source in texels. Empty means the whole texture.
+         * \param color         Four color components.
+         * \param flip          Flip factor given to the sprite shader.
+         */
+        void push(const std::uint64_t texture, const eka2l1::vec2 &tex_size, eka2l1::rect dest_rect,
+            eka2l1::rect source_rect, const float *color, const float flip);
+
+        void clear() {
+            vertices_.clear();
+        }
+
+        bool empty() const {
+            return vertices_.empty();
+        }
+
+        std::size_t sprite_count() const {
+            return vertices_.size() / 4;
+        }
+
+        const std::vector<sprite_vertex> &vertices() const {
+            return vertices_;
+        }
+
+        std::uint64_t texture() const {
+            return texture_;
+        }
+
+        const float *color() const {
+            return color_;
+        }
+
+        float flip() const {
+            return flip_;
+        }
+    };
+}
@@ -83,6 +83,16 @@ namespace eka2l1::drivers {
 
     using display_hook = std::function<void()>;
 
+    /**
+     * \brief Rendering statistics of one frame, counted on the driver thread.
+     */
+    struct graphics_driver_stats {
+        std::uint32_t draw_calls = 0; ///< Draw calls issued to the graphics API.
+        std::uint32_t state_changes = 0; ///< Commands that changed render state.
+        std::uint32_t bitmap_draws = 0; ///< Bitmap draw commands received.
+        std::uint32_t batched_bitmap_draws = 0; ///< Bitmap draws that shared a draw call with the previous one.
+    };
+
     class graphics_driver : public driver {
         graphic_api api_;
 
@@ -104,6 +114,13 @@ namespace eka2l1::drivers {
             return false;
         }
 
+        /**
+         * \brief Get rendering statistics of the last displayed frame.
+         */
+        virtual graphics_driver_stats get_last_frame_stats() const {
+            return graphics_driver_stats{};
+        }
+
         /**
          * \brief Set a hook when display function is called.
          *
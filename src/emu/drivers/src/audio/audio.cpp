@@ -19,8 +19,24 @@
 
 #include <drivers/audio/audio.h>
 #include <drivers/audio/backend/cubeb/audio_cubeb.h>
+#include <drivers/audio/mixer.h>
 
 namespace eka2l1::drivers {
+    audio_driver::audio_driver() {
+    }
+
+    audio_driver::~audio_driver() {
+    }
+
+    std::unique_ptr<audio_output_stream> audio_driver::new_output_stream(const std::uint32_t sample_rate,
+        const std::uint8_t channels, data_callback callback) {
+        if (!mixer_) {
+            mixer_ = std::make_unique<audio_mixer>(this);
+        }
+
+        return mixer_->new_stream(sample_rate, channels, callback);
+    }
+
     std::unique_ptr<audio_driver> make_audio_driver(const audio_driver_backend backend) {
         switch (backend) {
         case audio_driver_backend::cubeb: {
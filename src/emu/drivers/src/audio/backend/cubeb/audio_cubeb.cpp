@@ -21,6 +21,7 @@
 #include <common/platform.h>
 #include <drivers/audio/backend/cubeb/audio_cubeb.h>
 #include <drivers/audio/backend/cubeb/stream_cubeb.h>
+#include <drivers/audio/mixer.h>
 
 #if EKA2L1_PLATFORM(WIN32)
 #include <objbase.h>
@@ -39,6 +40,9 @@ namespace eka2l1::drivers {
     }
 
     cubeb_audio_driver::~cubeb_audio_driver() {
+        // The mixer's host stream must be destroyed before the context
+        mixer_.reset();
+
         if (context_) {
             cubeb_destroy(context_);
         }
@@ -60,7 +64,7 @@ namespace eka2l1::drivers {
         return preferred_rate;
     }
 
-    std::unique_ptr<audio_output_stream> cubeb_audio_driver::new_output_stream(const std::uint32_t sample_rate,
+    std::unique_ptr<audio_output_stream> cubeb_audio_driver::new_host_output_stream(const std::uint32_t sample_rate,
         const std::uint8_t channels, data_callback callback) {
         if (!init_) {
             return nullptr;
@@ -109,4 +109,14 @@ namespace eka2l1::drivers {
 
         return false;
     }
-}
\ No newline at end of file
+
+    std::uint32_t cubeb_audio_output_stream::latency_frames() {
+        std::uint32_t latency = 0;
+
+        if (!stream_ || (cubeb_stream_get_latency(stream_, &latency) != CUBEB_OK)) {
+            return 0;
+        }
+
+        return latency;
+    }
+}
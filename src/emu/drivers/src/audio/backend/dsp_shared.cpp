@@ -18,28 +18,189 @@
  */
 
 #include <common/log.h>
+#include <common/thread.h>
 #include <drivers/audio/backend/dsp_shared.h>
 
+#include <chrono>
+
 namespace eka2l1::drivers {
     dsp_output_stream_shared::dsp_output_stream_shared(drivers::audio_driver *aud)
         : dsp_output_stream()
         , aud_(aud)
+        , ring_(RING_BUFFER_SIZE)
+        , flush_target_(0)
+        , flush_requested_(false)
+        , wake_on_consume_(false)
+        , wake_seq_(0)
         , pointer_(0)
+        , generation_(0)
+        , decoding_(false)
+        , worker_quit_(false)
         , virtual_stop(true) {
-        last_frame_[0] = 0;
-        last_frame_[1] = 0;
     }
 
     dsp_output_stream_shared::~dsp_output_stream_shared() {
         if (stream_) {
             stream_->stop();
         }
+
+        stop_worker();
+    }
+
+    void dsp_output_stream_shared::start_worker_no_lock() {
+        if (worker_.joinable()) {
+            return;
+        }
+
+        worker_quit_ = false;
+        worker_ = std::thread([this]() {
+            common::set_thread_name("DSP stream decode thread");
+            worker_loop();
+        });
+    }
+
+    void dsp_output_stream_shared::stop_worker() {
+        {
+            const std::lock_guard<std::mutex> guard(worker_lock_);
+            worker_quit_ = true;
+            wake_seq_++;
+        }
+
+        worker_cond_.notify_one();
+
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void dsp_output_stream_shared::recycle_buffer_no_lock(dsp_buffer &buffer) {
+        if (free_buffers_.size() < MAX_FREE_BUFFERS) {
+            buffer.clear();
+            free_buffers_.push_back(std::move(buffer));
+        }
+    }
+
+    bool dsp_output_stream_shared::push_decoded_no_lock() {
+        if (pointer_ >= decoded_.size()) {
+            return true;
+        }
+
+        pointer_ += ring_.push(decoded_.data() + pointer_, decoded_.size() - pointer_);
+        return (pointer_ >= decoded_.size());
+    }
+
+    void dsp_output_stream_shared::worker_loop() {
+        std::unique_lock<std::mutex> guard(worker_lock_);
+
+        while (!worker_quit_) {
+            // Ask to be woken up by the next consumption before looking at the ring buffer. The fence pairs with
+            // the one in data_callback: either the ring state read below includes a consumption, or that
+            // consumption's callback sees the request and bumps the sequence under the lock.
+            wake_on_consume_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const std::uint32_t seq = wake_seq_;
+
+            // Push what's left of the current decoded buffer, then decode the next ones until the ring is full
+            while (push_decoded_no_lock() && !pending_.empty()) {
+                dsp_buffer encoded = std::move(pending_.front());
+                pending_.pop_front();
+
+                const std::uint32_t generation = generation_;
+                const four_cc format = format_;
+
+                decoding_ = true;
+
+                // Decode without holding the lock, so writes from the guest are not blocked
+                guard.unlock();
+
+                dsp_buffer decoded;
+
+                if (format == PCM16_FOUR_CC_CODE) {
+                    decoded.swap(encoded);
+                } else {
+                    decode_data(encoded, decoded);
+                }
+
+                guard.lock();
+                decoding_ = false;
+
+                if (format != PCM16_FOUR_CC_CODE) {
+                    recycle_buffer_no_lock(encoded);
+                }
+
+                if (generation != generation_) {
+                    // Stopped while decoding, drop it
+                    continue;
+                }
+
+                recycle_buffer_no_lock(decoded_);
+
+                decoded_ = std::move(decoded);
+                pointer_ = 0;
+
+                const std::size_t start = ring_.write_position();
+                marks_.push_back({ start, start + decoded_.size() });
+            }
+
+            // Notify buffers that started being consumed
+            const std::size_t read_pos = ring_.read_position();
+            std::size_t total_notify = 0;
+
+            while (!marks_.empty() && ((read_pos > marks_.front().start_) || (read_pos >= marks_.front().end_))) {
+                samples_copied_ += (marks_.front().end_ - marks_.front().start_) / sizeof(std::uint16_t);
+                marks_.pop_front();
+
+                total_notify++;
+            }
+
+            if (total_notify) {
+                guard.unlock();
+
+                dsp_stream_notification_callback callback;
+                void *userdata = nullptr;
+
+                {
+                    // Don't hold the lock while calling, the callback may wait for the guest
+                    const std::lock_guard<std::mutex> callback_guard(callback_lock_);
+                    callback = buffer_copied_callback_;
+                    userdata = buffer_copied_userdata_;
+                }
+
+                if (callback) {
+                    for (std::size_t i = 0; i < total_notify; i++) {
+                        callback(userdata);
+                    }
+                }
+
+                guard.lock();
+                continue;
+            }
+
+            if (marks_.empty() && pending_.empty() && (pointer_ >= decoded_.size())) {
+                // Nothing in flight, only new data can wake us up. Spare the audio callback from taking the lock.
+                wake_on_consume_.store(false, std::memory_order_relaxed);
+            }
+
+            // Otherwise wait for the audio callback to consume more. Nothing is consumed while the stream is paused,
+            // so this does not wake up until it plays again. The sequence only changes under the lock, which is held
+            // from the snapshot above until the wait, so no wake up can be missed in between.
+            worker_cond_.wait(guard, [&]() {
+                return worker_quit_ || (wake_seq_ != seq);
+            });
+        }
+
+        wake_on_consume_.store(false, std::memory_order_relaxed);
     }
 
     bool dsp_output_stream_shared::set_properties(const std::uint32_t freq, const std::uint8_t channels) {
         // Doc said: Writing to the stream must have stopped before you call this function.
-        if (buffers_.size() > 0) {
-            return false;
+        {
+            const std::lock_guard<std::mutex> guard(worker_lock_);
+
+            if (!pending_.empty() || !marks_.empty() || decoding_) {
+                return false;
+            }
         }
 
         if ((channels_ == channels) && (freq_ == freq)) {
@@ -64,6 +225,14 @@ namespace eka2l1::drivers {
         return true;
     }
 
+    bool dsp_output_stream_shared::format(const four_cc fmt) {
+        // Read by the decode worker
+        const std::lock_guard<std::mutex> guard(worker_lock_);
+        format_ = fmt;
+
+        return true;
+    }
+
     void dsp_output_stream_shared::volume(const std::uint32_t new_volume) {
         dsp_output_stream::volume(new_volume);
 
@@ -93,6 +262,24 @@ namespace eka2l1::drivers {
         if (!stream_)
             return true;
 
+        {
+            const std::lock_guard<std::mutex> guard(worker_lock_);
+
+            // Discard all buffers, including the ones being decoded and the ones already in the ring
+            pending_.clear();
+            marks_.clear();
+
+            pointer_ = decoded_.size();
+            generation_++;
+
+            flush_target_.store(ring_.write_position(), std::memory_order_release);
+            flush_requested_.store(true, std::memory_order_release);
+
+            wake_seq_++;
+        }
+
+        worker_cond_.notify_one();
+
         const std::lock_guard<std::mutex> guard(callback_lock_);
 
         // Call the finish callback
@@ -100,11 +287,6 @@ namespace eka2l1::drivers {
             complete_callback_(complete_userdata_);
 
         virtual_stop = true;
-
-        // Discard all buffers
-        while (auto buffer = buffers_.pop()) {
-        }
-
         return true;
     }
 
@@ -146,73 +328,67 @@ namespace eka2l1::drivers {
     }
 
     bool dsp_output_stream_shared::write(const std::uint8_t *data, const std::uint32_t data_size) {
-        // Copy buffer to queue
-        dsp_buffer buffer;
-        buffer.resize(data_size);
+        const std::lock_guard<std::mutex> guard(worker_lock_);
+
+        if ((format_ == PCM16_FOUR_CC_CODE) && pending_.empty() && !decoding_ && (pointer_ >= decoded_.size())
+            && (ring_.free_space() >= data_size)) {
+            // Nothing is queued before this, put it straight to the ring buffer
+            const std::size_t start = ring_.write_position();
+            ring_.push(data, data_size);
+
+            marks_.push_back({ start, start + data_size });
+        } else {
+            // Reuse a buffer instead of allocating a new one every write
+            dsp_buffer buffer;
+
+            if (!free_buffers_.empty()) {
+                buffer = std::move(free_buffers_.back());
+                free_buffers_.pop_back();
+            }
+
+            buffer.assign(data, data + data_size);
+            pending_.push_back(std::move(buffer));
+        }
 
-        std::memcpy(&buffer[0], data, data_size);
+        wake_seq_++;
 
-        // Push it to the queue
-        buffers_.push(buffer);
+        start_worker_no_lock();
+        worker_cond_.notify_one();
 
         return true;
     }
 
     std::size_t dsp_output_stream_shared::data_callback(std::int16_t *buffer, const std::size_t frame_count) {
-        std::size_t frame_wrote = 0;
+        // This runs on the real-time audio thread: no lock, no allocation.
+        if (flush_requested_.exchange(false, std::memory_order_acq_rel)) {
+            ring_.skip_to(flush_target_.load(std::memory_order_acquire));
+        }
 
-        while (frame_wrote < frame_count) {
-            std::optional<dsp_buffer> encoded;
+        const std::size_t frame_size = channels_ * sizeof(std::int16_t);
+        const std::size_t available_frames = ring_.size() / frame_size;
+        const std::size_t frame_wrote = std::min<std::size_t>(available_frames, frame_count);
 
-            if ((decoded_.size() == 0) || (decoded_.size() == pointer_)) {
-                // Get the next buffer
-                encoded = buffers_.pop();
+        if (frame_wrote != 0) {
+            ring_.pop(reinterpret_cast<std::uint8_t *>(buffer), frame_wrote * frame_size);
+            samples_played_ += frame_wrote * channels_;
+        }
 
-                if (!encoded) {
-                    break;
-                }
-                
-                pointer_ = 0;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
 
-                if (format_ == PCM16_FOUR_CC_CODE) {
-                    decoded_ = encoded.value();
-                } else {
-                    decode_data(encoded.value(), decoded_);
-                }
-                
-                // Callback that internal buffer has been copied
-                {
-                    std::size_t total_sample = (decoded_.size() / sizeof(std::uint16_t));
-                    samples_copied_ += total_sample;
-                    
-                    const std::lock_guard<std::mutex> guard(callback_lock_);
-                    if (buffer_copied_callback_) {
-                        buffer_copied_callback_(buffer_copied_userdata_);
-                    }
-                }
+        if (wake_on_consume_.load(std::memory_order_relaxed)) {
+            // Only asked for while the worker is idle or about to be, so the lock is short and almost never
+            // contended. Changing the sequence under it is what makes the wake up impossible to miss.
+            {
+                const std::lock_guard<std::mutex> guard(worker_lock_);
+                wake_on_consume_.store(false, std::memory_order_relaxed);
+                wake_seq_++;
             }
 
-            // We want to decode more
-            std::size_t frame_to_wrote = ((decoded_.size() - pointer_) / channels_ / sizeof(std::int16_t));
-            frame_to_wrote = std::min<std::size_t>(frame_to_wrote, frame_count - frame_wrote);
-
-            std::memcpy(&buffer[frame_wrote * channels_], &decoded_[pointer_], frame_to_wrote * channels_ * sizeof(std::int16_t));
-
-            // Set last frame
-            std::memcpy(last_frame_, &decoded_[pointer_ + (frame_to_wrote - 1) * channels_ * sizeof(std::int16_t)], channels_ * sizeof(std::int16_t));
-
-            pointer_ += frame_to_wrote * channels_ * sizeof(std::int16_t);
-            samples_played_ += frame_to_wrote * channels_;
-
-            frame_wrote += frame_to_wrote;
-        }
-
-        for (; frame_wrote < frame_count; frame_wrote++) {
-            // We dont want to drain the audio driver, so fill it with last frame
-            std::memcpy(&buffer[frame_wrote * channels_], last_frame_, channels_ * sizeof(std::int16_t));
+            worker_cond_.notify_one();
         }
 
-        return frame_count;
+        // Running dry is reported as an underrun by the mixer, which keeps the stream playing
+        return frame_wrote;
     }
 
     std::uint64_t dsp_output_stream_shared::position() {
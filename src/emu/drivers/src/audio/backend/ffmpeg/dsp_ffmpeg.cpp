@@ -38,11 +38,23 @@ namespace eka2l1::drivers {
     dsp_output_stream_ffmpeg::dsp_output_stream_ffmpeg(drivers::audio_driver *aud)
         : dsp_output_stream_shared(aud)
         , codec_(nullptr)
-        , timestamp_in_base_(0) {
+        , timestamp_in_base_(0)
+        , swr_(nullptr)
+        , swr_in_layout_(0)
+        , swr_in_format_(-1)
+        , swr_in_rate_(0)
+        , swr_out_rate_(0) {
         format(PCM16_FOUR_CC_CODE);
     }
 
     dsp_output_stream_ffmpeg::~dsp_output_stream_ffmpeg() {
+        // Decoding uses the codec context, stop it before freeing
+        stop_worker();
+
+        if (swr_) {
+            swr_free(&swr_);
+        }
+
         if (codec_) {
             avcodec_free_context(&codec_);
         }
@@ -69,6 +81,14 @@ namespace eka2l1::drivers {
             return false;
         }
 
+        if (codec_) {
+            avcodec_free_context(&codec_);
+        }
+
+        if (swr_) {
+            swr_free(&swr_);
+        }
+
         codec_ = avcodec_alloc_context3(decoder);
 
         if (!codec_) {
@@ -76,7 +96,39 @@ namespace eka2l1::drivers {
             return false;
         }
 
-        format_ = fmt;
+        return dsp_output_stream_shared::format(fmt);
+    }
+
+    bool dsp_output_stream_ffmpeg::prepare_resampler(AVFrame *frame) {
+        if (swr_ && (swr_in_layout_ == frame->channel_layout) && (swr_in_format_ == frame->format)
+            && (swr_in_rate_ == frame->sample_rate) && (swr_out_rate_ == freq_)) {
+            return true;
+        }
+
+        if (swr_) {
+            swr_free(&swr_);
+        }
+
+        swr_ = swr_alloc_set_opts(nullptr,
+            AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_S16, freq_,
+            frame->channel_layout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+            0, nullptr);
+
+        if (!swr_ || (swr_init(swr_) < 0)) {
+            LOG_ERROR(DRIVER_AUD, "Error initializing SWR context");
+
+            if (swr_) {
+                swr_free(&swr_);
+            }
+
+            return false;
+        }
+
+        swr_in_layout_ = frame->channel_layout;
+        swr_in_format_ = frame->format;
+        swr_in_rate_ = frame->sample_rate;
+        swr_out_rate_ = freq_;
+
         return true;
     }
 
@@ -95,35 +147,36 @@ namespace eka2l1::drivers {
                 return;
             }
 
-            dest.resize(2 * frame->nb_samples * sizeof(std::uint16_t));
             timestamp_in_base_ = frame->best_effort_timestamp;
 
             if ((channels_ != codec_->channels) || (frame->format != AV_SAMPLE_FMT_S16)) {
-                SwrContext *swr = swr_alloc_set_opts(nullptr,
-                    AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_S16, freq_,
-                    frame->channel_layout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
-                    0, nullptr);
-
-                if (swr_init(swr) < 0) {
-                    LOG_ERROR(DRIVER_AUD, "Error initializing SWR context");
+                if (!prepare_resampler(frame)) {
                     av_frame_free(&frame);
-
                     return;
                 }
 
+                // The context may hold samples from the previous frame
+                const int max_output = swr_get_out_samples(swr_, frame->nb_samples);
+                dest.resize(2 * common::max(max_output, frame->nb_samples) * sizeof(std::uint16_t));
+
                 std::uint8_t *output = &dest[0];
                 const std::uint8_t *source = frame->data[0];
 
-                const int result = swr_convert(swr, &output, frame->nb_samples, &source, frame->nb_samples);
-                swr_free(&swr);
+                const int result = swr_convert(swr_, &output, static_cast<int>(dest.size() / (2 * sizeof(std::uint16_t))),
+                    &source, frame->nb_samples);
 
                 if (result < 0) {
                     LOG_ERROR(DRIVER_AUD, "Error resample audio data!");
-                    return;
+                    dest.clear();
+                } else {
+                    dest.resize(2 * result * sizeof(std::uint16_t));
                 }
             } else {
+                dest.resize(2 * frame->nb_samples * sizeof(std::uint16_t));
                 std::memcpy(&dest[0], frame->data[0], dest.size());
             }
+
+            av_frame_free(&frame);
         }
     }
 }
\ No newline at end of file
@@ -144,7 +144,10 @@ namespace eka2l1::drivers {
 
         // Data drain, try to get more
         if (request_ff->flags_ & 1) {
-            output_stream_->stop();
+            if (output_stream_) {
+                output_stream_->stop();
+            }
+
             return;
         }
 
@@ -89,10 +89,16 @@ namespace eka2l1::drivers {
                 supply_stuff();
             }
 
-            // We are drained (out of frame)
-            // Call the finish callback
-            if (no_more_way && callback_) {
-                callback_(userdata_.data());
+            if (no_more_way) {
+                // We are drained (out of frame). The mixer keeps a short stream playing, so stop it ourselves.
+                if (output_stream_) {
+                    output_stream_->stop();
+                }
+
+                // Call the finish callback
+                if (callback_) {
+                    callback_(userdata_.data());
+                }
             }
         }
 
@@ -101,8 +107,15 @@ namespace eka2l1::drivers {
 
     bool player_shared::play() {
         // Stop previous session
-        if (output_stream_)
-            output_stream_->stop();
+        std::unique_ptr<audio_output_stream> previous_stream;
+
+        {
+            const std::lock_guard<std::mutex> guard(lock_);
+            previous_stream = std::move(output_stream_);
+        }
+
+        // Destroying a stream waits for its callback, which takes the lock. Do it without holding the lock.
+        previous_stream.reset();
 
         // Reset the request
         {
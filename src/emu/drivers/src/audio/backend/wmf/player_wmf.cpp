@@ -245,7 +245,10 @@ namespace eka2l1::drivers {
 
         // Data drain, try to get more
         if (request_wmf->flags_ & 1) {
-            output_stream_->stop();
+            if (output_stream_) {
+                output_stream_->stop();
+            }
+
             return;
         }
 
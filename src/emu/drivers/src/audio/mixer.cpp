@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/audio/audio.h>
+#include <drivers/audio/mixer.h>
+
+#include <common/algorithm.h>
+#include <common/log.h>
+#include <common/platform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if EKA2L1_ARCH(X64) || (EKA2L1_ARCH(X86) && defined(__SSE2__))
+#define MIXER_USE_SSE2 1
+#include <emmintrin.h>
+#elif EKA2L1_ARCH(ARM64) || defined(__ARM_NEON)
+#define MIXER_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace eka2l1::drivers {
+    static constexpr std::size_t SOURCE_BLOCK_FRAMES = 512;
+    static constexpr std::uint64_t FIXED_ONE = 1ULL << 32;
+    static constexpr std::uint32_t DEFAULT_HOST_RATE = 44100;
+
+    /**
+     * \brief Add samples multiplied by volume to the mix buffer.
+     */
+    static void accumulate_samples(float *dest, const std::int16_t *source, const std::size_t count, const float volume) {
+        std::size_t i = 0;
+
+#if MIXER_USE_SSE2
+        const __m128 vol = _mm_set1_ps(volume);
+
+        for (; i + 8 <= count; i += 8) {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+
+            // Sign extend to 32-bit
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+
+            _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(_mm_cvtepi32_ps(low), vol)));
+            _mm_storeu_ps(dest + i + 4, _mm_add_ps(_mm_loadu_ps(dest + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(high), vol)));
+        }
+#elif MIXER_USE_NEON
+        for (; i + 8 <= count; i += 8) {
+            const int16x8_t samples = vld1q_s16(source + i);
+
+            const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+            const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+
+            vst1q_f32(dest + i, vmlaq_n_f32(vld1q_f32(dest + i), low, volume));
+            vst1q_f32(dest + i + 4, vmlaq_n_f32(vld1q_f32(dest + i + 4), high, volume));
+        }
+#endif
+
+        for (; i < count; i++) {
+            dest[i] += static_cast<float>(source[i]) * volume;
+        }
+    }
+
+#if MIXER_USE_NEON
+    /**
+     * \brief Round to the nearest integer, like the SSE2 and scalar paths do.
+     * 
+     * vcvtq_s32_f32 truncates toward zero, which would bias quiet signals.
+     */
+    static inline int32x4_t round_to_int(const float32x4_t value) {
+#if EKA2L1_ARCH(ARM64)
+        return vcvtnq_s32_f32(value);
+#else
+        // No round to nearest conversion on ARMv7. Add half away from zero and truncate, only
+        // differs from the other paths on exact halves.
+        const uint32x4_t negative = vcltq_f32(value, vdupq_n_f32(0.0f));
+        const float32x4_t half = vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+
+        return vcvtq_s32_f32(vaddq_f32(value, half));
+#endif
+    }
+#endif
+
+    /**
+     * \brief Convert the mix buffer to signed 16-bit samples, with saturation.
+     */
+    static void output_samples(std::int16_t *dest, const float *source, const std::size_t count) {
+        std::size_t i = 0;
+
+#if MIXER_USE_SSE2
+        for (; i + 8 <= count; i += 8) {
+            const __m128i low = _mm_cvtps_epi32(_mm_loadu_ps(source + i));
+            const __m128i high = _mm_cvtps_epi32(_mm_loadu_ps(source + i + 4));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_packs_epi32(low, high));
+        }
+#elif MIXER_USE_NEON
+        for (; i + 8 <= count; i += 8) {
+            const int32x4_t low = round_to_int(vld1q_f32(source + i));
+            const int32x4_t high = round_to_int(vld1q_f32(source + i + 4));
+
+            vst1q_s16(dest + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+        }
+#endif
+
+        for (; i < count; i++) {
+            dest[i] = static_cast<std::int16_t>(common::clamp(-32768.0f, 32767.0f, std::nearbyint(source[i])));
+        }
+    }
+
+    audio_mixer_stream::audio_mixer_stream(audio_mixer *mixer, const std::uint32_t sample_rate, const std::uint8_t channels,
+        data_callback callback)
+        : mixer_(mixer)
+        , callback_(callback)
+        , sample_rate_(sample_rate)
+        , channels_(common::clamp<std::uint8_t>(1, 2, channels))
+        , volume_(1.0f)
+        , playing_(false)
+        , mixing_(false)
+        , reset_pending_(false)
+        , source_buffer_(SOURCE_BLOCK_FRAMES * 2)
+        , source_frames_(0)
+        , source_pos_(0)
+        , step_(FIXED_ONE)
+        , fraction_(FIXED_ONE)
+        , frames_mixed_(0)
+        , underruns_(0)
+        , buffered_frames_(0) {
+        previous_frame_[0] = previous_frame_[1] = 0;
+        current_frame_[0] = current_frame_[1] = 0;
+
+        if (mixer_->host_sample_rate() != 0) {
+            step_ = (static_cast<std::uint64_t>(sample_rate_) << 32) / mixer_->host_sample_rate();
+        }
+
+        mixer_->add_stream(this);
+    }
+
+    audio_mixer_stream::~audio_mixer_stream() {
+        mixer_->remove_stream(this);
+    }
+
+    bool audio_mixer_stream::start() {
+        if (playing_) {
+            return true;
+        }
+
+        // A pass started before the stop may still be rendering this stream. Let the mixing thread reset the
+        // resampler before it renders again, instead of touching its state from here.
+        reset_pending_.store(true, std::memory_order_relaxed);
+        playing_.store(true, std::memory_order_release);
+        return mixer_->start_host_stream();
+    }
+
+    bool audio_mixer_stream::stop() {
+        // Do not wait for the current pass here. The caller may hold a lock the callback is waiting on.
+        // The next pass will not pick the stream up.
+        playing_.store(false, std::memory_order_release);
+        return true;
+    }
+
+    bool audio_mixer_stream::is_playing() {
+        return playing_;
+    }
+
+    bool audio_mixer_stream::set_volume(const float volume) {
+        volume_ = volume;
+        return true;
+    }
+
+    audio_mixer_stream_stats audio_mixer_stream::stats() const {
+        audio_mixer_stream_stats result;
+        result.frames_mixed_ = frames_mixed_;
+        result.underruns_ = underruns_;
+
+        const std::uint32_t host_rate = mixer_->host_sample_rate();
+        const std::uint32_t host_latency = mixer_->host_stream_ ? mixer_->host_stream_->latency_frames() : 0;
+
+        result.latency_us_ = 0;
+
+        if (host_rate) {
+            result.latency_us_ = static_cast<std::uint32_t>((static_cast<std::uint64_t>(host_latency) * 1000000ULL) / host_rate);
+        }
+
+        if (sample_rate_) {
+            result.latency_us_ += static_cast<std::uint32_t>((static_cast<std::uint64_t>(buffered_frames_) * 1000000ULL) / sample_rate_);
+        }
+
+        return result;
+    }
+
+    bool audio_mixer_stream::fetch_source_frame() {
+        if (source_pos_ >= source_frames_) {
+            const std::size_t supplied = callback_(source_buffer_.data(), SOURCE_BLOCK_FRAMES);
+
+            source_frames_ = common::min(supplied, SOURCE_BLOCK_FRAMES);
+            source_pos_ = 0;
+
+            if (source_frames_ == 0) {
+                return false;
+            }
+        }
+
+        previous_frame_[0] = current_frame_[0];
+        previous_frame_[1] = current_frame_[1];
+
+        if (channels_ == 1) {
+            current_frame_[0] = current_frame_[1] = source_buffer_[source_pos_];
+        } else {
+            current_frame_[0] = source_buffer_[source_pos_ * 2];
+            current_frame_[1] = source_buffer_[source_pos_ * 2 + 1];
+        }
+
+        source_pos_++;
+        return true;
+    }
+
+    std::size_t audio_mixer_stream::render(std::int16_t *dest, const std::size_t frames, const std::uint32_t host_rate) {
+        if (reset_pending_.exchange(false, std::memory_order_acquire)) {
+            source_frames_ = 0;
+            source_pos_ = 0;
+            fraction_ = FIXED_ONE;
+
+            previous_frame_[0] = previous_frame_[1] = 0;
+            current_frame_[0] = current_frame_[1] = 0;
+        }
+
+        if ((step_ == FIXED_ONE) && (channels_ == 2)) {
+            // Same format as the host, let the callback write directly
+            const std::size_t supplied = common::min(callback_(dest, frames), frames);
+
+            if ((supplied < frames) && playing_.load(std::memory_order_acquire)) {
+                underruns_++;
+            }
+
+            return supplied;
+        }
+
+        std::size_t i = 0;
+
+        for (; i < frames; i++) {
+            bool has_frame = true;
+
+            while (fraction_ >= FIXED_ONE) {
+                if (!fetch_source_frame()) {
+                    has_frame = false;
+                    break;
+                }
+
+                fraction_ -= FIXED_ONE;
+            }
+
+            if (!has_frame) {
+                // A stream that stopped itself from the callback has ended, it did not run dry
+                if (playing_.load(std::memory_order_acquire)) {
+                    underruns_++;
+                }
+
+                break;
+            }
+
+            // Linear interpolation between the last two source frames
+            const std::int32_t weight = static_cast<std::int32_t>(fraction_ >> 17);
+
+            for (std::size_t c = 0; c < 2; c++) {
+                const std::int32_t delta = static_cast<std::int32_t>(current_frame_[c]) - previous_frame_[c];
+                dest[i * 2 + c] = static_cast<std::int16_t>(previous_frame_[c] + ((delta * weight) >> 15));
+            }
+
+            fraction_ += step_;
+        }
+
+        buffered_frames_ = static_cast<std::uint32_t>(source_frames_ - source_pos_);
+        return i;
+    }
+
+    audio_mixer::audio_mixer(audio_driver *driver)
+        : driver_(driver)
+        , host_rate_(0)
+        , snapshot_count_(0)
+        , mix_buffer_(MAX_MIX_FRAMES * 2)
+        , scratch_(MAX_MIX_FRAMES * 2)
+        , skipped_passes_(0) {
+        snapshot_.fill(nullptr);
+    }
+
+    audio_mixer::~audio_mixer() {
+        const std::lock_guard<std::mutex> guard(host_lock_);
+
+        if (host_stream_) {
+            host_stream_->stop();
+            host_stream_.reset();
+        }
+    }
+
+    std::unique_ptr<audio_output_stream> audio_mixer::new_stream(const std::uint32_t sample_rate, const std::uint8_t channels,
+        data_callback callback) {
+        if (!host_rate_) {
+            const std::lock_guard<std::mutex> guard(host_lock_);
+
+            if (!host_rate_) {
+                host_rate_ = driver_->native_sample_rate();
+
+                if (!host_rate_) {
+                    host_rate_ = DEFAULT_HOST_RATE;
+                }
+            }
+        }
+
+        return std::make_unique<audio_mixer_stream>(this, sample_rate, channels, callback);
+    }
+
+    void audio_mixer::add_stream(audio_mixer_stream *stream) {
+        const std::lock_guard<std::mutex> guard(streams_lock_);
+        streams_.push_back(stream);
+
+        if (streams_.size() > MAX_STREAMS) {
+            LOG_WARN(DRIVER_AUD, "{} audio streams are open, only {} of them can play at the same time", streams_.size(),
+                MAX_STREAMS);
+        }
+    }
+
+    void audio_mixer::remove_stream(audio_mixer_stream *stream) {
+        bool last_stream = false;
+
+        {
+            const std::lock_guard<std::mutex> guard(streams_lock_);
+            streams_.erase(std::remove(streams_.begin(), streams_.end(), stream), streams_.end());
+
+            last_stream = streams_.empty();
+        }
+
+        // No new pass can pick the stream up now. Wait for the current one to be done with it.
+        while (stream->mixing_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+
+        if (last_stream) {
+            // Nothing left to mix, do not keep the host device running on silence. Restarted by the next stream
+            // that starts playing.
+            const std::lock_guard<std::mutex> guard(host_lock_);
+
+            if (host_stream_) {
+                host_stream_->stop();
+            }
+        }
+    }
+
+    std::vector<audio_mixer_stream_stats> audio_mixer::stream_stats() {
+        const std::lock_guard<std::mutex> guard(streams_lock_);
+        std::vector<audio_mixer_stream_stats> result;
+
+        for (audio_mixer_stream *stream : streams_) {
+            result.push_back(stream->stats());
+        }
+
+        return result;
+    }
+
+    bool audio_mixer::start_host_stream() {
+        const std::lock_guard<std::mutex> guard(host_lock_);
+
+        if (!host_stream_) {
+            host_stream_ = driver_->new_host_output_stream(host_rate_, 2, [this](std::int16_t *output, const std::size_t frames) {
+                return mix(output, frames);
+            });
+
+            if (!host_stream_) {
+                LOG_ERROR(DRIVER_AUD, "Unable to create host stream for the audio mixer!");
+                return false;
+            }
+        }
+
+        return host_stream_->start();
+    }
+
+    std::size_t audio_mixer::mix(std::int16_t *output, const std::size_t frames) {
+        {
+            std::unique_lock<std::mutex> guard(streams_lock_, std::try_to_lock);
+
+            if (!guard.owns_lock()) {
+                // A stream is being added or removed, do not wait for that on the audio thread
+                skipped_passes_++;
+                std::fill(output, output + frames * 2, static_cast<std::int16_t>(0));
+
+                return frames;
+            }
+
+            snapshot_count_ = 0;
+
+            for (audio_mixer_stream *stream : streams_) {
+                if (snapshot_count_ == MAX_STREAMS) {
+                    break;
+                }
+
+                if (stream->playing_.load(std::memory_order_acquire)) {
+                    stream->mixing_.store(true, std::memory_order_release);
+                    snapshot_[snapshot_count_++] = stream;
+                }
+            }
+        }
+
+        // Stream callbacks are called without the lock held, they may take locks of their own
+        std::size_t done = 0;
+
+        while (done < frames) {
+            const std::size_t chunk = common::min(frames - done, MAX_MIX_FRAMES);
+            std::fill(mix_buffer_.begin(), mix_buffer_.begin() + chunk * 2, 0.0f);
+
+            for (std::size_t i = 0; i < snapshot_count_; i++) {
+                audio_mixer_stream *stream = snapshot_[i];
+
+                if (!stream->playing_.load(std::memory_order_acquire)) {
+                    continue;
+                }
+
+                const std::size_t rendered = stream->render(scratch_.data(), chunk, host_rate_);
+
+                if (rendered) {
+                    accumulate_samples(mix_buffer_.data(), scratch_.data(), rendered * 2, stream->volume_.load());
+                    stream->frames_mixed_ += rendered;
+                }
+            }
+
+            output_samples(output + done * 2, mix_buffer_.data(), chunk * 2);
+            done += chunk;
+        }
+
+        for (std::size_t i = 0; i < snapshot_count_; i++) {
+            snapshot_[i]->mixing_.store(false, std::memory_order_release);
+        }
+
+        return frames;
+    }
+}
@@ -168,6 +168,48 @@ namespace eka2l1::drivers {
     shared_graphics_driver::~shared_graphics_driver() {
     }
 
+    bool is_render_state_command(const std::uint16_t opcode) {
+        switch (opcode) {
+        case graphics_driver_clip_rect:
+        case graphics_driver_set_clipping:
+        case graphics_driver_set_viewport:
+        case graphics_driver_set_blend:
+        case graphics_driver_set_depth:
+        case graphics_driver_set_stencil:
+        case graphics_driver_set_cull:
+        case graphics_driver_blend_formula:
+        case graphics_driver_stencil_pass_condition:
+        case graphics_driver_stencil_set_action:
+        case graphics_driver_stencil_set_mask:
+        case graphics_driver_set_back_face_rule:
+        case graphics_driver_bind_bitmap:
+        case graphics_driver_use_program:
+        case graphics_driver_bind_texture:
+        case graphics_driver_bind_buffer:
+        case graphics_driver_set_texture_filter:
+        case graphics_driver_set_state:
+        case graphics_driver_restore_state:
+            return true;
+
+        default:
+            break;
+        }
+
+        return false;
+    }
+
+    void shared_graphics_driver::finish_frame_stats() {
+        const std::lock_guard<std::mutex> guard(stats_lock);
+
+        last_frame_stats = frame_stats;
+        frame_stats = graphics_driver_stats{};
+    }
+
+    graphics_driver_stats shared_graphics_driver::get_last_frame_stats() const {
+        const std::lock_guard<std::mutex> guard(stats_lock);
+        return last_frame_stats;
+    }
+
 #define HANDLE_BITMAP (1ULL << 32)
 
     bitmap *shared_graphics_driver::get_bitmap(const drivers::handle h) {
@@ -20,6 +20,9 @@
 #include <common/algorithm.h>
 #include <common/log.h>
 #include <common/platform.h>
+
+#include <algorithm>
+#include <cstddef>
 #include <fstream>
 #include <sstream>
 
@@ -32,6 +35,10 @@
 namespace eka2l1::drivers {
     ogl_graphics_driver::ogl_graphics_driver()
         : shared_graphics_driver(graphic_api::opengl)
+        , batch_vao(0)
+        , batch_vbo(0)
+        , batch_ibo(0)
+        , batch_buffer_offset(0)
         , should_stop(false)
         , is_gles(false) {
         init_graphics_library(eka2l1::drivers::graphic_api::opengl);
@@ -82,6 +89,8 @@ namespace eka2l1::drivers {
     static constexpr const char *fill_v_path = "resources//fill.vert";
     static constexpr const char *fill_f_path = "resources//fill.frag";
 
+    static constexpr std::size_t BATCH_BUFFER_SIZE = 4 * sprite_batch::MAX_SPRITES * sizeof(sprite_vertex) * 4;
+
     void ogl_graphics_driver::do_init() {
         sprite_program = std::make_unique<ogl_shader>(sprite_norm_v_path, sprite_norm_f_path);
         mask_program = std::make_unique<ogl_shader>(sprite_norm_v_path, sprite_mask_f_path);
@@ -117,6 +126,32 @@ namespace eka2l1::drivers {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
+        // Make the sprite batch streaming buffer. Attribute pointers are set on each flush, since the data
+        // offset moves along the buffer.
+        glGenVertexArrays(1, &batch_vao);
+        glGenBuffers(1, &batch_vbo);
+        glBindVertexArray(batch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+        glBufferData(GL_ARRAY_BUFFER, BATCH_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+
+        batch_buffer_offset = 0;
+
+        std::vector<GLushort> batch_indices(sprite_batch::MAX_SPRITES * 6);
+
+        for (std::size_t i = 0; i < sprite_batch::MAX_SPRITES; i++) {
+            for (std::size_t j = 0; j < 6; j++) {
+                batch_indices[i * 6 + j] = static_cast<GLushort>(i * 4 + indices[j]);
+            }
+        }
+
+        glGenBuffers(1, &batch_ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch_ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, batch_indices.size() * sizeof(GLushort), batch_indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
         color_loc = sprite_program->get_uniform_location("u_color").value_or(-1);
         proj_loc = sprite_program->get_uniform_location("u_proj").value_or(-1);
         model_loc = sprite_program->get_uniform_location("u_model").value_or(-1);
@@ -183,6 +218,70 @@ namespace eka2l1::drivers {
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
 
         glBindVertexArray(0);
+
+        frame_stats.draw_calls++;
+    }
+
+    void ogl_graphics_driver::queue_sprite(bitmap *bmp, eka2l1::rect dest_rect, eka2l1::rect source_rect, const GLfloat *color, const GLfloat flip) {
+        const std::uint64_t texture = bmp->tex->texture_handle();
+
+        if (!sprites.empty()) {
+            if (sprites.can_join(texture, color, flip)) {
+                frame_stats.batched_bitmap_draws++;
+            } else {
+                flush_sprite_batch();
+            }
+        }
+
+        sprites.push(texture, bmp->tex->get_size(), dest_rect, source_rect, color, flip);
+    }
+
+    void ogl_graphics_driver::flush_sprite_batch() {
+        if (sprites.empty()) {
+            return;
+        }
+
+        sprite_program->use(this);
+
+        const glm::mat4 model_matrix = glm::identity<glm::mat4>();
+
+        glUniformMatrix4fv(model_loc, 1, false, glm::value_ptr(model_matrix));
+        glUniformMatrix4fv(proj_loc, 1, false, glm::value_ptr(projection_matrix));
+        glUniform4fv(color_loc, 1, sprites.color());
+        glUniform1f(flip_loc, sprites.flip());
+
+        const std::size_t data_size = sprites.vertices().size() * sizeof(sprite_vertex);
+
+        glBindVertexArray(batch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+
+        if (batch_buffer_offset + data_size > BATCH_BUFFER_SIZE) {
+            // Orphan the storage, so the driver does not have to wait for draws still reading it
+            glBufferData(GL_ARRAY_BUFFER, BATCH_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+            batch_buffer_offset = 0;
+        }
+
+        glBufferSubData(GL_ARRAY_BUFFER, batch_buffer_offset, data_size, sprites.vertices().data());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(sprite_vertex), reinterpret_cast<GLvoid *>(batch_buffer_offset));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(sprite_vertex),
+            reinterpret_cast<GLvoid *>(batch_buffer_offset + offsetof(sprite_vertex, coord)));
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(sprites.texture()));
+
+        // See draw_bitmap
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch_ibo);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sprites.sprite_count() * 6), GL_UNSIGNED_SHORT, 0);
+
+        glBindVertexArray(0);
+
+        batch_buffer_offset += data_size;
+        sprites.clear();
+
+        frame_stats.draw_calls++;
     }
 
     void ogl_graphics_driver::draw_bitmap(command_helper &helper) {
@@ -234,6 +333,21 @@ namespace eka2l1::drivers {
         float rotation = 0.0f;
         helper.pop(rotation);
 
+        std::uint32_t flags = 0;
+        helper.pop(flags);
+
+        static const GLfloat white_color[] = { 255.0f, 255.0f, 255.0f, 255.0f };
+
+        const GLfloat *color = (flags & bitmap_draw_flag_use_brush) ? brush_color.elements.data() : white_color;
+        const GLfloat flip = (flags & bitmap_draw_flag_no_flip) ? 1.0f : -1.0f;
+
+        frame_stats.bitmap_draws++;
+
+        if (!mask_bmp && (rotation == 0.0f)) {
+            queue_sprite(bmp, dest_rect, source_rect, color, flip);
+            return;
+        }
+
         struct sprite_vertex {
             float top[2];
             float coord[2];
@@ -352,18 +466,8 @@ namespace eka2l1::drivers {
         glUniformMatrix4fv((mask_bmp ? proj_loc_mask : proj_loc), 1, false, glm::value_ptr(projection_matrix));
 
         // Supply brush
-        std::uint32_t flags = 0;
-        helper.pop(flags);
-
-        const GLfloat color[] = { 255.0f, 255.0f, 255.0f, 255.0f };
-
-        if (flags & bitmap_draw_flag_use_brush) {
-            glUniform4fv((mask_bmp ? color_loc_mask : color_loc), 1, brush_color.elements.data());
-        } else {
-            glUniform4fv((mask_bmp ? color_loc_mask : color_loc), 1, color);
-        }
-
-        glUniform1f((mask_bmp ? flip_loc_mask : flip_loc), (flags & bitmap_draw_flag_no_flip) ? 1.0f : -1.0f);
+        glUniform4fv((mask_bmp ? color_loc_mask : color_loc), 1, color);
+        glUniform1f((mask_bmp ? flip_loc_mask : flip_loc), flip);
 
         if (mask_bmp) {
             glUniform1f(invert_loc_mask, (flags & bitmap_draw_flag_invert_mask) ? 1.0f : 0.0f);
@@ -374,6 +478,8 @@ namespace eka2l1::drivers {
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
 
         glBindVertexArray(0);
+
+        frame_stats.draw_calls++;
     }
 
     void ogl_graphics_driver::set_clipping(command_helper &helper) {
@@ -427,6 +533,8 @@ namespace eka2l1::drivers {
         } else {
             glDrawElementsBaseVertex(prim_mode_to_gl_enum(prim_mode), count, data_format_to_gl_enum(val_type), reinterpret_cast<GLvoid *>(index_off_64), vert_off);
         }
+
+        frame_stats.draw_calls++;
     }
 
     void ogl_graphics_driver::set_viewport(const eka2l1::rect &viewport) {
@@ -777,6 +885,7 @@ namespace eka2l1::drivers {
     }
 
     void ogl_graphics_driver::display(command_helper &helper) {
+        finish_frame_stats();
         disp_hook_();
         helper.finish(this, 0);
     }
@@ -784,6 +893,15 @@ namespace eka2l1::drivers {
     void ogl_graphics_driver::dispatch(command *cmd) {
         command_helper helper(cmd);
 
+        // Brush color is captured by each queued sprite. Anything else may change what the batch draws, or where.
+        if ((cmd->opcode_ != graphics_driver_draw_bitmap) && (cmd->opcode_ != graphics_driver_set_brush_color)) {
+            flush_sprite_batch();
+        }
+
+        if (is_render_state_command(cmd->opcode_)) {
+            frame_stats.state_changes++;
+        }
+
         switch (cmd->opcode_) {
         case graphics_driver_draw_bitmap: {
             draw_bitmap(helper);
@@ -898,6 +1016,9 @@ namespace eka2l1::drivers {
                 delete cmd;
                 cmd = next;
             }
+
+            // Don't hold sprites back until another list arrives
+            flush_sprite_batch();
         }
     }
 
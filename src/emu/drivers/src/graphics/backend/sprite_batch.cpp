@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/sprite_batch.h>
+
+#include <algorithm>
+
+namespace eka2l1::drivers {
+    sprite_batch::sprite_batch()
+        : texture_(0)
+        , color_{ 0.0f, 0.0f, 0.0f, 0.0f }
+        , flip_(0.0f) {
+        vertices_.reserve(MAX_SPRITES * 4);
+    }
+
+    bool sprite_batch::can_join(const std::uint64_t texture, const float *color, const float flip) const {
+        if (empty() || (sprite_count() >= MAX_SPRITES)) {
+            return false;
+        }
+
+        return (texture_ == texture) && (flip_ == flip) && std::equal(color, color + 4, color_);
+    }
+
+    void sprite_batch::push(const std::uint64_t texture, const eka2l1::vec2 &tex_size, eka2l1::rect dest_rect,
+        eka2l1::rect source_rect, const float *color, const float flip) {
+        if (empty()) {
+            texture_ = texture;
+            flip_ = flip;
+            std::copy(color, color + 4, color_);
+        }
+
+        float coord_left = 0.0f;
+        float coord_top = 0.0f;
+        float coord_right = 1.0f;
+        float coord_bottom = 1.0f;
+
+        if (!source_rect.empty()) {
+            const float texel_width = 1.0f / tex_size.x;
+            const float texel_height = 1.0f / tex_size.y;
+
+            coord_left = source_rect.top.x * texel_width;
+            coord_top = source_rect.top.y * texel_height;
+            coord_right = (source_rect.top.x + source_rect.size.x) * texel_width;
+            coord_bottom = (source_rect.top.y + source_rect.size.y) * texel_height;
+        }
+
+        if (source_rect.size.x == 0) {
+            source_rect.size.x = tex_size.x;
+        }
+
+        if (source_rect.size.y == 0) {
+            source_rect.size.y = tex_size.y;
+        }
+
+        if (dest_rect.size.x == 0) {
+            dest_rect.size.x = source_rect.size.x;
+        }
+
+        if (dest_rect.size.y == 0) {
+            dest_rect.size.y = source_rect.size.y;
+        }
+
+        // Positions are already in pixels, so the whole batch shares an identity model matrix
+        const float left = static_cast<float>(dest_rect.top.x);
+        const float top = static_cast<float>(dest_rect.top.y);
+        const float right = static_cast<float>(dest_rect.top.x + dest_rect.size.x);
+        const float bottom = static_cast<float>(dest_rect.top.y + dest_rect.size.y);
+
+        vertices_.push_back({ { left, bottom }, { coord_left, coord_bottom } });
+        vertices_.push_back({ { right, top }, { coord_right, coord_top } });
+        vertices_.push_back({ { left, top }, { coord_left, coord_top } });
+        vertices_.push_back({ { right, bottom }, { coord_right, coord_bottom } });
+    }
+}
@@ -31,6 +31,7 @@
 #endif
 
 #include <common/types.h>
+#include <gdbstub/transport.h>
 
 namespace eka2l1 {
     class kernel_system;
@@ -96,6 +97,7 @@ namespace eka2l1 {
 
     class gdbstub {
         int gdbserver_socket = -1;
+        gdb_transport transport_;
 
         std::uint8_t command_buffer[GDB_BUFFER_SIZE];
         std::uint32_t command_length;
@@ -116,10 +118,6 @@ namespace eka2l1 {
         bool step_loop = false;
         bool send_trap = false;
 
-        // If set to false, the server will never be started and no
-        // gdbstub-related functions will be executed.
-        std::atomic<bool> server_enabled;
-
 #ifdef _WIN32
         WSADATA InitData;
 #endif
@@ -131,11 +129,11 @@ namespace eka2l1 {
         io_system *io;
 
     protected:
-        bool is_data_available();
-
-        std::uint8_t read_byte();
+        // If set to false, the server will never be started and no
+        // gdbstub-related functions will be executed.
+        std::atomic<bool> server_enabled;
 
-        void read_command();
+        bool read_command();
         void read_register();
         void read_registers();
         void read_memory();
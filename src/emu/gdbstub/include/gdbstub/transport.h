@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/ringbuf.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace eka2l1 {
+    /**
+     * \brief Socket side of the GDB stub.
+     *
+     * A reader thread blocks on the client socket, validates incoming packets, acknowledges them and
+     * hands their payload to the emulator thread through a lock-free queue. The emulator thread only
+     * polls that queue, so an idle debugger costs an atomic load per time slice instead of a syscall.
+     */
+    class gdb_transport {
+        static constexpr std::size_t QUEUE_CAPACITY = 64 * 1024;
+
+        int socket_;
+        std::thread reader_;
+
+        common::ring_buffer<std::uint8_t> packets_;
+        std::mutex send_lock_;
+
+        std::atomic<bool> alive_;
+        std::atomic<bool> break_requested_;
+
+        void reader_loop();
+        void queue_packet(const std::uint8_t *payload, const std::uint32_t size);
+
+    public:
+        explicit gdb_transport();
+        ~gdb_transport();
+
+        /**
+         * \brief Start reading packets from a connected client socket.
+         */
+        void start(const int socket);
+
+        /**
+         * \brief Shut the socket down and wait for the reader thread to exit.
+         */
+        void stop();
+
+        /**
+         * \brief Check if the connection is still usable.
+         */
+        bool is_alive() const;
+
+        /**
+         * \brief Check and clear the break request (Ctrl-C) sent by the client.
+         */
+        bool take_break_request();
+
+        /**
+         * \brief Pop the payload of the next validated packet.
+         *
+         * \param dest     Buffer to copy the payload to. Payloads longer than max_size are truncated.
+         * \param max_size Size of the destination buffer.
+         * \param size     Size of the payload copied.
+         *
+         * \returns False if no packet is pending.
+         */
+        bool pop_packet(std::uint8_t *dest, const std::uint32_t max_size, std::uint32_t &size);
+
+        /**
+         * \brief Send raw data to the client.
+         * \returns False on socket failure.
+         */
+        bool send(const std::uint8_t *data, std::size_t size);
+    };
+}
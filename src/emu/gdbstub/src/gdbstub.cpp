@@ -273,19 +273,6 @@ namespace eka2l1 {
         return output;
     }
 
-    /// Read a byte from the gdb client.
-    std::uint8_t gdbstub::read_byte() {
-        std::uint8_t c;
-        std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char *>(&c), 1, MSG_WAITALL);
-
-        if (received_size != 1) {
-            LOG_ERROR(GDBSTUB, "recv failed : {}", received_size);
-            this->shutdown_gdb();
-        }
-
-        return c;
-    }
-
     /// Calculate the checksum of the current command buffer.
     static std::uint8_t calculate_checksum(const std::uint8_t *buffer, std::size_t length) {
         return static_cast<std::uint8_t>(std::accumulate(buffer, buffer + length, 0, std::plus<std::uint8_t>()));
@@ -401,8 +388,7 @@ namespace eka2l1 {
      * @param packet Packet to be sent to client.
      */
     void gdbstub::send_packet(const char packet) {
-        std::size_t sent_size = send(gdbserver_socket, &packet, 1, 0);
-        if (sent_size != 1) {
+        if (!transport_.send(reinterpret_cast<const std::uint8_t *>(&packet), 1)) {
             LOG_ERROR(GDBSTUB, "send failed");
         }
     }
@@ -433,17 +419,9 @@ namespace eka2l1 {
         command_buffer[command_length + 2] = nibble_to_hex(checksum >> 4);
         command_buffer[command_length + 3] = nibble_to_hex(checksum);
 
-        std::uint8_t *ptr = command_buffer;
-        std::uint32_t left = command_length + 4;
-        while (left > 0) {
-            int sent_size = send(gdbserver_socket, reinterpret_cast<char *>(ptr), left, 0);
-            if (sent_size < 0) {
-                LOG_ERROR(GDBSTUB, "gdb: send failed");
-                return shutdown_gdb();
-            }
-
-            left -= sent_size;
-            ptr += sent_size;
+        if (!transport_.send(command_buffer, command_length + 4)) {
+            LOG_ERROR(GDBSTUB, "gdb: send failed");
+            return shutdown_gdb();
         }
     }
 
@@ -764,74 +742,16 @@ namespace eka2l1 {
         send_reply(buffer.c_str());
     }
 
-    /// Read command from gdb client.
-    void gdbstub::read_command() {
+    /// Take the next command received from gdb client. Validation and acknowledgement are done by the transport.
+    bool gdbstub::read_command() {
         command_length = 0;
         memset(command_buffer, 0, sizeof(command_buffer));
 
-        std::uint8_t c = read_byte();
-        if (c == '+') {
-            // ignore ack
-            return;
-        } else if (c == 0x03) {
-            LOG_INFO(GDBSTUB, "gdb: found break command");
-            halt_loop = true;
-            send_signal(current_thread, SIGTRAP);
-            return;
-        } else if (c != GDB_STUB_START) {
-            LOG_DEBUG(GDBSTUB, "gdb: read invalid byte {:02x}", c);
-            return;
-        }
-
-        while ((c = read_byte()) != GDB_STUB_END) {
-            if (command_length >= sizeof(command_buffer)) {
-                LOG_ERROR(GDBSTUB, "gdb: command_buffer overflow");
-                send_packet(GDB_STUB_NACK);
-                return;
-            }
-            command_buffer[command_length++] = c;
-        }
-
-        std::uint8_t checksum_received = hex_char_to_value(read_byte()) << 4;
-        checksum_received |= hex_char_to_value(read_byte());
-
-        std::uint8_t checksum_calculated = calculate_checksum(command_buffer, command_length);
-
-        if (checksum_received != checksum_calculated) {
-            LOG_ERROR(GDBSTUB, 
-                "gdb: invalid checksum: calculated {:02x} and read {:02x} for ${}# (length: {})",
-                checksum_calculated, checksum_received, command_buffer, command_length);
-
-            command_length = 0;
-
-            send_packet(GDB_STUB_NACK);
-            return;
-        }
-
-        send_packet(GDB_STUB_ACK);
-    }
-
-    /// Check if there is data to be read from the gdb client.
-    bool gdbstub::is_data_available() {
-        if (!is_connected()) {
+        if (!transport_.pop_packet(command_buffer, sizeof(command_buffer) - 1, command_length)) {
             return false;
         }
 
-        fd_set fd_socket;
-
-        FD_ZERO(&fd_socket);
-        FD_SET(gdbserver_socket, &fd_socket);
-
-        struct timeval t;
-        t.tv_sec = 0;
-        t.tv_usec = 0;
-
-        if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
-            LOG_ERROR(GDBSTUB, "select failed");
-            return false;
-        }
-
-        return FD_ISSET(gdbserver_socket, &fd_socket) != 0;
+        return command_length != 0;
     }
 
     /// Send requested register to gdb client.
@@ -1183,12 +1103,19 @@ namespace eka2l1 {
             return;
         }
 
-        if (!is_data_available()) {
+        if (!transport_.is_alive()) {
+            LOG_ERROR(GDBSTUB, "gdb: connection to client lost");
+            shutdown_gdb();
             return;
         }
 
-        read_command();
-        if (command_length == 0) {
+        if (transport_.take_break_request()) {
+            LOG_INFO(GDBSTUB, "gdb: found break command");
+            halt_loop = true;
+            send_signal(current_thread, SIGTRAP);
+        }
+
+        if (!read_command()) {
             return;
         }
 
@@ -1354,6 +1281,8 @@ namespace eka2l1 {
         } else {
             LOG_INFO(GDBSTUB, "Client connected.");
             saddr_client.sin_addr.s_addr = ntohl(saddr_client.sin_addr.s_addr);
+
+            transport_.start(gdbserver_socket);
         }
 
         // Clean up temporary socket if it's still alive at this point.
@@ -1401,7 +1330,7 @@ namespace eka2l1 {
 
         LOG_INFO(GDBSTUB, "Stopping GDB ...");
         if (gdbserver_socket != -1) {
-            shutdown(gdbserver_socket, SHUT_RDWR);
+            transport_.stop();
             gdbserver_socket = -1;
         }
 
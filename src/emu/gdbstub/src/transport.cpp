@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gdbstub/gdbstub.h>
+#include <gdbstub/transport.h>
+
+#include <common/log.h>
+#include <common/thread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace eka2l1 {
+    static std::uint8_t transport_hex_value(const std::uint8_t hex) {
+        if (hex >= '0' && hex <= '9') {
+            return hex - '0';
+        }
+
+        if (hex >= 'a' && hex <= 'f') {
+            return hex - 'a' + 0xA;
+        }
+
+        if (hex >= 'A' && hex <= 'F') {
+            return hex - 'A' + 0xA;
+        }
+
+        return 0;
+    }
+
+    gdb_transport::gdb_transport()
+        : socket_(-1)
+        , packets_(QUEUE_CAPACITY)
+        , alive_(false)
+        , break_requested_(false) {
+    }
+
+    gdb_transport::~gdb_transport() {
+        stop();
+    }
+
+    void gdb_transport::start(const int socket) {
+        stop();
+
+        socket_ = socket;
+        alive_ = true;
+        break_requested_ = false;
+
+        // Drop whatever the previous connection left behind
+        std::uint8_t leftover[256];
+        while (packets_.pop(leftover, sizeof(leftover)) != 0) {
+        }
+
+        reader_ = std::thread([this]() {
+            common::set_thread_name("GDB stub reader thread");
+            reader_loop();
+        });
+    }
+
+    void gdb_transport::stop() {
+        if (socket_ != -1) {
+            alive_ = false;
+            shutdown(socket_, SHUT_RDWR);
+        }
+
+        if (reader_.joinable()) {
+            reader_.join();
+        }
+
+        socket_ = -1;
+    }
+
+    bool gdb_transport::is_alive() const {
+        return alive_.load(std::memory_order_acquire);
+    }
+
+    bool gdb_transport::take_break_request() {
+        if (!break_requested_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        return break_requested_.exchange(false, std::memory_order_acq_rel);
+    }
+
+    bool gdb_transport::pop_packet(std::uint8_t *dest, const std::uint32_t max_size, std::uint32_t &size) {
+        // The size and the payload are published together, so a full header means a full packet
+        if (packets_.size() < sizeof(std::uint32_t)) {
+            return false;
+        }
+
+        std::uint32_t packet_size = 0;
+        packets_.pop(reinterpret_cast<std::uint8_t *>(&packet_size), sizeof(std::uint32_t));
+
+        size = std::min(packet_size, max_size);
+        packets_.pop(dest, size);
+
+        if (packet_size > size) {
+            packets_.skip_to(packets_.read_position() + (packet_size - size));
+        }
+
+        return true;
+    }
+
+    bool gdb_transport::send(const std::uint8_t *data, std::size_t size) {
+        const std::lock_guard<std::mutex> guard(send_lock_);
+
+        while (size > 0) {
+            const int sent_size = ::send(socket_, reinterpret_cast<const char *>(data), static_cast<int>(size), 0);
+            if (sent_size <= 0) {
+                return false;
+            }
+
+            size -= sent_size;
+            data += sent_size;
+        }
+
+        return true;
+    }
+
+    void gdb_transport::queue_packet(const std::uint8_t *payload, const std::uint32_t size) {
+        std::vector<std::uint8_t> entry(sizeof(std::uint32_t) + size);
+        std::memcpy(entry.data(), &size, sizeof(std::uint32_t));
+        std::memcpy(entry.data() + sizeof(std::uint32_t), payload, size);
+
+        // The emulator thread may be busy running guest code, wait for it to catch up
+        while (alive_ && (packets_.free_space() < entry.size())) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        packets_.push(entry.data(), entry.size());
+    }
+
+    void gdb_transport::reader_loop() {
+        enum class parse_state {
+            idle,
+            payload,
+            checksum_high,
+            checksum_low
+        };
+
+        parse_state state = parse_state::idle;
+
+        std::vector<std::uint8_t> payload;
+        payload.reserve(GDB_BUFFER_SIZE);
+
+        std::uint8_t checksum_calculated = 0;
+        std::uint8_t checksum_received = 0;
+
+        std::uint8_t buffer[4096];
+
+        while (alive_) {
+            const int received = recv(socket_, reinterpret_cast<char *>(buffer), sizeof(buffer), 0);
+
+            if (received <= 0) {
+                if (alive_ && (received < 0)) {
+                    LOG_ERROR(GDBSTUB, "recv failed : {}", received);
+                } else if (alive_) {
+                    LOG_INFO(GDBSTUB, "gdb: client disconnected");
+                }
+
+                break;
+            }
+
+            for (int i = 0; i < received; i++) {
+                const std::uint8_t c = buffer[i];
+
+                switch (state) {
+                case parse_state::idle:
+                    if (c == GDB_STUB_START) {
+                        payload.clear();
+                        checksum_calculated = 0;
+                        state = parse_state::payload;
+                    } else if (c == 0x03) {
+                        break_requested_.store(true, std::memory_order_release);
+                    } else if ((c != GDB_STUB_ACK) && (c != GDB_STUB_NACK)) {
+                        LOG_DEBUG(GDBSTUB, "gdb: read invalid byte {:02x}", c);
+                    }
+
+                    break;
+
+                case parse_state::payload:
+                    if (c == GDB_STUB_END) {
+                        state = parse_state::checksum_high;
+                        break;
+                    }
+
+                    // Leave room for the terminator the command handlers rely on
+                    if (payload.size() + 1 >= GDB_BUFFER_SIZE) {
+                        LOG_ERROR(GDBSTUB, "gdb: command_buffer overflow");
+
+                        const std::uint8_t nack = GDB_STUB_NACK;
+                        send(&nack, 1);
+
+                        state = parse_state::idle;
+                        break;
+                    }
+
+                    payload.push_back(c);
+                    checksum_calculated += c;
+                    break;
+
+                case parse_state::checksum_high:
+                    checksum_received = transport_hex_value(c) << 4;
+                    state = parse_state::checksum_low;
+                    break;
+
+                case parse_state::checksum_low: {
+                    checksum_received |= transport_hex_value(c);
+                    state = parse_state::idle;
+
+                    if (checksum_received != checksum_calculated) {
+                        LOG_ERROR(GDBSTUB, "gdb: invalid checksum: calculated {:02x} and read {:02x} (length: {})",
+                            checksum_calculated, checksum_received, payload.size());
+
+                        const std::uint8_t nack = GDB_STUB_NACK;
+                        send(&nack, 1);
+
+                        break;
+                    }
+
+                    const std::uint8_t ack = GDB_STUB_ACK;
+                    send(&ack, 1);
+
+                    queue_packet(payload.data(), static_cast<std::uint32_t>(payload.size()));
+                    break;
+                }
+
+                default:
+                    break;
+                }
+            }
+        }
+
+        alive_ = false;
+    }
+}
@@ -44,6 +44,7 @@ namespace eka2l1 {
 
     namespace mem {
         struct mem_model_chunk;
+        class cow_template;
     }
 
     using process_ptr = kernel::process *;
@@ -158,6 +159,9 @@ namespace eka2l1 {
             const std::size_t max_size() const;
             const std::size_t committed() const;
 
+            /*! \brief Get the size of committed memory currently backed by host physical memory. */
+            const std::size_t resident() const;
+
             const std::uint32_t bottom_offset() const;
             const std::uint32_t top_offset() const;
 
@@ -165,6 +169,15 @@ namespace eka2l1 {
                 return pos_access;
             }
 
+            /*! \brief Back a committed region with a copy-on-write view of a template.
+             *
+             * \param offset Offset of the region in the chunk.
+             * \param templ  The template to map.
+             *
+             * \returns True on success. On failure the region must be filled some other way.
+            */
+            bool map_template(const std::uint32_t offset, const mem::cow_template &templ);
+
             void *host_base();
         };
     }
@@ -20,10 +20,15 @@
 
 #pragma once
 
+#include <common/lru.h>
 #include <kernel/kernel_obj.h>
+#include <mem/cow.h>
 #include <mem/ptr.h>
 #include <utils/sec.h>
 
+#include <map>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -52,6 +57,95 @@ namespace eka2l1::kernel {
         return (ord) | (adj << 16) | (static_cast<std::uint64_t>(offset_to_apply) << 32);
     }
 
+    /**
+     * \brief Code and data of a RAM codeseg, as they were right after being loaded and relocated.
+     * 
+     * The result of relocation and import fixup only depends on where the codeseg and its dependencies
+     * are loaded. When a later process loads the codeseg at the same addresses, the pages can be mapped
+     * copy-on-write from here, instead of being copied and patched again.
+     */
+    struct codeseg_template {
+        std::uint64_t source_hash_ = 0;             ///< Hash of the unrelocated code and data.
+        address code_run_addr_ = 0;
+        address data_run_addr_ = 0;
+        std::vector<address> imports_;              ///< Resolved import values, in patching order.
+
+        std::unique_ptr<mem::cow_template> code_;
+        std::unique_ptr<mem::cow_template> data_;   ///< Null if the codeseg has no data.
+
+        std::size_t size() const;
+    };
+
+    /**
+     * \brief Templates of recently loaded codesegs.
+     * 
+     * Each template holds a host memory file, so the cache is bounded both in count and in bytes.
+     * The least recently used template is dropped first. Chunks that already mapped it keep their pages.
+     */
+    class codeseg_template_cache {
+        common::lru_cache<std::u16string, std::shared_ptr<codeseg_template>> templates_;
+
+        std::size_t hits_ = 0;
+        std::size_t misses_ = 0;
+
+    public:
+        static constexpr std::size_t DEFAULT_MAX_COUNT = 64;
+        static constexpr std::size_t DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+        explicit codeseg_template_cache(const std::size_t max_count = DEFAULT_MAX_COUNT,
+            const std::size_t max_size = DEFAULT_MAX_SIZE);
+
+        /**
+         * \brief Find the template of a codeseg.
+         * 
+         * \param path         Full path of the codeseg.
+         * \param source_hash  Hash of the unrelocated code and data.
+         * 
+         * \returns Nullptr if none is stored, or the stored one came from different content. The template
+         *          stays alive while the result is held, even if the cache drops it meanwhile.
+         */
+        std::shared_ptr<codeseg_template> find(const std::u16string &path, const std::uint64_t source_hash);
+
+        /**
+         * \brief Store the template of a codeseg, replacing the old one.
+         * 
+         * Least recently used templates are dropped until the cache fits in its bounds again.
+         * A template bigger than the whole cache is not stored.
+         */
+        void add(const std::u16string &path, codeseg_template &&templ);
+
+        void record(const bool hit) {
+            if (hit) {
+                hits_++;
+            } else {
+                misses_++;
+            }
+        }
+
+        std::size_t hits() const {
+            return hits_;
+        }
+
+        std::size_t misses() const {
+            return misses_;
+        }
+
+        std::size_t evictions() {
+            return templates_.evictions();
+        }
+
+        std::size_t count() {
+            return templates_.count();
+        }
+
+        /**
+         * \brief Get the total size of the stored code and data, in bytes.
+         */
+        std::size_t size() {
+            return templates_.total_cost();
+        }
+    };
+
     struct codeseg_create_info {
         std::u16string full_path;
 
@@ -135,6 +229,10 @@ namespace eka2l1::kernel {
 
         bool export_table_fixed_;
 
+        std::uint64_t source_hash_;
+
+        std::uint64_t get_source_hash();
+
     public:
         /*! \brief Create a new codeseg
          *
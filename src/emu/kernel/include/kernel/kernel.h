@@ -286,6 +286,7 @@ namespace eka2l1 {
         std::unique_ptr<kernel::btrace> btrace_inst_;
         std::unique_ptr<hle::lib_manager> lib_mngr_;
         std::unique_ptr<kernel::thread_scheduler> thr_sch_;
+        std::unique_ptr<kernel::codeseg_template_cache> codeseg_templates_;
 
         ntimer *timing_;
         memory_system *mem_;
@@ -495,6 +496,15 @@ namespace eka2l1 {
             return mem_;
         }
 
+        /**
+         * \brief Get the store of relocated codeseg images to map on relaunch.
+         * 
+         * \returns Nullptr if codeseg templates are disabled in the config.
+         */
+        kernel::codeseg_template_cache *get_codeseg_template_cache() {
+            return codeseg_templates_.get();
+        }
+
         hle::lib_manager *get_lib_manager() {
             return lib_mngr_.get();
         }
@@ -519,6 +529,10 @@ namespace eka2l1 {
             return rom_info_;
         }
 
+        void set_rom_info(loader::rom *rom_info) {
+            rom_info_ = rom_info;
+        }
+
         std::locale *get_current_locale() {
             return locale_.get();
         }
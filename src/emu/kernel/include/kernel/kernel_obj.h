@@ -93,6 +93,7 @@ namespace eka2l1 {
             access_type access;
             object_type obj_type;
 
+            // Objects made without a kernel, like in unit tests, get no UID
             explicit kernel_obj(kernel_system *kern, const std::string &obj_name, kernel_obj *owner = nullptr,
                 kernel::access_type access = access_type::local_access);
 
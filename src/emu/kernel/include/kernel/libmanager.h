@@ -40,6 +40,7 @@ namespace YAML {
 namespace eka2l1 {
     class io_system;
     class memory_system;
+    struct file;
     class kernel_system;
     class system;
 
@@ -69,6 +70,8 @@ namespace eka2l1 {
         struct e32img;
         struct romimg;
 
+        class e32img_cache;
+
         using e32img_ptr = std::shared_ptr<e32img>;
         using romimg_ptr = std::shared_ptr<romimg>;
     }
@@ -135,6 +138,8 @@ namespace eka2l1 {
             std::vector<patch_info> patches_;
             std::vector<patch_pending_entry> patch_pendings_;
 
+            std::unique_ptr<loader::e32img_cache> e32_cache_;
+
         protected:
             const std::uint8_t *entry_points_call_routine_;
             const std::uint8_t *thread_entry_routine_;
@@ -143,6 +148,8 @@ namespace eka2l1 {
 
             drive_number get_drive_rom();
 
+            std::optional<loader::e32img> parse_e32img_cached(common::ro_stream *stream, file *source);
+
             void apply_pending_patches();
             void apply_trick_or_treat_algo();
 
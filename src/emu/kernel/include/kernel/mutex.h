@@ -21,8 +21,8 @@
 #pragma once
 
 #include <common/linked.h>
-#include <common/queue.h>
 #include <kernel/thread.h>
+#include <kernel/waitqueue.h>
 
 namespace eka2l1 {
     namespace kernel {
@@ -35,7 +35,7 @@ namespace eka2l1 {
             //! Thread holding
             kernel::thread *holding;
 
-            kernel::thread_priority_queue waits;
+            kernel::thread_wait_queue waits;
             common::roundabout pendings;
             common::roundabout suspended;
 
@@ -101,6 +101,10 @@ namespace eka2l1 {
             */
             bool suspend_thread(thread *thr);
             bool unsuspend_thread(thread *thr);
+
+            const contention_stats &get_contention_stats() const {
+                return waits.stats();
+            }
         };
     }
 }
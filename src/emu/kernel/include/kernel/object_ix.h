@@ -41,19 +41,34 @@ namespace eka2l1 {
             kernel
         };
 
+        static constexpr std::uint32_t HANDLE_PAGE_SHIFT = 7;
+        static constexpr std::uint32_t HANDLE_PAGE_SIZE = 1 << HANDLE_PAGE_SHIFT;
+        static constexpr std::int32_t HANDLE_NO_FREE_SLOT = -1;
+
         struct object_ix_record {
-            kernel_obj_ptr object;
-            uint32_t associated_handle;
+            kernel_obj_ptr object = nullptr;
+            uint32_t associated_handle = 0;
+            std::int32_t next_free = HANDLE_NO_FREE_SLOT; ///< Index of the next free slot, valid while this slot is free.
             bool free = true;
         };
 
-        /*! \brief The ultimate object handles holder. */
+        using object_ix_page = std::array<object_ix_record, HANDLE_PAGE_SIZE>;
+
+        /**
+         * \brief The ultimate object handles holder.
+         *
+         * Slots are allocated in pages as the container fills up, so a container with a few handles stays small.
+         * Free slots are chained in a free list threaded through the records themselves, making both opening
+         * and closing a handle constant time.
+         */
         class object_ix {
             uint64_t uid;
 
             size_t next_instance;
 
-            std::array<object_ix_record, MAX_HANDLE_COUNT> objects;
+            std::vector<std::unique_ptr<object_ix_page>> pages;
+            std::int32_t free_head;
+
             std::vector<std::uint32_t> handles;
 
             handle_array_owner owner;
@@ -61,10 +76,21 @@ namespace eka2l1 {
 
             uint32_t make_handle(size_t index);
 
+            object_ix_record *get_record(const std::uint32_t index);
+            bool grow();
+            void rebuild_free_list();
+
             kernel_system *kern;
 
         public:
-            explicit object_ix() {}
+            explicit object_ix()
+                : uid(0)
+                , next_instance(0)
+                , free_head(HANDLE_NO_FREE_SLOT)
+                , owner(handle_array_owner::kernel)
+                , totals(0)
+                , kern(nullptr) {
+            }
             explicit object_ix(kernel_system *kern, handle_array_owner owner);
 
             void do_state(common::chunkyseri &seri);
@@ -109,6 +135,11 @@ namespace eka2l1 {
                 return totals;
             }
 
+            /*! \brief Get the number of bytes the handle slots currently take. */
+            std::size_t memory_usage() const {
+                return sizeof(object_ix) + pages.size() * sizeof(object_ix_page) + handles.capacity() * sizeof(std::uint32_t);
+            }
+
             /*! \brief Get the last handle created. 0 if none left */
             std::uint32_t last_handle();
 
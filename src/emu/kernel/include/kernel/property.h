@@ -27,7 +27,9 @@
 #include <utils/reqsts.h>
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace eka2l1 {
@@ -44,22 +46,33 @@ namespace eka2l1 {
             unk
         };
 
+        /*! \brief Binary values up to this size are stored inside the property, without allocation. */
+        static constexpr std::uint32_t PROPERTY_INPLACE_BIN_SIZE = 512;
+
         /*! \brief Property is a kind of environment data. 
 		 *
 		 * Property is defined by cagetory and key. Each property contains either
 		 * integer or binary data. Properties are stored in the kernel until shutdown,
 		 * and they are the way of ITC (Inter-Thread communication).
  		 *
+		 * Setters are serialized with each other. Readers never block on a small value: they copy it
+		 * optimistically, and retry if a setter ran meanwhile (a sequence lock).
 		*/
         class property : public kernel::kernel_obj, public std::pair<int, int> {
         public:
             typedef void (*data_change_callback_handler)(void *userdata, service::property *prop);
 
         protected:
-            int ndata;
-            std::vector<uint8_t> bindata;
+            std::atomic<int> ndata;
+
+            /*! \brief Small binary value, in words that readers load atomically while a setter may store them. */
+            std::array<std::atomic<std::uint64_t>, PROPERTY_INPLACE_BIN_SIZE / sizeof(std::uint64_t)> bindata;
+            std::vector<std::uint8_t> bindata_large;    ///< Only used by values that do not fit in bindata.
+
+            std::atomic<std::uint32_t> data_len;
+            std::atomic<std::uint32_t> sequence;        ///< Odd while a setter is writing the binary value.
 
-            uint32_t data_len;
+            std::mutex write_lock;
 
             service::property_type data_type;
 
@@ -70,6 +83,9 @@ namespace eka2l1 {
 
             void fire_data_change_callbacks();
 
+            void write_inplace_bin(const std::uint8_t *source, const std::uint32_t size);
+            void read_inplace_bin(std::uint8_t *dest, const std::uint32_t size);
+
         public:
             explicit property(kernel_system *kern);
 
@@ -89,6 +105,9 @@ namespace eka2l1 {
              *
              * If the property type is not integer, this return false, else
              * it will set the value and notify the request.		
+             * 
+             * Pending subscriptions are completed and data change callbacks are fired on
+             * every set, even if the value stays the same.
              *
              * \param val The value to set.
 			*/
@@ -115,6 +134,16 @@ namespace eka2l1 {
             int get_int();
             std::vector<uint8_t> get_bin();
 
+            /**
+             * \brief Copy the binary value to a buffer, without allocating.
+             * 
+             * \param dest       The buffer to copy to.
+             * \param dest_size  Size of the buffer. The value is truncated to fit.
+             * 
+             * \returns Full length of the value, which may be larger than dest_size.
+             */
+            std::uint32_t get_bin(std::uint8_t *dest, const std::uint32_t dest_size);
+
             template <typename T>
             std::optional<T> get_pkg() {
                 auto bin = get_bin();
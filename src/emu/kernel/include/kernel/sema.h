@@ -21,8 +21,8 @@
 #pragma once
 
 #include <common/linked.h>
-#include <common/queue.h>
 #include <kernel/thread.h>
+#include <kernel/waitqueue.h>
 
 #include <memory>
 
@@ -32,7 +32,7 @@ namespace eka2l1 {
     namespace kernel {
         class semaphore : public kernel_obj {
             int32_t avail_count;
-            kernel::thread_priority_queue waits;
+            kernel::thread_wait_queue waits;
             common::roundabout suspended;
 
             bool signaling;
@@ -53,9 +53,13 @@ namespace eka2l1 {
             bool suspend_waiting_thread(thread *thr);
             bool unsuspend_waiting_thread(thread *thr);
 
-            void priority_change();
+            void priority_change(thread *thr);
 
             int count() const;
+
+            const contention_stats &get_contention_stats() const {
+                return waits.stats();
+            }
         };
     }
 }
@@ -56,6 +56,7 @@ namespace eka2l1 {
 
         class mutex;
         class semaphore;
+        class thread_wait_queue;
         class process;
     }
 
@@ -148,9 +149,11 @@ namespace eka2l1 {
             friend class thread_scheduler;
             friend class mutex;
             friend class semaphore;
+            friend class thread_wait_queue;
             friend class process;
             friend class service::faker;
             friend class legacy::sync_object_base;
+            friend struct thread_test_access;
 
             thread_state state;
             thread_state backup_state;
@@ -220,6 +223,9 @@ namespace eka2l1 {
 
             common::double_link<kernel::thread> scheduler_link;
             common::double_linked_queue_element wait_link;
+            thread_wait_queue *wait_queue; ///< The wait queue the thread is linked in through its wait link.
+            int wait_priority; ///< Priority the thread was queued with in its wait queue.
+            std::uint64_t wait_start_us; ///< Time the thread started waiting in a wait queue.
             common::double_linked_queue_element pending_link;
             common::double_linked_queue_element suspend_link;
             common::double_linked_queue_element process_thread_link;
@@ -308,8 +314,12 @@ namespace eka2l1 {
 
             explicit thread(kernel_system *kern, memory_system *mem, ntimer *timing)
                 : kernel_obj(kern)
+                , real_priority(0)
                 , mem(mem)
-                , timing(timing) {
+                , timing(timing)
+                , wait_queue(nullptr)
+                , wait_priority(0)
+                , wait_start_us(0) {
                 obj_type = kernel::object_type::thread;
             }
 
@@ -445,19 +455,15 @@ namespace eka2l1 {
                 return thread_handles.total_open();
             }
 
+            std::size_t get_handle_table_memory() const {
+                return thread_handles.memory_usage();
+            }
+
             std::uint32_t last_handle() {
                 return thread_handles.last_handle();
             }
         };
 
         using thread_ptr = kernel::thread *;
-
-        struct thread_priority_less_comparator {
-            const bool operator()(kernel::thread *lhs, kernel::thread *rhs) const {
-                return lhs->current_real_priority() < rhs->current_real_priority();
-            }
-        };
-
-        using thread_priority_queue = eka2l1::cp_queue<kernel::thread *, thread_priority_less_comparator>;
     }
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/linked.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eka2l1::kernel {
+    class thread;
+
+    static constexpr std::size_t WAIT_QUEUE_PRIORITY_COUNT = 64;
+
+    /**
+     * \brief Contention statistics of a synchronization object.
+     */
+    struct contention_stats {
+        std::uint64_t wait_count = 0; ///< Number of times a thread had to block on the object.
+        std::uint64_t total_wait_us = 0; ///< Time threads spent in the wait queue, in microseconds.
+        std::uint64_t max_wait_us = 0; ///< Longest time a thread spent in the wait queue at once.
+        std::uint32_t max_waiters = 0; ///< Largest number of threads waiting at the same time.
+        std::uint64_t inversions = 0; ///< Number of waits where the holder had lower priority than the waiter.
+    };
+
+    /**
+     * \brief Priority-ordered queue of threads blocked on a kernel object.
+     *
+     * Threads are linked in through their wait link, into one list per priority. Pushing,
+     * removing and taking the highest priority thread do not depend on the number of waiters.
+     * Threads of the same priority are served in the order they came.
+     *
+     * A thread can only be in one wait queue at a time.
+     */
+    class thread_wait_queue {
+        common::roundabout queues_[WAIT_QUEUE_PRIORITY_COUNT];
+        std::uint32_t mask_[WAIT_QUEUE_PRIORITY_COUNT / 32];
+        std::size_t count_;
+
+        contention_stats stats_;
+
+        void link(thread *thr);
+        void unlink(thread *thr);
+
+    public:
+        explicit thread_wait_queue();
+
+        /**
+         * \brief Unlink the threads still waiting, so none of them points to a freed queue.
+         */
+        ~thread_wait_queue();
+
+        thread_wait_queue(const thread_wait_queue &) = delete;
+        thread_wait_queue &operator=(const thread_wait_queue &) = delete;
+
+        /**
+         * \brief Add a thread to the back of the list for its current priority.
+         *
+         * \param thr       The thread to add. Must not be in any wait queue.
+         * \param now_us    Current time in microseconds, used to measure how long the thread waits.
+         */
+        void push(thread *thr, const std::uint64_t now_us);
+
+        /**
+         * \brief Get the highest priority thread that waited the longest.
+         * \returns Nullptr if the queue is empty.
+         */
+        thread *top();
+
+        /**
+         * \brief Remove and return the thread that top() gives.
+         */
+        thread *pop(const std::uint64_t now_us);
+
+        /**
+         * \brief Remove a thread from the queue.
+         * \returns False if the thread is not in this queue.
+         */
+        bool remove(thread *thr, const std::uint64_t now_us);
+
+        bool contains(thread *thr) const;
+
+        /**
+         * \brief Move a thread to the list of its new priority, after its priority changed.
+         */
+        void requeue(thread *thr);
+
+        /**
+         * \brief Count a thread that had to block on the object.
+         *
+         * \param inverted  True if the thread blocked behind a holder with lower priority than itself.
+         */
+        void record_wait(const bool inverted = false);
+
+        std::size_t size() const {
+            return count_;
+        }
+
+        bool empty() const {
+            return count_ == 0;
+        }
+
+        const contention_stats &stats() const {
+            return stats_;
+        }
+    };
+}
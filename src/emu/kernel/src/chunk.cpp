@@ -158,6 +158,10 @@ namespace eka2l1 {
             return mmc_impl_->committed();
         }
 
+        const std::size_t chunk::resident() const {
+            return mmc_impl_->resident();
+        }
+
         const std::uint32_t chunk::bottom_offset() const {
             return mmc_impl_->bottom();
         }
@@ -211,6 +215,10 @@ namespace eka2l1 {
             return mmc_impl_->allocate(size);
         }
 
+        bool chunk::map_template(const std::uint32_t offset, const mem::cow_template &templ) {
+            return mmc_impl_->map_template(offset, templ);
+        }
+
         void *chunk::host_base() {
             return mmc_impl_->host_base();
         }
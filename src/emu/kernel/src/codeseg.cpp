@@ -26,12 +26,16 @@
 
 #include <algorithm>
 
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
 namespace eka2l1::kernel {
     codeseg::codeseg(kernel_system *kern, const std::string &name, codeseg_create_info &info)
         : kernel_obj(kern, name, nullptr, kernel::access_type::global_access)
         , state(codeseg_state_none)
         , export_table_fixed_(false)
-        , code_chunk_shared(nullptr) {
+        , code_chunk_shared(nullptr)
+        , source_hash_(0) {
         std::copy(info.uids, info.uids + 3, uids);
         code_base = info.code_base;
         data_base = info.data_base;
@@ -125,6 +129,8 @@ namespace eka2l1::kernel {
 
         bool code_chunk_for_reuse = eligible_for_codeseg_reuse();
         bool need_patch_and_reloc = true;
+        bool code_chunk_fresh = false;
+        bool data_chunk_owned = false;
 
         if (kern->is_eka1()) {
             unmark();
@@ -143,9 +149,8 @@ namespace eka2l1::kernel {
 
                 the_addr_of_code_run = code_chunk->base(new_foe).ptr_address();
 
-                // Copy data
                 code_base_ptr = reinterpret_cast<std::uint8_t *>(code_chunk->host_base());
-                std::copy(code_data.get(), code_data.get() + code_size, code_base_ptr); // .code
+                code_chunk_fresh = true;
 
                 if (code_chunk_for_reuse) {
                     code_chunk_shared = code_chunk;
@@ -162,6 +167,8 @@ namespace eka2l1::kernel {
             if (!data_addr) {
                 dt_chunk = kern->create<kernel::chunk>(mem, new_foe, "", 0, data_size_align, data_size_align,
                     prot_read_write, kernel::chunk_type::normal, kernel::chunk_access::local, kernel::chunk_attrib::anonymous);
+
+                data_chunk_owned = true;
             } else {
                 kernel::chunk_access acc = kernel::chunk_access::dll_static_data;
 
@@ -172,6 +179,8 @@ namespace eka2l1::kernel {
                     dt_chunk = kern->create<kernel::chunk>(mem, new_foe, "", 0, data_size_align, data_size_align,
                         prot_read_write, kernel::chunk_type::normal, acc, kernel::chunk_attrib::anonymous,
                         0x00, false, data_base, nullptr);
+
+                    data_chunk_owned = true;
                 } else {
                     dt_chunk = new_foe->get_rom_bss_chunk();
                     add_offset = data_base - dt_chunk->base(new_foe).ptr_address();
@@ -188,12 +197,6 @@ namespace eka2l1::kernel {
 
             data_base_ptr = reinterpret_cast<std::uint8_t *>(dt_chunk->host_base()) + add_offset;
             the_addr_of_data_run = dt_chunk->base(new_foe).ptr_address() + add_offset;
-
-            // Confirmed that if data is in ROM, only BSS is reserved
-            std::copy(constant_data.get(), constant_data.get() + data_size, data_base_ptr); // .data
-
-            const std::uint32_t bss_off = data_size;
-            std::fill(data_base_ptr + bss_off, data_base_ptr + bss_off + bss_size, 0); // .bss
         } else {
             the_addr_of_data_run = data_addr;
             data_base_ptr = reinterpret_cast<std::uint8_t *>(kern->get_memory_system()->get_real_pointer(data_addr));
@@ -204,30 +207,79 @@ namespace eka2l1::kernel {
 
         attaches.push_back({ new_foe, dt_chunk, code_chunk });
         
+        const bool need_import_patch = need_patch_and_reloc && ((code_addr && forcefully) || !code_addr);
+        std::vector<address> import_values;
+
         // Attach all of its dependencies
         for (auto &dependency: dependencies) {
             dependency.dep_->attach(new_foe);
 
-            // Patch what imports we need
-            if (need_patch_and_reloc) {
-                if ((code_addr && forcefully) || !code_addr) {
-                    for (const std::uint64_t import: dependency.import_info_) {
-                        const std::uint16_t ord = (import & 0xFFFF);
-                        const std::uint16_t adj = (import >> 16) & 0xFFFF;
-                        const std::uint32_t offset_to_apply = (import >> 32) & 0xFFFFFFFF;
-
-                        const address addr = dependency.dep_->lookup(new_foe, ord);
-                        if (!addr) {
-                            LOG_ERROR(KERNEL, "Invalid ordinal {}, requested from {}", ord, dependency.dep_->name());
-                        }
+            // Resolve what imports we need
+            if (need_import_patch) {
+                for (const std::uint64_t import: dependency.import_info_) {
+                    const std::uint16_t ord = (import & 0xFFFF);
+                    const std::uint16_t adj = (import >> 16) & 0xFFFF;
 
-                        *reinterpret_cast<std::uint32_t*>(&code_base_ptr[offset_to_apply]) = addr + adj;
+                    const address addr = dependency.dep_->lookup(new_foe, ord);
+                    if (!addr) {
+                        LOG_ERROR(KERNEL, "Invalid ordinal {}, requested from {}", ord, dependency.dep_->name());
                     }
+
+                    import_values.push_back(addr + adj);
                 }
             }
         }
 
-        if (need_patch_and_reloc) {
+        // If this codeseg was loaded to the same place with the same imports before, map the pages
+        // of that load copy-on-write, and skip copying and patching entirely.
+        codeseg_template_cache *templates = kern->get_codeseg_template_cache();
+        std::shared_ptr<codeseg_template> templ;
+
+        const bool can_use_template = templates && need_patch_and_reloc && code_chunk_fresh && !code_chunk_for_reuse
+            && ((data_size_align == 0) || data_chunk_owned) && !full_path.empty();
+
+        if (can_use_template) {
+            templ = templates->find(full_path, get_source_hash());
+
+            if (templ && ((templ->code_run_addr_ != the_addr_of_code_run) || (templ->data_run_addr_ != the_addr_of_data_run)
+                || (templ->imports_ != import_values) || (!templ->data_ != !dt_chunk))) {
+                templ = nullptr;
+            }
+
+            if (templ && (!code_chunk->map_template(0, *templ->code_) || (templ->data_ && !dt_chunk->map_template(0, *templ->data_)))) {
+                LOG_WARN(KERNEL, "Unable to map template of codeseg {}, loading it normally", name());
+                templ = nullptr;
+            }
+
+            templates->record(templ != nullptr);
+        }
+
+        if (!templ) {
+            if (code_chunk_fresh) {
+                std::copy(code_data.get(), code_data.get() + code_size, code_base_ptr); // .code
+            }
+
+            if (data_size_align != 0) {
+                // Confirmed that if data is in ROM, only BSS is reserved
+                std::copy(constant_data.get(), constant_data.get() + data_size, data_base_ptr); // .data
+
+                const std::uint32_t bss_off = data_size;
+                std::fill(data_base_ptr + bss_off, data_base_ptr + bss_off + bss_size, 0); // .bss
+            }
+        }
+
+        if (need_import_patch && !templ) {
+            std::size_t import_index = 0;
+
+            for (auto &dependency: dependencies) {
+                for (const std::uint64_t import: dependency.import_info_) {
+                    const std::uint32_t offset_to_apply = (import >> 32) & 0xFFFFFFFF;
+                    *reinterpret_cast<std::uint32_t*>(&code_base_ptr[offset_to_apply]) = import_values[import_index++];
+                }
+            }
+        }
+
+        if (need_patch_and_reloc && !templ) {
             if (!relocation_list.empty()) {
                 const std::uint32_t code_delta = the_addr_of_code_run - code_base;
                 const std::uint32_t data_delta = the_addr_of_data_run - data_base;
@@ -292,6 +344,23 @@ namespace eka2l1::kernel {
                     *to_relocate_ptr = *to_relocate_ptr + the_delta;
                 }
             }
+
+            if (can_use_template) {
+                codeseg_template fresh_templ;
+                fresh_templ.source_hash_ = get_source_hash();
+                fresh_templ.code_run_addr_ = the_addr_of_code_run;
+                fresh_templ.data_run_addr_ = the_addr_of_data_run;
+                fresh_templ.imports_ = std::move(import_values);
+                fresh_templ.code_ = std::make_unique<mem::cow_template>(code_base_ptr, code_size_align);
+
+                if (data_size_align != 0) {
+                    fresh_templ.data_ = std::make_unique<mem::cow_template>(data_base_ptr, data_size_align);
+                }
+
+                if (fresh_templ.code_->valid() && (!fresh_templ.data_ || fresh_templ.data_->valid())) {
+                    templates->add(full_path, std::move(fresh_templ));
+                }
+            }
         }
 
         state = codeseg_state_attached;
@@ -300,6 +369,38 @@ namespace eka2l1::kernel {
         return true;
     }
 
+    std::uint64_t codeseg::get_source_hash() {
+        if (!source_hash_) {
+            source_hash_ = XXH64(code_data.get(), code_data ? code_size : 0, 0);
+            source_hash_ = XXH64(constant_data.get(), constant_data ? data_size : 0, source_hash_);
+        }
+
+        return source_hash_;
+    }
+
+    std::size_t codeseg_template::size() const {
+        return (code_ ? code_->size() : 0) + (data_ ? data_->size() : 0);
+    }
+
+    codeseg_template_cache::codeseg_template_cache(const std::size_t max_count, const std::size_t max_size)
+        : templates_(max_size, max_count) {
+    }
+
+    std::shared_ptr<codeseg_template> codeseg_template_cache::find(const std::u16string &path, const std::uint64_t source_hash) {
+        std::optional<std::shared_ptr<codeseg_template>> result = templates_.get(path);
+
+        if (!result || ((*result)->source_hash_ != source_hash)) {
+            return nullptr;
+        }
+
+        return *result;
+    }
+
+    void codeseg_template_cache::add(const std::u16string &path, codeseg_template &&templ) {
+        const std::size_t cost = templ.size();
+        templates_.put(path, std::make_shared<codeseg_template>(std::move(templ)), cost);
+    }
+
     bool codeseg::detach(kernel::process *de_foe) {
         auto attach_info = common::find_and_ret_if(attaches, [=](const attached_info &info) {
             return info.attached_process == de_foe;
@@ -123,6 +123,8 @@ namespace eka2l1 {
         OBJECT_CONTAINER_CLEANUP(processes_);
         OBJECT_CONTAINER_CLEANUP(libraries_);
         OBJECT_CONTAINER_CLEANUP(codesegs_);
+
+        codeseg_templates_.reset();
         OBJECT_CONTAINER_CLEANUP(message_queues_);
         OBJECT_CONTAINER_CLEANUP(logical_channels_);
         OBJECT_CONTAINER_CLEANUP(logical_devices_);
@@ -139,6 +141,10 @@ namespace eka2l1 {
         // Instantiate btrace
         btrace_inst_ = std::make_unique<kernel::btrace>(this, io_);
 
+        if (conf_ && conf_->codeseg_cow_templates) {
+            codeseg_templates_ = std::make_unique<kernel::codeseg_template_cache>();
+        }
+
         // Create real time IPC event
         realtime_ipc_signal_evt_ = timing_->register_event("RealTimeIpc", [this](std::uint64_t userdata, std::uint64_t cycles_late) {
             kernel::thread *thr = get_by_id<kernel::thread>(static_cast<kernel::uid>(userdata));
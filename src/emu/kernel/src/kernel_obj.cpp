@@ -31,7 +31,7 @@ namespace eka2l1 {
             , owner(owner)
             , kern(kern)
             , access(access)
-            , uid(kern->next_uid()) {
+            , uid(kern ? kern->next_uid() : 0) {
             if (!this->obj_name.empty() && this->obj_name.back() == '\0') {
                 // GET RID!
                 this->obj_name.pop_back();
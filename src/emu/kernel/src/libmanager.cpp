@@ -33,6 +33,7 @@
 #include <common/configure.h>
 #include <config/config.h>
 
+#include <loader/e32cache.h>
 #include <loader/e32img.h>
 #include <loader/romimage.h>
 #include <mem/page.h>
@@ -737,7 +738,9 @@ namespace eka2l1::hle {
 
                 eka2l1::ro_file_stream image_data_stream(f.get());
 
-                auto parse_result = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream));
+                // ROM files are mostly ROM images, don't waste time hashing them
+                auto parse_result = f->is_in_rom() ? loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream))
+                                                   : parse_e32img_cached(reinterpret_cast<common::ro_stream *>(&image_data_stream), f.get());
                 if (parse_result != std::nullopt) {
                     f->close();
                     result.first = std::move(parse_result);
@@ -821,7 +824,7 @@ namespace eka2l1::hle {
 
                     return load_as_romimg(*romimg, lib_path);
                 } else {
-                    auto e32img = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream));
+                    auto e32img = parse_e32img_cached(reinterpret_cast<common::ro_stream *>(&image_data_stream), f.get());
                     if (!e32img) {
                         return nullptr;
                     }
@@ -1119,6 +1122,18 @@ namespace eka2l1::hle {
             // Circumvent ROM vs ROFS issue at the moment.
             additional_mode_ = PREFER_PHYSICAL;
         }
+
+        if (config::state *conf = kern_->get_config()) {
+            e32_cache_ = std::make_unique<loader::e32img_cache>(add_path(conf->storage, "cache/codeseg/"));
+        }
+    }
+
+    std::optional<loader::e32img> lib_manager::parse_e32img_cached(common::ro_stream *stream, file *source) {
+        if (!e32_cache_) {
+            return loader::parse_e32img(stream);
+        }
+
+        return e32_cache_->parse(stream, source->file_name(), source->last_modify_since_1ad(), source->offset_in_image());
     }
     
     lib_manager::~lib_manager() {
@@ -79,7 +79,9 @@ namespace eka2l1 {
                 assert(!holding->wait_obj);
 
                 kernel::thread *calm_down = kern->crr_thread();
-                waits.push(calm_down);
+
+                waits.record_wait(holding->current_real_priority() < calm_down->current_real_priority());
+                waits.push(calm_down, timing->microseconds());
 
                 calm_down->get_scheduler()->wait(calm_down);
                 calm_down->state = thread_state::wait_mutex;
@@ -126,14 +128,11 @@ namespace eka2l1 {
             }
 
             case thread_state::wait_mutex: {
-                auto thr_ite = std::find(waits.begin(), waits.end(), thread_to_wake);
-
-                if (thr_ite == waits.end()) {
+                if (!waits.remove(thread_to_wake, timing->microseconds())) {
                     LOG_ERROR(KERNEL, "Thread request to wake up with this mutex is not in hold pending queue");
                     return;
                 }
 
-                waits.remove(thread_to_wake);
                 break;
             }
 
@@ -168,8 +167,11 @@ namespace eka2l1 {
 
             auto put_top_wait_to_pending = [&]() {
                 // Take it from top of the wait queue
-                kernel::thread *top_wait = std::move(waits.top());
-                waits.pop();
+                kernel::thread *top_wait = waits.pop(timing->microseconds());
+
+                if (!top_wait) {
+                    return;
+                }
 
                 pendings.push(&top_wait->pending_link);
 
@@ -207,8 +209,7 @@ namespace eka2l1 {
                 }
 
                 // The pending queue is currently empty, we might need to kickstart it
-                kernel::thread *ready_thread = std::move(waits.top());
-                waits.pop();
+                kernel::thread *ready_thread = waits.pop(timing->microseconds());
 
                 ready_thread->get_scheduler()->dewait(ready_thread);
                 ready_thread->state = thread_state::ready;
@@ -226,8 +227,11 @@ namespace eka2l1 {
         }
 
         void mutex::wake_next_thread() {
-            kernel::thread *thr = waits.top();
-            waits.pop();
+            kernel::thread *thr = waits.pop(timing->microseconds());
+
+            if (!thr) {
+                return;
+            }
 
             pendings.push(&thr->pending_link);
 
@@ -238,12 +242,11 @@ namespace eka2l1 {
         void mutex::priority_change(thread *thr) {
             switch (thr->state) {
             case thread_state::hold_mutex_pending: {
-                if (!thr->pending_link.alone() && thr->real_priority < waits.top()->real_priority) {
+                if (!thr->pending_link.alone() && !waits.empty() && thr->real_priority < waits.top()->real_priority) {
                     // Remove this from pending
                     thr->pending_link.deque();
 
-                    waits.push(thr);
-                    waits.resort();
+                    waits.push(thr, timing->microseconds());
 
                     thr->get_scheduler()->wait(thr);
                     thr->state = thread_state::wait_mutex;
@@ -253,14 +256,11 @@ namespace eka2l1 {
             }
 
             case thread_state::wait_mutex: {
-                waits.resort();
+                waits.requeue(thr);
 
                 // If the priority is increased, put it in pending
                 if (thr->last_priority < thr->real_priority) {
-                    const auto &wait_thr_ite = std::find(waits.begin(), waits.end(), thr);
-
-                    if (wait_thr_ite != waits.end()) {
-                        waits.remove(thr);
+                    if (waits.remove(thr, timing->microseconds())) {
                         pendings.push(&thr->pending_link);
 
                         thr->get_scheduler()->dewait(thr);
@@ -281,14 +281,11 @@ namespace eka2l1 {
         bool mutex::suspend_thread(thread *thr) {
             switch (thr->state) {
             case thread_state::wait_mutex: {
-                const auto thr_ite = std::find(waits.begin(), waits.end(), thr);
-
-                if (thr_ite == waits.end()) {
+                if (!waits.remove(thr, timing->microseconds())) {
                     LOG_ERROR(KERNEL, "Thread given is not found in waits");
                     return false;
                 }
 
-                waits.remove(thr);
                 suspended.push(&thr->suspend_link);
 
                 suspend_count++;
@@ -324,7 +321,7 @@ namespace eka2l1 {
             }
 
             thr->suspend_link.deque();
-            waits.push(thr);
+            waits.push(thr, timing->microseconds());
 
             suspend_count--;
             thr->state = thread_state::wait_mutex;
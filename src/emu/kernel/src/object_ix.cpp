@@ -81,26 +81,71 @@ namespace eka2l1::kernel {
         return handle;
     }
 
-    std::uint32_t object_ix::add_object(kernel_obj_ptr obj) {
-        auto slot = std::find_if(objects.begin(), objects.end(), [](const object_ix_record &record) {
-            return record.free;
-        });
+    object_ix_record *object_ix::get_record(const std::uint32_t index) {
+        const std::uint32_t page_index = index >> HANDLE_PAGE_SHIFT;
+
+        if (page_index >= pages.size()) {
+            return nullptr;
+        }
+
+        return &(*pages[page_index])[index & (HANDLE_PAGE_SIZE - 1)];
+    }
+
+    bool object_ix::grow() {
+        if (pages.size() * HANDLE_PAGE_SIZE >= MAX_HANDLE_COUNT) {
+            return false;
+        }
+
+        const std::uint32_t base = static_cast<std::uint32_t>(pages.size() * HANDLE_PAGE_SIZE);
+        pages.push_back(std::make_unique<object_ix_page>());
+
+        object_ix_page &page = *pages.back();
+
+        // Chain the new slots in ascending order, in front of whatever is still free
+        for (std::uint32_t i = 0; i < HANDLE_PAGE_SIZE; i++) {
+            page[i].next_free = (i == HANDLE_PAGE_SIZE - 1) ? free_head : static_cast<std::int32_t>(base + i + 1);
+        }
+
+        free_head = static_cast<std::int32_t>(base);
+        return true;
+    }
 
-        if (slot != objects.end()) {
-            next_instance = (next_instance + 1) & HANDLE_NEXT_INSTANCE_MASK;
-            std::uint32_t ret_handle = make_handle(slot - objects.begin());
+    void object_ix::rebuild_free_list() {
+        free_head = HANDLE_NO_FREE_SLOT;
 
-            slot->associated_handle = ret_handle;
-            slot->free = false;
-            slot->object = obj;
+        // Walk backwards so that the lowest free slot ends up being handed out first
+        for (std::size_t i = pages.size() * HANDLE_PAGE_SIZE; i > 0; i--) {
+            object_ix_record *record = get_record(static_cast<std::uint32_t>(i - 1));
 
-            obj->increase_access_count();
+            if (record->free) {
+                record->next_free = free_head;
+                free_head = static_cast<std::int32_t>(i - 1);
+            }
+        }
+    }
 
-            totals++;
-            return ret_handle;
+    std::uint32_t object_ix::add_object(kernel_obj_ptr obj) {
+        if ((free_head == HANDLE_NO_FREE_SLOT) && !grow()) {
+            return INVALID_HANDLE;
         }
 
-        return INVALID_HANDLE;
+        const std::uint32_t index = static_cast<std::uint32_t>(free_head);
+        object_ix_record *slot = get_record(index);
+
+        free_head = slot->next_free;
+
+        next_instance = (next_instance + 1) & HANDLE_NEXT_INSTANCE_MASK;
+        std::uint32_t ret_handle = make_handle(index);
+
+        slot->associated_handle = ret_handle;
+        slot->free = false;
+        slot->object = obj;
+        slot->next_free = HANDLE_NO_FREE_SLOT;
+
+        obj->increase_access_count();
+
+        totals++;
+        return ret_handle;
     }
 
     std::uint32_t object_ix::last_handle() {
@@ -133,12 +178,14 @@ namespace eka2l1::kernel {
     kernel_obj_ptr object_ix::get_object(std::uint32_t handle) {
         handle_inspect_info info = inspect_handle(handle);
 
-        if (info.object_ix_index < objects.size()) {
-            if (objects[info.object_ix_index].free) {
+        object_ix_record *record = get_record(info.object_ix_index);
+
+        if (record) {
+            if (record->free) {
                 return nullptr;
             }
 
-            return objects[info.object_ix_index].object;
+            return record->object;
         }
 
         LOG_WARN(KERNEL, "Can't find object with handle: 0x{:x}", handle);
@@ -150,8 +197,10 @@ namespace eka2l1::kernel {
         handle_inspect_info info = inspect_handle(handle);
         int ret_value = 0;
 
-        if (info.object_ix_index < objects.size()) {
-            kernel_obj_ptr obj = objects[info.object_ix_index].object;
+        object_ix_record *record = get_record(info.object_ix_index);
+
+        if (record) {
+            kernel_obj_ptr obj = record->object;
 
             if (!obj) {
                 return -1;
@@ -174,8 +223,11 @@ namespace eka2l1::kernel {
                 kern->destroy(obj);
             }
 
-            objects[info.object_ix_index].free = true;
-            objects[info.object_ix_index].object = nullptr;
+            record->free = true;
+            record->object = nullptr;
+            record->next_free = free_head;
+
+            free_head = info.object_ix_index;
 
             // Find the handle in unclosed handle list
             auto iterator = std::find(handles.begin(), handles.end(), handle);
@@ -190,22 +242,30 @@ namespace eka2l1::kernel {
     }
 
     void object_ix::reset() {
-        for (auto &index: objects) {
-            if (index.free == false) {
-                index.object->decrease_access_count();
-                index.free = true;
+        for (auto &page: pages) {
+            for (auto &index: *page) {
+                if (index.free == false) {
+                    index.object->decrease_access_count();
+                    index.free = true;
+
+                    if (index.object->get_access_count() <= 0 && index.object->get_object_type() != object_type::process && index.object->get_object_type() != object_type::thread) {
+                        kern->destroy(index.object);
+                    }
 
-                if (index.object->get_access_count() <= 0 && index.object->get_object_type() != object_type::process && index.object->get_object_type() != object_type::thread) {
-                    kern->destroy(index.object);
+                    index.object = nullptr;
                 }
             }
         }
+
+        rebuild_free_list();
     }
     
     bool object_ix::has(kernel_obj_ptr obj) {
-        for (const auto &index: objects) {
-            if ((index.object == obj) && (index.free == false)) {
-                return true;
+        for (const auto &page: pages) {
+            for (const auto &index: *page) {
+                if ((index.object == obj) && (index.free == false)) {
+                    return true;
+                }
             }
         }
 
@@ -215,9 +275,11 @@ namespace eka2l1::kernel {
     std::uint32_t object_ix::count(kernel_obj_ptr obj) {
         std::uint32_t so_far = 0;
 
-        for (const auto &index: objects) {
-            if ((index.free == false) && (index.object == obj)) {
-                so_far++;
+        for (const auto &page: pages) {
+            for (const auto &index: *page) {
+                if ((index.free == false) && (index.object == obj)) {
+                    so_far++;
+                }
             }
         }
 
@@ -228,6 +290,7 @@ namespace eka2l1::kernel {
         : kern(kern)
         , owner(owner)
         , next_instance(0)
+        , free_head(HANDLE_NO_FREE_SLOT)
         , uid(kern->next_uid())
         , totals(0) {}
 
@@ -246,8 +309,8 @@ namespace eka2l1::kernel {
         std::uint32_t slot_count = 0;
 
         if (seri.get_seri_mode() == common::SERI_MODE_WRITE) {
-            for (std::size_t i = 0; i < objects.size(); i++) {
-                if (!objects[i].free) {
+            for (std::size_t i = 0; i < pages.size() * HANDLE_PAGE_SIZE; i++) {
+                if (!get_record(static_cast<std::uint32_t>(i))->free) {
                     slot_count++;
                     slot_used.push(static_cast<std::uint16_t>(i));
                 }
@@ -265,20 +328,37 @@ namespace eka2l1::kernel {
                 next_slot_use = slot_used.top();
                 slot_used.pop();
 
-                obj_id = objects[next_slot_use].object->unique_id();
+                obj_id = get_record(next_slot_use)->object->unique_id();
             }
 
             seri.absorb(next_slot_use);
             seri.absorb(obj_id);
-            seri.absorb(objects[next_slot_use].associated_handle);
+
+            if (seri.get_seri_mode() == common::SERI_MODE_READ) {
+                while ((next_slot_use >= pages.size() * HANDLE_PAGE_SIZE) && grow()) {
+                }
+            }
+
+            object_ix_record *record = get_record(next_slot_use);
+
+            if (!record) {
+                LOG_ERROR(KERNEL, "Handle slot {} out of range while loading state", next_slot_use);
+                return;
+            }
+
+            seri.absorb(record->associated_handle);
 
             if (seri.get_seri_mode() == common::SERI_MODE_READ) {
                 // TODO
-                //objects[next_slot_use].object = kern->get_kernel_obj_raw(obj_id);
-                objects[next_slot_use].free = false;
+                //record->object = kern->get_kernel_obj_raw(obj_id);
+                record->free = false;
             }
         }
 
+        if (seri.get_seri_mode() == common::SERI_MODE_READ) {
+            rebuild_free_list();
+        }
+
         // Hey, we need to save last thread handle too
         seri.absorb_container(handles);
     }
@@ -25,14 +25,23 @@
 
 #include <common/log.h>
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
 namespace eka2l1 {
     namespace service {
         property::property(kernel_system *kern)
             : kernel::kernel_obj(kern, "", nullptr, kernel::access_type::global_access)
+            , ndata(0)
             , data_len(0)
+            , sequence(0)
             , data_type(service::property_type::unk) {
             obj_type = kernel::object_type::prop;
-            bindata.reserve(512);
+
+            for (auto &word : bindata) {
+                word.store(0, std::memory_order_relaxed);
+            }
         }
 
         bool property::is_defined() {
@@ -53,17 +62,19 @@ namespace eka2l1 {
             data_type = pt;
             data_len = pre_allocated;
 
-            if (pre_allocated > 512) {
-                LOG_WARN(KERNEL, "Property trying to alloc more then 512 bytes, limited to 512 bytes");
-                data_len = 512;
+            if (pre_allocated > PROPERTY_INPLACE_BIN_SIZE) {
+                LOG_WARN(KERNEL, "Property trying to alloc more then {} bytes, limited to {} bytes", PROPERTY_INPLACE_BIN_SIZE,
+                    PROPERTY_INPLACE_BIN_SIZE);
+
+                data_len = PROPERTY_INPLACE_BIN_SIZE;
             }
         }
 
         bool property::set_int(int val) {
             if (data_type == service::property_type::int_data) {
-                ndata = val;
-                notify_request(epoc::error_none);
+                ndata.store(val, std::memory_order_relaxed);
 
+                notify_request(epoc::error_none);
                 fire_data_change_callbacks();
 
                 return true;
@@ -72,13 +83,41 @@ namespace eka2l1 {
             return false;
         }
 
-        bool property::set(uint8_t *bdata, uint32_t arr_length) {
-            if (arr_length > data_len) {
-                bindata.resize(arr_length);
+        void property::write_inplace_bin(const std::uint8_t *source, const std::uint32_t size) {
+            for (std::uint32_t offset = 0; offset < size; offset += sizeof(std::uint64_t)) {
+                std::uint64_t word = 0;
+                std::memcpy(&word, source + offset, std::min<std::uint32_t>(sizeof(std::uint64_t), size - offset));
+
+                bindata[offset / sizeof(std::uint64_t)].store(word, std::memory_order_relaxed);
             }
+        }
 
-            memcpy(bindata.data(), bdata, arr_length);
-            data_len = arr_length;
+        void property::read_inplace_bin(std::uint8_t *dest, const std::uint32_t size) {
+            for (std::uint32_t offset = 0; offset < size; offset += sizeof(std::uint64_t)) {
+                const std::uint64_t word = bindata[offset / sizeof(std::uint64_t)].load(std::memory_order_relaxed);
+                std::memcpy(dest + offset, &word, std::min<std::uint32_t>(sizeof(std::uint64_t), size - offset));
+            }
+        }
+
+        bool property::set(uint8_t *bdata, uint32_t arr_length) {
+            {
+                const std::lock_guard<std::mutex> guard(write_lock);
+                const std::uint32_t seq = sequence.load(std::memory_order_relaxed);
+
+                // Odd sequence tells readers that the value is being torn. The fence keeps the words
+                // stored below from being seen before it.
+                sequence.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                if (arr_length > PROPERTY_INPLACE_BIN_SIZE) {
+                    bindata_large.assign(bdata, bdata + arr_length);
+                } else {
+                    write_inplace_bin(bdata, arr_length);
+                }
+
+                data_len.store(arr_length, std::memory_order_relaxed);
+                sequence.store(seq + 2, std::memory_order_release);
+            }
 
             notify_request(epoc::error_none);
             fire_data_change_callbacks();
@@ -91,15 +130,54 @@ namespace eka2l1 {
                 return -1;
             }
 
-            return ndata;
+            return ndata.load(std::memory_order_relaxed);
+        }
+
+        std::uint32_t property::get_bin(std::uint8_t *dest, const std::uint32_t dest_size) {
+            while (true) {
+                const std::uint32_t seq_before = sequence.load(std::memory_order_acquire);
+
+                if (seq_before & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const std::uint32_t length = data_len.load(std::memory_order_relaxed);
+
+                if (length > PROPERTY_INPLACE_BIN_SIZE) {
+                    // Large values may be reallocated by a setter, so they can't be read optimistically
+                    const std::lock_guard<std::mutex> guard(write_lock);
+                    const std::uint32_t locked_length = data_len.load(std::memory_order_relaxed);
+
+                    if (locked_length > PROPERTY_INPLACE_BIN_SIZE) {
+                        std::memcpy(dest, bindata_large.data(), std::min(locked_length, dest_size));
+                    } else {
+                        read_inplace_bin(dest, std::min(locked_length, dest_size));
+                    }
+
+                    return locked_length;
+                }
+
+                // The words may be stored meanwhile. The fence orders the loads before checking that they were not.
+                read_inplace_bin(dest, std::min(length, dest_size));
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == seq_before) {
+                    return length;
+                }
+            }
         }
 
         std::vector<uint8_t> property::get_bin() {
-            std::vector<uint8_t> local;
-            local.resize(data_len);
+            std::vector<uint8_t> local(PROPERTY_INPLACE_BIN_SIZE);
+            std::uint32_t length = get_bin(local.data(), static_cast<std::uint32_t>(local.size()));
 
-            memcpy(local.data(), bindata.data(), data_len);
+            while (length > local.size()) {
+                local.resize(length);
+                length = get_bin(local.data(), static_cast<std::uint32_t>(local.size()));
+            }
 
+            local.resize(length);
             return local;
         }
 
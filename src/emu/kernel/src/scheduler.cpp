@@ -27,6 +27,7 @@
 #include <kernel/kernel.h>
 #include <kernel/scheduler.h>
 #include <kernel/thread.h>
+#include <kernel/waitqueue.h>
 #include <mem/mem.h>
 #include <mem/mmu.h>
 #include <mem/process.h>
@@ -91,6 +92,7 @@ namespace eka2l1::kernel {
             // timing->unschedule_event(wakeup_evt, newt->unique_id());
             crr_thread = newt;
             crr_thread->state = thread_state::run;
+            core_mmu->set_traced_thread(static_cast<std::uint32_t>(newt->unique_id()));
             
             mem::mem_model_process *mm_process = crr_process ? crr_process->get_mem_model() : nullptr;
 
@@ -336,6 +338,11 @@ namespace eka2l1::kernel {
         if (wakeup_evt)
             timing->unschedule_event(wakeup_evt, thr->unique_id());
 
+        // A stopped thread must never be handed a mutex or semaphore it was waiting on
+        if (thr->wait_queue) {
+            thr->wait_queue->remove(thr, timing->microseconds());
+        }
+
         if (thr->state == thread_state::ready) {
             unschedule(thr);
         } else if (thr->state == thread_state::run) {
@@ -22,6 +22,7 @@
 
 #include <kernel/kernel.h>
 #include <kernel/sema.h>
+#include <kernel/timing.h>
 
 #include <common/log.h>
 
@@ -42,9 +43,8 @@ namespace eka2l1 {
 
             for (size_t i = 0; i < signal_count; i++) {
                 if (avail_count++ < 0) {
-                    if (waits.size() != 0) {
-                        kernel::thread *ready_thread = std::move(waits.top());
-                        waits.pop();
+                    if (!waits.empty()) {
+                        kernel::thread *ready_thread = waits.pop(kern->get_ntimer()->microseconds());
 
                         assert(ready_thread->wait_obj == this);
 
@@ -63,7 +63,9 @@ namespace eka2l1 {
             if (--avail_count < 0) {
                 assert(!calling_thr->wait_obj);
 
-                waits.push(calling_thr);
+                waits.record_wait();
+                waits.push(calling_thr, kern->get_ntimer()->microseconds());
+
                 calling_thr->get_scheduler()->wait(calling_thr);
 
                 calling_thr->state = thread_state::wait_fast_sema;
@@ -71,8 +73,8 @@ namespace eka2l1 {
             }
         }
 
-        void semaphore::priority_change() {
-            waits.resort();
+        void semaphore::priority_change(thread *thr) {
+            waits.requeue(thr);
         }
 
         bool semaphore::suspend_waiting_thread(thread *thr) {
@@ -82,14 +84,11 @@ namespace eka2l1 {
                 return false;
             }
 
-            const auto thr_ite = std::find(waits.begin(), waits.end(), thr);
-
-            if (thr_ite == waits.end()) {
+            if (!waits.remove(thr, kern->get_ntimer()->microseconds())) {
                 LOG_ERROR(KERNEL, "Thread given is not found in waits");
                 return false;
             }
 
-            waits.remove(thr);
             suspended.push(&thr->suspend_link);
 
             thr->state = thread_state::wait_fast_sema_suspend;
@@ -110,7 +109,7 @@ namespace eka2l1 {
             }
 
             thr->suspend_link.deque();
-            waits.push(thr);
+            waits.push(thr, kern->get_ntimer()->microseconds());
 
             thr->state = thread_state::wait_fast_sema;
 
@@ -2252,21 +2252,13 @@ namespace eka2l1::epoc {
         }
 
         std::uint8_t *data_ptr = data.get(crr_pr);
-        auto data_vec = prop->get_bin();
-
-        const std::size_t size_to_copy = std::min<std::size_t>(data_vec.size(), datlength);
-        std::int32_t return_code = epoc::error_none;
-
-        if (data_vec.size() > datlength) {
-            // The given buffer can't hold ours.
-            return_code = epoc::error_overflow;
-        }
 
         // Whether the buffer is too small, we still have to either copy truncated or full data.
-        std::copy(data_vec.begin(), data_vec.begin() + size_to_copy, data.get(kern->crr_process()));
+        const std::uint32_t data_size = prop->get_bin(data_ptr, static_cast<std::uint32_t>(std::max<std::int32_t>(datlength, 0)));
 
-        if (return_code != epoc::error_none) {
-            return return_code;
+        if (data_size > static_cast<std::uint32_t>(datlength)) {
+            // The given buffer can't hold ours.
+            return epoc::error_overflow;
         }
 
         return datlength;
@@ -2433,25 +2425,17 @@ namespace eka2l1::epoc {
             return epoc::error_not_found;
         }
 
-        std::vector<uint8_t> dat = prop->get_property_object()->get_bin();
+        // Whether the buffer is too small, we still have to either copy truncated or full data.
+        const std::uint32_t data_size = prop->get_property_object()->get_bin(buffer_ptr_guest.get(kern->crr_process()),
+            static_cast<std::uint32_t>(std::max<std::int32_t>(buffer_size, 0)));
 
-        if (dat.size() == 0) {
+        if (data_size == 0) {
             return epoc::error_argument;
         }
 
-        const std::size_t size_to_copy = std::min<std::size_t>(dat.size(), buffer_size);
-        std::int32_t return_code = epoc::error_none;
-
-        if (dat.size() > buffer_size) {
+        if (data_size > static_cast<std::uint32_t>(buffer_size)) {
             // The given buffer can't hold ours.
-            return_code = epoc::error_overflow;
-        }
-
-        // Whether the buffer is too small, we still have to either copy truncated or full data.
-        std::copy(dat.begin(), dat.begin() + size_to_copy, buffer_ptr_guest.get(kern->crr_process()));
-
-        if (return_code != epoc::error_none) {
-            return return_code;
+            return epoc::error_overflow;
         }
 
         return buffer_size;
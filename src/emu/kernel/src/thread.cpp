@@ -242,6 +242,9 @@ namespace eka2l1 {
             , timing(timing)
             , timeout_sts(0)
             , wait_obj(nullptr)
+            , wait_queue(nullptr)
+            , wait_priority(0)
+            , wait_start_us(0)
             , sleep_nof_sts(0)
             , thread_handles(kern, handle_array_owner::thread)
             , rendezvous_reason(0)
@@ -518,7 +521,7 @@ namespace eka2l1 {
                 }
 
                 case object_type::sema: {
-                    reinterpret_cast<semaphore *>(wait_obj)->priority_change();
+                    reinterpret_cast<semaphore *>(wait_obj)->priority_change(this);
                     break;
                 }
 
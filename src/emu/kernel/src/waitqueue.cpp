@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/thread.h>
+#include <kernel/waitqueue.h>
+
+#include <common/algorithm.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace eka2l1::kernel {
+    thread_wait_queue::thread_wait_queue()
+        : count_(0) {
+        std::fill(mask_, mask_ + sizeof(mask_) / sizeof(mask_[0]), 0);
+    }
+
+    thread_wait_queue::~thread_wait_queue() {
+        while (thread *thr = top()) {
+            unlink(thr);
+        }
+    }
+
+    void thread_wait_queue::link(thread *thr) {
+        const int pri = common::clamp<int>(0, WAIT_QUEUE_PRIORITY_COUNT - 1, thr->current_real_priority());
+
+        queues_[pri].push(&thr->wait_link);
+        mask_[pri >> 5] |= (1u << (pri & 31));
+
+        thr->wait_queue = this;
+        thr->wait_priority = pri;
+    }
+
+    void thread_wait_queue::unlink(thread *thr) {
+        const int pri = thr->wait_priority;
+
+        thr->wait_link.deque();
+        thr->wait_queue = nullptr;
+
+        if (queues_[pri].empty()) {
+            mask_[pri >> 5] &= ~(1u << (pri & 31));
+        }
+    }
+
+    void thread_wait_queue::push(thread *thr, const std::uint64_t now_us) {
+        assert(!thr->wait_queue);
+
+        link(thr);
+        thr->wait_start_us = now_us;
+
+        count_++;
+        stats_.max_waiters = std::max<std::uint32_t>(stats_.max_waiters, static_cast<std::uint32_t>(count_));
+    }
+
+    thread *thread_wait_queue::top() {
+        // Bit scan of zero is undefined, so only look at words with a waiter
+        if (mask_[1]) {
+            const int non_empty = common::find_most_significant_bit_one(mask_[1]);
+            return E_LOFF(queues_[non_empty + 31].first(), thread, wait_link);
+        }
+
+        if (mask_[0]) {
+            const int non_empty = common::find_most_significant_bit_one(mask_[0]);
+            return E_LOFF(queues_[non_empty - 1].first(), thread, wait_link);
+        }
+
+        return nullptr;
+    }
+
+    thread *thread_wait_queue::pop(const std::uint64_t now_us) {
+        thread *thr = top();
+
+        if (thr) {
+            remove(thr, now_us);
+        }
+
+        return thr;
+    }
+
+    bool thread_wait_queue::remove(thread *thr, const std::uint64_t now_us) {
+        if (!contains(thr)) {
+            return false;
+        }
+
+        unlink(thr);
+        count_--;
+
+        const std::uint64_t waited = (now_us > thr->wait_start_us) ? (now_us - thr->wait_start_us) : 0;
+
+        stats_.total_wait_us += waited;
+        stats_.max_wait_us = std::max(stats_.max_wait_us, waited);
+
+        return true;
+    }
+
+    bool thread_wait_queue::contains(thread *thr) const {
+        return thr->wait_queue == this;
+    }
+
+    void thread_wait_queue::requeue(thread *thr) {
+        if (!contains(thr) || (thr->wait_priority == thr->current_real_priority())) {
+            return;
+        }
+
+        unlink(thr);
+        link(thr);
+    }
+
+    void thread_wait_queue::record_wait(const bool inverted) {
+        stats_.wait_count++;
+
+        if (inverted) {
+            stats_.inversions++;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <loader/e32img.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace eka2l1::common {
+    class chunkyseri;
+}
+
+namespace eka2l1::loader {
+    static constexpr std::uint32_t E32IMG_CACHE_MAGIC = 0x43323345; ///< E32C
+    static constexpr std::uint32_t E32IMG_CACHE_VERSION = 2;
+    static constexpr std::uint64_t E32IMG_CACHE_DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+    struct e32img_cache_header {
+        std::uint32_t magic_;
+        std::uint32_t version_;
+        std::uint64_t source_key_;
+        std::uint64_t source_size_;
+        std::uint64_t source_mtime_;
+        std::uint64_t payload_hash_;
+        std::uint32_t payload_size_;
+        std::uint32_t header_struct_size_;
+    };
+
+    /**
+     * \brief Persistent cache of parsed E32 images.
+     *
+     * Parsing an E32 image means decompressing the code and data sections, and walking
+     * the import and relocation sections. The result is stored on the host and reused on
+     * the next launch.
+     *
+     * Entries are keyed by the image path, and are valid as long as the image size and
+     * modification time stay the same, so a hit does not need to read the image. Images
+     * stored inside a ROFS image all share its modification time, so their offset in it is
+     * also part of the key. Images without a path are keyed by the hash of their content.
+     *
+     * The cache folder is bounded in size. When it grows over the limit, the least recently
+     * written entries are removed.
+     *
+     * Relocation and import fixup are not cached: they depend on where the code segment
+     * is loaded for each process, and on the export tables of dependencies which may be
+     * replaced between launches.
+     */
+    class e32img_cache {
+        std::string cache_dir_;
+        std::mutex write_lock_;
+
+        std::uint64_t max_size_;
+        std::uint64_t total_size_; ///< Size of all entries in the folder. Guarded by the write lock.
+
+        std::atomic<std::size_t> hits_;
+        std::atomic<std::size_t> misses_;
+        std::atomic<std::size_t> evictions_;
+
+        std::string cache_file_path(const std::uint64_t key) const;
+
+        std::optional<e32img> read_cache(const std::string &path, const std::uint64_t key, const std::uint64_t size,
+            const std::uint64_t mtime);
+        bool write_cache(const std::string &path, e32img &img, const std::uint64_t key, const std::uint64_t size,
+            const std::uint64_t mtime);
+
+        /**
+         * \brief Remove the oldest entries until the folder fits in the size limit. Needs the write lock.
+         */
+        void evict_no_lock(const std::string &keep_path);
+
+    public:
+        explicit e32img_cache(const std::string &cache_dir, const std::uint64_t max_size = E32IMG_CACHE_DEFAULT_MAX_SIZE);
+
+        /**
+         * \brief Parse an E32 image, using the cached result when available.
+         *
+         * On cache miss, the image is parsed normally and the result is written to the cache.
+         *
+         * \param stream        The stream containing the whole E32 image.
+         * \param source_path   Path of the image. If empty, the entry is keyed by the image content.
+         * \param source_mtime  Last modification time of the image. Ignored if the path is empty.
+         * \param source_offset Offset of the image in the filesystem image storing it, 0 if it's a
+         *                      standalone file. Ignored if the path is empty.
+         *
+         * \returns Parsed image, nullopt if the image is invalid.
+         */
+        std::optional<e32img> parse(common::ro_stream *stream, const std::u16string &source_path = u"",
+            const std::uint64_t source_mtime = 0, const std::uint64_t source_offset = 0);
+
+        std::size_t hits() const {
+            return hits_;
+        }
+
+        std::size_t misses() const {
+            return misses_;
+        }
+
+        std::size_t evictions() const {
+            return evictions_;
+        }
+    };
+
+    /**
+     * \brief Serialize/deserialize a parsed E32 image, excluding runtime states.
+     */
+    void absorb_e32img(common::chunkyseri &seri, e32img &img);
+}
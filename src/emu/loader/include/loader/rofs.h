@@ -22,6 +22,7 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace eka2l1::common {
@@ -78,4 +79,57 @@ namespace eka2l1::loader {
 
     bool dump_rofs_system(common::ro_stream &stream, const std::string &path, std::atomic<int> &progress,
         const int max_progress = 100);
+
+    struct rofs_index_entry {
+        std::u16string name_;
+        std::uint32_t offset_;                  ///< Offset of file data from the start of the image.
+        std::uint32_t size_;
+        std::uint8_t att_;
+        bool is_dir_;
+        std::vector<std::uint32_t> children_;   ///< Index of entries in this directory.
+    };
+
+    /**
+     * \brief Lookup table of all entries in a ROFS image, built once when the image is mounted.
+     * 
+     * Entry at index 0 is the root directory.
+     */
+    struct rofs_index {
+        std::vector<rofs_index_entry> entries_;
+        std::unordered_map<std::u16string, std::uint32_t> lookup_;
+        std::uint64_t time_;
+
+        /**
+         * \brief Find an entry in the index.
+         * 
+         * \param path Path with or without the drive, case insensitive.
+         * \returns Nullptr if the entry does not exist.
+         */
+        const rofs_index_entry *find(const std::u16string &path) const;
+    };
+
+    /**
+     * \brief Build a lookup table of an ROFS image without extracting anything.
+     * 
+     * \param stream   Stream to the image.
+     * \param index    The index to fill.
+     * 
+     * \returns False if the image is corrupted or not supported.
+     */
+    bool build_rofs_index(common::ro_stream &stream, rofs_index &index);
+
+    /**
+     * \brief Extract files directly under a directory of an indexed ROFS image.
+     * 
+     * Used for the few files the host needs to read before the image is mounted.
+     * 
+     * \param stream       Stream to the image.
+     * \param index        Index built from the image.
+     * \param dir_path     Path of the directory in the image.
+     * \param dest_path    Host directory to extract to.
+     * 
+     * \returns False if the directory does not exist in the image.
+     */
+    bool extract_rofs_directory_files(common::ro_stream &stream, const rofs_index &index, const std::u16string &dir_path,
+        const std::string &dest_path);
 }
\ No newline at end of file
@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace eka2l1 {
@@ -225,8 +226,20 @@ namespace eka2l1 {
 
             root_dir_list root;
 
+            // Flattened index of every file in the first root directory. The key is the
+            // lowercased path without the drive (for example: \sys\bin\euser.dll).
+            std::unordered_map<std::u16string, rom_entry> file_index;
+
+            /**
+             * @brief Walk the whole burned tree once and fill the flattened file index.
+             * 
+             * This is called by load_rom, so normally there is no need to call it again.
+             */
+            void build_file_index();
+
             loader::rom_dir *burn_tree_find_dir(const std::string &vir_path);
             std::optional<loader::rom_entry> burn_tree_find_entry(const std::string &vir_path);
+            std::optional<loader::rom_entry> burn_tree_find_entry(const std::u16string &vir_path);
         };
 
         enum rom_defrag_error {
@@ -127,6 +127,7 @@ namespace eka2l1::loader {
 
         std::vector<std::uint8_t> unicode_flag_array;
         std::vector<std::uint8_t> res_data;
+        std::vector<std::uint8_t> dict_data;
 
         std::vector<std::uint16_t> resource_offsets;
         std::vector<std::uint16_t> dict_offsets;
@@ -152,13 +153,34 @@ namespace eka2l1::loader {
         bool confirm_signature() override;
     };
 
+    /**
+     * \brief A resource file.
+     *
+     * Resources read are kept in a size-bounded cache shared by all resource files, so reopening the
+     * same file does not decompress them again. Files opened with a path are keyed by the path, size,
+     * modification time and offset in the filesystem image storing them. Others are keyed by the hash
+     * of their content.
+     */
     class rsc_file {
     protected:
         std::unique_ptr<rsc_file_impl_base> impl_;
-        void instantiate_impl(common::ro_stream *stream);
+        std::uint64_t source_key_;
+
+        void instantiate_impl(common::ro_stream *stream, const std::u16string &source_path,
+            const std::uint64_t source_mtime, const std::uint64_t source_offset);
 
     public:
-        explicit rsc_file(common::ro_stream *stream);
+        /**
+         * \brief Open a resource file.
+         *
+         * \param stream        The stream containing the whole resource file.
+         * \param source_path   Path of the file. If empty, cached resources are keyed by the file content.
+         * \param source_mtime  Last modification time of the file. Ignored if the path is empty.
+         * \param source_offset Offset of the file in the filesystem image storing it, 0 if it's a
+         *                      standalone file. Ignored if the path is empty.
+         */
+        explicit rsc_file(common::ro_stream *stream, const std::u16string &source_path = u"",
+            const std::uint64_t source_mtime = 0, const std::uint64_t source_offset = 0);
         
         std::vector<std::uint8_t> read(const int res_id);
         std::uint32_t get_uid(const int idx);
@@ -166,6 +188,11 @@ namespace eka2l1::loader {
         bool confirm_signature();
     };
 
+    /**
+     * \brief Set the maximum total size in bytes of resources kept by the shared resource cache.
+     */
+    void set_resource_cache_capacity(const std::size_t capacity);
+
     void absorb_resource_string(common::chunkyseri &seri, std::u16string &str);
 
     template <typename T>
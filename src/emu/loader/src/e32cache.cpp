@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <loader/e32cache.h>
+
+#include <common/algorithm.h>
+#include <common/buffer.h>
+#include <common/chunkyseri.h>
+#include <common/cvt.h>
+#include <common/fileutils.h>
+#include <common/log.h>
+#include <common/path.h>
+#include <common/random.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <vector>
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+namespace eka2l1::loader {
+    static void absorb_reloc_section(common::chunkyseri &seri, e32_reloc_section &section) {
+        seri.absorb(section.size);
+        seri.absorb(section.num_relocs);
+
+        seri.absorb_container(section.entries, [](common::chunkyseri &seri, e32_reloc_entry &entry) {
+            seri.absorb(entry.base);
+            seri.absorb(entry.size);
+            seri.absorb_container(entry.rels_info);
+        });
+    }
+
+    void absorb_e32img(common::chunkyseri &seri, e32img &img) {
+        seri.absorb(img.epoc_ver);
+
+        // Both headers are plain data, the cache header guards their layout
+        seri.absorb_impl(reinterpret_cast<std::uint8_t *>(&img.header), sizeof(e32img_header));
+        seri.absorb_impl(reinterpret_cast<std::uint8_t *>(&img.header_extended), sizeof(e32img_header_extended));
+
+        std::uint8_t has_extended = img.has_extended_header;
+        seri.absorb(has_extended);
+        img.has_extended_header = has_extended;
+
+        seri.absorb(img.uncompressed_size);
+
+        std::uint32_t data_size = static_cast<std::uint32_t>(img.data.size());
+        seri.absorb(data_size);
+
+        if (seri.get_seri_mode() == common::SERI_MODE_READ) {
+            img.data.resize(data_size);
+        }
+
+        seri.absorb_impl(reinterpret_cast<std::uint8_t *>(img.data.data()), data_size);
+
+        seri.absorb_container(img.ed.syms);
+        seri.absorb(img.iat.number_imports);
+        seri.absorb_container(img.iat.its);
+
+        seri.absorb(img.import_section.size);
+        seri.absorb_container(img.import_section.imports, [](common::chunkyseri &seri, e32img_import_block &block) {
+            seri.absorb(block.dll_name_offset);
+            seri.absorb(block.number_of_imports);
+            seri.absorb_container(block.ordinals);
+            seri.absorb(block.dll_name);
+        });
+
+        absorb_reloc_section(seri, img.code_reloc_section);
+        absorb_reloc_section(seri, img.data_reloc_section);
+
+        seri.absorb_container(img.dll_names);
+    }
+
+    e32img_cache::e32img_cache(const std::string &cache_dir, const std::uint64_t max_size)
+        : cache_dir_(cache_dir)
+        , max_size_(max_size)
+        , total_size_(0)
+        , hits_(0)
+        , misses_(0)
+        , evictions_(0) {
+        if (cache_dir_.empty()) {
+            return;
+        }
+
+        eka2l1::create_directories(cache_dir_);
+
+        common::dir_iterator ite(cache_dir_);
+        ite.detail = true;
+
+        common::dir_entry entry;
+
+        while (ite.next_entry(entry) == 0) {
+            if ((entry.type == common::FILE_REGULAR) && (eka2l1::path_extension(entry.name) == ".e32c")) {
+                total_size_ += entry.size;
+            }
+        }
+    }
+
+    std::string e32img_cache::cache_file_path(const std::uint64_t key) const {
+        return eka2l1::add_path(cache_dir_, fmt::format("{:016x}.e32c", key));
+    }
+
+    std::optional<e32img> e32img_cache::read_cache(const std::string &path, const std::uint64_t key, const std::uint64_t size,
+        const std::uint64_t mtime) {
+        common::ro_std_file_stream cache_stream(path, true);
+        if (!cache_stream.valid()) {
+            return std::nullopt;
+        }
+
+        e32img_cache_header header;
+        if (cache_stream.read(&header, sizeof(header)) != sizeof(header)) {
+            return std::nullopt;
+        }
+
+        if ((header.magic_ != E32IMG_CACHE_MAGIC) || (header.version_ != E32IMG_CACHE_VERSION)
+            || (header.source_key_ != key) || (header.source_size_ != size) || (header.source_mtime_ != mtime)
+            || (header.header_struct_size_ != sizeof(e32img_header) + sizeof(e32img_header_extended))) {
+            return std::nullopt;
+        }
+
+        std::vector<std::uint8_t> payload(header.payload_size_);
+        if (cache_stream.read(payload.data(), payload.size()) != payload.size()) {
+            return std::nullopt;
+        }
+
+        // The serializer does not check bounds of strings and containers, so verify the payload first
+        if (XXH64(payload.data(), payload.size(), 0) != header.payload_hash_) {
+            LOG_WARN(LOADER, "Cached image {} is corrupted, reparsing", path);
+            return std::nullopt;
+        }
+
+        e32img img{};
+
+        common::chunkyseri seri(payload.data(), payload.size(), common::SERI_MODE_READ);
+        absorb_e32img(seri, img);
+
+        if (seri.size() != payload.size()) {
+            return std::nullopt;
+        }
+
+        return img;
+    }
+
+    bool e32img_cache::write_cache(const std::string &path, e32img &img, const std::uint64_t key, const std::uint64_t size,
+        const std::uint64_t mtime) {
+        common::chunkyseri measurer(nullptr, 0, common::SERI_MODE_MEASURE);
+        absorb_e32img(measurer, img);
+
+        std::vector<std::uint8_t> payload(measurer.size());
+        common::chunkyseri seri(payload.data(), payload.size(), common::SERI_MODE_WRITE);
+        absorb_e32img(seri, img);
+
+        e32img_cache_header header;
+        header.magic_ = E32IMG_CACHE_MAGIC;
+        header.version_ = E32IMG_CACHE_VERSION;
+        header.source_key_ = key;
+        header.source_size_ = size;
+        header.source_mtime_ = mtime;
+        header.payload_hash_ = XXH64(payload.data(), payload.size(), 0);
+        header.payload_size_ = static_cast<std::uint32_t>(payload.size());
+        header.header_struct_size_ = sizeof(e32img_header) + sizeof(e32img_header_extended);
+
+        const std::lock_guard<std::mutex> guard(write_lock_);
+
+        // Write to a temporary file then move it in, so a crash never leaves a half-written entry.
+        // The name is unique, as other emulator instances may share the folder.
+        const std::string temp_path = fmt::format("{}.{:08x}.tmp", path, eka2l1::random());
+
+        bool written = false;
+
+        {
+            common::wo_std_file_stream cache_stream(temp_path, true);
+            if (!cache_stream.valid()) {
+                return false;
+            }
+
+            written = (cache_stream.write(&header, sizeof(header)) == sizeof(header))
+                && (cache_stream.write(payload.data(), payload.size()) == payload.size());
+        }
+
+        if (!written) {
+            common::remove(temp_path);
+            return false;
+        }
+
+        // An outdated entry of the same image is replaced
+        const std::int64_t old_size = common::file_size(path);
+
+        if (old_size > 0) {
+            total_size_ -= common::min<std::uint64_t>(total_size_, static_cast<std::uint64_t>(old_size));
+        }
+
+        common::remove(path);
+
+        if (!common::move_file(temp_path, path)) {
+            common::remove(temp_path);
+            return false;
+        }
+
+        total_size_ += sizeof(header) + payload.size();
+
+        if (total_size_ > max_size_) {
+            evict_no_lock(path);
+        }
+
+        return true;
+    }
+
+    void e32img_cache::evict_no_lock(const std::string &keep_path) {
+        struct cache_file {
+            std::string path_;
+            std::uint64_t size_;
+            std::uint64_t mtime_;
+        };
+
+        std::vector<cache_file> files;
+
+        common::dir_iterator ite(cache_dir_);
+        ite.detail = true;
+
+        common::dir_entry entry;
+        total_size_ = 0;
+
+        while (ite.next_entry(entry) == 0) {
+            if ((entry.type != common::FILE_REGULAR) || (eka2l1::path_extension(entry.name) != ".e32c")) {
+                continue;
+            }
+
+            const std::string path = eka2l1::add_path(cache_dir_, entry.name);
+            total_size_ += entry.size;
+
+            if (path != keep_path) {
+                files.push_back({ path, entry.size, common::get_last_modifiy_since_ad(common::utf8_to_ucs2(path)) });
+            }
+        }
+
+        std::sort(files.begin(), files.end(), [](const cache_file &lhs, const cache_file &rhs) {
+            return lhs.mtime_ < rhs.mtime_;
+        });
+
+        // Leave some room, so the next few writes do not scan the folder again
+        const std::uint64_t target_size = max_size_ / 4 * 3;
+
+        for (const cache_file &file : files) {
+            if (total_size_ <= target_size) {
+                break;
+            }
+
+            if (common::remove(file.path_)) {
+                total_size_ -= common::min(total_size_, file.size_);
+                evictions_++;
+            }
+        }
+    }
+
+    std::optional<e32img> e32img_cache::parse(common::ro_stream *stream, const std::u16string &source_path,
+        const std::uint64_t source_mtime, const std::uint64_t source_offset) {
+        if (cache_dir_.empty()) {
+            return parse_e32img(stream);
+        }
+
+        const std::uint64_t size = stream->size();
+
+        if (!source_path.empty()) {
+            // Look up by path first, a hit does not touch the image at all
+            const std::string key_source = common::ucs2_to_utf8(common::lowercase_ucs2_string(source_path));
+
+            const std::uint64_t key = XXH64(key_source.data(), key_source.size(), source_offset);
+            const std::string path = cache_file_path(key);
+
+            if (auto cached = read_cache(path, key, size, source_mtime)) {
+                hits_++;
+                return cached;
+            }
+
+            misses_++;
+
+            auto img = parse_e32img(stream);
+
+            if (img && !write_cache(path, *img, key, size, source_mtime)) {
+                LOG_WARN(LOADER, "Unable to write parsed image cache to {}", path);
+            }
+
+            return img;
+        }
+
+        std::vector<std::uint8_t> raw(size);
+
+        stream->seek(0, common::seek_where::beg);
+        if (stream->read(raw.data(), raw.size()) != raw.size()) {
+            return std::nullopt;
+        }
+
+        const std::uint64_t key = XXH64(raw.data(), raw.size(), 0);
+        const std::string path = cache_file_path(key);
+
+        if (auto cached = read_cache(path, key, size, 0)) {
+            hits_++;
+            return cached;
+        }
+
+        misses_++;
+
+        common::ro_buf_stream raw_stream(raw.data(), raw.size());
+        auto img = parse_e32img(reinterpret_cast<common::ro_stream *>(&raw_stream));
+
+        if (img && !write_cache(path, *img, key, size, 0)) {
+            LOG_WARN(LOADER, "Unable to write parsed image cache to {}", path);
+        }
+
+        return img;
+    }
+}
@@ -19,16 +19,20 @@
 
 #include <loader/rofs.h>
 #include <common/buffer.h>
+#include <common/algorithm.h>
 #include <common/log.h>
 
 #include <common/path.h>
 #include <common/cvt.h>
 
+#include <algorithm>
+
 namespace eka2l1::loader {
     bool rofs_entry::read(common::ro_stream &stream, const int version) {
         const std::uint64_t start_pos = stream.tell();
 
-        if (stream.read(&struct_size_, 2) != 2) {
+        // Zero sized entry would never advance the stream
+        if ((stream.read(&struct_size_, 2) != 2) || (struct_size_ == 0)) {
             return false;
         }
 
@@ -235,4 +239,163 @@ namespace eka2l1::loader {
         progress = base_progress + max_progress;
         return true;
     }
+
+    static std::u16string normalize_rofs_path(const std::u16string &path) {
+        std::u16string result = common::lowercase_ucs2_string(path);
+        std::replace(result.begin(), result.end(), u'/', u'\\');
+
+        // Strip the drive
+        if ((result.length() >= 2) && (result[1] == u':')) {
+            result.erase(0, 2);
+        }
+
+        if (result.empty() || (result[0] != u'\\')) {
+            result.insert(result.begin(), u'\\');
+        }
+
+        while ((result.length() > 1) && (result.back() == u'\\')) {
+            result.pop_back();
+        }
+
+        return result;
+    }
+
+    static bool index_directory(common::ro_stream &stream, rofs_index &index, const std::uint32_t dir_index,
+        const std::u16string &dir_path, const int version, const int file_offset, const std::uint32_t offset,
+        const int depth) {
+        // Corrupted images may have looping directories
+        static constexpr int MAX_DIRECTORY_DEPTH = 64;
+
+        if (depth > MAX_DIRECTORY_DEPTH) {
+            return false;
+        }
+
+        stream.seek(offset - file_offset, common::seek_where::beg);
+
+        rofs_dir dir_var;
+        if (!dir_var.read(stream, version)) {
+            return false;
+        }
+
+        auto child_path = [&](const rofs_entry &source) {
+            return ((dir_path == u"\\") ? u"" : dir_path) + u"\\" + source.filename_;
+        };
+
+        auto add_entry = [&](const rofs_entry &source, const bool is_dir) -> std::uint32_t {
+            rofs_index_entry entry;
+            entry.name_ = source.filename_;
+            entry.offset_ = source.file_addr_ - file_offset;
+            entry.size_ = source.file_size_;
+            entry.att_ = source.att_;
+            entry.is_dir_ = is_dir;
+
+            const std::uint32_t new_index = static_cast<std::uint32_t>(index.entries_.size());
+            index.entries_.push_back(std::move(entry));
+            index.entries_[dir_index].children_.push_back(new_index);
+            index.lookup_[normalize_rofs_path(child_path(source))] = new_index;
+
+            return new_index;
+        };
+
+        if (dir_var.file_block_addr_ - file_offset) {
+            stream.seek(dir_var.file_block_addr_ - file_offset, common::seek_where::beg);
+
+            while (stream.tell() - (dir_var.file_block_addr_ - file_offset) < dir_var.file_block_size_) {
+                rofs_entry file_entry;
+                if (!file_entry.read(stream, version)) {
+                    return false;
+                }
+
+                add_entry(file_entry, false);
+            }
+        }
+
+        for (auto &subdir_ent: dir_var.subdirs_) {
+            const std::uint32_t subdir_index = add_entry(subdir_ent, true);
+            const std::u16string subdir_path = normalize_rofs_path(child_path(subdir_ent));
+
+            if (!index_directory(stream, index, subdir_index, subdir_path, version, file_offset,
+                subdir_ent.file_addr_, depth + 1)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool build_rofs_index(common::ro_stream &stream, rofs_index &index) {
+        rofs_header rheader;
+        if (stream.read(&rheader, sizeof(rofs_header)) != sizeof(rofs_header)) {
+            return false;
+        }
+
+        if (!supported_format(rheader)) {
+            return false;
+        }
+
+        index.entries_.clear();
+        index.lookup_.clear();
+        index.time_ = rheader.time_;
+
+        rofs_index_entry root;
+        root.offset_ = 0;
+        root.size_ = 0;
+        root.att_ = 0x10;
+        root.is_dir_ = true;
+
+        index.entries_.push_back(std::move(root));
+        index.lookup_[u"\\"] = 0;
+
+        const int file_offset = rheader.dir_tree_offset_ - rheader.header_size_;
+        return index_directory(stream, index, 0, u"\\", rheader.rofs_format_version_, file_offset,
+            rheader.dir_tree_offset_, 0);
+    }
+
+    const rofs_index_entry *rofs_index::find(const std::u16string &path) const {
+        auto result = lookup_.find(normalize_rofs_path(path));
+
+        if (result == lookup_.end()) {
+            return nullptr;
+        }
+
+        return &entries_[result->second];
+    }
+
+    bool extract_rofs_directory_files(common::ro_stream &stream, const rofs_index &index, const std::u16string &dir_path,
+        const std::string &dest_path) {
+        const rofs_index_entry *dir_entry = index.find(dir_path);
+
+        if (!dir_entry || !dir_entry->is_dir_) {
+            return false;
+        }
+
+        eka2l1::create_directories(dest_path);
+        std::vector<char> buf;
+
+        for (const std::uint32_t child: dir_entry->children_) {
+            const rofs_index_entry &entry = index.entries_[child];
+
+            if (entry.is_dir_) {
+                continue;
+            }
+
+            std::string fname = common::ucs2_to_utf8(entry.name_);
+            if (common::is_platform_case_sensitive()) {
+                fname = common::lowercase_string(fname);
+            }
+
+            buf.resize(entry.size_);
+            stream.seek(entry.offset_, common::seek_where::beg);
+
+            if (stream.read(buf.data(), buf.size()) != buf.size()) {
+                LOG_WARN(LOADER, "Can't read file {} from ROFS image", fname);
+                continue;
+            }
+
+            std::ofstream extract_stream(add_path(dest_path, fname), std::ios_base::binary);
+            extract_stream.write(buf.data(), buf.size());
+        }
+
+        return true;
+    }
 }
\ No newline at end of file
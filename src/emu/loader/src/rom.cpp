@@ -66,24 +66,89 @@ namespace eka2l1::loader {
         return last_dir_found;
     }
 
-    std::optional<loader::rom_entry> rom::burn_tree_find_entry(const std::string &vir_path) {
-        loader::rom_dir *last_dir_found = burn_tree_find_dir(eka2l1::file_directory(vir_path, true));
+    static void add_dir_to_file_index(std::unordered_map<std::u16string, rom_entry> &index, const rom_dir &dir,
+        const std::u16string &base) {
+        for (const auto &entry: dir.entries) {
+            if (entry.dir) {
+                continue;
+            }
 
-        if (!last_dir_found) {
-            return std::nullopt;
+            std::u16string key = base;
+            key += u'\\';
+            key += common::lowercase_ucs2_string(entry.name);
+
+            index.emplace(std::move(key), entry);
+        }
+
+        for (const auto &subdir: dir.subdirs) {
+            std::u16string new_base = base;
+            new_base += u'\\';
+            new_base += common::lowercase_ucs2_string(subdir.name);
+
+            add_dir_to_file_index(index, subdir, new_base);
+        }
+    }
+
+    /**
+     * @brief Turn a virtual path into a key of the flattened file index.
+     * 
+     * The drive is stripped, separators are unified to backslash, duplicated separators are merged
+     * and the whole path is lowercased.
+     */
+    static std::u16string make_file_index_key(const std::u16string &vir_path) {
+        std::size_t start = 0;
+
+        if ((vir_path.length() >= 2) && (vir_path[1] == u':')) {
+            start = 2;
+        }
+
+        std::u16string key;
+        key.reserve(vir_path.length() - start + 1);
+
+        for (std::size_t i = start; i < vir_path.length(); i++) {
+            char16_t c = vir_path[i];
+
+            if ((c == u'/') || (c == u'\\')) {
+                if (!key.empty() && (key.back() == u'\\')) {
+                    continue;
+                }
+
+                key += u'\\';
+                continue;
+            }
+
+            if (key.empty()) {
+                key += u'\\';
+            }
+
+            key += c;
         }
 
-        loader::rom_entry temp_entry;
-        temp_entry.name = common::utf8_to_ucs2(eka2l1::filename(vir_path, true));
+        return common::lowercase_ucs2_string(key);
+    }
 
-        auto res2 = std::lower_bound(last_dir_found->entries.begin(), last_dir_found->entries.end(), temp_entry,
-            [](const loader::rom_entry &lhs, const loader::rom_entry &rhs) { return common::compare_ignore_case(lhs.name, rhs.name) == -1; });
+    void rom::build_file_index() {
+        file_index.clear();
 
-        if (res2 != last_dir_found->entries.end() && !res2->dir && (common::compare_ignore_case(temp_entry.name, res2->name) == 0)) {
-            return *res2;
+        if (root.root_dirs.empty()) {
+            return;
         }
 
-        return std::nullopt;
+        add_dir_to_file_index(file_index, root.root_dirs[0].dir, u"");
+    }
+
+    std::optional<loader::rom_entry> rom::burn_tree_find_entry(const std::u16string &vir_path) {
+        auto result = file_index.find(make_file_index_key(vir_path));
+
+        if (result == file_index.end()) {
+            return std::nullopt;
+        }
+
+        return result->second;
+    }
+
+    std::optional<loader::rom_entry> rom::burn_tree_find_entry(const std::string &vir_path) {
+        return burn_tree_find_entry(common::utf8_to_ucs2(vir_path));
     }
 
     uint32_t rom_to_offset(address romstart, address off) {
@@ -282,6 +347,7 @@ namespace eka2l1::loader {
             common::seek_where::beg);
 
         romf.root = read_root_dir_list(romf, stream);
+        romf.build_file_index();
 
         return romf;
     }
@@ -25,15 +25,33 @@
 #include <common/bytes.h>
 #include <common/buffer.h>
 #include <common/chunkyseri.h>
+#include <common/cvt.h>
 #include <common/dictcomp.h>
 #include <common/log.h>
 #include <common/unicode.h>
 
+#include <common/lru.h>
+
 #include <loader/rsc.h>
 
-#include <stack>
+#define XXH_INLINE_ALL
+#include <xxhash.h>
 
 namespace eka2l1::loader {
+    static constexpr std::size_t MAX_DICTIONARY_STREAM_DEPTH = 32;
+    static constexpr std::size_t DEFAULT_RESOURCE_CACHE_CAPACITY = 4 * 1024 * 1024;
+
+    using resource_cache_key = std::pair<std::uint64_t, int>;
+
+    static common::lru_cache<resource_cache_key, std::vector<std::uint8_t>> &get_resource_cache() {
+        static common::lru_cache<resource_cache_key, std::vector<std::uint8_t>> cache(DEFAULT_RESOURCE_CACHE_CAPACITY);
+        return cache;
+    }
+
+    void set_resource_cache_capacity(const std::size_t capacity) {
+        get_resource_cache().set_capacity(capacity);
+    }
+
     /*
        The header format should be readed like this:
        - First 12 bytes should contain 3 UID type
@@ -144,46 +162,57 @@ namespace eka2l1::loader {
             return read_size_bytes;
         }
 
-        std::stack<common::dictcomp> streams;
+        const bool is_calypso = (flags & calypso);
+        const int num_bits = num_of_bits_use_for_dict_token;
 
-        auto append_dictcomp_stream = [&](int resource_index) {
-            std::uint16_t begin_bits = resource_offsets[resource_index - 1];
-            std::uint16_t end_bits = resource_offsets[resource_index];
+        // Dictionary entries may reference other entries. The top stream is always the one being decoded,
+        // the ones below resume where they left when it ends.
+        std::vector<common::dictcomp> streams;
+        streams.reserve(MAX_DICTIONARY_STREAM_DEPTH);
 
-            // I don't use any cache though
-            common::dictcomp comp_stream(&res_data[0], begin_bits, end_bits, num_of_bits_use_for_dict_token);
-            streams.push(std::move(comp_stream));
-        };
+        const int res_begin_bits = (res_index > 0) ? resource_offsets[res_index - 1] : 0;
+        streams.emplace_back(res_data.data(), static_cast<int>(res_data.size()), res_begin_bits, resource_offsets[res_index], num_bits);
 
-        append_dictcomp_stream(res_index);
-
-        bool is_calypso = (flags & calypso);
+        common::dictcomp::token tok;
         int total_bytes = 0;
 
-        for (;;) {
-            if (streams.empty()) {
-                break;
+        while (!streams.empty()) {
+            common::dictcomp &comp_stream = streams.back();
+
+            if (comp_stream.eos()) {
+                streams.pop_back();
+                continue;
             }
 
-            common::dictcomp comp_stream = std::move(streams.top());
-            streams.pop();
+            if (!comp_stream.next_token(tok, is_calypso)) {
+                LOG_ERROR(LOADER, "Dictionary compressed token goes past the end of stream");
+                return -1;
+            }
 
-            for (;;) {
-                const int index_of_dict_entry = comp_stream.index_of_current_directory_entry();
-                if (index_of_dict_entry < 0) {
-                    int result = comp_stream.read(buffer, max, is_calypso);
+            if (tok.is_dict_entry) {
+                if ((tok.dict_index >= static_cast<int>(dict_offsets.size())) || (streams.size() >= MAX_DICTIONARY_STREAM_DEPTH)) {
+                    LOG_ERROR(LOADER, "Invalid dictionary entry reference {}", tok.dict_index);
+                    return -1;
+                }
 
-                    if (result == -1) {
-                        return result;
-                    }
+                const int dict_begin_bits = (tok.dict_index > 0) ? dict_offsets[tok.dict_index - 1] : 0;
+                streams.emplace_back(dict_data.data(), static_cast<int>(dict_data.size()), dict_begin_bits,
+                    dict_offsets[tok.dict_index], num_bits);
 
-                    total_bytes += result;
-                    max -= result;
-                } else {
-                    append_dictcomp_stream(index_of_dict_entry);
-                    break;
-                }
+                continue;
+            }
+
+            if (tok.literal_size > max - total_bytes) {
+                LOG_ERROR(LOADER, "Can't decompress: unsufficent memory (needed: 0x{:X} vs provided 0x{:X})",
+                    total_bytes + tok.literal_size, max);
+                return -1;
             }
+
+            if (!comp_stream.read_literal(buffer + total_bytes, tok.literal_size)) {
+                return -1;
+            }
+
+            total_bytes += tok.literal_size;
         }
 
         return total_bytes;
@@ -276,8 +305,9 @@ namespace eka2l1::loader {
                     flags |= first_res_generated_bit_array_of_res_contains_compressed_unicode;
                 }
 
-                // After the flag and some two byte
-                res_offset = 19;
+                // After the flag and the size of largest resource is the start of resource data
+                buf->read(19, &res_offset, sizeof(res_offset));
+
                 std::uint16_t num_bits_of_res_data = 0;
 
                 buf->read(buf->size() - 2, &num_bits_of_res_data, 2);
@@ -314,6 +344,9 @@ namespace eka2l1::loader {
                 dict_offsets.resize(num_entries);
                 buf->read(dict_index_offset, &dict_offsets[0], 2 * num_entries);
 
+                dict_data.resize(dict_index_offset - dict_offset);
+                buf->read(dict_offset, dict_data.data(), static_cast<std::uint32_t>(dict_data.size()));
+
                 // the bottom 3 bits of firstByteAfterUids stores the number of bits used for
                 // dictionary tokens as an offset from 3, e.g. if 2 is stored in these three bits
                 // then the number of bits per dictionary token would be 3+2=5 - this allows a
@@ -739,24 +772,42 @@ namespace eka2l1::loader {
     rsc_file_legacy::~rsc_file_legacy() {
     }
 
-    void rsc_file::instantiate_impl(common::ro_stream *stream) {
-        std::uint32_t uid = 0;
-        if (stream->read(&uid, 4) != 4) {
+    void rsc_file::instantiate_impl(common::ro_stream *stream, const std::u16string &source_path,
+        const std::uint64_t source_mtime, const std::uint64_t source_offset) {
+        std::vector<std::uint8_t> content(stream->size());
+        if ((content.size() < 4) || (stream->read(content.data(), content.size()) != content.size())) {
             return;
         }
 
-        stream->seek(0, common::seek_where::beg);
+        if (!source_path.empty()) {
+            // The path with the size and time identifies the content, no need to hash all of it
+            const std::uint64_t identity[3] = { content.size(), source_mtime, source_offset };
+            const std::string key_source = common::ucs2_to_utf8(common::lowercase_ucs2_string(source_path));
+
+            source_key_ = XXH64(key_source.data(), key_source.size(), XXH64(identity, sizeof(identity), 0));
+        } else {
+            source_key_ = XXH64(content.data(), content.size(), 0);
+        }
+
+        std::uint32_t uid = 0;
+        std::memcpy(&uid, content.data(), 4);
+
+        // Parse from the bytes already read and hashed, instead of going through the source stream again.
+        // Both implementations copy what they need out of the stream while constructing.
+        common::ro_buf_stream content_stream(content.data(), content.size());
 
         if ((uid == 0x101F4A6B) || (uid == 0x101F5010)) {
-            impl_ = std::make_unique<rsc_file_morden>(stream);
+            impl_ = std::make_unique<rsc_file_morden>(&content_stream);
             return;
         }
 
-        impl_ = std::make_unique<rsc_file_legacy>(stream);
+        impl_ = std::make_unique<rsc_file_legacy>(&content_stream);
     }
     
-    rsc_file::rsc_file(common::ro_stream *seri) {
-        instantiate_impl(seri);
+    rsc_file::rsc_file(common::ro_stream *seri, const std::u16string &source_path, const std::uint64_t source_mtime,
+        const std::uint64_t source_offset)
+        : source_key_(0) {
+        instantiate_impl(seri, source_path, source_mtime, source_offset);
     }
 
     std::vector<std::uint8_t> rsc_file::read(const int res_id) {
@@ -765,7 +816,21 @@ namespace eka2l1::loader {
             return std::vector<std::uint8_t>{};
         }
 
-        return impl_->read(res_id);
+        auto &cache = get_resource_cache();
+        const resource_cache_key key{ source_key_, res_id };
+
+        if (auto cached = cache.get(key)) {
+            return std::move(*cached);
+        }
+
+        std::vector<std::uint8_t> data = impl_->read(res_id);
+
+        // Failed reads may succeed later (e.g. after the signature is confirmed), don't remember them
+        if (!data.empty()) {
+            cache.put(key, data, data.size());
+        }
+
+        return data;
     }
 
     std::uint32_t rsc_file::get_uid(const int idx) {
@@ -32,6 +32,7 @@ namespace eka2l1::common {
 
 namespace eka2l1::mem {
     class control_base;
+    class cow_template;
     class mmu_base;
 
     struct mem_model_process;
@@ -78,12 +79,34 @@ namespace eka2l1::mem {
         virtual const std::size_t committed() const = 0;
         virtual const std::size_t max() const = 0;
 
+        /**
+         * \brief Get the size of committed memory that currently takes physical host memory.
+         * 
+         * Committed pages are only backed by the host once they are touched, so this is at most committed().
+         */
+        std::size_t resident();
+
         virtual const vm_address base(mem_model_process *process) = 0;
         virtual std::size_t commit(const vm_address offset, const std::size_t size) = 0;
         virtual void decommit(const vm_address offset, const std::size_t size) = 0;
 
         virtual void *host_base() = 0;
 
+        /**
+         * \brief Replace the content of committed memory with a copy-on-write view of a template.
+         * 
+         * The region must already be committed. Guest addresses and host pointers of the region
+         * stay the same, only the backing pages change.
+         * 
+         * \param offset Offset of the region in the chunk, aligned to host page size.
+         * \param templ  The template to map. Its size is the size of the region.
+         * 
+         * \returns True on success. On failure, the region is left untouched and should be filled normally.
+         */
+        virtual bool map_template(const vm_address offset, const cow_template &templ) {
+            return false;
+        }
+
         /**
          * \brief Unmap the committed chunk region from the CPU.
          * 
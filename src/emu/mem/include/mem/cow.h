@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eka2l1::mem {
+    /**
+     * \brief Read-only snapshot of memory, that can be mapped copy-on-write into chunks.
+     *
+     * Every chunk the template is mapped to shares the same host pages, until a page is written,
+     * at which point the writer gets its own private copy of it.
+     */
+    class cow_template {
+        std::int64_t handle_;
+        std::size_t size_;
+
+    public:
+        /**
+         * \brief Snapshot the given memory.
+         *
+         * Check valid() after construction, the host may not support copy-on-write mapping.
+         */
+        explicit cow_template(const void *data, const std::size_t size);
+        ~cow_template();
+
+        cow_template(const cow_template &) = delete;
+        cow_template &operator=(const cow_template &) = delete;
+
+        bool valid() const {
+            return handle_ >= 0;
+        }
+
+        std::size_t size() const {
+            return size_;
+        }
+
+        /**
+         * \brief Replace host memory with a copy-on-write view of this template.
+         *
+         * The template size and the destination must both be aligned to the host page size.
+         *
+         * \param dest Pointer to the memory to replace.
+         * \param perm Permission of the mapped pages.
+         *
+         * \returns True on success. On failure, the destination memory is left untouched.
+         */
+        bool map(void *dest, const prot perm) const;
+    };
+}
@@ -39,6 +39,9 @@ namespace eka2l1 {
 
         struct page_table_allocator;
         using page_table_allocator_impl = std::unique_ptr<page_table_allocator>;
+
+        class access_tracer;
+        using access_tracer_impl = std::unique_ptr<access_tracer>;
     }
 
     namespace arm {
@@ -54,6 +57,7 @@ namespace eka2l1 {
 
         mem::control_impl impl_;
         mem::page_table_allocator_impl alloc_;
+        mem::access_tracer_impl tracer_;
 
         void *rom_map_;
         std::size_t rom_size_;
@@ -75,6 +79,14 @@ namespace eka2l1 {
             return impl_->model_type();
         }
 
+        /**
+         * \brief Get the guest memory access tracer, enabled through the mem-trace-path option.
+         * \returns Nullptr if tracing is disabled.
+         */
+        mem::access_tracer *get_access_tracer() {
+            return tracer_.get();
+        }
+
         mem::mmu_base *get_mmu(arm::core *cc);
         const int get_page_size() const;
 
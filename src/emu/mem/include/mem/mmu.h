@@ -34,6 +34,7 @@ namespace eka2l1::config {
 
 namespace eka2l1::mem {
     class control_base;
+    class access_tracer;
 
     /**
      * \brief The base of memory management unit.
@@ -43,6 +44,16 @@ namespace eka2l1::mem {
         friend class control_base;
 
         control_base *manager_;
+        access_tracer *tracer_;
+        std::uint32_t traced_thread_;
+
+        template <typename T>
+        bool read_data(const vm_address addr, T *data);
+
+        template <typename T>
+        bool write_data(const vm_address addr, T *data);
+
+        void fill_tlb(const vm_address addr, page_info *inf);
 
         bool read_8bit_data(const vm_address addr, std::uint8_t *data);
         bool read_16bit_data(const vm_address addr, std::uint16_t *data);
@@ -67,6 +78,22 @@ namespace eka2l1::mem {
         void map_to_cpu(const vm_address addr, const std::size_t size, void *ptr, const prot perm);
         void unmap_from_cpu(const vm_address addr, const std::size_t size);
 
+        /**
+         * \brief Set the tracer that accesses going through this MMU are recorded to.
+         *
+         * Traced pages are kept out of the CPU's TLB, so that every access to them reaches the tracer.
+         */
+        void set_access_tracer(access_tracer *tracer) {
+            tracer_ = tracer;
+        }
+
+        /**
+         * \brief Set the guest thread that traced accesses are attributed to.
+         */
+        void set_traced_thread(const std::uint32_t thread_id) {
+            traced_thread_ = thread_id;
+        }
+
         /**
          * \brief Get host pointer of a virtual address, in the specified address space.
          */
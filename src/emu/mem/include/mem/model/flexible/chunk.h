@@ -67,6 +67,7 @@ namespace eka2l1::mem::flexible {
         void decommit(const vm_address offset, const std::size_t size) override;
 
         bool allocate(const std::size_t size) override;
+        bool map_template(const vm_address offset, const cow_template &templ) override;
 
         void unmap_from_cpu(mem_model_process *pr, mmu_base *mmu) override;
         void map_to_cpu(mem_model_process *pr, mmu_base *mmu) override;
@@ -26,6 +26,7 @@
 
 namespace eka2l1::mem {
     class control_base;
+    class cow_template;
 }
 
 namespace eka2l1::mem::flexible {
@@ -42,6 +43,9 @@ namespace eka2l1::mem::flexible {
         control_base *control_;
         bool external_;
 
+        std::uint32_t template_page_start_; ///< First page backed by a template view.
+        std::uint32_t template_page_end_; ///< Page after the last one backed by a template view.
+
         std::vector<mapping*> mappings_;
 
     public:
@@ -103,5 +107,18 @@ namespace eka2l1::mem::flexible {
          * @returns     True on success.
          */
         bool decommit(const std::uint32_t page_offset, const std::size_t total_pages);
+
+        /**
+         * @brief       Back committed pages with a copy-on-write view of a template.
+         * 
+         * Host pointers of the pages do not change, so mappings need no update.
+         * 
+         * @param       page_offset   Starting page offset of the region.
+         * @param       templ         The template to map. Its size is the size of the region.
+         * @param       perm          The permissions of the pages.
+         * 
+         * @returns     True on success. Memory objects using external host memory can't be remapped.
+         */
+        bool map_template(const std::uint32_t page_offset, const cow_template &templ, const prot perm);
     };
 }
\ No newline at end of file
@@ -46,6 +46,10 @@ namespace eka2l1::mem {
         std::uint16_t granularity_shift_;
 
         std::unique_ptr<common::bitmap_allocator> page_bma_;
+
+        vm_address template_start_{ 0 }; ///< Start of the range backed by template views.
+        vm_address template_end_{ 0 }; ///< End of the range backed by template views.
+
         linear_section *get_section(const std::uint32_t flags);
 
         void do_selection_cpu_memory_manipulation(mmu_base *mmu, const bool unmap);
@@ -83,6 +87,7 @@ namespace eka2l1::mem {
         void decommit(const vm_address offset, const std::size_t size) override;
 
         bool allocate(const std::size_t size) override;
+        bool map_template(const vm_address offset, const cow_template &templ) override;
 
         void unmap_from_cpu(mem_model_process *pr, mmu_base *mmu) override;
         void map_to_cpu(mem_model_process *pr, mmu_base *mmu) override;
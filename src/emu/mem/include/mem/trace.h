@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/ringbuf.h>
+#include <mem/common.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eka2l1::mem {
+    enum access_trace_flags {
+        ACCESS_TRACE_FLAG_WRITE = 1 << 0
+    };
+
+    /**
+     * \brief A single guest memory access, as stored in the trace file.
+     */
+    struct access_trace_record {
+        std::uint32_t pc_;
+        std::uint32_t addr_;
+        std::uint64_t value_;
+        std::uint32_t thread_id_;
+        std::uint16_t asid_;
+        std::uint8_t size_;
+        std::uint8_t flags_;
+    };
+
+    static_assert(sizeof(access_trace_record) == 24, "Access trace record must stay packed");
+
+    static constexpr std::uint32_t ACCESS_TRACE_MAGIC = 0x5254454D; // MEMTR
+    static constexpr std::uint32_t ACCESS_TRACE_VERSION = 1;
+
+    struct access_trace_header {
+        std::uint32_t magic_;
+        std::uint32_t version_;
+        std::uint32_t record_size_;
+        std::uint32_t reserved_;
+    };
+
+    /**
+     * \brief An inclusive start, exclusive end range of guest addresses to trace.
+     */
+    struct access_trace_range {
+        vm_address start_;
+        vm_address end_;
+    };
+
+    /**
+     * \brief Parse trace ranges, in form of "start-end,start-end" with hexadecimal addresses.
+     * \returns False if the string is malformed.
+     */
+    bool parse_access_trace_ranges(const std::string &str, std::vector<access_trace_range> &ranges);
+
+    /**
+     * \brief Record guest memory accesses into a compact binary file.
+     *
+     * Each host thread that records gets its own lock-free ring buffer, so the CPU threads never contend
+     * with each other nor with the file. A background writer drains all buffers to disk, and frees the
+     * buffers of host threads that have exited. When a buffer is full, records are dropped and counted
+     * rather than stalling the guest.
+     *
+     * The filter ranges are fixed on construction, so they can be checked without locking.
+     */
+    class access_tracer {
+        struct producer {
+            common::ring_buffer<access_trace_record> records_;
+            std::atomic<std::uint64_t> dropped_;
+
+            explicit producer(const std::size_t capacity)
+                : records_(capacity)
+                , dropped_(0) {
+            }
+        };
+
+        std::vector<access_trace_range> ranges_;
+        std::size_t buffer_capacity_;
+        std::uint64_t instance_id_;
+
+        std::FILE *file_;
+
+        mutable std::mutex producers_lock_;
+        std::vector<std::shared_ptr<producer>> producers_; ///< Also referenced by the thread recording into each one.
+        std::uint64_t retired_dropped_; ///< Dropped count of freed buffers. Guarded by the producers lock.
+
+        std::thread writer_;
+        std::mutex writer_lock_;
+        std::condition_variable writer_cond_;
+        bool stopping_;
+
+        std::atomic<std::uint64_t> written_;
+
+        producer *get_producer();
+        void writer_loop();
+        bool drain();
+
+    public:
+        /**
+         * \brief Create the tracer and start the writer.
+         *
+         * \param path             Path of the trace file to create.
+         * \param ranges           Address ranges to record. Empty to record everything.
+         * \param buffer_capacity  Number of records each host thread can buffer before dropping.
+         */
+        explicit access_tracer(const std::string &path, const std::vector<access_trace_range> &ranges,
+            const std::size_t buffer_capacity = 64 * 1024);
+
+        ~access_tracer();
+
+        bool is_open() const {
+            return file_ != nullptr;
+        }
+
+        /**
+         * \brief Check if any byte in the given guest range is being traced.
+         */
+        bool should_trace(const vm_address addr, const std::uint32_t size) const;
+
+        void record(const vm_address pc, const vm_address addr, const std::uint64_t value, const asid addr_space,
+            const std::uint32_t thread_id, const std::uint8_t size, const bool is_write);
+
+        /**
+         * \brief Write everything buffered so far to the file.
+         */
+        void flush();
+
+        /**
+         * \brief Get number of records dropped because a buffer was full.
+         */
+        std::uint64_t dropped() const;
+
+        std::uint64_t written() const {
+            return written_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * \brief Get number of per-thread buffers currently registered.
+         */
+        std::size_t producer_count() const;
+    };
+
+    /**
+     * \brief Read all records of a trace file.
+     * \returns False if the file does not exist or is not a trace file.
+     */
+    bool read_access_trace(const std::string &path, std::vector<access_trace_record> &records);
+
+    struct access_trace_hot_address {
+        vm_address addr_;
+        std::uint64_t reads_;
+        std::uint64_t writes_;
+    };
+
+    /**
+     * \brief Find the most accessed addresses, sorted by total number of accesses.
+     */
+    std::vector<access_trace_hot_address> find_hot_addresses(const std::vector<access_trace_record> &records,
+        const std::size_t max_count);
+
+    struct access_trace_shared_line {
+        vm_address line_addr_;
+        std::vector<std::uint32_t> threads_;
+        std::uint64_t writes_;
+    };
+
+    /**
+     * \brief Find cache lines that guest threads falsely share.
+     *
+     * A line is reported when at least two threads touch disjoint bytes of it and at least one of them
+     * writes, meaning the threads would not share data but still bounce the line between cores.
+     *
+     * \param line_size Size of a cache line in bytes, at most 64.
+     */
+    std::vector<access_trace_shared_line> find_false_sharing(const std::vector<access_trace_record> &records,
+        const std::uint32_t line_size);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mem/cow.h>
+
+#include <common/virtualmem.h>
+
+namespace eka2l1::mem {
+    cow_template::cow_template(const void *data, const std::size_t size)
+        : handle_(common::create_memory_file(data, size))
+        , size_(size) {
+    }
+
+    cow_template::~cow_template() {
+        common::close_memory_file(handle_);
+    }
+
+    bool cow_template::map(void *dest, const prot perm) const {
+        const std::size_t host_page_size = static_cast<std::size_t>(common::get_host_page_size());
+
+        // Partial host pages can't be replaced, and would run past the end of the file
+        if (!valid() || (reinterpret_cast<std::uintptr_t>(dest) % host_page_size != 0) || (size_ % host_page_size != 0)) {
+            return false;
+        }
+
+        return common::map_memory_file_private(dest, size_, handle_, perm);
+    }
+}
@@ -23,12 +23,14 @@
 #include <common/log.h>
 #include <common/virtualmem.h>
 
+#include <config/config.h>
 #include <cpu/arm_interface.h>
 
 #include <mem/mem.h>
 #include <mem/allocator/std_page_allocator.h>
 #include <mem/mmu.h>
 #include <mem/ptr.h>
+#include <mem/trace.h>
 
 #include <algorithm>
 
@@ -38,6 +40,17 @@ namespace eka2l1 {
         : conf_(conf) {
         alloc_ = std::make_unique<mem::basic_page_table_allocator>();
         impl_ = mem::make_new_control(monitor, alloc_.get(), conf_, 12, mem_map_old, model_type);
+
+        if (!conf_->mem_trace_path.empty()) {
+            std::vector<mem::access_trace_range> ranges;
+
+            if (!mem::parse_access_trace_ranges(conf_->mem_trace_ranges, ranges)) {
+                LOG_ERROR(MEMORY, "Invalid memory trace ranges \"{}\", tracing all addresses", conf_->mem_trace_ranges);
+                ranges.clear();
+            }
+
+            tracer_ = std::make_unique<mem::access_tracer>(conf_->mem_trace_path, ranges);
+        }
     }
 
     memory_system::~memory_system() {
@@ -47,7 +60,10 @@ namespace eka2l1 {
     }
 
     mem::mmu_base *memory_system::get_mmu(arm::core *cc) {
-        return impl_->get_or_create_mmu(cc);
+        mem::mmu_base *mmu = impl_->get_or_create_mmu(cc);
+        mmu->set_access_tracer(tracer_.get());
+
+        return mmu;
     }
 
     void *memory_system::get_real_pointer(const address addr, const mem::asid optional_asid) {
@@ -22,6 +22,7 @@
 #include <config/config.h>
 #include <mem/mmu.h>
 #include <mem/control.h>
+#include <mem/trace.h>
 
 #include <mem/model/flexible/mmu.h>
 #include <mem/model/multiple/mmu.h>
@@ -29,6 +30,8 @@
 namespace eka2l1::mem {
     mmu_base::mmu_base(control_base *manager, arm::core *cpu, config::state *conf)
         : manager_(manager)
+        , tracer_(nullptr)
+        , traced_thread_(0)
         , cpu_(cpu)
         , conf_(conf) {
         // Set CPU read/write functions
@@ -76,172 +79,91 @@ namespace eka2l1::mem {
 
     /// ================== MISCS ====================
 
-    bool mmu_base::read_8bit_data(const vm_address addr, std::uint8_t *data) {
+    template <typename T>
+    bool mmu_base::read_data(const vm_address addr, T *data) {
         page_info *inf = manager_->get_page_info(current_addr_space(), addr);
         if (!inf || !inf->host_addr) {
             return false;
         }
 
-        std::uint8_t *ptr = reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_);
-
+        T *ptr = reinterpret_cast<T *>(reinterpret_cast<std::uint8_t *>(inf->host_addr) + (addr & manager_->offset_mask_));
         *data = *ptr;
 
         if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 1 byte from address 0x{:X}", addr);
+            LOG_TRACE(MEMORY, "Read {} bytes from address 0x{:X}", sizeof(T), addr);
         }
 
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
+        if (tracer_ && tracer_->should_trace(addr, sizeof(T))) {
+            tracer_->record(cpu_->get_pc(), addr, *data, current_addr_space(), traced_thread_, sizeof(T), false);
+        }
 
+        fill_tlb(addr, inf);
         return true;
     }
 
-    bool mmu_base::read_16bit_data(const vm_address addr, std::uint16_t *data) {
+    template <typename T>
+    bool mmu_base::write_data(const vm_address addr, T *data) {
         page_info *inf = manager_->get_page_info(current_addr_space(), addr);
         if (!inf || !inf->host_addr) {
             return false;
         }
 
-        std::uint16_t *ptr = reinterpret_cast<std::uint16_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *data = *ptr;
+        T *ptr = reinterpret_cast<T *>(reinterpret_cast<std::uint8_t *>(inf->host_addr) + (addr & manager_->offset_mask_));
+        *ptr = *data;
 
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 2 bytes from address 0x{:X}", addr);
+        if (conf_->log_write) {
+            LOG_TRACE(MEMORY, "Write {} bytes to address 0x{:X}", sizeof(T), addr);
         }
 
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
+        if (tracer_ && tracer_->should_trace(addr, sizeof(T))) {
+            tracer_->record(cpu_->get_pc(), addr, *data, current_addr_space(), traced_thread_, sizeof(T), true);
+        }
 
+        fill_tlb(addr, inf);
         return true;
     }
 
-    bool mmu_base::read_32bit_data(const vm_address addr, std::uint32_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint32_t *ptr = reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *data = *ptr;
+    void mmu_base::fill_tlb(const vm_address addr, page_info *inf) {
+        const vm_address page_addr = addr & ~manager_->offset_mask_;
 
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 4 bytes from address 0x{:X}", addr);
+        // Accesses through the TLB never come back here, so traced pages must stay out of it
+        if (tracer_ && tracer_->should_trace(page_addr, manager_->page_size())) {
+            return;
         }
 
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
-
-        return true;
+        cpu_->set_tlb_page(page_addr, reinterpret_cast<std::uint8_t *>(inf->host_addr), inf->perm);
     }
 
-    bool mmu_base::read_64bit_data(const vm_address addr, std::uint64_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint64_t *ptr = reinterpret_cast<std::uint64_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *data = *ptr;
+    bool mmu_base::read_8bit_data(const vm_address addr, std::uint8_t *data) {
+        return read_data(addr, data);
+    }
 
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 8 bytes from address 0x{:X}", addr);
-        }
+    bool mmu_base::read_16bit_data(const vm_address addr, std::uint16_t *data) {
+        return read_data(addr, data);
+    }
 
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
+    bool mmu_base::read_32bit_data(const vm_address addr, std::uint32_t *data) {
+        return read_data(addr, data);
+    }
 
-        return true;
+    bool mmu_base::read_64bit_data(const vm_address addr, std::uint64_t *data) {
+        return read_data(addr, data);
     }
 
     bool mmu_base::write_8bit_data(const vm_address addr, std::uint8_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint8_t *ptr = reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_);
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 1 byte to address 0x{:X}", addr);
-        }
-
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
-
-        return true;
+        return write_data(addr, data);
     }
 
     bool mmu_base::write_16bit_data(const vm_address addr, std::uint16_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint16_t *ptr = reinterpret_cast<std::uint16_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 2 bytes to address 0x{:X}", addr);
-        }
-
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
-
-        return true;
+        return write_data(addr, data);
     }
 
     bool mmu_base::write_32bit_data(const vm_address addr, std::uint32_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint32_t *ptr = reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 4 bytes to address 0x{:X}", addr);
-        }
-
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
-
-        return true;
+        return write_data(addr, data);
     }
 
     bool mmu_base::write_64bit_data(const vm_address addr, std::uint64_t *data) {
-        page_info *inf = manager_->get_page_info(current_addr_space(), addr);
-        if (!inf || !inf->host_addr) {
-            return false;
-        }
-
-        std::uint64_t *ptr = reinterpret_cast<std::uint64_t*>(reinterpret_cast<std::uint8_t*>(inf->host_addr) +
-            (addr & manager_->offset_mask_));
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 8 bytes to address 0x{:X}", addr);
-        }
-
-        cpu_->set_tlb_page(addr & ~manager_->offset_mask_, reinterpret_cast<std::uint8_t*>(inf->host_addr),
-            inf->perm);
-
-        return true;
+        return write_data(addr, data);
     }
 
     bool mmu_base::read_code(const vm_address addr, std::uint32_t *data) {
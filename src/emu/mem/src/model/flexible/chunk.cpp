@@ -128,6 +128,10 @@ namespace eka2l1::mem::flexible {
         return true;
     }
 
+    bool flexible_mem_model_chunk::map_template(const vm_address offset, const cow_template &templ) {
+        return mem_obj_->map_template(offset >> control_->page_size_bits_, templ, permission_);
+    }
+
     void flexible_mem_model_chunk::unmap_from_cpu(mem_model_process *pr, mmu_base *mmu) {
         manipulate_cpu_map(page_bma_.get(), reinterpret_cast<flexible_mem_model_process*>(pr),
             mmu, false);
@@ -21,6 +21,7 @@
 #include <mem/model/flexible/memobj.h>
 #include <mem/model/flexible/mapping.h>
 #include <mem/model/flexible/control.h>
+#include <mem/cow.h>
 
 #include <common/algorithm.h>
 #include <common/log.h>
@@ -31,7 +32,9 @@ namespace eka2l1::mem::flexible {
         : data_(external_host)
         , page_occupied_(page_count)
         , control_(ctrl)
-        , external_(false) {
+        , external_(false)
+        , template_page_start_(0)
+        , template_page_end_(0) {
         if (data_) {
             external_ = true;
         } else {
@@ -98,12 +101,18 @@ namespace eka2l1::mem::flexible {
         const std::uint32_t size_to_decommit = static_cast<std::uint32_t>(total_pages << control_->page_size_bits_);
 
         if (!external_) {
+            const bool has_template_view = (page_offset < template_page_end_) && (page_offset + total_pages > template_page_start_);
             const bool deresult = common::decommit(reinterpret_cast<std::uint8_t*>(data_) + start_offset,
-                size_to_decommit);
+                size_to_decommit, has_template_view);
 
             if (!deresult) {
                 return false;
             }
+
+            if (has_template_view && (page_offset <= template_page_start_) && (page_offset + total_pages >= template_page_end_)) {
+                template_page_start_ = 0;
+                template_page_end_ = 0;
+            }
         }
 
         control_flexible *ctrl_fx = reinterpret_cast<control_flexible*>(control_);
@@ -126,6 +135,28 @@ namespace eka2l1::mem::flexible {
         return true;
     }
 
+    bool memory_object::map_template(const std::uint32_t page_offset, const cow_template &templ, const prot perm) {
+        const std::size_t total_pages = (templ.size() + control_->page_size() - 1) >> control_->page_size_bits_;
+
+        if (external_ || (page_offset + total_pages > page_occupied_)) {
+            return false;
+        }
+
+        if (!templ.map(reinterpret_cast<std::uint8_t *>(data_) + (page_offset << control_->page_size_bits_), perm)) {
+            return false;
+        }
+
+        if (template_page_start_ == template_page_end_) {
+            template_page_start_ = page_offset;
+            template_page_end_ = static_cast<std::uint32_t>(page_offset + total_pages);
+        } else {
+            template_page_start_ = common::min(template_page_start_, page_offset);
+            template_page_end_ = common::max(template_page_end_, static_cast<std::uint32_t>(page_offset + total_pages));
+        }
+
+        return true;
+    }
+
     bool memory_object::attach_mapping(mapping *layout) {
         if (std::find(mappings_.begin(), mappings_.end(), layout) != mappings_.end())
             return false;
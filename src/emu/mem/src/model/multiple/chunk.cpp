@@ -20,6 +20,7 @@
 #include <mem/model/multiple/chunk.h>
 #include <mem/model/multiple/control.h>
 #include <mem/model/multiple/process.h>
+#include <mem/cow.h>
 
 #include <common/algorithm.h>
 #include <common/virtualmem.h>
@@ -215,9 +216,16 @@ namespace eka2l1::mem {
 
             // Decommit the memory from the host
             if (!is_external_host) {
-                if (!common::decommit(reinterpret_cast<std::uint8_t *>(host_base_) + (ps_off << control_->page_size_bits_) + pt_base,
-                        page_num << control_->page_size_bits_)) {
+                const vm_address host_start = (ps_off << control_->page_size_bits_) + pt_base;
+                const vm_address host_end = host_start + (page_num << control_->page_size_bits_);
+                const bool has_template_view = (host_start < template_end_) && (host_end > template_start_);
+
+                if (!common::decommit(reinterpret_cast<std::uint8_t *>(host_base_) + host_start,
+                        page_num << control_->page_size_bits_, has_template_view)) {
                     LOG_ERROR(MEMORY, "Can't decommit a page from host memory");
+                } else if (has_template_view && (host_start <= template_start_) && (host_end >= template_end_)) {
+                    template_start_ = 0;
+                    template_end_ = 0;
                 }
             }
 
@@ -372,6 +380,28 @@ namespace eka2l1::mem {
         return MEM_MODEL_CHUNK_ERR_OK;
     }
 
+    bool multiple_mem_model_chunk::map_template(const vm_address offset, const cow_template &templ) {
+        if (is_external_host || (offset + templ.size() > max_size_)) {
+            return false;
+        }
+
+        if (!templ.map(reinterpret_cast<std::uint8_t *>(host_base_) + offset, permission_)) {
+            return false;
+        }
+
+        const vm_address end = static_cast<vm_address>(offset + templ.size());
+
+        if (template_start_ == template_end_) {
+            template_start_ = offset;
+            template_end_ = end;
+        } else {
+            template_start_ = common::min(template_start_, offset);
+            template_end_ = common::max(template_end_, end);
+        }
+
+        return true;
+    }
+
     void multiple_mem_model_chunk::do_selection_cpu_memory_manipulation(mmu_base *mmu, const bool unmap) {
         manipulate_cpu_map(page_bma_.get(), nullptr, mmu, !unmap);
     }
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mem/trace.h>
+
+#include <common/log.h>
+#include <common/thread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <unordered_map>
+
+namespace eka2l1::mem {
+    static std::atomic<std::uint64_t> tracer_instance_counter{ 1 };
+
+    // Buffers of this host thread, keyed by tracer instance. The thread's references are dropped when it
+    // exits, which tells the tracer the buffer can be freed once drained.
+    static thread_local std::unordered_map<std::uint64_t, std::shared_ptr<void>> thread_producers;
+
+    static bool parse_trace_address(const std::string &str, vm_address &result) {
+        if (str.empty()) {
+            return false;
+        }
+
+        char *end = nullptr;
+        const unsigned long long value = std::strtoull(str.c_str(), &end, 16);
+
+        if ((*end != '\0') || (value > 0x100000000ULL)) {
+            return false;
+        }
+
+        // The end of the address space is written as 100000000
+        result = static_cast<vm_address>(std::min<unsigned long long>(value, 0xFFFFFFFFULL));
+        return true;
+    }
+
+    bool parse_access_trace_ranges(const std::string &str, std::vector<access_trace_range> &ranges) {
+        std::size_t pos = 0;
+
+        while (pos < str.length()) {
+            std::size_t comma = str.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = str.length();
+            }
+
+            const std::string range_str = str.substr(pos, comma - pos);
+            const std::size_t dash = range_str.find('-');
+
+            if (dash == std::string::npos) {
+                return false;
+            }
+
+            access_trace_range range;
+
+            if (!parse_trace_address(range_str.substr(0, dash), range.start_) || !parse_trace_address(range_str.substr(dash + 1), range.end_)) {
+                return false;
+            }
+
+            if (range.start_ >= range.end_) {
+                return false;
+            }
+
+            ranges.push_back(range);
+            pos = comma + 1;
+        }
+
+        return true;
+    }
+
+    access_tracer::access_tracer(const std::string &path, const std::vector<access_trace_range> &ranges,
+        const std::size_t buffer_capacity)
+        : ranges_(ranges)
+        , buffer_capacity_(buffer_capacity)
+        , instance_id_(tracer_instance_counter++)
+        , file_(nullptr)
+        , retired_dropped_(0)
+        , stopping_(false)
+        , written_(0) {
+        file_ = std::fopen(path.c_str(), "wb");
+
+        if (!file_) {
+            LOG_ERROR(MEMORY, "Unable to create memory access trace file {}", path);
+            return;
+        }
+
+        access_trace_header header;
+        header.magic_ = ACCESS_TRACE_MAGIC;
+        header.version_ = ACCESS_TRACE_VERSION;
+        header.record_size_ = sizeof(access_trace_record);
+        header.reserved_ = 0;
+
+        std::fwrite(&header, sizeof(access_trace_header), 1, file_);
+
+        writer_ = std::thread([this]() {
+            common::set_thread_name("Memory access trace writer");
+            writer_loop();
+        });
+
+        LOG_INFO(MEMORY, "Tracing memory accesses to {} ({} filter ranges)", path, ranges_.size());
+    }
+
+    access_tracer::~access_tracer() {
+        if (!file_) {
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> guard(writer_lock_);
+            stopping_ = true;
+        }
+
+        writer_cond_.notify_one();
+        writer_.join();
+
+        std::fclose(file_);
+
+        const std::uint64_t total_dropped = dropped();
+        if (total_dropped != 0) {
+            LOG_WARN(MEMORY, "Memory access trace dropped {} records, consider narrowing the filter", total_dropped);
+        }
+    }
+
+    bool access_tracer::should_trace(const vm_address addr, const std::uint32_t size) const {
+        if (ranges_.empty()) {
+            return true;
+        }
+
+        const std::uint64_t end = static_cast<std::uint64_t>(addr) + size;
+
+        for (const access_trace_range &range : ranges_) {
+            if ((addr < range.end_) && (end > range.start_)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    access_tracer::producer *access_tracer::get_producer() {
+        auto ite = thread_producers.find(instance_id_);
+
+        if (ite != thread_producers.end()) {
+            return static_cast<producer *>(ite->second.get());
+        }
+
+        // Forget buffers of tracers that have been destroyed since, the thread is the last one holding them
+        for (auto dead_ite = thread_producers.begin(); dead_ite != thread_producers.end();) {
+            if (dead_ite->second.use_count() == 1) {
+                dead_ite = thread_producers.erase(dead_ite);
+            } else {
+                dead_ite++;
+            }
+        }
+
+        // First record from this host thread, register a buffer for it
+        auto prod = std::make_shared<producer>(buffer_capacity_);
+
+        {
+            const std::lock_guard<std::mutex> guard(producers_lock_);
+            producers_.push_back(prod);
+        }
+
+        thread_producers.emplace(instance_id_, prod);
+        return prod.get();
+    }
+
+    void access_tracer::record(const vm_address pc, const vm_address addr, const std::uint64_t value, const asid addr_space,
+        const std::uint32_t thread_id, const std::uint8_t size, const bool is_write) {
+        if (!file_) {
+            return;
+        }
+
+        access_trace_record rec;
+        rec.pc_ = pc;
+        rec.addr_ = addr;
+        rec.value_ = value;
+        rec.thread_id_ = thread_id;
+        rec.asid_ = static_cast<std::uint16_t>(addr_space);
+        rec.size_ = size;
+        rec.flags_ = is_write ? ACCESS_TRACE_FLAG_WRITE : 0;
+
+        producer *prod = get_producer();
+
+        if (prod->records_.push(&rec, 1) == 0) {
+            prod->dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool access_tracer::drain() {
+        static constexpr std::size_t DRAIN_CHUNK_SIZE = 1024;
+        access_trace_record chunk[DRAIN_CHUNK_SIZE];
+
+        bool drained_any = false;
+        const std::lock_guard<std::mutex> guard(producers_lock_);
+
+        for (auto ite = producers_.begin(); ite != producers_.end();) {
+            producer *prod = ite->get();
+
+            // Only the tracer holds it: the recording thread has exited and will not push anymore.
+            // Pairs with the release of the thread's reference, so its last records are seen below.
+            const bool thread_exited = (ite->use_count() == 1);
+
+            if (thread_exited) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+
+            std::size_t popped = 0;
+
+            while ((popped = prod->records_.pop(chunk, DRAIN_CHUNK_SIZE)) != 0) {
+                std::fwrite(chunk, sizeof(access_trace_record), popped, file_);
+                written_.fetch_add(popped, std::memory_order_relaxed);
+
+                drained_any = true;
+            }
+
+            if (thread_exited) {
+                retired_dropped_ += prod->dropped_.load(std::memory_order_relaxed);
+                ite = producers_.erase(ite);
+            } else {
+                ite++;
+            }
+        }
+
+        return drained_any;
+    }
+
+    void access_tracer::writer_loop() {
+        std::unique_lock<std::mutex> lock(writer_lock_);
+
+        while (!stopping_) {
+            writer_cond_.wait_for(lock, std::chrono::milliseconds(10));
+            drain();
+        }
+
+        drain();
+    }
+
+    void access_tracer::flush() {
+        if (!file_) {
+            return;
+        }
+
+        const std::lock_guard<std::mutex> guard(writer_lock_);
+
+        drain();
+        std::fflush(file_);
+    }
+
+    std::uint64_t access_tracer::dropped() const {
+        const std::lock_guard<std::mutex> guard(producers_lock_);
+        std::uint64_t total = retired_dropped_;
+
+        for (const auto &prod : producers_) {
+            total += prod->dropped_.load(std::memory_order_relaxed);
+        }
+
+        return total;
+    }
+
+    std::size_t access_tracer::producer_count() const {
+        const std::lock_guard<std::mutex> guard(producers_lock_);
+        return producers_.size();
+    }
+
+    bool read_access_trace(const std::string &path, std::vector<access_trace_record> &records) {
+        std::FILE *f = std::fopen(path.c_str(), "rb");
+
+        if (!f) {
+            return false;
+        }
+
+        access_trace_header header;
+
+        if ((std::fread(&header, sizeof(access_trace_header), 1, f) != 1) || (header.magic_ != ACCESS_TRACE_MAGIC)
+            || (header.record_size_ != sizeof(access_trace_record))) {
+            std::fclose(f);
+            return false;
+        }
+
+        access_trace_record rec;
+
+        while (std::fread(&rec, sizeof(access_trace_record), 1, f) == 1) {
+            records.push_back(rec);
+        }
+
+        std::fclose(f);
+        return true;
+    }
+
+    std::vector<access_trace_hot_address> find_hot_addresses(const std::vector<access_trace_record> &records,
+        const std::size_t max_count) {
+        std::unordered_map<vm_address, access_trace_hot_address> counts;
+
+        for (const access_trace_record &rec : records) {
+            access_trace_hot_address &entry = counts.emplace(rec.addr_, access_trace_hot_address{ rec.addr_, 0, 0 }).first->second;
+
+            if (rec.flags_ & ACCESS_TRACE_FLAG_WRITE) {
+                entry.writes_++;
+            } else {
+                entry.reads_++;
+            }
+        }
+
+        std::vector<access_trace_hot_address> result;
+        result.reserve(counts.size());
+
+        for (const auto &[addr, entry] : counts) {
+            result.push_back(entry);
+        }
+
+        std::sort(result.begin(), result.end(), [](const access_trace_hot_address &lhs, const access_trace_hot_address &rhs) {
+            const std::uint64_t lhs_total = lhs.reads_ + lhs.writes_;
+            const std::uint64_t rhs_total = rhs.reads_ + rhs.writes_;
+
+            return (lhs_total == rhs_total) ? (lhs.addr_ < rhs.addr_) : (lhs_total > rhs_total);
+        });
+
+        if (result.size() > max_count) {
+            result.resize(max_count);
+        }
+
+        return result;
+    }
+
+    std::vector<access_trace_shared_line> find_false_sharing(const std::vector<access_trace_record> &records,
+        const std::uint32_t line_size) {
+        struct line_user {
+            std::uint64_t byte_mask_ = 0;
+            std::uint64_t writes_ = 0;
+        };
+
+        std::vector<access_trace_shared_line> result;
+
+        if ((line_size == 0) || (line_size > 64) || (line_size & (line_size - 1))) {
+            return result;
+        }
+
+        // Ordered so that the report comes out sorted by address
+        std::map<vm_address, std::map<std::uint32_t, line_user>> lines;
+
+        for (const access_trace_record &rec : records) {
+            const vm_address line_addr = rec.addr_ & ~(line_size - 1);
+            const std::uint32_t offset = rec.addr_ - line_addr;
+            const std::uint32_t size_in_line = std::min<std::uint32_t>(rec.size_, line_size - offset);
+
+            line_user &user = lines[line_addr][rec.thread_id_];
+            user.byte_mask_ |= ((size_in_line == 64) ? ~0ULL : ((1ULL << size_in_line) - 1)) << offset;
+
+            if (rec.flags_ & ACCESS_TRACE_FLAG_WRITE) {
+                user.writes_++;
+            }
+        }
+
+        for (const auto &[line_addr, users] : lines) {
+            if (users.size() < 2) {
+                continue;
+            }
+
+            access_trace_shared_line shared;
+            shared.line_addr_ = line_addr;
+            shared.writes_ = 0;
+
+            for (auto first = users.begin(); first != users.end(); first++) {
+                for (auto second = std::next(first); second != users.end(); second++) {
+                    const bool disjoint = (first->second.byte_mask_ & second->second.byte_mask_) == 0;
+                    const bool has_writer = (first->second.writes_ != 0) || (second->second.writes_ != 0);
+
+                    if (!disjoint || !has_writer) {
+                        continue;
+                    }
+
+                    for (const std::uint32_t thread_id : { first->first, second->first }) {
+                        if (std::find(shared.threads_.begin(), shared.threads_.end(), thread_id) == shared.threads_.end()) {
+                            shared.threads_.push_back(thread_id);
+                            shared.writes_ += users.at(thread_id).writes_;
+                        }
+                    }
+                }
+            }
+
+            if (!shared.threads_.empty()) {
+                result.push_back(std::move(shared));
+            }
+        }
+
+        return result;
+    }
+}
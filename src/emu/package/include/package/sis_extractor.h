@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eka2l1 {
+    namespace common {
+        class ro_stream;
+    }
+
+    namespace loader {
+        struct sis_compressed;
+
+        /**
+         * \brief Extract file records of a SIS package on a pool of worker threads.
+         *
+         * Records are independent deflate streams, so each one is inflated and written on its own
+         * worker. Only reading the compressed bytes from the package stream is serialized.
+         */
+        class sis_file_extractor {
+            struct extract_job {
+                std::string path_;
+                std::string key_; ///< Lowercased path, so pending extractions match on any host.
+                sis_compressed *compressed_;
+            };
+
+            common::ro_stream *stream_;
+            std::mutex stream_lock_;
+
+            std::vector<std::thread> workers_;
+            std::size_t max_workers_;
+
+            std::deque<extract_job> jobs_;
+            std::set<std::string> pending_paths_; ///< Keyed by lowercased path.
+            std::mutex jobs_lock_;
+            std::condition_variable jobs_cond_;
+            std::condition_variable done_cond_;
+            bool stopping_;
+
+            std::atomic<int> *progress_;
+            std::uint64_t total_bytes_;
+            std::atomic<std::uint64_t> done_bytes_;
+
+            void worker_loop();
+            bool extract(const extract_job &job);
+            void report_progress(const std::uint64_t amount);
+
+            std::uint64_t read_compressed(sis_compressed &compressed, const std::uint64_t pos, std::uint8_t *buf,
+                const std::uint64_t size);
+
+        public:
+            /**
+             * \brief Create a new extractor.
+             *
+             * \param stream        Stream of the whole package. Must outlive the extractor.
+             * \param max_workers   Maximum number of worker threads. 0 to pick from the host's CPU count.
+             */
+            explicit sis_file_extractor(common::ro_stream *stream, const std::size_t max_workers = 0);
+            ~sis_file_extractor();
+
+            /**
+             * \brief Report extraction progress, in percentage, to the given handle.
+             *
+             * \param progress      The progress handle. Nullptr to disable reporting.
+             * \param total_bytes   Total uncompressed bytes expected to be extracted.
+             */
+            void set_progress(std::atomic<int> *progress, const std::uint64_t total_bytes);
+
+            /**
+             * \brief Read and uncompress a whole record into memory, on the calling thread.
+             */
+            std::vector<std::uint8_t> read_to_buffer(sis_compressed &compressed);
+
+            /**
+             * \brief Queue a record to be extracted to a host file.
+             *
+             * If a previous extraction to the same path is still pending, it's waited for first, so
+             * the last queued record always wins. Paths are compared case-insensitively.
+             *
+             * \param path          UTF-8 host path of the destination file.
+             * \param compressed    The record. Must stay alive until the extraction is done.
+             */
+            void queue(const std::string &path, sis_compressed &compressed);
+
+            /**
+             * \brief Wait for the extraction to a path to finish.
+             *
+             * The path is compared case-insensitively against queued ones.
+             */
+            void wait(const std::string &path);
+
+            /**
+             * \brief Wait for all queued extractions to finish.
+             */
+            void wait_all();
+        };
+    }
+}
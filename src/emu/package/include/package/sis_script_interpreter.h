@@ -22,11 +22,13 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
 #include <stack>
 #include <vector>
 
 #include <loader/sis_fields.h>
+#include <package/sis_extractor.h>
 
 namespace eka2l1 {
     class system;
@@ -59,6 +61,7 @@ namespace eka2l1 {
             common::ro_stream *data_stream;
 
             io_system *io;
+            std::unique_ptr<sis_file_extractor> extractor;
 
             manager::packages *mngr;
             manager::device *current_dvc;
@@ -79,6 +82,11 @@ namespace eka2l1 {
              */
             int gasp_true_form_of_integral_expression(const sis_expression &expr);
 
+            /**
+             * \brief Get the total uncompressed size of all file records in the install data.
+             */
+            std::uint64_t total_file_data_size();
+
         public:
             show_text_func show_text;                   ///< Hook function to display texts.
             choose_lang_func choose_lang;               ///< Hook function to choose controller's language.
@@ -110,7 +118,8 @@ namespace eka2l1 {
             /**
              * \brief Get the data in the index of a buffer block in the SIS, write it to a physical file.
              * 
-             * Usually uses for extracting large app data.
+             * Usually uses for extracting large app data. The extraction is queued to the extractor's
+             * worker pool, and is only guaranteed to be done once the interpretation returns.
              * 
              * \param path          UTF-8 path to the physical file.
              * \param data_idx      The index of the source buffer in block buffer.
@@ -123,9 +132,13 @@ namespace eka2l1 {
 
             bool interpret(sis_controller *controller, const std::uint16_t base_data_idx, std::atomic<int> &progress);
 
-            bool interpret(std::atomic<int> &progress) {
-                return interpret(main_controller, 0, progress);
-            }
+            /**
+             * \brief Run the install script of the main controller.
+             *
+             * \param progress Receives the extraction progress, in percentage.
+             * \returns True on success.
+             */
+            bool interpret(std::atomic<int> &progress);
         };
     }
 }
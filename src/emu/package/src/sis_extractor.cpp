@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <package/sis_extractor.h>
+
+#include <common/algorithm.h>
+#include <common/buffer.h>
+#include <common/fileutils.h>
+#include <common/log.h>
+#include <common/path.h>
+#include <common/thread.h>
+
+#include <loader/sis_fields.h>
+
+#include <miniz.h>
+
+#include <cstdio>
+
+namespace eka2l1::loader {
+    static constexpr std::uint64_t READ_CHUNK_SIZE = 0x100000;
+    static constexpr std::uint64_t INFLATE_CHUNK_SIZE = 0x100000;
+    static constexpr std::size_t WRITE_BUFFER_SIZE = 0x400000;
+    static constexpr std::size_t MAX_EXTRACT_WORKERS = 8;
+
+    static std::uint64_t get_compressed_size(const sis_compressed &compressed) {
+        // Minus the algorithm and uncompressed size fields
+        return ((compressed.len_low) | (static_cast<std::uint64_t>(compressed.len_high) << 32)) - 12;
+    }
+
+    sis_file_extractor::sis_file_extractor(common::ro_stream *stream, const std::size_t max_workers)
+        : stream_(stream)
+        , max_workers_(max_workers)
+        , stopping_(false)
+        , progress_(nullptr)
+        , total_bytes_(0)
+        , done_bytes_(0) {
+        if (max_workers_ == 0) {
+            max_workers_ = common::clamp<std::size_t>(1, MAX_EXTRACT_WORKERS, std::thread::hardware_concurrency());
+        }
+    }
+
+    sis_file_extractor::~sis_file_extractor() {
+        {
+            const std::lock_guard<std::mutex> guard(jobs_lock_);
+            stopping_ = true;
+        }
+
+        // Workers drain the queue before leaving
+        jobs_cond_.notify_all();
+
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void sis_file_extractor::set_progress(std::atomic<int> *progress, const std::uint64_t total_bytes) {
+        progress_ = progress;
+        total_bytes_ = total_bytes;
+        done_bytes_ = 0;
+
+        if (progress_) {
+            *progress_ = 0;
+        }
+    }
+
+    void sis_file_extractor::report_progress(const std::uint64_t amount) {
+        if (!progress_ || (total_bytes_ == 0)) {
+            return;
+        }
+
+        const std::uint64_t done = (done_bytes_ += amount);
+        const int percentage = static_cast<int>(common::min<std::uint64_t>(done * 100 / total_bytes_, 100));
+
+        // Workers finish out of order, never let the progress go backward
+        int current = progress_->load();
+        while ((current < percentage) && !progress_->compare_exchange_weak(current, percentage)) {
+        }
+    }
+
+    std::uint64_t sis_file_extractor::read_compressed(sis_compressed &compressed, const std::uint64_t pos, std::uint8_t *buf,
+        const std::uint64_t size) {
+        const std::lock_guard<std::mutex> guard(stream_lock_);
+
+        stream_->seek(compressed.offset + pos, common::seek_where::beg);
+        return stream_->read(buf, size);
+    }
+
+    std::vector<std::uint8_t> sis_file_extractor::read_to_buffer(sis_compressed &compressed) {
+        const std::uint64_t compressed_size = get_compressed_size(compressed);
+        std::vector<std::uint8_t> raw(compressed_size);
+
+        if (read_compressed(compressed, 0, raw.data(), compressed_size) != compressed_size) {
+            LOG_ERROR(PACKAGE, "Unable to read {} bytes of file data from the package", compressed_size);
+            return {};
+        }
+
+        if (compressed.algorithm == sis_compressed_algorithm::none) {
+            return raw;
+        }
+
+        std::vector<std::uint8_t> uncompressed(compressed.uncompressed_size);
+        mz_ulong uncompressed_size = static_cast<mz_ulong>(uncompressed.size());
+
+        const int result = mz_uncompress(uncompressed.data(), &uncompressed_size, raw.data(), static_cast<mz_ulong>(raw.size()));
+        if (result != MZ_OK) {
+            LOG_ERROR(PACKAGE, "Uncompress failed with description: {}", mz_error(result));
+        }
+
+        uncompressed.resize(uncompressed_size);
+        return uncompressed;
+    }
+
+    bool sis_file_extractor::extract(const extract_job &job) {
+        sis_compressed &compressed = *job.compressed_;
+
+        eka2l1::create_directories(eka2l1::file_directory(job.path_));
+
+        // Delete the file, starts over
+        if (common::is_system_case_insensitive() && eka2l1::exists(job.path_)) {
+            if (!common::remove(job.path_)) {
+                LOG_WARN(PACKAGE, "Unable to remove {} to extract new file", job.path_);
+            }
+        }
+
+        FILE *file = fopen(job.path_.c_str(), "wb");
+        if (!file) {
+            LOG_ERROR(PACKAGE, "Unable to open {} for extraction", job.path_);
+            report_progress(compressed.uncompressed_size);
+            return false;
+        }
+
+        std::setvbuf(file, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+
+        const bool deflated = (compressed.algorithm == sis_compressed_algorithm::deflated);
+        std::uint64_t left = get_compressed_size(compressed);
+        std::uint64_t pos = 0;
+        std::uint64_t total_inflated_size = 0;
+
+        std::vector<std::uint8_t> in_chunk(common::min(left, READ_CHUNK_SIZE));
+        std::vector<std::uint8_t> out_chunk(deflated ? INFLATE_CHUNK_SIZE : 0);
+
+        mz_stream stream{};
+        bool success = true;
+        bool stream_end = false;
+
+        if (deflated && (inflateInit(&stream) != MZ_OK)) {
+            LOG_ERROR(PACKAGE, "Can not intialize inflate stream");
+            fclose(file);
+            return false;
+        }
+
+        while ((left > 0) && success && !stream_end) {
+            const std::uint64_t grab = common::min(left, READ_CHUNK_SIZE);
+
+            if (read_compressed(compressed, pos, in_chunk.data(), grab) != grab) {
+                LOG_ERROR(PACKAGE, "Stream fail, skipping file {}, should report to developers.", job.path_);
+                success = false;
+                break;
+            }
+
+            pos += grab;
+            left -= grab;
+
+            if (!deflated) {
+                success = (fwrite(in_chunk.data(), 1, grab, file) == grab);
+                report_progress(grab);
+
+                continue;
+            }
+
+            stream.next_in = in_chunk.data();
+            stream.avail_in = static_cast<unsigned int>(grab);
+
+            // Highly compressed data may need several output chunks for a single input chunk
+            do {
+                stream.next_out = out_chunk.data();
+                stream.avail_out = static_cast<unsigned int>(out_chunk.size());
+
+                const int result = inflate(&stream, MZ_NO_FLUSH);
+                const std::uint64_t produced = out_chunk.size() - stream.avail_out;
+
+                if (produced) {
+                    if (fwrite(out_chunk.data(), 1, produced, file) != produced) {
+                        LOG_ERROR(PACKAGE, "Unable to write to {}", job.path_);
+                        success = false;
+                        break;
+                    }
+
+                    total_inflated_size += produced;
+                    report_progress(produced);
+                }
+
+                if (result == MZ_STREAM_END) {
+                    stream_end = true;
+                    break;
+                }
+
+                if (result == MZ_BUF_ERROR) {
+                    // Need more input
+                    break;
+                }
+
+                if (result != MZ_OK) {
+                    LOG_ERROR(PACKAGE, "Uncompress failed with description: {}", mz_error(result));
+                    success = false;
+                    break;
+                }
+            } while ((stream.avail_in > 0) || (stream.avail_out == 0));
+        }
+
+        if (deflated) {
+            if (success && (total_inflated_size != compressed.uncompressed_size)) {
+                LOG_ERROR(PACKAGE, "Sanity check failed: Total inflated size not equal to specified uncompress size "
+                                   "in SISCompressed ({} vs {})!",
+                    total_inflated_size, compressed.uncompressed_size);
+            }
+
+            inflateEnd(&stream);
+        }
+
+        fclose(file);
+        return success;
+    }
+
+    void sis_file_extractor::worker_loop() {
+        common::set_thread_name("SIS extractor thread");
+
+        while (true) {
+            extract_job job;
+
+            {
+                std::unique_lock<std::mutex> lock(jobs_lock_);
+                jobs_cond_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+
+                if (jobs_.empty()) {
+                    return;
+                }
+
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+
+            extract(job);
+
+            {
+                const std::lock_guard<std::mutex> guard(jobs_lock_);
+                pending_paths_.erase(job.key_);
+            }
+
+            done_cond_.notify_all();
+        }
+    }
+
+    void sis_file_extractor::queue(const std::string &path, sis_compressed &compressed) {
+        const std::string key = common::lowercase_string(path);
+        std::unique_lock<std::mutex> lock(jobs_lock_);
+
+        // Wait and insert under one lock, so two queues to the same path can't both slip through
+        done_cond_.wait(lock, [&]() { return pending_paths_.find(key) == pending_paths_.end(); });
+
+        jobs_.push_back({ path, key, &compressed });
+        pending_paths_.insert(key);
+
+        if (workers_.size() < max_workers_) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+
+        lock.unlock();
+        jobs_cond_.notify_one();
+    }
+
+    void sis_file_extractor::wait(const std::string &path) {
+        const std::string key = common::lowercase_string(path);
+
+        std::unique_lock<std::mutex> lock(jobs_lock_);
+        done_cond_.wait(lock, [&]() { return pending_paths_.find(key) == pending_paths_.end(); });
+    }
+
+    void sis_file_extractor::wait_all() {
+        std::unique_lock<std::mutex> lock(jobs_lock_);
+        done_cond_.wait(lock, [this]() { return pending_paths_.empty(); });
+    }
+}
@@ -21,7 +21,6 @@
 #include <common/algorithm.h>
 #include <common/buffer.h>
 #include <common/cvt.h>
-#include <common/flate.h>
 #include <common/fileutils.h>
 #include <common/log.h>
 #include <common/path.h>
@@ -33,8 +32,6 @@
 #include <package/manager.h>
 #include <package/sis_script_interpreter.h>
 
-#include <miniz.h>
-
 namespace eka2l1 {
     namespace loader {
         std::string get_install_path(const std::u16string &pseudo_path, drive_number drv) {
@@ -73,138 +70,36 @@ namespace eka2l1 {
             , io(io)
             , main_controller(main_controller)
             , install_data(inst_data)
-            , install_drive(inst_drv) {
+            , install_drive(inst_drv)
+            , extractor(std::make_unique<sis_file_extractor>(stream)) {
         }
 
         std::vector<uint8_t> ss_interpreter::get_small_file_buf(uint32_t data_idx, uint16_t crr_blck_idx) {
             sis_file_data *data = reinterpret_cast<sis_file_data *>(
                 reinterpret_cast<sis_data_unit *>(install_data->data_units.fields[crr_blck_idx].get())->data_unit.fields[data_idx].get());
-            sis_compressed compressed = data->raw_data;
-
-            std::uint64_t us = ((compressed.len_low) | (static_cast<uint64_t>(compressed.len_high) << 32)) - 12;
-
-            compressed.compressed_data.resize(us);
-
-            data_stream->seek(compressed.offset, common::seek_where::beg);
-            data_stream->read(&compressed.compressed_data[0], us);
-
-            if (compressed.algorithm == sis_compressed_algorithm::none) {
-                return compressed.compressed_data;
-            }
-
-            compressed.uncompressed_data.resize(compressed.uncompressed_size);
-            mz_stream stream;
-
-            stream.zalloc = nullptr;
-            stream.zfree = nullptr;
-
-            if (inflateInit(&stream) != MZ_OK) {
-                LOG_ERROR(PACKAGE, "Can not intialize inflate stream");
-            }
-
-            flate::inflate_data(&stream, compressed.compressed_data.data(),
-                compressed.uncompressed_data.data(), static_cast<std::uint32_t>(us));
-
-            inflateEnd(&stream);
-
-            return compressed.uncompressed_data;
-        }
 
-        // Assuming this file is small since it's stored in std::vector
-        // Directly write this
-        void extract_file_with_buf(const std::string &path, std::vector<uint8_t> &data) {
-            std::string rp = eka2l1::file_directory(path);
-            eka2l1::create_directories(rp);
-
-            LOG_INFO(PACKAGE, "Write to: {}", path);
-
-            FILE *temp = fopen(path.c_str(), "wb");
-            fwrite(data.data(), 1, data.size(), temp);
-
-            fclose(temp);
+            return extractor->read_to_buffer(data->raw_data);
         }
 
         void ss_interpreter::extract_file(const std::string &path, const uint32_t idx, uint16_t crr_blck_idx) {
-            std::string rp = eka2l1::file_directory(path);
-            eka2l1::create_directories(rp);
-
-            // Delete the file, starts over
-            if (common::is_system_case_insensitive() && eka2l1::exists(path)) {
-                if (!common::remove(path)) {
-                    LOG_WARN(PACKAGE, "Unable to remove {} to extract new file", path);
-                }
-            }
-
-            FILE *file = fopen(path.c_str(), "wb");
-
             sis_data_unit *data_unit = reinterpret_cast<sis_data_unit *>(install_data->data_units.fields[crr_blck_idx].get());
             sis_file_data *data = reinterpret_cast<sis_file_data *>(data_unit->data_unit.fields[idx].get());
 
-            sis_compressed compressed = data->raw_data;
-
-            std::uint64_t left = ((compressed.len_low) | (static_cast<std::uint64_t>(compressed.len_high) << 32)) - 12;
-            data_stream->seek(compressed.offset, common::seek_where::beg);
-
-            std::vector<unsigned char> temp_chunk;
-            temp_chunk.resize(CHUNK_SIZE);
-
-            std::vector<unsigned char> temp_inflated_chunk;
-            temp_inflated_chunk.resize(CHUNK_MAX_INFLATED_SIZE);
-
-            mz_stream stream;
-
-            stream.zalloc = nullptr;
-            stream.zfree = nullptr;
-
-            if (compressed.algorithm == sis_compressed_algorithm::deflated) {
-                if (inflateInit(&stream) != MZ_OK) {
-                    LOG_ERROR(PACKAGE, "Can not intialize inflate stream");
-                }
-            }
-
-            std::uint32_t total_inflated_size = 0;
-
-            while (left > 0) {
-                std::fill(temp_chunk.begin(), temp_chunk.end(), 0);
-                int grab = static_cast<int>(left < CHUNK_SIZE ? left : CHUNK_SIZE);
-
-                data_stream->read(&temp_chunk[0], grab);
-
-                if (!data_stream->valid()) {
-                    LOG_ERROR(PACKAGE, "Stream fail, skipping this file, should report to developers.");
-                    return;
-                }
-
-                if (compressed.algorithm == sis_compressed_algorithm::deflated) {
-                    uint32_t inflated_size = 0;
-
-                    auto res = flate::inflate_data(&stream, temp_chunk.data(), temp_inflated_chunk.data(), grab, &inflated_size);
-
-                    if (!res) {
-                        LOG_ERROR(PACKAGE, "Uncompress failed! Report to developers");
-                        return;
-                    }
+            extractor->queue(path, data->raw_data);
+        }
 
-                    fwrite(temp_inflated_chunk.data(), 1, inflated_size, file);
-                    total_inflated_size += inflated_size;
-                } else {
-                    fwrite(temp_chunk.data(), 1, grab, file);
-                }
+        std::uint64_t ss_interpreter::total_file_data_size() {
+            std::uint64_t total = 0;
 
-                left -= grab;
-            }
+            for (auto &wrap_data_unit : install_data->data_units.fields) {
+                sis_data_unit *data_unit = reinterpret_cast<sis_data_unit *>(wrap_data_unit.get());
 
-            if (compressed.algorithm == sis_compressed_algorithm::deflated) {
-                if (total_inflated_size != compressed.uncompressed_size) {
-                    LOG_ERROR(PACKAGE, "Sanity check failed: Total inflated size not equal to specified uncompress size "
-                              "in SISCompressed ({} vs {})!",
-                        total_inflated_size, compressed.uncompressed_size);
+                for (auto &wrap_file_data : data_unit->data_unit.fields) {
+                    total += reinterpret_cast<sis_file_data *>(wrap_file_data.get())->raw_data.uncompressed_size;
                 }
-
-                inflateEnd(&stream);
             }
 
-            fclose(file);
+            return total;
         }
 
         static bool is_expression_integral_type(const ss_expr_op op) {
@@ -351,6 +246,8 @@ namespace eka2l1 {
             }
 
             case ss_expr_op::EFuncExists: {
+                // The file may be one that is still being extracted
+                extractor->wait_all();
                 pass = io->exist(expr->val.unicode_string);
                 break;
             }
@@ -365,6 +262,18 @@ namespace eka2l1 {
             return pass;
         }
 
+        bool ss_interpreter::interpret(std::atomic<int> &progress) {
+            extractor->set_progress(&progress, total_file_data_size());
+
+            const bool result = interpret(main_controller, 0, progress);
+
+            extractor->wait_all();
+            extractor->set_progress(nullptr, 0);
+
+            progress = 100;
+            return result;
+        }
+
         bool ss_interpreter::interpret(sis_controller *controller, const std::uint16_t base_data_idx, std::atomic<int> &progress) {
             // Set current controller
             current_controllers.push(controller);
@@ -412,7 +321,17 @@ namespace eka2l1 {
 
                     if (file->target.unicode_string.length() > 0) {
                         install_path = get_install_path(file->target.unicode_string, install_drive);
-                        raw_path = common::ucs2_to_utf8(*(io->get_raw_path(common::utf8_to_ucs2(install_path))));
+
+                        // Files are extracted on the host, so the target must be on a drive backed by a host folder.
+                        // Drives served from a ROM image have none.
+                        const std::optional<std::u16string> target_host_path = io->get_raw_path(common::utf8_to_ucs2(install_path));
+
+                        if (!target_host_path) {
+                            LOG_ERROR(PACKAGE, "Install target {} is not on a writable drive, skipping", install_path);
+                            continue;
+                        }
+
+                        raw_path = common::ucs2_to_utf8(*target_host_path);
                     }
 
                     switch (file->op) {
@@ -451,6 +370,7 @@ namespace eka2l1 {
                             }
 
                             if (!yes_choosen) {
+                                extractor->wait_all();
                                 mngr->delete_files_and_bucket(current_controllers.top()->info.uid.uid);
                             }
 
@@ -475,7 +395,8 @@ namespace eka2l1 {
                                 lowered = true;
                             }
 
-                            extract_file(raw_path, file->idx, crr_blck_idx);
+                            const std::string extract_path = raw_path;
+                            extract_file(extract_path, file->idx, crr_blck_idx);
 
                             LOG_INFO(PACKAGE, "EOpInstall: {}", raw_path);
 
@@ -488,7 +409,13 @@ namespace eka2l1 {
 
                             if (FOUND_STR(raw_path.find(".sis")) || FOUND_STR(raw_path.find(".sisx"))) {
                                 LOG_INFO(PACKAGE, "Detected an SmartInstaller SIS, path at: {}", raw_path);
-                                mngr->install_package(common::utf8_to_ucs2(raw_path), drive_c, progress);
+
+                                extractor->wait(extract_path);
+
+                                // The nested install reports from 0 to 100 on its own. Sharing our handle would
+                                // leave it stuck at 100 for the rest of this package.
+                                std::atomic<int> nested_progress(0);
+                                mngr->install_package(common::utf8_to_ucs2(raw_path), drive_c, nested_progress);
                             }
                         } else {
                             skip_next_file = false;
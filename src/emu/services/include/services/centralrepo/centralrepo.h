@@ -34,12 +34,22 @@ namespace eka2l1 {
     class io_system;
     class device_manager;
 
+    namespace common {
+        class ini_file;
+    }
+
     /**
      * \brief Parse a new centrep ini file.
 	 * \returns False if IO error or invalid centrep configs.
 	*/
     bool parse_new_centrep_ini(const std::string &path, central_repo &repo);
 
+    /**
+     * \brief Parse a new centrep ini file that has already been loaded.
+	 * \returns False if invalid centrep configs.
+	*/
+    bool parse_new_centrep_ini(common::ini_file &creini, central_repo &repo);
+
     class central_repo_server;
 
     struct central_repo_client_session {
@@ -25,20 +25,133 @@
 
 #include <kernel/ipc.h>
 #include <mem/ptr.h>
+#include <utils/des.h>
 
 #include <cstring>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace eka2l1 {
     class system;
 
+    namespace kernel {
+        class process;
+    }
+
     namespace epoc {
         struct security_info;
         struct security_policy;
     }
 
     namespace service {
+        /**
+         * \brief A descriptor passed as IPC argument, resolved in the client's memory.
+         *
+         * The data is not copied. It can be read and written in place until the message is completed.
+         */
+        template <typename T>
+        struct ipc_descriptor_arg {
+            epoc::desc<T> *des = nullptr;
+            kernel::process *owner = nullptr;
+
+            T *data = nullptr;
+            std::uint32_t length = 0; ///< Length of the data, in characters.
+            std::uint32_t max_length = 0; ///< Capacity in characters. Same as the length for constant descriptors.
+
+            void set_length(const std::uint32_t new_length) {
+                des->set_length(owner, new_length);
+                length = new_length;
+            }
+
+            /**
+             * \brief Clamp a length given by the client to what can be read from the descriptor.
+             */
+            std::uint32_t clamp_read_length(const std::int32_t requested) const {
+                return static_cast<std::uint32_t>(common::clamp<std::int64_t>(0, length, requested));
+            }
+
+            /**
+             * \brief Clamp a length given by the client to what can be written to the descriptor.
+             */
+            std::uint32_t clamp_write_length(const std::int32_t requested) const {
+                return static_cast<std::uint32_t>(common::clamp<std::int64_t>(0, max_length, requested));
+            }
+        };
+
+        using ipc_des8_arg = ipc_descriptor_arg<std::uint8_t>;
+        using ipc_des16_arg = ipc_descriptor_arg<char16_t>;
+
+        /**
+         * \brief Placeholder for an IPC argument slot that should not be decoded.
+         */
+        struct ipc_unused_arg {
+        };
+
+        /**
+         * \brief What is shared between decoding all arguments of one message.
+         */
+        struct ipc_arg_decode_state {
+            kernel::process *owner;
+            bool is_eka1;
+        };
+
+        /**
+         * \brief Check if the type the client gave for an argument slot is a descriptor of the given width.
+         */
+        bool is_descriptor_argument_type(const ipc_arg_type type, const bool is_16_bit);
+
+        /**
+         * \brief Fill a descriptor argument from a descriptor in the client's memory.
+         *
+         * \returns False if the descriptor is not valid, or has room for data but no data pointer.
+         */
+        bool fill_descriptor_argument(epoc::desc<std::uint8_t> *des, kernel::process *owner, ipc_des8_arg &value);
+        bool fill_descriptor_argument(epoc::desc<char16_t> *des, kernel::process *owner, ipc_des16_arg &value);
+
+        template <typename T>
+        std::enable_if_t<std::is_arithmetic_v<T>, bool> decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state,
+            const int idx, T &value) {
+            static_assert(sizeof(T) <= sizeof(std::uint32_t), "Argument type is larger than an IPC argument slot");
+
+            std::memcpy(&value, &args.args[idx], sizeof(T));
+            return true;
+        }
+
+        inline bool decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx, ipc_unused_arg &value) {
+            return true;
+        }
+
+        bool decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx, ipc_des8_arg &value);
+        bool decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx, ipc_des16_arg &value);
+
+        template <typename Tuple, std::size_t... Idx>
+        bool decode_ipc_argument_slots(ipc_arg &args, const ipc_arg_decode_state &state, Tuple &result, std::index_sequence<Idx...>) {
+            return (decode_ipc_argument(args, state, static_cast<int>(Idx), std::get<Idx>(result)) && ...);
+        }
+
+        /**
+         * \brief   Decode IPC arguments in one pass, with the client already looked up.
+         *
+         * \returns std::nullopt if a slot does not hold what its type asks for. Else the decoded arguments.
+         *
+         * \sa      ipc_context::get_arguments
+         */
+        template <typename... Slots>
+        std::optional<std::tuple<Slots...>> decode_ipc_arguments(ipc_arg &args, const ipc_arg_decode_state &state) {
+            static_assert(sizeof...(Slots) <= 4, "IPC messages only have 4 arguments");
+
+            std::tuple<Slots...> result;
+
+            if (!decode_ipc_argument_slots(args, state, result, std::index_sequence_for<Slots...>{})) {
+                return std::nullopt;
+            }
+
+            return result;
+        }
+
         /**
          * \brief Context struct, wrapping around IPC message object.
          * 
@@ -76,6 +189,27 @@ namespace eka2l1 {
             template <typename T>
             std::optional<T> get_argument_value(const int idx);
 
+            /**
+             * \brief   Decode the IPC arguments of the message in one pass.
+             *
+             * Each type describes the argument slot with the same index:
+             * - Integer and floating point types up to 32 bits are read straight from the slot.
+             * - ipc_des8_arg and ipc_des16_arg resolve a descriptor without copying its data.
+             * - ipc_unused_arg skips the slot.
+             *
+             * The client process and the kernel version are only looked up once for all slots.
+             *
+             * \returns std::nullopt if a slot does not hold what its type asks for. Else the decoded arguments.
+             *
+             * \sa      get_argument_value
+             */
+            template <typename... Slots>
+            std::optional<std::tuple<Slots...>> get_arguments() {
+                return decode_ipc_arguments<Slots...>(msg->args, begin_arguments_decode());
+            }
+
+            ipc_arg_decode_state begin_arguments_decode();
+
             /**
              * \brief    Convert descriptor data to a struct.
              * 
@@ -135,6 +135,12 @@ namespace eka2l1::epoc {
          */
         void take_action_on_change(kernel::thread *drawer);
 
+        /**
+         * @brief Report that part of this window's content changed, so the screen composes it again.
+         * @param area The changed area, in window coordinates.
+         */
+        void damage(const eka2l1::rect &area);
+
         void queue_event(const epoc::event &evt) override;
 
         // ===================== OPCODE IMPLEMENTATIONS ===========================
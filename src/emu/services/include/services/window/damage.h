@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/vecx.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eka2l1::epoc {
+    /**
+     * \brief Check if a rectangle covers no pixel.
+     *
+     * Unlike rect::empty(), this also catches rectangles that only have one dimension being zero.
+     */
+    inline bool is_rect_area_empty(const eka2l1::rect &area) {
+        return (area.size.x <= 0) || (area.size.y <= 0);
+    }
+
+    /**
+     * \brief Accumulate areas of the screen that need to be composed again.
+     *
+     * Rectangles are kept apart so that small updates in different corners of the screen do not
+     * grow into a full screen composition. Past MAX_DAMAGE_RECTS, everything collapses into the
+     * bounding box, since tracking more costs more than drawing a few extra pixels.
+     */
+    class damage_tracker {
+        std::vector<eka2l1::rect> rects_;
+        bool full_;
+
+    public:
+        static constexpr std::size_t MAX_DAMAGE_RECTS = 8;
+
+        explicit damage_tracker();
+
+        /**
+         * \brief Mark an area as needing composition.
+         * \param area The area, in screen coordinates.
+         */
+        void add(const eka2l1::rect &area);
+
+        /**
+         * \brief Mark the whole screen as needing composition.
+         */
+        void add_all();
+
+        void clear();
+
+        bool empty() const {
+            return !full_ && rects_.empty();
+        }
+
+        bool is_full() const {
+            return full_;
+        }
+
+        /**
+         * \brief Get damaged rectangles. They never contain each other, but may still overlap.
+         */
+        const std::vector<eka2l1::rect> &rects() const {
+            return rects_;
+        }
+    };
+
+    /**
+     * \brief A window as seen by the screen composer.
+     */
+    struct compose_layer {
+        eka2l1::rect area; ///< Area of the window on the screen.
+        bool opaque; ///< True if nothing behind this window can show through it.
+    };
+
+    /**
+     * \brief Check if a layer can not be seen inside an area.
+     *
+     * The layer is hidden when one single opaque layer in front of it covers the whole part of it
+     * that lies inside the area. Being covered by a combination of layers is not detected.
+     *
+     * \param layers    All layers, in back to front order.
+     * \param index     Index of the layer to check.
+     * \param area      The area being composed, in screen coordinates.
+     */
+    bool is_layer_covered(const std::vector<compose_layer> &layers, const std::size_t index, const eka2l1::rect &area);
+}
@@ -27,6 +27,8 @@
 #include <common/uid.h>
 #include <common/vecx.h>
 
+#include <cstring>
+
 namespace eka2l1 {
     struct ws_cmd_header {
         uint16_t op;
@@ -40,6 +42,67 @@ namespace eka2l1 {
         void *data_ptr;
     };
 
+    static constexpr std::uint16_t WS_CMD_HANDLE_FLAG = 0x8000;
+
+    /**
+     * \brief Walk a client command buffer in place, without copying it out of guest memory.
+     *
+     * The client only writes the target handle when it differs from the previous command's one,
+     * so a command without the handle flag targets the same object as the command before it.
+     */
+    class ws_cmd_buffer_reader {
+        std::uint8_t *beg_;
+        std::uint8_t *end_;
+        std::uint32_t handle_;
+
+    public:
+        explicit ws_cmd_buffer_reader(std::uint8_t *buffer, const std::size_t size, const std::uint32_t initial_handle = 0)
+            : beg_(buffer)
+            , end_(buffer + size)
+            , handle_(initial_handle) {
+        }
+
+        /**
+         * \brief Read the next command.
+         * \returns False when the buffer is exhausted, or the remaining data does not hold a whole command.
+         */
+        bool next(ws_cmd &cmd) {
+            if (static_cast<std::size_t>(end_ - beg_) < sizeof(ws_cmd_header)) {
+                return false;
+            }
+
+            std::uint8_t *cur = beg_;
+
+            std::memcpy(&cmd.header, cur, sizeof(ws_cmd_header));
+            cur += sizeof(ws_cmd_header);
+
+            if (cmd.header.op & WS_CMD_HANDLE_FLAG) {
+                if (static_cast<std::size_t>(end_ - cur) < sizeof(std::uint32_t)) {
+                    return false;
+                }
+
+                cmd.header.op &= ~WS_CMD_HANDLE_FLAG;
+
+                std::memcpy(&handle_, cur, sizeof(std::uint32_t));
+                cur += sizeof(std::uint32_t);
+            }
+
+            if (static_cast<std::size_t>(end_ - cur) < cmd.header.cmd_len) {
+                return false;
+            }
+
+            cmd.obj_handle = handle_;
+            cmd.data_ptr = cur;
+
+            beg_ = cur + cmd.header.cmd_len;
+            return true;
+        }
+
+        bool empty() const {
+            return beg_ >= end_;
+        }
+    };
+
     struct ws_cmd_screen_device_header {
         int num_screen;
         uint32_t screen_dvc_ptr;
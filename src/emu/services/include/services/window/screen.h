@@ -23,6 +23,7 @@
 #include <drivers/graphics/common.h>
 #include <services/window/classes/config.h>
 #include <services/window/common.h>
+#include <services/window/damage.h>
 
 #include <cstdint>
 #include <map>
@@ -47,6 +48,23 @@ namespace eka2l1::drivers {
 namespace eka2l1::epoc {
     struct window;
     struct window_group;
+    struct window_user;
+
+    /**
+     * \brief Statistics of the screen composition.
+     */
+    struct compose_stats {
+        std::uint64_t frames_composed = 0; ///< Redraws that actually drew something.
+        std::uint64_t frames_skipped = 0; ///< Redraws skipped because nothing changed.
+        std::uint64_t total_pixels_drawn = 0;
+
+        // Numbers of the last composed frame
+        std::uint64_t last_damaged_pixels = 0; ///< Pixels the damaged rectangles cover.
+        std::uint64_t last_pixels_drawn = 0; ///< Pixels drawn, counting overdraw of stacked windows.
+        std::uint32_t last_damage_rects = 0;
+        std::uint32_t last_windows_drawn = 0; ///< Counted once for each damaged rectangle the window is drawn in.
+        std::uint32_t last_windows_culled = 0; ///< Windows skipped for being hidden behind opaque windows.
+    };
 
     struct screen {
         int number;
@@ -86,6 +104,13 @@ namespace eka2l1::epoc {
         std::map<std::int32_t, eka2l1::rect> pointer_areas_;
         eka2l1::vec2 pointer_cursor_pos_;
 
+        damage_tracker damage; ///< Areas of the screen that changed since the last composition.
+        compose_stats stats;
+
+        // Reused between compositions so that redraws don't allocate
+        std::vector<epoc::window_user *> compose_windows;
+        std::vector<compose_layer> compose_layers;
+
         typedef void (*focus_change_callback_handler)(void *userdata, epoc::window_group *focus);
         using focus_change_callback = std::pair<void *, focus_change_callback_handler>;
 
@@ -158,7 +183,12 @@ namespace eka2l1::epoc {
         void resize(drivers::graphics_driver *driver, const eka2l1::vec2 &new_size);
 
         void deinit(drivers::graphics_driver *driver);
-        void redraw(drivers::graphics_command_list_builder *builder, const bool need_bind);
+
+        /**
+         * \brief Compose damaged areas of the screen.
+         * \returns False if nothing was damaged, and no command was recorded.
+         */
+        bool redraw(drivers::graphics_command_list_builder *builder, const bool need_bind);
 
         /**
          * \brief Redraw the screen.
@@ -166,6 +196,19 @@ namespace eka2l1::epoc {
          */
         void redraw(drivers::graphics_driver *driver);
 
+        /**
+         * \brief Mark an area of the screen as changed, so that the next redraw composes it again.
+         * \param area The changed area, in screen coordinates.
+         */
+        void add_damage(const eka2l1::rect &area);
+
+        /**
+         * \brief Mark the whole screen as changed.
+         *
+         * Used when windows move, appear or disappear, which may reveal any part of the screen.
+         */
+        void invalidate_all();
+
         /**
          * \brief Update the window group focus.
          */
@@ -164,6 +164,9 @@ namespace eka2l1::epoc {
         eka2l1::kernel::thread *client_thread;
         epoc::window_client_obj *last_obj;
 
+        std::uint32_t cached_obj_handle;
+        epoc::window_client_obj *cached_obj;
+
         epoc::version cli_version;
 
         epoc::redraw_fifo redraws;
@@ -231,7 +234,7 @@ namespace eka2l1::epoc {
         void get_ready(service::ipc_context &ctx, ws_cmd *cmd, const event_listener_type type);
 
         void execute_command(service::ipc_context &ctx, ws_cmd cmd);
-        void execute_commands(service::ipc_context &ctx, std::vector<ws_cmd> cmds);
+        void execute_commands(service::ipc_context &ctx, ws_cmd_buffer_reader &reader);
         void parse_command_buffer(service::ipc_context &ctx);
 
         std::uint32_t add_object(window_client_obj_ptr &obj);
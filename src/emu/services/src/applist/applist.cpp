@@ -170,7 +170,8 @@ namespace eka2l1 {
                 return {};
             }
 
-            loader::rsc_file std_rsc(reinterpret_cast<common::ro_stream *>(&std_rsc_raw));
+            loader::rsc_file std_rsc(reinterpret_cast<common::ro_stream *>(&std_rsc_raw), f->file_name(), f->last_modify_since_1ad(),
+                f->offset_in_image());
 
             if (confirm_sig) {
                 std_rsc.confirm_signature();
@@ -78,6 +78,10 @@ namespace eka2l1 {
             return false;
         }
 
+        return parse_new_centrep_ini(creini, repo);
+    }
+
+    bool parse_new_centrep_ini(common::ini_file &creini, central_repo &repo) {
         // Get the version
         if (!creini.find("cenrep")) {
             return false;
@@ -413,15 +417,29 @@ namespace eka2l1 {
                         return 0;
                     }
 
-                    // Try to load the INI
-                    auto path = io->get_raw_path(repo_folder + repoini);
+                    // Try to load the INI. Read it through the VFS, the one in ROM may only be in a ROM image
+                    symfile inifile = io->open_file(repo_folder + repoini, READ_MODE | BIN_MODE);
+
+                    if (!inifile) {
+                        continue;
+                    }
+
+                    std::vector<std::uint8_t> inibuf(inifile->size());
+
+                    if (!inibuf.empty()) {
+                        inifile->read_file(&inibuf[0], 1, static_cast<std::uint32_t>(inibuf.size()));
+                    }
+
+                    inifile->close();
+
+                    common::ini_file creini;
 
-                    if (!path) {
+                    if (creini.load(inibuf.data(), inibuf.size()) < 0) {
                         continue;
                     }
 
                     repo->uid = key;
-                    if (parse_new_centrep_ini(common::ucs2_to_utf8(*path), *repo)) {
+                    if (parse_new_centrep_ini(creini, *repo)) {
                         repo->reside_place = avail_drives[0];
                         repo->access_count = 1;
                         avail_drives.pop_back();
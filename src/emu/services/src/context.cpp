@@ -139,6 +139,59 @@ namespace eka2l1 {
             return std::nullopt;
         }
 
+        ipc_arg_decode_state ipc_context::begin_arguments_decode() {
+            return { msg->own_thr->owning_process(), sys->get_kernel_system()->is_eka1() };
+        }
+
+        bool is_descriptor_argument_type(const ipc_arg_type type, const bool is_16_bit) {
+            const bool is_descriptor = (int)type & (int)ipc_arg_type::flag_des;
+            const bool is_type_16_bit = (int)type & (int)ipc_arg_type::flag_16b;
+
+            return is_descriptor && (is_type_16_bit == is_16_bit);
+        }
+
+        template <typename T>
+        static bool fill_descriptor_argument_impl(epoc::desc<T> *des, kernel::process *owner, ipc_descriptor_arg<T> &value) {
+            if (!des || !des->is_valid_descriptor()) {
+                return false;
+            }
+
+            value.des = des;
+            value.owner = owner;
+            value.data = des->get_pointer(owner);
+            value.length = des->get_length();
+            value.max_length = des->get_max_length(owner);
+
+            return value.data || !value.max_length;
+        }
+
+        bool fill_descriptor_argument(epoc::desc<std::uint8_t> *des, kernel::process *owner, ipc_des8_arg &value) {
+            return fill_descriptor_argument_impl(des, owner, value);
+        }
+
+        bool fill_descriptor_argument(epoc::desc<char16_t> *des, kernel::process *owner, ipc_des16_arg &value) {
+            return fill_descriptor_argument_impl(des, owner, value);
+        }
+
+        template <typename T>
+        static bool decode_descriptor_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx,
+            ipc_descriptor_arg<T> &value) {
+            // EKA1 does not send argument types. Check before touching client memory.
+            if (!state.is_eka1 && !is_descriptor_argument_type(args.get_arg_type(idx), std::is_same_v<T, char16_t>)) {
+                return false;
+            }
+
+            return fill_descriptor_argument(ptr<epoc::desc<T>>(args.args[idx]).get(state.owner), state.owner, value);
+        }
+
+        bool decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx, ipc_des8_arg &value) {
+            return decode_descriptor_argument(args, state, idx, value);
+        }
+
+        bool decode_ipc_argument(ipc_arg &args, const ipc_arg_decode_state &state, const int idx, ipc_des16_arg &value) {
+            return decode_descriptor_argument(args, state, idx, value);
+        }
+
         void ipc_context::complete(int res) {
             if (msg->request_sts) {
                 kernel_system *kern = sys->get_kernel_system();
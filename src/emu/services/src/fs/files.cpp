@@ -253,14 +253,16 @@ namespace eka2l1 {
     }
 
     void fs_server_client::file_seek(service::ipc_context *ctx) {
-        std::optional<std::int32_t> handle_res = ctx->get_argument_value<std::int32_t>(3);
+        // Slot order: (0) seek offset, (1) seek mode, (2) new pos, (3) handle
+        auto args = ctx->get_arguments<std::int32_t, std::int32_t, service::ipc_unused_arg, std::int32_t>();
 
-        if (!handle_res) {
+        if (!args) {
             ctx->complete(epoc::error_argument);
             return;
         }
 
-        fs_node *node = get_file_node(*handle_res);
+        const auto [seek_off, seek_mode, new_pos, handle] = *args;
+        fs_node *node = get_file_node(handle);
 
         if (node == nullptr || node->vfs_node->type != io_component_type::file) {
             ctx->complete(epoc::error_bad_handle);
@@ -269,36 +271,26 @@ namespace eka2l1 {
 
         file *vfs_file = reinterpret_cast<file *>(node->vfs_node.get());
 
-        std::optional<std::int32_t> seek_mode = ctx->get_argument_value<std::int32_t>(1);
-        std::optional<std::int32_t> seek_off = ctx->get_argument_value<std::int32_t>(0);
-
-        if (!seek_mode || !seek_off) {
-            ctx->complete(epoc::error_argument);
-            return;
-        }
-
         file_seek_mode vfs_seek_mode;
 
-        switch (*seek_mode) {
+        switch (seek_mode) {
         case 0: // ESeekAddress. Handle this as a normal seek start
             vfs_seek_mode = file_seek_mode::address;
             break;
 
         default:
-            vfs_seek_mode = static_cast<file_seek_mode>(*seek_mode - 1);
+            vfs_seek_mode = static_cast<file_seek_mode>(seek_mode - 1);
             break;
         }
 
         // This should also support negative
-        std::uint64_t seek_res = vfs_file->seek(*seek_off, vfs_seek_mode);
+        std::uint64_t seek_res = vfs_file->seek(seek_off, vfs_seek_mode);
 
         if (seek_res == 0xFFFFFFFFFFFFFFFF) {
             ctx->complete(epoc::error_argument);
             return;
         }
 
-        // Slot order: (0) seek offset, (1) seek mode, (2) new pos
-
         if ((int)ctx->sys->get_symbian_version_use() >= (int)epocver::epoc95) {
             ctx->write_data_to_descriptor_argument(2, seek_res);
         } else {
@@ -390,20 +382,22 @@ namespace eka2l1 {
             return;
         }
 
-        std::optional<std::string> write_data = ctx->get_argument_value<std::string>(0);
+        fs_node *node = get_file_node(*handle_res);
 
-        if (!write_data) {
-            ctx->complete(epoc::error_argument);
+        if (node == nullptr || node->vfs_node->type != io_component_type::file) {
+            ctx->complete(epoc::error_bad_handle);
             return;
         }
 
-        fs_node *node = get_file_node(*handle_res);
+        // Slot order: (0) data, (1) length, (2) position, (3) handle
+        auto args = ctx->get_arguments<service::ipc_des8_arg, std::int32_t, std::int32_t>();
 
-        if (node == nullptr || node->vfs_node->type != io_component_type::file) {
-            ctx->complete(epoc::error_bad_handle);
+        if (!args) {
+            ctx->complete(epoc::error_argument);
             return;
         }
 
+        const auto [write_data, write_len_provided, write_pos_provided] = *args;
         file *vfs_file = reinterpret_cast<file *>(node->vfs_node.get());
 
         if (!(node->open_mode & WRITE_MODE)) {
@@ -411,8 +405,7 @@ namespace eka2l1 {
             return;
         }
 
-        std::int32_t write_len = *ctx->get_argument_value<std::int32_t>(1);
-        std::int32_t write_pos_provided = *ctx->get_argument_value<std::int32_t>(2);
+        const std::uint32_t write_len = write_data.clamp_read_length(write_len_provided);
 
         std::uint64_t write_pos = 0;
         std::uint64_t size_of_file = vfs_file->size();
@@ -436,7 +429,7 @@ namespace eka2l1 {
 
         // If this write pos is beyond the current end of file, use last pos
         vfs_file->seek(write_pos, file_seek_mode::beg);
-        size_t wrote_size = vfs_file->write_file(write_data.value().data(), 1, write_len);
+        size_t wrote_size = vfs_file->write_file(write_data.data, 1, write_len);
 
         //LOG_TRACE(SERVICE_EFSRV, "File {} wroted with size: {}, at {}", common::ucs2_to_utf8(vfs_file->file_name()), wrote_size, write_pos);
 
@@ -458,10 +451,16 @@ namespace eka2l1 {
             return;
         }
 
-        file *vfs_file = reinterpret_cast<file *>(node->vfs_node.get());
+        // Slot order: (0) buffer, (1) length, (2) position, (3) handle
+        auto args = ctx->get_arguments<service::ipc_des8_arg, std::int32_t, std::int32_t>();
+
+        if (!args) {
+            ctx->complete(epoc::error_argument);
+            return;
+        }
 
-        int read_len = *ctx->get_argument_value<std::int32_t>(1);
-        int read_pos_provided = *ctx->get_argument_value<std::int32_t>(2);
+        auto [read_buffer, read_len_provided, read_pos_provided] = *args;
+        file *vfs_file = reinterpret_cast<file *>(node->vfs_node.get());
 
         std::uint64_t read_pos = 0;
         std::uint64_t last_pos = vfs_file->tell();
@@ -475,17 +474,18 @@ namespace eka2l1 {
 
         vfs_file->seek(read_pos, file_seek_mode::beg);
 
-        uint64_t size = vfs_file->size();
+        const std::uint64_t size = vfs_file->size();
+        const std::uint64_t size_left = (size > read_pos) ? (size - read_pos) : 0;
 
-        if (size - read_pos < read_len) {
-            read_len = static_cast<int>(size - read_pos);
-        }
+        std::uint32_t read_len = read_buffer.clamp_write_length(read_len_provided);
 
-        std::vector<char> read_data;
-        read_data.resize(read_len);
+        if (size_left < read_len) {
+            read_len = static_cast<std::uint32_t>(size_left);
+        }
 
-        size_t read_finish_len = vfs_file->read_file(read_data.data(), 1, read_len);
-        ctx->write_data_to_descriptor_argument(0, reinterpret_cast<uint8_t *>(read_data.data()), static_cast<std::uint32_t>(read_finish_len));
+        // Read straight into the client's buffer
+        size_t read_finish_len = vfs_file->read_file(read_buffer.data, 1, read_len);
+        read_buffer.set_length(static_cast<std::uint32_t>(read_finish_len));
 
         //LOG_TRACE(SERVICE_EFSRV, "Readed {} from {} to address 0x{:x}", read_finish_len, read_pos, ctx->msg->args.args[0]);
         ctx->complete(epoc::error_none);
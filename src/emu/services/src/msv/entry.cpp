@@ -338,7 +338,9 @@ namespace eka2l1::epoc::msv {
         }
 
         ro_file_stream nearest_default_entries_file_stream(nearest_default_entries_file_io.get());
-        loader::rsc_file nearest_default_entries_loader(reinterpret_cast<common::ro_stream *>(&nearest_default_entries_file_stream));
+        loader::rsc_file nearest_default_entries_loader(reinterpret_cast<common::ro_stream *>(&nearest_default_entries_file_stream),
+            nearest_default_entries_file_io->file_name(), nearest_default_entries_file_io->last_modify_since_1ad(),
+            nearest_default_entries_file_io->offset_in_image());
 
         auto entries_info_buf = nearest_default_entries_loader.read(1);
 
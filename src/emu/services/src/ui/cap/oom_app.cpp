@@ -277,7 +277,8 @@ namespace eka2l1 {
             symfile resource_priv = io->open_file(designated_file, READ_MODE | BIN_MODE);
             if (resource_priv) {
                 ro_file_stream resource_priv_fstream(resource_priv.get());
-                loader::rsc_file resource_priv_parser(reinterpret_cast<common::ro_stream*>(&resource_priv_fstream));
+                loader::rsc_file resource_priv_parser(reinterpret_cast<common::ro_stream*>(&resource_priv_fstream),
+                    resource_priv->file_name(), resource_priv->last_modify_since_1ad(), resource_priv->offset_in_image());
 
                 auto data = resource_priv_parser.read(epoc::FEP_RESOURCE_ID);
                 common::chunkyseri seri(data.data(), data.size(), common::chunkyseri_mode::SERI_MODE_READ);
@@ -57,7 +57,8 @@ namespace eka2l1 {
 
         // Read the file
         eka2l1::ro_file_stream config_file_stream(config_file.get());
-        loader::rsc_file config_rsc(reinterpret_cast<common::ro_stream *>(&config_file_stream));
+        loader::rsc_file config_rsc(reinterpret_cast<common::ro_stream *>(&config_file_stream), config_file->file_name(),
+            config_file->last_modify_since_1ad(), config_file->offset_in_image());
 
         // Read the initialisation data
         // The RSC data are layout as follow:
@@ -72,7 +72,8 @@ namespace eka2l1 {
         }
 
         eka2l1::ro_file_stream fstream(f.get());
-        loader::rsc_file rsc_priority(reinterpret_cast<common::ro_stream *>(&fstream));
+        loader::rsc_file rsc_priority(reinterpret_cast<common::ro_stream *>(&fstream), f->file_name(), f->last_modify_since_1ad(),
+            f->offset_in_image());
 
         auto priority_view_value_raw = rsc_priority.read(2);
         priority_ = *reinterpret_cast<const std::uint32_t *>(priority_view_value_raw.data());
@@ -128,6 +128,7 @@ namespace eka2l1::epoc {
         extent.size = husband_->size;
 
         husband_->scr->dsa_rect.merge(extent);
+        husband_->damage(husband_->bounding_rect());
 
         ctx.complete(1);
     }
@@ -162,6 +163,7 @@ namespace eka2l1::epoc {
         state_ = state_completed;
 
         if (husband_) {
+            husband_->damage(husband_->bounding_rect());
             husband_->set_dsa_active(false);
             husband_->direct = nullptr;
             husband_ = nullptr;
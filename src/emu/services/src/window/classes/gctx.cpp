@@ -339,7 +339,9 @@ namespace eka2l1::epoc {
         if (cmd_list && !flushed) {
             flush_queue_to_driver();
 
-            // Content of the window changed, so call the handler
+            // Content of the window changed, so call the handler. Drawing in a redraw is clipped to the redraw rectangle.
+            const bool in_redraw = (attached_window->flags & epoc::window_user::flags_in_redraw);
+            attached_window->damage(in_redraw ? attached_window->redraw_rect_curr : attached_window->bounding_rect());
             attached_window->take_action_on_change(rq);
             flushed = true;
         }
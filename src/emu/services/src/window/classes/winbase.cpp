@@ -176,6 +176,11 @@ namespace eka2l1::epoc {
             return;
         }
 
+        // Whatever was below this window may be revealed
+        if (scr) {
+            scr->invalidate_all();
+        }
+
         window *ite = parent->child;
 
         if (parent->child == this) {
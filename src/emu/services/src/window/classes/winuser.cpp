@@ -141,6 +141,10 @@ namespace eka2l1::epoc {
     }
 
     void window_user::set_extent(const eka2l1::vec2 &top, const eka2l1::vec2 &new_size) {
+        if ((pos != top) || (size != new_size)) {
+            scr->invalidate_all();
+        }
+
         pos = top;
 
         if (size != new_size) {
@@ -174,6 +178,7 @@ namespace eka2l1::epoc {
         }
 
         flags &= ~flags_visible;
+        scr->invalidate_all();
 
         if (vis) {
             flags |= flags_visible;
@@ -227,6 +232,21 @@ namespace eka2l1::epoc {
         return scr->disp_mode;
     }
 
+    void window_user::damage(const eka2l1::rect &area) {
+        if (!is_visible()) {
+            return;
+        }
+
+        eka2l1::rect on_screen = area.intersect(bounding_rect());
+
+        if (is_rect_area_empty(on_screen)) {
+            return;
+        }
+
+        on_screen.top = on_screen.top + absolute_position();
+        scr->add_damage(on_screen);
+    }
+
     void window_user::take_action_on_change(kernel::thread *drawer) {
         // Want to trigger a screen redraw
         if (is_visible()) {
@@ -273,6 +293,9 @@ namespace eka2l1::epoc {
 
     void window_user::end_redraw(service::ipc_context &ctx, ws_cmd &cmd) {
         drivers::graphics_driver *drv = client->get_ws().get_graphics_driver();
+
+        // Drawing in the redraw was clipped to this
+        const eka2l1::rect redrawn_rect = redraw_rect_curr;
         redraw_rect_curr.make_empty();
 
         if (resize_needed) {
@@ -320,6 +343,7 @@ namespace eka2l1::epoc {
         } while (ite != end);
 
         if (any_flush_performed) {
+            damage(redrawn_rect);
             take_action_on_change(ctx.msg->own_thr);
         }
 
@@ -444,6 +468,7 @@ namespace eka2l1::epoc {
 
     void window_user::activate(service::ipc_context &context, ws_cmd &cmd) {
         flags |= flags_active;
+        damage(bounding_rect());
 
         invalidate(bounding_rect());
         context.complete(epoc::error_none);
@@ -511,6 +536,11 @@ namespace eka2l1::epoc {
 
         case EWsWinOpSetPos: {
             eka2l1::vec2 *pos_to_set = reinterpret_cast<eka2l1::vec2 *>(cmd.data_ptr);
+
+            if (pos != *pos_to_set) {
+                scr->invalidate_all();
+            }
+
             pos = *pos_to_set;
             ctx.complete(epoc::error_none);
             break;
@@ -557,6 +587,9 @@ namespace eka2l1::epoc {
         }
 
         case EWsWinOpSetBackgroundColor: {
+            // The background may now let windows behind show through, or stop doing so
+            damage(bounding_rect());
+
             if (cmd.header.cmd_len == 0) {
                 clear_color_enable = false;
                 ctx.complete(epoc::error_none);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <services/window/damage.h>
+
+#include <algorithm>
+
+namespace eka2l1::epoc {
+    damage_tracker::damage_tracker()
+        : full_(true) {
+    }
+
+    void damage_tracker::add(const eka2l1::rect &area) {
+        if (full_ || is_rect_area_empty(area)) {
+            return;
+        }
+
+        for (const eka2l1::rect &existing : rects_) {
+            if (existing.contains(area)) {
+                return;
+            }
+        }
+
+        // Drop everything the new area already covers
+        rects_.erase(std::remove_if(rects_.begin(), rects_.end(), [&](const eka2l1::rect &existing) {
+            return area.contains(existing);
+        }),
+            rects_.end());
+
+        rects_.push_back(area);
+
+        if (rects_.size() > MAX_DAMAGE_RECTS) {
+            eka2l1::rect bound = rects_[0];
+
+            for (std::size_t i = 1; i < rects_.size(); i++) {
+                bound.merge(rects_[i]);
+            }
+
+            rects_.clear();
+            rects_.push_back(bound);
+        }
+    }
+
+    void damage_tracker::add_all() {
+        full_ = true;
+        rects_.clear();
+    }
+
+    void damage_tracker::clear() {
+        full_ = false;
+        rects_.clear();
+    }
+
+    bool is_layer_covered(const std::vector<compose_layer> &layers, const std::size_t index, const eka2l1::rect &area) {
+        const eka2l1::rect visible_part = layers[index].area.intersect(area);
+
+        if (is_rect_area_empty(visible_part)) {
+            return true;
+        }
+
+        for (std::size_t i = index + 1; i < layers.size(); i++) {
+            if (layers[i].opaque && layers[i].area.contains(visible_part)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -32,13 +32,11 @@
 #include <thread>
 
 namespace eka2l1::epoc {
-    struct window_drawer_walker : public window_tree_walker {
-        drivers::graphics_command_list_builder *builder_;
-        std::uint32_t total_redrawed_;
+    struct window_compose_collector : public window_tree_walker {
+        std::vector<epoc::window_user *> &windows_;
 
-        explicit window_drawer_walker(drivers::graphics_command_list_builder *builder)
-            : builder_(builder)
-            , total_redrawed_(0) {
+        explicit window_compose_collector(std::vector<epoc::window_user *> &windows)
+            : windows_(windows) {
         }
 
         bool do_it(window *win) {
@@ -59,31 +57,25 @@ namespace eka2l1::epoc {
                 return false;
             }
 
-            eka2l1::vec2 abs_pos = winuser->absolute_position();
-
-            if (winuser->clear_color_enable) {
-                auto color_extracted = common::rgb_to_vec(winuser->clear_color);
-
-                if (winuser->display_mode() <= epoc::display_mode::color16mu) {
-                    color_extracted[0] = 255;
-                }
-
-                builder_->set_brush_color_detail({ color_extracted[1], color_extracted[2], color_extracted[3], color_extracted[0] });
-                builder_->draw_rectangle(eka2l1::rect(abs_pos, winuser->size));
-            } else {
-                builder_->set_brush_color(eka2l1::vec3(255, 255, 255));
-            }
-
-            // Draw it onto current binding buffer
-            builder_->draw_bitmap(winuser->driver_win_id, 0, eka2l1::rect(abs_pos, { 0, 0 }),
-                eka2l1::rect({ 0, 0 }, winuser->size), eka2l1::vec2(0, 0), 0.0f, 0);
-
-            total_redrawed_++;
-
+            windows_.push_back(winuser);
             return false;
         }
     };
 
+    static bool is_window_opaque(const window_user *winuser) {
+        // The background is drawn first with blending replaced, so nothing behind shows through
+        // once it has full alpha. The window content blends over it.
+        if (!winuser->clear_color_enable) {
+            return false;
+        }
+
+        return (winuser->display_mode() <= epoc::display_mode::color16mu) || ((winuser->clear_color >> 24) == 0xFF);
+    }
+
+    static std::uint64_t rect_area(const eka2l1::rect &area) {
+        return static_cast<std::uint64_t>(area.size.x) * static_cast<std::uint64_t>(area.size.y);
+    }
+
     screen::screen(const int number, epoc::config::screen &scr_conf)
         : number(number)
         , ui_rotation(0)
@@ -110,24 +102,103 @@ namespace eka2l1::epoc {
         }
     }
 
-    void screen::redraw(drivers::graphics_command_list_builder *cmd_builder, const bool need_bind) {
+    bool screen::redraw(drivers::graphics_command_list_builder *cmd_builder, const bool need_bind) {
+        if (damage.empty()) {
+            // The screen texture still holds the last composition, which is up to date
+            stats.frames_skipped++;
+            return false;
+        }
+
+        compose_windows.clear();
+        compose_layers.clear();
+
+        // Walk through the window tree in recursive order, collecting what can be seen
+        window_compose_collector collector(compose_windows);
+        root->walk_tree_back_to_front(&collector);
+
+        for (window_user *winuser : compose_windows) {
+            compose_layers.push_back({ eka2l1::rect(winuser->absolute_position(), winuser->size), is_window_opaque(winuser) });
+        }
+
         if (need_bind) {
             cmd_builder->bind_bitmap(screen_texture);
         }
-        
+
         cmd_builder->set_blend_mode(true);
         cmd_builder->blend_formula(drivers::blend_equation::add, drivers::blend_equation::add,
             drivers::blend_factor::frag_out_alpha, drivers::blend_factor::one_minus_frag_out_alpha,
             drivers::blend_factor::one, drivers::blend_factor::one);
 
-        // Walk through the window tree in recursive order, and do draw
-        // We dont care about visible regions. Nowadays, detect visible region to reduce pixel plotting is
-        // just not really worth the time, since GPU draws so fast. Symbian code still has it though.
-        window_drawer_walker adrawwalker(cmd_builder);
-        root->walk_tree_back_to_front(&adrawwalker);
+        const eka2l1::rect screen_area({ 0, 0 }, current_mode().size);
+
+        stats.last_damaged_pixels = 0;
+        stats.last_pixels_drawn = 0;
+        stats.last_damage_rects = 0;
+        stats.last_windows_drawn = 0;
+        stats.last_windows_culled = 0;
+
+        auto compose_area = [&](const eka2l1::rect &damaged) {
+            const eka2l1::rect area = damaged.intersect(screen_area);
+
+            if (is_rect_area_empty(area)) {
+                return;
+            }
+
+            stats.last_damage_rects++;
+            stats.last_damaged_pixels += rect_area(area);
+
+            for (std::size_t i = 0; i < compose_layers.size(); i++) {
+                const eka2l1::rect part = compose_layers[i].area.intersect(area);
+
+                if (is_rect_area_empty(part)) {
+                    continue;
+                }
+
+                if (is_layer_covered(compose_layers, i, area)) {
+                    stats.last_windows_culled++;
+                    continue;
+                }
+
+                window_user *winuser = compose_windows[i];
+
+                if (winuser->clear_color_enable) {
+                    auto color_extracted = common::rgb_to_vec(winuser->clear_color);
+
+                    if (winuser->display_mode() <= epoc::display_mode::color16mu) {
+                        color_extracted[0] = 255;
+                    }
+
+                    cmd_builder->set_brush_color_detail({ color_extracted[1], color_extracted[2], color_extracted[3], color_extracted[0] });
+                    cmd_builder->draw_rectangle(part);
+                } else {
+                    cmd_builder->set_brush_color(eka2l1::vec3(255, 255, 255));
+                }
+
+                // Only draw the part of the window that is inside the damaged area
+                cmd_builder->draw_bitmap(winuser->driver_win_id, 0, eka2l1::rect(part.top, { 0, 0 }),
+                    eka2l1::rect(part.top - compose_layers[i].area.top, part.size), eka2l1::vec2(0, 0), 0.0f, 0);
+
+                stats.last_windows_drawn++;
+                stats.last_pixels_drawn += rect_area(part);
+            }
+        };
+
+        if (damage.is_full()) {
+            compose_area(screen_area);
+        } else {
+            for (const eka2l1::rect &damaged : damage.rects()) {
+                compose_area(damaged);
+            }
+        }
+
+        damage.clear();
+
+        stats.frames_composed++;
+        stats.total_pixels_drawn += stats.last_pixels_drawn;
 
         // Done! Unbind and submit this to the driver
         cmd_builder->bind_bitmap(0);
+        return true;
     }
 
     void screen::redraw(drivers::graphics_driver *driver) {
@@ -138,8 +209,18 @@ namespace eka2l1::epoc {
         // Make command list first, and bind our screen bitmap
         auto cmd_list = driver->new_command_list();
         auto cmd_builder = driver->new_command_builder(cmd_list.get());
-        redraw(cmd_builder.get(), true);
-        driver->submit_command_list(*cmd_list);
+
+        if (redraw(cmd_builder.get(), true)) {
+            driver->submit_command_list(*cmd_list);
+        }
+    }
+
+    void screen::add_damage(const eka2l1::rect &area) {
+        damage.add(area);
+    }
+
+    void screen::invalidate_all() {
+        damage.add_all();
     }
 
     void screen::deinit(drivers::graphics_driver *driver) {
@@ -184,6 +265,9 @@ namespace eka2l1::epoc {
             need_bind = false;
         }
 
+        // All pixels are lost
+        invalidate_all();
+
         redraw(cmd_builder.get(), need_bind);
         driver->submit_command_list(*cmd_list);
     }
@@ -98,51 +98,35 @@ namespace eka2l1::epoc {
     }
 
     void window_server_client::parse_command_buffer(service::ipc_context &ctx) {
-        std::optional<std::string> dat = ctx.get_argument_value<std::string>(cmd_slot);
+        std::uint8_t *buffer = ctx.get_descriptor_argument_ptr(cmd_slot);
 
-        if (!dat) {
+        if (!buffer) {
             return;
         }
 
-        char *beg = dat->data();
-        char *end = dat->data() + dat->size();
-
-        std::vector<ws_cmd> cmds;
-
-        while (beg < end) {
-            ws_cmd cmd;
-
-            cmd.header = *reinterpret_cast<ws_cmd_header *>(beg);
-
-            if (cmd.header.op & 0x8000) {
-                cmd.header.op &= ~0x8000;
-                cmd.obj_handle = *reinterpret_cast<std::uint32_t *>(beg + sizeof(ws_cmd_header));
-
-                beg += sizeof(ws_cmd_header) + sizeof(cmd.obj_handle);
-            } else {
-                beg += sizeof(ws_cmd_header);
-            }
-
-            cmd.data_ptr = reinterpret_cast<void *>(beg);
-            beg += cmd.header.cmd_len;
-
-            cmds.push_back(std::move(cmd));
-        }
-
-        execute_commands(ctx, std::move(cmds));
+        ws_cmd_buffer_reader reader(buffer, ctx.get_argument_data_size(cmd_slot));
+        execute_commands(ctx, reader);
     }
 
     window_server_client::window_server_client(service::session *guest_session, kernel::thread *own_thread, epoc::version ver)
         : guest_session(guest_session)
         , client_thread(own_thread)
         , last_obj(nullptr)
+        , cached_obj_handle(0)
+        , cached_obj(nullptr)
         , cli_version(ver)
         , primary_device(nullptr)
         , uid_counter(0) {
     }
 
-    void window_server_client::execute_commands(service::ipc_context &ctx, std::vector<ws_cmd> cmds) {
-        for (auto &cmd : cmds) {
+    void window_server_client::execute_commands(service::ipc_context &ctx, ws_cmd_buffer_reader &reader) {
+        ws_cmd cmd;
+
+        // Handles are resolved once per run of commands targeting the same object
+        cached_obj_handle = 0;
+        cached_obj = nullptr;
+
+        while (reader.next(cmd)) {
             if (cmd.obj_handle == guest_session->unique_id()) {
                 if (last_obj) {
                     last_obj->on_command_batch_done(ctx);
@@ -150,8 +134,17 @@ namespace eka2l1::epoc {
                 }
 
                 execute_command(ctx, cmd);
+
+                // Client commands may create or destroy objects
+                cached_obj_handle = 0;
+                cached_obj = nullptr;
             } else {
-                if (auto obj = get_object(cmd.obj_handle)) {
+                if (cmd.obj_handle != cached_obj_handle) {
+                    cached_obj_handle = cmd.obj_handle;
+                    cached_obj = get_object(cmd.obj_handle);
+                }
+
+                if (auto obj = cached_obj) {
                     if (last_obj != obj) {
                         if (last_obj != nullptr) {
                             last_obj->on_command_batch_done(ctx);
@@ -163,11 +156,17 @@ namespace eka2l1::epoc {
                     if (obj->execute_command(ctx, cmd)) {
                         // The command batch is silently flushed...
                         last_obj = nullptr;
+                        cached_obj_handle = 0;
+                        cached_obj = nullptr;
                     }
                 }
             }
         }
 
+        if (!reader.empty()) {
+            LOG_WARN(SERVICE_WINDOW, "Command buffer ends with a truncated command, ignored");
+        }
+
         if (last_obj) {
             last_obj->on_command_batch_done(ctx);
             last_obj = nullptr;
@@ -210,6 +209,11 @@ namespace eka2l1::epoc {
             return false;
         }
 
+        if (cached_obj == objects[idx - 1].get()) {
+            cached_obj_handle = 0;
+            cached_obj = nullptr;
+        }
+
         objects[idx - 1].reset();
         return true;
     }
@@ -1113,15 +1117,23 @@ namespace eka2l1 {
         wsini_path += static_cast<char16_t>((char)dn + 'A');
         wsini_path += u":\\system\\data\\wsini.ini";
 
-        auto wsini_path_host = io->get_raw_path(wsini_path);
+        // Read through the VFS, the file may only be in a ROM image
+        symfile wsini_file = io->open_file(wsini_path, READ_MODE | BIN_MODE);
 
-        if (!wsini_path_host) {
+        if (!wsini_file) {
             LOG_ERROR(SERVICE_WINDOW, "Can't find the window config file, app using window server will broken");
             return;
         }
 
-        std::string wsini_path_host_utf8 = common::ucs2_to_utf8(*wsini_path_host);
-        int err = ws_config.load(wsini_path_host_utf8.c_str());
+        std::vector<std::uint8_t> wsini_data(wsini_file->size());
+
+        if (!wsini_data.empty()) {
+            wsini_file->read_file(wsini_data.data(), 1, static_cast<std::uint32_t>(wsini_data.size()));
+        }
+
+        wsini_file->close();
+
+        int err = ws_config.load(wsini_data.data(), wsini_data.size());
 
         if (err != 0) {
             LOG_ERROR(SERVICE_WINDOW, "Loading wsini file broke with code {}", err);
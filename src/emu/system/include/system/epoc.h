@@ -82,6 +82,8 @@ namespace eka2l1 {
     class system;
     class system_impl;
 
+    struct system_shared_resources;
+
     using hal_instance = std::unique_ptr<epoc::hal>;
     using system_reset_callback_type = std::function<void(system *)>;
 
@@ -92,6 +94,8 @@ namespace eka2l1 {
         config::state *conf_;
         config::app_settings *settings_;
 
+        system_shared_resources *shared_; ///< Resources shared with other instances. May be null.
+
         explicit system_create_components();
     };
 
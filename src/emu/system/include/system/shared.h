@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/sharedcache.h>
+#include <loader/rom.h>
+#include <vfs/vfs.h>
+
+#include <string>
+
+namespace eka2l1 {
+    /**
+     * \brief Immutable resources that emulator instances in the same process can share.
+     * 
+     * Create one, and hand it to every instance through system_create_components. It must outlive
+     * all of them. An instance that is not given one keeps its own, and shares nothing.
+     * 
+     * Only the parsed ROM and the mapped ROFS images are shared. Loaded codesegs and font data
+     * are patched by the kernel and services after loading, so each instance keeps its own copy.
+     */
+    struct system_shared_resources {
+        common::shared_cache<std::string, loader::rom> roms_; ///< Parsed ROMs, keyed by path, size and modification time.
+        rofs_image_cache rofs_images_; ///< Mapped ROFS images, keyed the same way.
+    };
+}
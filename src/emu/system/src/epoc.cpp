@@ -35,6 +35,7 @@
 #include <system/consts.h>
 #include <system/hal.h>
 #include <system/epoc.h>
+#include <system/shared.h>
 
 #include <utils/panic.h>
 
@@ -42,7 +43,9 @@
 #include <scripting/manager.h>
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 
@@ -85,7 +88,8 @@ namespace eka2l1 {
         : graphics_(nullptr)
         , audio_(nullptr)
         , conf_(nullptr)
-        , settings_(nullptr) {
+        , settings_(nullptr)
+        , shared_(nullptr) {
 
     }
     
@@ -115,7 +119,12 @@ namespace eka2l1 {
 #endif
 
         debugger_base *debugger_;
-        loader::rom romf_;
+
+        // Shared with the other instances of the process. Never null, an empty ROM is used until one is loaded.
+        std::shared_ptr<loader::rom> romf_;
+
+        std::unique_ptr<system_shared_resources> own_shared_;
+        system_shared_resources *shared_;
         window_server *winserv_;
 
         config::state *conf_;
@@ -177,7 +186,7 @@ namespace eka2l1 {
             epoc::init_hal(parent_);
 
             // Initialize HLE finally
-            dispatcher_ = std::make_unique<dispatch::dispatcher>(kern_.get(), timing_.get());
+            dispatcher_ = std::make_unique<dispatch::dispatcher>(kern_.get(), timing_.get(), conf_->present_on_thread);
 
             winserv_ = reinterpret_cast<window_server *>(kern_->get_by_name<service::server>(eka2l1::get_winserv_name_by_epocver(
                 kern_->get_epoc_version())));
@@ -374,7 +383,7 @@ namespace eka2l1 {
         }
 
         loader::rom *get_rom_info() {
-            return &romf_;
+            return romf_.get();
         }
 
         epocver get_symbian_version_use() const {
@@ -506,7 +515,7 @@ namespace eka2l1 {
         exmonitor = arm::create_exclusive_monitor(cpu_type, 1);
         cpu = arm::create_core(exmonitor.get(), cpu_type);
 
-        kern_ = std::make_unique<kernel_system>(parent_, timing_.get(), io_.get(), conf_, app_settings_, &romf_, cpu.get(),
+        kern_ = std::make_unique<kernel_system>(parent_, timing_.get(), io_.get(), conf_, app_settings_, romf_.get(), cpu.get(),
             disassembler_.get());
 
         epoc::init_panic_descriptions();
@@ -523,7 +532,14 @@ namespace eka2l1 {
         , adriver(param.audio_)
         , conf_(param.conf_)
         , app_settings_(param.settings_)
+        , romf_(std::make_shared<loader::rom>())
+        , shared_(param.shared_)
         , exit(false) {
+        if (!shared_) {
+            own_shared_ = std::make_unique<system_shared_resources>();
+            shared_ = own_shared_.get();
+        }
+
 #if EKA2L1_ARCH(ARM)
         cpu_type = arm_emulator_type::r12l1;
 #else
@@ -658,40 +674,95 @@ namespace eka2l1 {
         return packages_->install_package(path, drv, h);
     }
 
+    // ROFS images kept by the firmware installer sit next to the ROM, named ROFS1.IMG, ROFS2.IMG... in priority order
+    static void mount_rofs_images(abstract_file_system *rom_fs, const std::string &rom_dir) {
+        common::dir_iterator ite(rom_dir);
+        common::dir_entry image_entry;
+
+        // Index parsed from the name, and the path
+        std::vector<std::pair<int, std::string>> image_paths;
+
+        while (ite.next_entry(image_entry) == 0) {
+            const std::string name_lower = common::lowercase_string(image_entry.name);
+
+            if ((name_lower.compare(0, 4, "rofs") == 0) && (eka2l1::path_extension(name_lower) == ".img")) {
+                // Sort by the number, ROFS10 comes after ROFS9
+                const int index = std::atoi(name_lower.c_str() + 4);
+                image_paths.emplace_back(index, eka2l1::add_path(rom_dir, image_entry.name));
+            }
+        }
+
+        std::sort(image_paths.begin(), image_paths.end());
+
+        for (const auto &[index, image_path]: image_paths) {
+            if (!rom_fs->mount_image(drive_z, common::utf8_to_ucs2(image_path))) {
+                LOG_WARN(SYSTEM, "Unable to mount ROFS image {}", image_path);
+            }
+        }
+    }
+
+    // The parsed ROM tree is immutable after load, so instances given the same shared resources reuse it
+    static std::shared_ptr<loader::rom> load_shared_rom(system_shared_resources &shared, const std::string &path) {
+        const std::string cache_key = fmt::format("{}|{}|{}", path, common::file_size(path),
+            common::get_last_modifiy_since_ad(common::utf8_to_ucs2(path)));
+
+        return shared.roms_.get_or_create(cache_key, [&]() -> std::shared_ptr<loader::rom> {
+            symfile f = eka2l1::physical_file_proxy(path, READ_MODE | BIN_MODE);
+
+            if (!f || !f->valid()) {
+                LOG_ERROR(SYSTEM, "ROM file not present: {}", path);
+                return nullptr;
+            }
+
+            eka2l1::ro_file_stream rom_fstream(f.get());
+            std::optional<loader::rom> romf_res = loader::load_rom(reinterpret_cast<common::ro_stream *>(
+                &rom_fstream));
+
+            if (!romf_res) {
+                return nullptr;
+            }
+
+            return std::make_shared<loader::rom>(std::move(*romf_res));
+        });
+    }
+
     bool system_impl::load_rom(const std::string &path) {
-        symfile f = eka2l1::physical_file_proxy(path, READ_MODE | BIN_MODE);
+        std::shared_ptr<loader::rom> new_rom = load_shared_rom(*shared_, path);
 
-        if (!f || !f->valid()) {
-            LOG_ERROR(SYSTEM, "ROM file not present: {}", path);
+        if (!new_rom) {
             return false;
         }
 
-        eka2l1::ro_file_stream rom_fstream(f.get());
-        std::optional<loader::rom> romf_res = loader::load_rom(reinterpret_cast<common::ro_stream *>(
-            &rom_fstream));
+        auto current_device = dvcmngr_->get_current();
 
-        if (!romf_res) {
+        if (!current_device) {
             return false;
         }
 
-        rom_fstream.seek(0, common::seek_where::beg);
+        std::optional<drive> rom_drive;
 
-        romf_ = std::move(*romf_res);
+        if (rom_fs_id_.has_value()) {
+            // The filesystem refers to the previous ROM and its ROFS images, recreate it
+            rom_drive = io_->get_drive_entry(drive_z);
+            io_->remove_filesystem(rom_fs_id_.value());
+            rom_fs_id_.reset();
+        }
 
-        if (!rom_fs_id_.has_value()) {
-            auto current_device = dvcmngr_->get_current();
+        romf_ = std::move(new_rom);
+        kern_->set_rom_info(romf_.get());
 
-            if (!current_device) {
-                return false;
-            }
+        file_system_inst rom_fs = create_rom_filesystem(romf_.get(), mem_.get(),
+            get_symbian_version_use(), current_device->firmware_code, &shared_->rofs_images_);
 
-            file_system_inst rom_fs = create_rom_filesystem(&romf_, mem_.get(),
-                get_symbian_version_use(), current_device->firmware_code);
+        mount_rofs_images(rom_fs.get(), eka2l1::file_directory(path));
+        rom_fs_id_ = io_->add_filesystem(rom_fs);
 
-            rom_fs_id_ = io_->add_filesystem(rom_fs);
+        if (rom_drive) {
+            io_->mount_physical_path(drive_z, rom_drive->media_type, rom_drive->attribute,
+                common::utf8_to_ucs2(rom_drive->real_path));
         }
 
-        bool res1 = kern_->map_rom(romf_.header.rom_base, path);
+        bool res1 = kern_->map_rom(romf_->header.rom_base, path);
 
         if (!res1) {
             return false;
@@ -100,7 +100,7 @@ namespace eka2l1 {
 
     static device_installation_error dump_data_from_fpsx(loader::firmware::fpsx_header &header, common::ro_stream &stream, const std::string &drives_c_path,
         const std::string &drives_e_path, const std::string &drives_z_path, const std::string &rom_resident_path,
-        std::atomic<int> &progress, const int max_progress) {
+        std::vector<std::string> &rofs_images, std::atomic<int> &progress, const int max_progress) {
         if (header.type_ == loader::firmware::FPSX_TYPE_INVALID) {
             progress += max_progress;
             return device_installation_none;
@@ -183,7 +183,9 @@ namespace eka2l1 {
             }
         }
 
-        std::string image_path = eka2l1::add_path(rom_resident_path, "TEMP.IMG");
+        const bool is_uda = (header.type_ == loader::firmware::FPSX_TYPE_UDA);
+        const std::string image_path = eka2l1::add_path(rom_resident_path, is_uda ? "TEMP.IMG" :
+            ("ROFS" + std::to_string(rofs_images.size() + 1) + ".IMG"));
         std::ofstream rom_stream(image_path, std::ios_base::binary);
 
         loader::firmware::block_tree_entry *appropiate_block = nullptr;
@@ -228,7 +230,7 @@ namespace eka2l1 {
         rom_stream.close();
 
         // What to do with it now?
-        if (header.type_ == loader::firmware::FPSX_TYPE_UDA) {
+        if (is_uda) {
             // Extract the FAT image, with some twists
             // I was using ifstream, but not sure why it fucked up
             FILE *fat_image_file = fopen(image_path.c_str(), "rb");
@@ -255,14 +257,28 @@ namespace eka2l1 {
 
             progress += max_progress;
         } else {
-            // Extract the ROFS image
+            // Keep the ROFS image, it's mounted in place when the device boots
             common::ro_std_file_stream rofs_img_stream(image_path, true);
+            loader::rofs_index index;
 
-            // Dump quality ROFS content!!!!!
-            if (!loader::dump_rofs_system(rofs_img_stream, drives_z_path, progress, max_progress)) {
-                LOG_ERROR(SYSTEM, "Error while dumping ROFS!");
+            if (!loader::build_rofs_index(rofs_img_stream, index)) {
+                LOG_ERROR(SYSTEM, "Error while indexing ROFS!");
                 return device_installation_rofs_corrupt;
             }
+
+            // Product and version detection read these from the host, before any image is mounted
+            static const char16_t *HOST_NEEDED_DIRS[] = { u"\\resource\\versions", u"\\system\\versions",
+                u"\\system\\install" };
+
+            for (const char16_t *needed_dir: HOST_NEEDED_DIRS) {
+                loader::extract_rofs_directory_files(rofs_img_stream, index, needed_dir,
+                    eka2l1::add_path(drives_z_path, common::ucs2_to_utf8(needed_dir).substr(1) + "\\"));
+            }
+
+            rofs_images.push_back(image_path);
+            progress += max_progress;
+
+            return device_installation_none;
         }
 
         // Remove the image, no need it no more :((
@@ -401,6 +417,7 @@ namespace eka2l1 {
         }
 
         std::string drives_z_temp_path = eka2l1::add_path(drives_z_path, "temp\\");
+        std::vector<std::string> rofs_images;
 
         for (auto &fpsx_filename: filenames) {
             common::ro_std_file_stream fpsx_file_stream(fpsx_filename, true);
@@ -413,7 +430,7 @@ namespace eka2l1 {
             }
 
             const auto result = dump_data_from_fpsx(fpsx_head.value(), fpsx_file_stream, drives_c_path, drives_e_path, drives_z_temp_path,
-                rom_resident_path, progress, average_progress_max);
+                rom_resident_path, rofs_images, progress, average_progress_max);
 
             if (result != device_installation_none) {
                 return result;
@@ -431,6 +448,10 @@ namespace eka2l1 {
             LOG_ERROR(SYSTEM, "Revert all changes");
             eka2l1::common::remove(drives_z_temp_path);
 
+            for (const std::string &rofs_image: rofs_images) {
+                eka2l1::common::remove(rofs_image);
+            }
+
             return device_installation_determine_product_failure;
         }
 
@@ -443,6 +464,10 @@ namespace eka2l1 {
         eka2l1::create_directories(eka2l1::file_directory(target_rom_path));
         common::move_file(drives_z_temp_path, add_path(drives_z_path, firmcode_low + "\\"));
         common::move_file(current_temp_rom, target_rom_path);
+
+        for (const std::string &rofs_image: rofs_images) {
+            common::move_file(rofs_image, eka2l1::add_path(eka2l1::file_directory(target_rom_path), eka2l1::filename(rofs_image)));
+        }
         
         const add_device_error err_adddvc = dvcmngr->add_new_device(firmcode, model, manufacturer, ver, 0);
 
@@ -21,6 +21,7 @@
 
 #include <common/buffer.h>
 #include <common/container.h>
+#include <common/sharedcache.h>
 #include <common/types.h>
 #include <common/watcher.h>
 #include <common/uid.h>
@@ -177,6 +178,15 @@ namespace eka2l1 {
 
         virtual std::uint64_t last_modify_since_1ad() = 0;
 
+        /*! \brief Get the offset of the file data in the filesystem image storing it.
+         *
+         * Files in a ROFS image share the image's modification time, this tells them apart.
+         * Standalone files return 0.
+         */
+        virtual std::uint64_t offset_in_image() const {
+            return 0;
+        }
+
         std::size_t read_file(const std::uint64_t offset, void *buf, std::uint32_t size,
             std::uint32_t count);
     };
@@ -259,6 +269,12 @@ namespace eka2l1 {
             return false;
         }
 
+        /*! \brief Mount a read-only filesystem image on a drive, served in place from the image file.
+        */
+        virtual bool mount_image(const drive_number drv, const std::u16string &image_path) {
+            return false;
+        }
+
         virtual bool unmount(const drive_number drv) = 0;
 
         virtual std::unique_ptr<file> open_file(const std::u16string &path, const int mode) = 0;
@@ -312,9 +328,23 @@ namespace eka2l1 {
         virtual void validate_for_host() = 0;
     };
 
+    struct rofs_mounted_image;
+
+    /**
+     * \brief Mapped ROFS images, shared by the ROM filesystems it is given to.
+     */
+    using rofs_image_cache = common::shared_cache<std::string, rofs_mounted_image>;
+
     std::shared_ptr<abstract_file_system> create_physical_filesystem(const epocver ver, const std::string &product_code);
+
+    /**
+     * \brief Create the filesystem serving the ROM and the ROFS images mounted on it.
+     * 
+     * \param image_cache  Where to look up ROFS images mapped by other filesystems. If null, the
+     *                     filesystem maps its images for itself.
+     */
     std::shared_ptr<abstract_file_system> create_rom_filesystem(loader::rom *rom_cache, memory_system *mem,
-        const epocver ver, const std::string &product_code);
+        const epocver ver, const std::string &product_code, rofs_image_cache *image_cache = nullptr);
 
     using file_system_inst = std::shared_ptr<abstract_file_system>;
     using filesystem_id = std::size_t;
@@ -483,4 +513,22 @@ namespace eka2l1 {
 
         std::uint64_t write(const void *buf, const std::uint64_t write_size) override;
     };
+
+    class rw_file_stream : public common::rw_stream {
+        file *f_;
+
+    public:
+        explicit rw_file_stream(file *f)
+            : f_(f) {
+        }
+
+        void seek(const std::int64_t amount, common::seek_where wh) override;
+        bool valid() override;
+        std::uint64_t left() override;
+        uint64_t tell() const override;
+        uint64_t size() override;
+
+        std::uint64_t read(void *buf, const std::uint64_t read_size) override;
+        std::uint64_t write(const void *buf, const std::uint64_t write_size) override;
+    };
 }
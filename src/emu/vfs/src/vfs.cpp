@@ -24,8 +24,11 @@
 #include <common/log.h>
 #include <common/path.h>
 #include <common/platform.h>
+#include <common/sharedcache.h>
+#include <common/virtualmem.h>
 #include <common/wildcard.h>
 
+#include <loader/rofs.h>
 #include <loader/rom.h>
 #include <mem/mem.h>
 #include <mem/ptr.h>
@@ -37,8 +40,11 @@
 #include <map>
 #include <mutex>
 #include <regex>
+#include <set>
 #include <thread>
 #include <stack>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <string.h>
 
@@ -552,10 +558,248 @@ namespace eka2l1 {
         }
     };
 
+    // Gives up caching host paths that are not in a canonical form (relative components, duplicated separators)
+    static bool is_plain_host_path(const std::string &path) {
+        if ((path.find("//") != std::string::npos) || (path.find("/./") != std::string::npos) || (path.find("/../") != std::string::npos)) {
+            return false;
+        }
+
+        const std::string name = eka2l1::filename(path);
+        return (name != ".") && (name != "..");
+    }
+
     class physical_file_system : public abstract_file_system {
         std::mutex fs_mutex;
         std::unique_ptr<common::directory_watcher> watcher_;
 
+        struct translated_path {
+            std::u16string host_path_;
+            std::size_t host_root_length_;
+            bool is_root_;
+        };
+
+        // Virtual path to host path. Dropped as a whole when full or when the mapping changes.
+        static constexpr std::size_t MAX_TRANSLATION_CACHE_SIZE = 4096;
+        std::unordered_map<std::u16string, translated_path> translation_cache_;
+
+        // Host directory listings used to answer existence queries without asking the host.
+        // A listed directory is watched, and any change reported on it drops the listing.
+        static constexpr std::size_t MAX_LISTING_WATCH_COUNT = 512;
+        std::unordered_map<std::string, std::unordered_map<std::string, common::file_type>> listing_cache_;
+        std::unordered_map<std::string, std::int32_t> listing_watches_;
+
+        // Parent directory to the child directories that have a listing cached in their subtree.
+        // Lets a change drop a subtree without walking every cached listing.
+        std::unordered_map<std::string, std::unordered_set<std::string>> listing_children_;
+
+        std::mutex cache_lock_;
+
+        // Must be destroyed before the caches it invalidates
+        std::unique_ptr<common::directory_watcher> listing_watcher_;
+
+        static std::string host_parent_path(const std::string &host_path) {
+            const std::size_t sep_pos = host_path.find_last_of('/');
+            return ((sep_pos == std::string::npos) || (sep_pos == 0)) ? std::string{} : host_path.substr(0, sep_pos);
+        }
+
+        void invalidate_path_caches() {
+            const std::lock_guard<std::mutex> guard(cache_lock_);
+            translation_cache_.clear();
+            listing_cache_.clear();
+            listing_children_.clear();
+        }
+
+        // Must be called with the cache lock held
+        void index_host_listing_no_lock(const std::string &dir_path) {
+            std::string child = dir_path;
+            std::string parent = host_parent_path(child);
+
+            while (!parent.empty()) {
+                if (!listing_children_[parent].insert(child).second) {
+                    // The rest of the chain is already indexed
+                    break;
+                }
+
+                child = std::move(parent);
+                parent = host_parent_path(child);
+            }
+        }
+
+        // Drop the listing of the given directory and of everything under it. Must be called with the cache lock held.
+        void drop_host_listing_tree_no_lock(const std::string &dir_path) {
+            listing_cache_.erase(dir_path);
+
+            auto children_ite = listing_children_.find(dir_path);
+
+            if (children_ite != listing_children_.end()) {
+                const std::unordered_set<std::string> children = std::move(children_ite->second);
+                listing_children_.erase(children_ite);
+
+                for (const std::string &child: children) {
+                    drop_host_listing_tree_no_lock(child);
+                }
+            }
+        }
+
+        // Drop the listing that contains the given path, and every listing under it. Must be called with the cache lock held.
+        void drop_host_listings_no_lock(const std::string &host_path) {
+            std::string parent = host_parent_path(host_path);
+
+            if (!parent.empty()) {
+                listing_cache_.erase(parent);
+            }
+
+            drop_host_listing_tree_no_lock(host_path);
+
+            // Unlink the dropped subtree from the index, and prune ancestors that no longer lead to a listing
+            std::string child = host_path;
+
+            while (!parent.empty()) {
+                auto parent_ite = listing_children_.find(parent);
+
+                if (parent_ite == listing_children_.end()) {
+                    break;
+                }
+
+                parent_ite->second.erase(child);
+
+                if (!parent_ite->second.empty() || (listing_cache_.find(parent) != listing_cache_.end())) {
+                    break;
+                }
+
+                listing_children_.erase(parent_ite);
+
+                child = std::move(parent);
+                parent = host_parent_path(child);
+            }
+        }
+
+        void drop_host_listings(const std::u16string &host_path) {
+            const std::lock_guard<std::mutex> guard(cache_lock_);
+            drop_host_listings_no_lock(common::ucs2_to_utf8(host_path));
+        }
+
+        void on_listed_directory_changed(const std::string &dir_path, common::directory_changes &changes) {
+            const std::lock_guard<std::mutex> guard(cache_lock_);
+            drop_host_listings_no_lock(dir_path);
+
+            for (auto &change: changes) {
+                // An empty name is a change on the listed directory itself, such as it being deleted or moved away
+                const std::string changed_path = change.filename_.empty() ? dir_path : (dir_path + '/' + change.filename_);
+                drop_host_listings_no_lock(changed_path);
+
+                if (change.change_ & (common::directory_change_action_delete | common::directory_change_action_moved_from)) {
+                    // The host stops watching a directory that is gone. Forget about it so it is watched again if recreated.
+                    // The watcher itself is not touched here, since this runs on its own thread.
+                    const std::string sub_prefix = changed_path + '/';
+
+                    for (auto ite = listing_watches_.begin(); ite != listing_watches_.end();) {
+                        if ((ite->first == changed_path) || (ite->first.compare(0, sub_prefix.length(), sub_prefix) == 0)) {
+                            ite = listing_watches_.erase(ite);
+                        } else {
+                            ite++;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Must be called with the cache lock held
+        bool build_host_listing_no_lock(const std::string &dir_path) {
+            if (listing_watches_.find(dir_path) == listing_watches_.end()) {
+                if (listing_watches_.size() >= MAX_LISTING_WATCH_COUNT) {
+                    return false;
+                }
+
+                if (!listing_watcher_) {
+                    listing_watcher_ = std::make_unique<common::directory_watcher>();
+                }
+
+                const std::int32_t handle = listing_watcher_->watch(dir_path, [this, dir_path](void *userdata, common::directory_changes &changes) {
+                    on_listed_directory_changed(dir_path, changes);
+                },
+                    nullptr, common::directory_change_move | common::directory_change_creation);
+
+                if (handle <= 0) {
+                    return false;
+                }
+
+                listing_watches_.emplace(dir_path, handle);
+            }
+
+            // The iterator treats the last component as a filter when there is no trailing separator
+            common::dir_iterator iterator(dir_path + '/');
+            std::unordered_map<std::string, common::file_type> listing;
+
+            common::dir_entry entry;
+
+            while (iterator.next_entry(entry) == 0) {
+                if ((entry.name == ".") || (entry.name == "..")) {
+                    continue;
+                }
+
+                listing.emplace(entry.name, entry.type);
+            }
+
+            listing_cache_[dir_path] = std::move(listing);
+            index_host_listing_no_lock(dir_path);
+
+            return true;
+        }
+
+        // Must be called with the cache lock held
+        common::file_type get_host_file_type_no_lock(const std::string &host_path, const std::size_t host_root_length) {
+            const std::size_t sep_pos = host_path.find_last_of('/');
+
+            if ((sep_pos == std::string::npos) || (sep_pos == host_path.length() - 1)) {
+                return common::get_file_type(host_path);
+            }
+
+            const std::string dir_path = host_path.substr(0, sep_pos);
+            auto listing_ite = listing_cache_.find(dir_path);
+
+            if (listing_ite == listing_cache_.end()) {
+                if (dir_path.length() > host_root_length) {
+                    // A missing parent answers for all of its would-be children
+                    if (get_host_file_type_no_lock(dir_path, host_root_length) != common::FILE_DIRECTORY) {
+                        return common::FILE_INVALID;
+                    }
+                }
+
+                if (!build_host_listing_no_lock(dir_path)) {
+                    return common::get_file_type(host_path);
+                }
+
+                listing_ite = listing_cache_.find(dir_path);
+            }
+
+            auto entry_ite = listing_ite->second.find(host_path.substr(sep_pos + 1));
+
+            if (entry_ite == listing_ite->second.end()) {
+                return common::FILE_INVALID;
+            }
+
+            if (entry_ite->second == common::FILE_UNKN) {
+                // The directory stream did not give us the type, ask once
+                entry_ite->second = common::get_file_type(host_path);
+            }
+
+            return entry_ite->second;
+        }
+
+        common::file_type get_host_file_type(const std::u16string &host_path, const std::size_t host_root_length) {
+            const std::string host_path_utf8 = common::ucs2_to_utf8(host_path);
+
+#if EKA2L1_PLATFORM(UNIX)
+            if (is_plain_host_path(host_path_utf8)) {
+                const std::lock_guard<std::mutex> guard(cache_lock_);
+                return get_host_file_type_no_lock(host_path_utf8, host_root_length);
+            }
+#endif
+
+            return common::get_file_type(host_path_utf8);
+        }
+
     protected:
         std::string firmcode;
         epocver ver;
@@ -622,20 +866,65 @@ namespace eka2l1 {
 
             // Mark as mapped
             mappings[static_cast<int>(drv)].second = true;
+            invalidate_path_caches();
 
             return true;
         }
 
-        std::optional<std::u16string> get_real_physical_path(const std::u16string &vert_path, bool *is_root = nullptr) {
+        std::optional<std::u16string> get_real_physical_path(const std::u16string &vert_path, bool *is_root = nullptr,
+            std::size_t *host_root_length = nullptr) {
+            {
+                const std::lock_guard<std::mutex> guard(cache_lock_);
+                auto cached = translation_cache_.find(vert_path);
+
+                if (cached != translation_cache_.end()) {
+                    if (is_root) {
+                        *is_root = cached->second.is_root_;
+                    }
+
+                    if (host_root_length) {
+                        *host_root_length = cached->second.host_root_length_;
+                    }
+
+                    return cached->second.host_path_;
+                }
+            }
+
+            translated_path result;
+            std::optional<std::u16string> host_path = translate_physical_path(vert_path, result.is_root_, result.host_root_length_);
+
+            if (!host_path.has_value() || host_path->empty()) {
+                return host_path;
+            }
+
+            if (is_root) {
+                *is_root = result.is_root_;
+            }
+
+            if (host_root_length) {
+                *host_root_length = result.host_root_length_;
+            }
+
+            result.host_path_ = host_path.value();
+
+            const std::lock_guard<std::mutex> guard(cache_lock_);
+
+            if (translation_cache_.size() >= MAX_TRANSLATION_CACHE_SIZE) {
+                translation_cache_.clear();
+            }
+
+            translation_cache_.emplace(vert_path, std::move(result));
+            return host_path;
+        }
+
+        std::optional<std::u16string> translate_physical_path(const std::u16string &vert_path, bool &is_root, std::size_t &host_root_length) {
             const std::int32_t stack_level = path_stack_level(vert_path);
             
             if (stack_level < 0) {
                 return std::nullopt;
             }
 
-            if (is_root) {
-                *is_root = (stack_level == 0);
-            }
+            is_root = (stack_level == 0);
 
             std::string path_ucs8 = common::ucs2_to_utf8(vert_path);
             const std::string root = eka2l1::root_name(path_ucs8);
@@ -675,6 +964,9 @@ namespace eka2l1 {
                 vert_path_no_root = common::lowercase_ucs2_string(vert_path_no_root);
             }
 
+            // The mapping root itself, without the trailing separator
+            host_root_length = map_path.length() - 1;
+
             return eka2l1::add_path(map_path, vert_path_no_root);
         }
 
@@ -690,6 +982,7 @@ namespace eka2l1 {
 
         void set_epoc_ver(const epocver ever) override {
             ver = ever;
+            invalidate_path_caches();
         }
 
         std::optional<std::u16string> get_raw_path(const std::u16string &path) override {
@@ -703,16 +996,23 @@ namespace eka2l1 {
                 return false;
             }
 
-            return common::remove(common::ucs2_to_utf8(*path_real));
+            const bool result = common::remove(common::ucs2_to_utf8(*path_real));
+
+            // Dropped once the host is done, so a lookup racing with the removal can not cache the old state
+            drop_host_listings(*path_real);
+            return result;
         }
 
         void set_product_code(const std::string &pc) override {
             firmcode = pc;
+            invalidate_path_caches();
         }
 
         bool exists(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
-            return real_path ? eka2l1::exists(common::ucs2_to_utf8(*real_path)) : false;
+            std::size_t host_root_length = 0;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, nullptr, &host_root_length);
+
+            return real_path ? (get_host_file_type(*real_path, host_root_length) != common::FILE_INVALID) : false;
         }
 
         bool replace(const std::u16string &old_path, const std::u16string &new_path) override {
@@ -723,18 +1023,38 @@ namespace eka2l1 {
                 return false;
             }
 
-            return common::move_file(common::ucs2_to_utf8(*old_path_real),
+            const bool result = common::move_file(common::ucs2_to_utf8(*old_path_real),
                 common::ucs2_to_utf8(*new_path_real));
+
+            drop_host_listings(*old_path_real);
+            drop_host_listings(*new_path_real);
+
+            return result;
         }
 
         bool create_directories(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            std::size_t host_root_length = 0;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, nullptr, &host_root_length);
 
             if (!real_path) {
                 return false;
             }
 
-            eka2l1::create_directories(common::ucs2_to_utf8(*real_path));
+            std::string real_path_utf8 = common::ucs2_to_utf8(*real_path);
+            eka2l1::create_directories(real_path_utf8);
+
+            // Every missing parent is created, so listings of all of them may change
+            const std::lock_guard<std::mutex> guard(cache_lock_);
+
+            while (!real_path_utf8.empty() && (real_path_utf8.back() == '/')) {
+                real_path_utf8.pop_back();
+            }
+
+            while (real_path_utf8.length() > host_root_length) {
+                drop_host_listings_no_lock(real_path_utf8);
+                real_path_utf8 = host_parent_path(real_path_utf8);
+            }
+
             return true;
         }
 
@@ -746,6 +1066,7 @@ namespace eka2l1 {
             }
 
             eka2l1::create_directory(common::ucs2_to_utf8(*real_path));
+            drop_host_listings(*real_path);
 
             return true;
         }
@@ -762,6 +1083,7 @@ namespace eka2l1 {
         bool unmount(const drive_number drv) override {
             if (mappings[static_cast<int>(drv)].second) {
                 mappings[static_cast<int>(drv)].second = false;
+                invalidate_path_caches();
 
                 for (auto &watch_handle: watches[drv]) {
                     if (watcher_) {
@@ -810,7 +1132,9 @@ namespace eka2l1 {
             }
 
             bool is_root = false;
-            auto new_path = get_real_physical_path(vir_path, &is_root);
+            std::size_t host_root_length = 0;
+
+            auto new_path = get_real_physical_path(vir_path, &is_root, &host_root_length);
 
             if (!new_path) {
                 return std::unique_ptr<directory>(nullptr);
@@ -822,7 +1146,7 @@ namespace eka2l1 {
 
             std::string new_path_utf8 = common::ucs2_to_utf8(*new_path);
 
-            if (!eka2l1::exists(new_path_utf8)) {
+            if (get_host_file_type(*new_path, host_root_length) == common::FILE_INVALID) {
                 return std::unique_ptr<directory>(nullptr);
             }
 
@@ -831,21 +1155,23 @@ namespace eka2l1 {
         }
 
         std::optional<entry_info> get_entry_info(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            std::size_t host_root_length = 0;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, nullptr, &host_root_length);
 
             if (!real_path) {
                 return std::nullopt;
             }
 
             std::string real_path_utf8 = common::ucs2_to_utf8(*real_path);
+            const common::file_type host_type = get_host_file_type(*real_path, host_root_length);
 
-            if (!eka2l1::exists(real_path_utf8)) {
+            if (host_type == common::FILE_INVALID) {
                 return std::nullopt;
             }
 
             entry_info info;
 
-            if (common::is_file(real_path_utf8, common::FILE_DIRECTORY)) {
+            if (host_type == common::FILE_DIRECTORY) {
                 info.type = io_component_type::dir;
                 info.size = 0;
             } else {
@@ -889,19 +1215,29 @@ namespace eka2l1 {
                 }
             }
 
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            std::size_t host_root_length = 0;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, nullptr, &host_root_length);
 
             if (!real_path) {
                 return nullptr;
             }
 
-            std::string real_path_utf8 = common::ucs2_to_utf8(*real_path);
+            if (!(mode & WRITE_MODE)) {
+                const common::file_type host_type = get_host_file_type(*real_path, host_root_length);
 
-            if (!(mode & WRITE_MODE) && (!eka2l1::exists(real_path_utf8) || common::is_file(real_path_utf8, common::FILE_DIRECTORY))) {
-                return nullptr;
+                if ((host_type == common::FILE_INVALID) || (host_type == common::FILE_DIRECTORY)) {
+                    return nullptr;
+                }
+            }
+
+            std::unique_ptr<file> result = std::make_unique<physical_file>(path, *real_path, mode);
+
+            if (mode & WRITE_MODE) {
+                // The file may have just been created
+                drop_host_listings(*real_path);
             }
 
-            return std::make_unique<physical_file>(path, *real_path, mode);
+            return result;
         }
 
         std::int64_t watch_directory(const std::u16string &path, common::directory_watcher_callback callback,
@@ -959,20 +1295,385 @@ namespace eka2l1 {
                     common::copy_folder(mapping.first.real_path, mapping.first.real_path, common::FOLDER_COPY_FLAG_LOWERCASE_NAME,
                         nullptr);
                 }
+
+                invalidate_path_caches();
             }
         }
     };
 
+    // A ROFS image mapped to host memory. Immutable once loaded, so it's shared by every filesystem given the same cache.
+    struct rofs_mounted_image {
+        std::string path_;
+        std::uint8_t *data_;
+        std::size_t size_;
+        loader::rofs_index index_;
+
+        rofs_mounted_image()
+            : data_(nullptr)
+            , size_(0) {
+        }
+
+        ~rofs_mounted_image() {
+            if (data_) {
+                common::unmap_file(data_, size_);
+            }
+        }
+    };
+
+    // File served directly from a mapped ROFS image
+    struct rofs_file : public file {
+        const std::uint8_t *data_;
+        std::uint64_t size_;
+        std::uint64_t crr_pos_;
+        std::uint64_t time_;
+        std::uint64_t image_offset_;
+        std::u16string input_path_;
+
+        explicit rofs_file(const std::uint8_t *data, const std::uint64_t size, const std::uint64_t time,
+            const std::uint64_t image_offset, const std::u16string &input_path)
+            : data_(data)
+            , size_(size)
+            , crr_pos_(0)
+            , time_(time)
+            , image_offset_(image_offset)
+            , input_path_(input_path) {
+        }
+
+        uint64_t size() const override {
+            return size_;
+        }
+
+        bool valid() override {
+            return crr_pos_ < size_;
+        }
+
+        size_t read_file(void *data, uint32_t size, uint32_t count) override {
+            if (crr_pos_ >= size_) {
+                return 0;
+            }
+
+            const std::uint64_t will_read = std::min<std::uint64_t>(static_cast<std::uint64_t>(count) * size, size_ - crr_pos_);
+            std::memcpy(data, data_ + crr_pos_, will_read);
+
+            crr_pos_ += will_read;
+            return static_cast<size_t>(will_read);
+        }
+
+        int file_mode() const override {
+            return READ_MODE;
+        }
+
+        size_t write_file(const void *data, uint32_t size, uint32_t count) override {
+            LOG_ERROR(VFS, "Can't write into ROFS!");
+            return -1;
+        }
+
+        std::uint64_t seek(std::int64_t seek_off, file_seek_mode where) override {
+            std::int64_t new_pos = 0;
+
+            switch (where) {
+            case file_seek_mode::beg:
+                new_pos = seek_off;
+                break;
+
+            case file_seek_mode::crr:
+                new_pos = static_cast<std::int64_t>(crr_pos_) + seek_off;
+                break;
+
+            case file_seek_mode::end:
+                new_pos = static_cast<std::int64_t>(size_) + seek_off;
+                break;
+
+            default:
+                // Not in ROM, there is no linear address
+                return 0xFFFFFFFFFFFFFFFF;
+            }
+
+            if (new_pos < 0) {
+                LOG_ERROR(VFS, "Attempting to seek to negative offset ({})", new_pos);
+                return 0xFFFFFFFFFFFFFFFF;
+            }
+
+            crr_pos_ = static_cast<std::uint64_t>(new_pos);
+            return crr_pos_;
+        }
+
+        std::uint64_t last_modify_since_1ad() override {
+            return time_;
+        }
+
+        std::uint64_t offset_in_image() const override {
+            return image_offset_;
+        }
+
+        std::string get_error_descriptor() override {
+            return "no";
+        }
+
+        bool is_in_rom() const override {
+            return false;
+        }
+
+        address rom_address() const override {
+            return 0;
+        }
+
+        uint64_t tell() override {
+            return crr_pos_;
+        }
+
+        std::u16string file_name() const override {
+            return input_path_;
+        }
+
+        bool close() override {
+            return true;
+        }
+
+        bool resize(const std::size_t new_size) override {
+            return false;
+        }
+    };
+
+    // Lists a directory from mounted ROFS images first, then whatever the host has that the images do not.
+    class rofs_directory : public directory {
+    public:
+        struct listed_entry {
+            const loader::rofs_index_entry *entry_;
+            const rofs_mounted_image *image_;
+        };
+
+    private:
+        std::vector<listed_entry> entries_;
+        std::size_t entry_pos_;
+
+        std::unique_ptr<directory> host_dir_;
+        std::set<std::u16string> listed_names_;
+
+        std::regex filter_;
+        std::string vir_path_;
+        epoc::uid_type utype_;
+        std::uint32_t drive_attrib_;
+
+        std::optional<entry_info> peek_info_;
+        bool peeking_;
+
+        bool match_entry(const listed_entry &listed) {
+            const loader::rofs_index_entry *entry = listed.entry_;
+
+            if (attribute != io_attrib_none) {
+                if (!(attribute & io_attrib_include_dir) && entry->is_dir_) {
+                    return false;
+                }
+
+                if (!(attribute & io_attrib_include_file) && !entry->is_dir_) {
+                    return false;
+                }
+            }
+
+            if (!std::regex_match(common::lowercase_string(common::ucs2_to_utf8(entry->name_)), filter_)) {
+                return false;
+            }
+
+            if (!entry->is_dir_ && (attribute & io_attrib_include_file) && (attribute & io_attrib_allow_uid)) {
+                epoc::uid_type file_uid;
+
+                if ((entry->size_ < sizeof(file_uid)) || (entry->offset_ + sizeof(file_uid) > listed.image_->size_)) {
+                    return false;
+                }
+
+                std::memcpy(&file_uid, listed.image_->data_ + entry->offset_, sizeof(file_uid));
+
+                if (((utype_.uid1 != 0) && (utype_.uid1 != file_uid.uid1)) || ((utype_.uid2 != 0) && (utype_.uid2 != file_uid.uid2))
+                    || ((utype_.uid3 != 0) && (utype_.uid3 != file_uid.uid3))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    public:
+        explicit rofs_directory(std::vector<listed_entry> &entries, std::unique_ptr<directory> host_dir,
+            const std::string &vir_path, const std::string &filter, epoc::uid_type type, const std::uint32_t attrib,
+            const std::uint32_t drive_attrib)
+            : directory(attrib)
+            , entries_(std::move(entries))
+            , entry_pos_(0)
+            , host_dir_(std::move(host_dir))
+            , filter_(common::wildcard_to_regex_string(common::lowercase_string(filter)))
+            , vir_path_(vir_path)
+            , utype_(type)
+            , drive_attrib_(drive_attrib)
+            , peeking_(false) {
+            for (const auto &listed: entries_) {
+                listed_names_.insert(common::lowercase_ucs2_string(listed.entry_->name_));
+            }
+        }
+
+        std::optional<entry_info> get_next_entry() override {
+            if (peeking_) {
+                peeking_ = false;
+                return peek_info_;
+            }
+
+            while (entry_pos_ < entries_.size()) {
+                const listed_entry &listed = entries_[entry_pos_++];
+
+                if (!match_entry(listed)) {
+                    continue;
+                }
+
+                entry_info info;
+                info.type = listed.entry_->is_dir_ ? io_component_type::dir : io_component_type::file;
+                info.size = listed.entry_->is_dir_ ? 0 : listed.entry_->size_;
+                info.name = common::ucs2_to_utf8(listed.entry_->name_);
+                info.full_path = eka2l1::add_path(vir_path_, info.name);
+                info.has_raw_attribute = true;
+                info.raw_attribute = listed.entry_->att_;
+                info.attribute = drive_attrib_;
+                info.last_write = listed.image_->index_.time_;
+
+                return info;
+            }
+
+            while (host_dir_) {
+                std::optional<entry_info> info = host_dir_->get_next_entry();
+
+                if (!info) {
+                    host_dir_.reset();
+                    break;
+                }
+
+                if (listed_names_.find(common::lowercase_ucs2_string(common::utf8_to_ucs2(info->name))) == listed_names_.end()) {
+                    return info;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        std::optional<entry_info> peek_next_entry() override {
+            if (!peeking_) {
+                peek_info_ = get_next_entry();
+                peeking_ = true;
+            }
+
+            return peek_info_;
+        }
+    };
+
     class rom_file_system : public physical_file_system {
         loader::rom *rom_cache;
         memory_system *mem;
 
+        // Used when no cache shared with other instances is given
+        rofs_image_cache own_image_cache_;
+        rofs_image_cache *image_cache_;
+
+        struct rofs_mount {
+            drive_number drive_;
+            std::shared_ptr<rofs_mounted_image> image_;
+        };
+
+        // Later images take priority over earlier ones
+        std::vector<rofs_mount> images;
+
+        const loader::rofs_index_entry *find_rofs_entry(const std::u16string &path, const rofs_mounted_image **result_image) {
+            const std::u16string &root = eka2l1::root_name(path, true);
+
+            if (root.empty()) {
+                return nullptr;
+            }
+
+            const drive_number drv = char16_to_drive(root[0]);
+
+            for (auto ite = images.rbegin(); ite != images.rend(); ite++) {
+                if (ite->drive_ != drv) {
+                    continue;
+                }
+
+                if (const loader::rofs_index_entry *entry = ite->image_->index_.find(path)) {
+                    if (result_image) {
+                        *result_image = ite->image_.get();
+                    }
+
+                    return entry;
+                }
+            }
+
+            return nullptr;
+        }
 
     public:
-        explicit rom_file_system(loader::rom *cache, memory_system *mem, epocver ver, const std::string &product_code)
+        explicit rom_file_system(loader::rom *cache, memory_system *mem, epocver ver, const std::string &product_code,
+            rofs_image_cache *image_cache)
             : physical_file_system(ver, product_code)
             , rom_cache(cache)
-            , mem(mem) {
+            , mem(mem)
+            , image_cache_(image_cache ? image_cache : &own_image_cache_) {
+        }
+
+        bool mount_image(const drive_number drv, const std::u16string &image_path) override {
+            const std::string path_utf8 = common::ucs2_to_utf8(image_path);
+            const std::int64_t image_size = common::file_size(path_utf8);
+
+            if (image_size <= 0) {
+                LOG_ERROR(VFS, "ROFS image {} does not exist or is empty", path_utf8);
+                return false;
+            }
+
+            // Size and modification time are in the key, so a replaced image is not served stale
+            const std::string cache_key = fmt::format("{}|{}|{}", path_utf8, image_size,
+                common::get_last_modifiy_since_ad(image_path));
+
+            std::shared_ptr<rofs_mounted_image> image = image_cache_->get_or_create(cache_key, [&]() -> std::shared_ptr<rofs_mounted_image> {
+                auto new_image = std::make_shared<rofs_mounted_image>();
+                new_image->path_ = path_utf8;
+                new_image->size_ = static_cast<std::size_t>(image_size);
+                new_image->data_ = reinterpret_cast<std::uint8_t *>(common::map_file(path_utf8, prot_read, new_image->size_));
+
+                if (!new_image->data_) {
+                    LOG_ERROR(VFS, "Unable to map ROFS image {} to memory", path_utf8);
+                    return nullptr;
+                }
+
+                // Index is built once here. Every lookup after this stays in memory.
+                common::ro_buf_stream image_stream(new_image->data_, new_image->size_);
+
+                if (!loader::build_rofs_index(image_stream, new_image->index_)) {
+                    LOG_ERROR(VFS, "ROFS image {} is corrupted", path_utf8);
+                    return nullptr;
+                }
+
+                return new_image;
+            });
+
+            if (!image) {
+                return false;
+            }
+
+            images.push_back({ drv, std::move(image) });
+            return true;
+        }
+
+        bool exists(const std::u16string &path) override {
+            if (find_rofs_entry(path, nullptr)) {
+                return true;
+            }
+
+            return physical_file_system::exists(path);
+        }
+
+        std::optional<std::u16string> get_raw_path(const std::u16string &path) override {
+            std::optional<std::u16string> host_path = physical_file_system::get_raw_path(path);
+
+            // Files only in a ROFS image have no copy on the host. Callers must read them through the VFS.
+            if (host_path && find_rofs_entry(path, nullptr) && !eka2l1::exists(common::ucs2_to_utf8(*host_path))) {
+                return std::nullopt;
+            }
+
+            return host_path;
         }
 
         bool delete_entry(const std::u16string &path) override {
@@ -1006,12 +1707,8 @@ namespace eka2l1 {
         }
 
         abstract_file_system_err_code is_entry_in_rom(const std::u16string &path) override {
-            // Don't bother getting an entry if it's not even available on host
-            if (!exists(path)) {
-                return abstract_file_system_err_code::no;
-            }
-
-            if (rom_cache->burn_tree_find_entry(common::ucs2_to_utf8(path))) {
+            // The ROM index is the source of truth here, no need to ask the host
+            if (rom_cache->burn_tree_find_entry(path)) {
                 return abstract_file_system_err_code::ok;
             }
 
@@ -1024,11 +1721,6 @@ namespace eka2l1 {
                 return nullptr;
             }
 
-            // Don't bother getting an entry if it's not even available on host
-            if (!exists(path)) {
-                return nullptr;
-            }
-
             std::u16string new_path = path;
 
             if (static_cast<int>(ver) >= static_cast<int>(epocver::eka2)) {
@@ -1039,27 +1731,65 @@ namespace eka2l1 {
                 }
             }
 
-            auto entry = rom_cache->burn_tree_find_entry(common::ucs2_to_utf8(new_path));
-            auto ff = physical_file_system::open_file(new_path, mode);
+            auto entry = rom_cache->burn_tree_find_entry(new_path);
+
+            // Only ROFS files (not in the ROM index) and physical preference need to touch the host
+            if (!entry) {
+                const rofs_mounted_image *image = nullptr;
+                const loader::rofs_index_entry *rofs_entry = find_rofs_entry(new_path, &image);
+
+                if (!rofs_entry || rofs_entry->is_dir_) {
+                    return physical_file_system::open_file(new_path, mode);
+                }
+
+                if (mode & PREFER_PHYSICAL) {
+                    if (auto ff = physical_file_system::open_file(new_path, mode)) {
+                        return ff;
+                    }
+                }
 
-            // Dont change order!
-            if (!entry || ((mode & PREFER_PHYSICAL) && (ff->size() != entry->size))) {
-                return ff;
+                if (static_cast<std::uint64_t>(rofs_entry->offset_) + rofs_entry->size_ > image->size_) {
+                    LOG_ERROR(VFS, "File {} lies outside of its ROFS image", common::ucs2_to_utf8(path));
+                    return nullptr;
+                }
+
+                return std::make_unique<rofs_file>(image->data_ + rofs_entry->offset_, rofs_entry->size_,
+                    image->index_.time_, rofs_entry->offset_, path);
+            }
+
+            if (mode & PREFER_PHYSICAL) {
+                auto ff = physical_file_system::open_file(new_path, mode);
+
+                if (ff && (ff->size() != entry->size)) {
+                    return ff;
+                }
             }
 
             return std::make_unique<rom_file>(mem, rom_cache, *entry, path);
         }
 
         std::optional<entry_info> get_entry_info(const std::u16string &path) override {
-            // Don't bother getting an entry if it's not even available on host
-            if (!exists(path)) {
-                return std::nullopt;
-            }
-
-            auto entry = rom_cache->burn_tree_find_entry(common::ucs2_to_utf8(path));
+            auto entry = rom_cache->burn_tree_find_entry(path);
 
             if (!entry) {
-                return physical_file_system::get_entry_info(path);
+                const rofs_mounted_image *image = nullptr;
+                const loader::rofs_index_entry *rofs_entry = find_rofs_entry(path, &image);
+
+                if (!rofs_entry) {
+                    return physical_file_system::get_entry_info(path);
+                }
+
+                entry_info info;
+                info.type = rofs_entry->is_dir_ ? io_component_type::dir : io_component_type::file;
+                info.has_raw_attribute = true;
+                info.raw_attribute = rofs_entry->att_;
+                info.size = rofs_entry->is_dir_ ? 0 : rofs_entry->size_;
+                info.name = common::ucs2_to_utf8(rofs_entry->name_);
+                info.full_path = common::ucs2_to_utf8(path);
+                info.attribute = mappings[static_cast<int>(char16_to_drive(eka2l1::root_name(path, true)[0]))].first.attribute;
+                info.last_write = image->index_.time_;
+
+                return info;
             }
 
             entry_info info;
@@ -1073,6 +1803,65 @@ namespace eka2l1 {
             return info;
         }
 
+        std::unique_ptr<directory> open_directory(const std::u16string &path, epoc::uid_type type, const std::uint32_t attrib) override {
+            if (images.empty()) {
+                return physical_file_system::open_directory(path, type, attrib);
+            }
+
+            std::u16string vir_path = path;
+            std::string filter("*");
+
+            const std::size_t pos_check = vir_path.find_last_of(u"\\/");
+
+            if ((pos_check != std::u16string::npos) && (pos_check != vir_path.length() - 1)) {
+                filter = common::ucs2_to_utf8(vir_path.substr(pos_check + 1));
+                vir_path.erase(pos_check + 1);
+            }
+
+            const std::u16string &root = eka2l1::root_name(vir_path, true);
+
+            if (root.empty()) {
+                return physical_file_system::open_directory(path, type, attrib);
+            }
+
+            const drive_number drv = char16_to_drive(root[0]);
+
+            std::vector<rofs_directory::listed_entry> entries;
+            std::set<std::u16string> names;
+
+            bool found = false;
+
+            for (auto ite = images.rbegin(); ite != images.rend(); ite++) {
+                if (ite->drive_ != drv) {
+                    continue;
+                }
+
+                const loader::rofs_index_entry *dir_entry = ite->image_->index_.find(vir_path);
+
+                if (!dir_entry || !dir_entry->is_dir_) {
+                    continue;
+                }
+
+                found = true;
+
+                for (const std::uint32_t child: dir_entry->children_) {
+                    const loader::rofs_index_entry *child_entry = &ite->image_->index_.entries_[child];
+
+                    // Shadowed by an image with higher priority
+                    if (names.insert(common::lowercase_ucs2_string(child_entry->name_)).second) {
+                        entries.push_back({ child_entry, ite->image_.get() });
+                    }
+                }
+            }
+
+            if (!found) {
+                return physical_file_system::open_directory(path, type, attrib);
+            }
+
+            return std::make_unique<rofs_directory>(entries, physical_file_system::open_directory(path, type, attrib),
+                common::ucs2_to_utf8(vir_path), filter, type, attrib, mappings[static_cast<int>(drv)].first.attribute);
+        }
+
         std::optional<std::u16string> find_entry_with_address(const std::u16string &clue, const address addr) override {
             std::u16string the_base_path = clue;
             loader::rom_dir *the_base_dir = &(rom_cache->root.root_dirs[0].dir);
@@ -1100,8 +1889,8 @@ namespace eka2l1 {
     }
 
     std::shared_ptr<abstract_file_system> create_rom_filesystem(loader::rom *rom_cache, memory_system *mem,
-        const epocver ver, const std::string &product_code) {
-        return std::make_unique<rom_file_system>(rom_cache, mem, ver, product_code);
+        const epocver ver, const std::string &product_code, rofs_image_cache *image_cache) {
+        return std::make_unique<rom_file_system>(rom_cache, mem, ver, product_code, image_cache);
     }
 
     io_component::io_component(io_component_type type, const std::uint32_t attrib)
@@ -1467,4 +2256,41 @@ namespace eka2l1 {
     std::uint64_t wo_file_stream::write(const void *buf, const std::uint64_t write_size) {
         return f_->write_file(buf, static_cast<std::uint32_t>(write_size), 1);
     }
+
+    void rw_file_stream::seek(const std::int64_t amount, common::seek_where wh) {
+        f_->seek(amount, static_cast<file_seek_mode>(wh));
+    }
+
+    bool rw_file_stream::valid() {
+        return f_->tell() < f_->size();
+    }
+
+    std::uint64_t rw_file_stream::left() {
+        if (f_->tell() >= f_->size()) {
+            return 0;
+        }
+
+        return f_->size() - f_->tell();
+    }
+
+    std::uint64_t rw_file_stream::tell() const {
+        return f_->tell();
+    }
+
+    std::uint64_t rw_file_stream::size() {
+        return f_->size();
+    }
+
+    std::uint64_t rw_file_stream::read(void *buf, const std::uint64_t read_size) {
+        std::size_t result = f_->read_file(buf, static_cast<std::uint32_t>(read_size), 1);
+        if (result == static_cast<std::size_t>(-1)) {
+            return 0;
+        }
+
+        return result;
+    }
+
+    std::uint64_t rw_file_stream::write(const void *buf, const std::uint64_t write_size) {
+        return f_->write_file(buf, static_cast<std::uint32_t>(write_size), 1);
+    }
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <catch2/catch.hpp>
+#include <common/dictcomp.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace eka2l1;
+
+namespace {
+    // Write bits from the least significant bit of each byte, same as the resource compiler
+    struct bit_writer {
+        std::vector<std::uint8_t> buf;
+        int bit_count = 0;
+
+        void write(const std::uint32_t value, const int num_bits) {
+            for (int i = 0; i < num_bits; i++, bit_count++) {
+                if ((bit_count >> 3) >= static_cast<int>(buf.size())) {
+                    buf.push_back(0);
+                }
+
+                if (value & (1 << i)) {
+                    buf[bit_count >> 3] |= (1 << (bit_count & 7));
+                }
+            }
+        }
+
+        void write_bytes(const std::vector<std::uint8_t> &bytes) {
+            for (const std::uint8_t byte : bytes) {
+                write(byte, 8);
+            }
+        }
+    };
+}
+
+TEST_CASE("dictcomp_tokens", "dictcomp") {
+    bit_writer writer;
+
+    // Literal of 2 bytes: off bit, prefix 10
+    writer.write(0, 1);
+    writer.write(0b01, 2);
+    writer.write_bytes({ 0xAB, 0xCD });
+
+    // Dictionary entry 5, with 5 bits token
+    writer.write(1, 1);
+    writer.write(5, 5);
+
+    // Literal of 6 bytes: off bit, prefix 1110, 3 bits size minus 4
+    writer.write(0, 1);
+    writer.write(0b0111, 4);
+    writer.write(2, 3);
+    writer.write_bytes({ 1, 2, 3, 4, 5, 6 });
+
+    // Literal of 14 bytes: off bit, prefix 1111, 8 bits size minus 12
+    std::vector<std::uint8_t> long_run(14);
+    for (std::size_t i = 0; i < long_run.size(); i++) {
+        long_run[i] = static_cast<std::uint8_t>(0xF0 + i);
+    }
+
+    writer.write(0, 1);
+    writer.write(0b1111, 4);
+    writer.write(2, 8);
+    writer.write_bytes(long_run);
+
+    const int total_bits = writer.bit_count;
+    common::dictcomp stream(writer.buf.data(), static_cast<int>(writer.buf.size()), 0, total_bits, 5);
+    common::dictcomp::token tok;
+    std::uint8_t out[32];
+
+    REQUIRE(stream.next_token(tok, false));
+    REQUIRE_FALSE(tok.is_dict_entry);
+    REQUIRE(tok.literal_size == 2);
+    REQUIRE(stream.read_literal(out, tok.literal_size));
+    REQUIRE(out[0] == 0xAB);
+    REQUIRE(out[1] == 0xCD);
+
+    REQUIRE(stream.next_token(tok, false));
+    REQUIRE(tok.is_dict_entry);
+    REQUIRE(tok.dict_index == 5);
+
+    REQUIRE(stream.next_token(tok, false));
+    REQUIRE(tok.literal_size == 6);
+    REQUIRE(stream.read_literal(out, tok.literal_size));
+    REQUIRE(std::vector<std::uint8_t>(out, out + 6) == std::vector<std::uint8_t>{ 1, 2, 3, 4, 5, 6 });
+
+    REQUIRE(stream.next_token(tok, false));
+    REQUIRE(tok.literal_size == 14);
+    REQUIRE(stream.read_literal(out, tok.literal_size));
+    REQUIRE(std::vector<std::uint8_t>(out, out + 14) == long_run);
+
+    REQUIRE(stream.eos());
+}
+
+TEST_CASE("dictcomp_truncated_literal", "dictcomp") {
+    bit_writer writer;
+
+    // Claims 3 bytes but only has one
+    writer.write(0, 1);
+    writer.write(0b011, 3);
+    writer.write(0x12, 8);
+
+    common::dictcomp stream(writer.buf.data(), static_cast<int>(writer.buf.size()), 0, writer.bit_count, 5);
+    common::dictcomp::token tok;
+    std::uint8_t out[4];
+
+    REQUIRE(stream.next_token(tok, false));
+    REQUIRE(tok.literal_size == 3);
+    REQUIRE_FALSE(stream.read_literal(out, tok.literal_size));
+}
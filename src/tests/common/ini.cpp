@@ -81,3 +81,17 @@ TEST_CASE("recursive_prop_with_comma", "ini_test") {
     REQUIRE(p->get<common::ini_value>(1)->get_value() == "7");
     REQUIRE(p->get<common::ini_value>(2)->get_value() == "9");
 }
+
+TEST_CASE("load_ucs2_from_memory", "ini_test") {
+    const std::u16string content = u"\xFEFF[WINDOWMODE]\nmode color16ma\n";
+
+    common::ini_file ini;
+    REQUIRE(ini.load(reinterpret_cast<const std::uint8_t *>(content.data()), content.size() * sizeof(char16_t)) == 0);
+
+    auto sec_ptr = ini.find("WINDOWMODE");
+    REQUIRE(sec_ptr);
+
+    auto mode_ptr = sec_ptr->get_as<common::ini_section>()->find("mode");
+    REQUIRE(mode_ptr);
+    REQUIRE(mode_ptr->get_as<common::ini_pair>()->get<common::ini_value>(0)->get_value() == "color16ma");
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <catch2/catch.hpp>
+#include <common/lru.h>
+
+#include <string>
+
+using namespace eka2l1;
+
+TEST_CASE("lru_cache_eviction", "lru_cache") {
+    common::lru_cache<int, std::string> cache(10);
+
+    cache.put(1, "one", 4);
+    cache.put(2, "two", 4);
+
+    // Touch the first one, so the second one is the least recently used
+    REQUIRE(cache.get(1).value() == "one");
+
+    cache.put(3, "three", 4);
+
+    REQUIRE(cache.get(1).value() == "one");
+    REQUIRE_FALSE(cache.get(2));
+    REQUIRE(cache.get(3).value() == "three");
+    REQUIRE(cache.total_cost() == 8);
+
+    // Too large to ever fit
+    cache.put(4, "four", 11);
+    REQUIRE_FALSE(cache.get(4));
+
+    cache.set_capacity(4);
+    REQUIRE(cache.total_cost() == 4);
+    REQUIRE(cache.get(3).value() == "three");
+}
+
+TEST_CASE("lru_cache_max_entries", "lru_cache") {
+    common::lru_cache<int, std::string> cache(100, 2);
+
+    cache.put(1, "one", 1);
+    cache.put(2, "two", 1);
+
+    REQUIRE(cache.get(1).value() == "one");
+
+    // Far below the capacity, but one entry too many
+    cache.put(3, "three", 1);
+
+    REQUIRE(cache.count() == 2);
+    REQUIRE(cache.evictions() == 1);
+    REQUIRE_FALSE(cache.get(2));
+    REQUIRE(cache.get(3).value() == "three");
+
+    // Replacing is not evicting
+    cache.put(3, "drei", 1);
+    REQUIRE(cache.count() == 2);
+    REQUIRE(cache.evictions() == 1);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project 
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <catch2/catch.hpp>
+#include <common/ringbuf.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+TEST_CASE("ring_buffer_wrap_around", "ring_buffer") {
+    common::ring_buffer<std::uint8_t> ring(6);
+    REQUIRE(ring.capacity() == 8);
+
+    const std::uint8_t first[6] = { 1, 2, 3, 4, 5, 6 };
+    REQUIRE(ring.push(first, 6) == 6);
+
+    std::uint8_t out[8] = {};
+    REQUIRE(ring.pop(out, 4) == 4);
+    REQUIRE(out[3] == 4);
+
+    // Only 6 left free, the rest must be rejected
+    const std::uint8_t second[8] = { 7, 8, 9, 10, 11, 12, 13, 14 };
+    REQUIRE(ring.push(second, 8) == 6);
+    REQUIRE(ring.size() == 8);
+
+    REQUIRE(ring.pop(out, 8) == 8);
+    REQUIRE(out[0] == 5);
+    REQUIRE(out[2] == 7);
+    REQUIRE(out[7] == 12);
+
+    REQUIRE(ring.read_position() == 12);
+    REQUIRE(ring.write_position() == 12);
+}
+
+TEST_CASE("ring_buffer_skip_to", "ring_buffer") {
+    common::ring_buffer<std::uint8_t> ring(16);
+
+    const std::uint8_t data[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    ring.push(data, 10);
+
+    ring.skip_to(7);
+    REQUIRE(ring.size() == 3);
+
+    // Can't skip past what has been written
+    ring.skip_to(100);
+    REQUIRE(ring.size() == 0);
+    REQUIRE(ring.read_position() == 10);
+}
+
+TEST_CASE("ring_buffer_producer_consumer", "ring_buffer") {
+    common::ring_buffer<std::uint32_t> ring(64);
+    static constexpr std::uint32_t TOTAL = 100000;
+
+    std::thread producer([&]() {
+        std::uint32_t next = 0;
+
+        while (next < TOTAL) {
+            next += static_cast<std::uint32_t>(ring.push(&next, 1));
+        }
+    });
+
+    std::uint32_t expected = 0;
+    bool in_order = true;
+
+    while (expected < TOTAL) {
+        std::uint32_t values[16];
+        const std::size_t count = ring.pop(values, 16);
+
+        for (std::size_t i = 0; i < count; i++) {
+            in_order = in_order && (values[i] == expected++);
+        }
+    }
+
+    producer.join();
+    REQUIRE(in_order);
+}
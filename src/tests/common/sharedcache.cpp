@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project 
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/sharedcache.h>
+
+#include <string>
+
+using namespace eka2l1;
+
+TEST_CASE("shared_cache_lifetime", "shared_cache") {
+    common::shared_cache<std::string, int> cache;
+    int create_count = 0;
+
+    auto factory = [&]() {
+        create_count++;
+        return std::make_shared<int>(42);
+    };
+
+    std::shared_ptr<int> first = cache.get_or_create("rom", factory);
+    std::shared_ptr<int> second = cache.get_or_create("rom", factory);
+
+    REQUIRE(first == second);
+    REQUIRE(create_count == 1);
+    REQUIRE(cache.size() == 1);
+
+    // Nobody uses it anymore, it should be created again
+    first.reset();
+    second.reset();
+
+    REQUIRE(cache.size() == 0);
+    REQUIRE(*cache.get_or_create("rom", factory) == 42);
+    REQUIRE(create_count == 2);
+}
+
+TEST_CASE("shared_cache_failed_creation", "shared_cache") {
+    common::shared_cache<std::string, int> cache;
+
+    REQUIRE_FALSE(cache.get_or_create("rom", []() { return std::shared_ptr<int>(); }));
+    REQUIRE(cache.size() == 0);
+}
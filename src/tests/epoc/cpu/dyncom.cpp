@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/platform.h>
+#include <cpu/arm_factory.h>
+#include <cpu/dyncom/arm_dyncom.h>
+#include <cpu/dyncom/arm_dyncom_trans_cache.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace eka2l1;
+
+static constexpr std::uint32_t GUEST_LOOP_BASE = 0x10000;
+
+// A loop calling a small function every iteration, so that both static branches and returns are exercised.
+//
+// loop:   bl func
+//         subs r1, r1, #1
+//         bne loop
+//         svc #0
+// func:   add r0, r0, #1
+//         eor r2, r0, r1
+//         bx lr
+static const std::uint32_t GUEST_LOOP_CODE[] = {
+    0xEB000002,
+    0xE2511001,
+    0x1AFFFFFC,
+    0xEF000000,
+    0xE2800001,
+    0xE0202001,
+    0xE12FFF1E
+};
+
+static constexpr std::uint32_t GUEST_LOOP_INSTRUCTIONS_PER_ITERATION = 6;
+
+struct guest_loop_result {
+    bool finished_ = false;
+    bool faulted_ = false;
+    std::uint32_t counter_ = 0;
+    std::size_t block_lookups_ = 0;
+    double seconds_ = 0.0;
+};
+
+static guest_loop_result run_guest_loop(const arm_emulator_type type, const std::uint32_t iterations) {
+    guest_loop_result result;
+
+    arm::exclusive_monitor_instance monitor = arm::create_exclusive_monitor(type, 1);
+    arm::core_instance core = arm::create_core(monitor.get(), type);
+
+    if (!core) {
+        return result;
+    }
+
+    std::vector<std::uint8_t> memory(0x1000);
+    std::memcpy(memory.data(), GUEST_LOOP_CODE, sizeof(GUEST_LOOP_CODE));
+
+    auto get_ptr = [&](const address addr, const std::size_t size) -> std::uint8_t * {
+        if ((addr < GUEST_LOOP_BASE) || (addr + size > GUEST_LOOP_BASE + memory.size())) {
+            return nullptr;
+        }
+
+        return memory.data() + (addr - GUEST_LOOP_BASE);
+    };
+
+    core->read_code = [&](address addr, std::uint32_t *data) {
+        std::uint8_t *ptr = get_ptr(addr, sizeof(std::uint32_t));
+        if (ptr) {
+            std::memcpy(data, ptr, sizeof(std::uint32_t));
+        }
+        return ptr != nullptr;
+    };
+
+    core->read_32bit = core->read_code;
+    core->system_call_handler = [&](const std::uint32_t) {
+        result.finished_ = true;
+        core->stop();
+    };
+
+    core->exception_handler = [&](arm::exception_type, const std::uint32_t) {
+        result.faulted_ = true;
+        core->stop();
+    };
+
+    core->set_cpsr(0x10);
+    core->set_pc(GUEST_LOOP_BASE);
+    core->set_reg(0, 0);
+    core->set_reg(1, iterations);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    while (!result.finished_ && !result.faulted_) {
+        core->run(1000000);
+    }
+
+    result.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.counter_ = core->get_reg(0);
+
+    if (auto dyncom = dynamic_cast<arm::dyncom_core *>(core.get())) {
+        result.block_lookups_ = dyncom->trans_cache().lookups();
+    }
+
+    return result;
+}
+
+TEST_CASE("dyncom_chained_loop", "dyncom") {
+    const guest_loop_result result = run_guest_loop(arm_emulator_type::dyncom, 5000);
+
+    REQUIRE(result.finished_);
+    REQUIRE(!result.faulted_);
+    REQUIRE(result.counter_ == 5000);
+
+    // Each iteration branches three times. Once the links are made, none of them should go through the dispatcher
+    REQUIRE(result.block_lookups_ > 0);
+    REQUIRE(result.block_lookups_ < 100);
+}
+
+TEST_CASE("dyncom_trans_cache_trim_breaks_links", "dyncom") {
+    arm::dyncom_trans_cache cache;
+
+    cache.begin_block();
+    cache.alloc(64);
+    char *target = cache.end_block(0x1000, 0x1040);
+
+    cache.clear();
+
+    // A branch that asked for a link after the clear, but before the next translation released the memory
+    arm::dyncom_block_link link{};
+    cache.link(link, 0x1000, target);
+    REQUIRE(cache.is_linked(link, 0x1000));
+
+    cache.begin_block();
+    REQUIRE(!cache.is_linked(link, 0x1000));
+}
+
+TEST_CASE("dyncom_trans_cache_large_blocks", "dyncom") {
+    arm::dyncom_trans_cache cache(2);
+
+    // Blocks ended at the size limit must always find room, even when they get moved to a fresh chunk
+    for (std::uint32_t i = 0; i < 16; i++) {
+        cache.begin_block();
+        bool allocated = true;
+
+        while (allocated && (cache.block_size() < arm::dyncom_trans_cache::MAX_BLOCK_SIZE)) {
+            allocated = (cache.alloc(200) != nullptr);
+        }
+
+        REQUIRE(allocated);
+
+        const std::uint32_t pc = 0x10000 + i * 0x1000;
+        REQUIRE(cache.end_block(pc, pc + 0x1000));
+        REQUIRE(cache.find(pc));
+    }
+
+    REQUIRE(cache.committed_size() == 2 * arm::dyncom_trans_cache::CHUNK_SIZE);
+    REQUIRE(cache.evicted_chunks() > 0);
+}
+
+// Tracks the gap between the dyncom interpreter and the JIT on the same guest loop
+TEST_CASE("dyncom_throughput_benchmark", "[.][benchmark]") {
+    static constexpr std::uint32_t ITERATIONS = 10000000;
+
+    std::vector<std::pair<const char *, arm_emulator_type>> backends = {
+        { "dyncom", arm_emulator_type::dyncom }
+    };
+
+#if !EKA2L1_ARCH(ARM)
+    backends.push_back({ "dynarmic", arm_emulator_type::dynarmic });
+#endif
+
+    for (const auto &[name, type] : backends) {
+        const guest_loop_result result = run_guest_loop(type, ITERATIONS);
+
+        REQUIRE(result.finished_);
+        REQUIRE(result.counter_ == ITERATIONS);
+
+        const double mips = (static_cast<double>(ITERATIONS) * GUEST_LOOP_INSTRUCTIONS_PER_ITERATION) / result.seconds_ / 1000000.0;
+        WARN(name << ": " << result.seconds_ << " s, " << mips << " MIPS");
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <dispatch/present.h>
+
+using namespace eka2l1;
+
+static const eka2l1::vec2 SCREEN_SIZE = { 240, 320 };
+
+TEST_CASE("present_dirty_tracker_merges_until_taken", "dispatch") {
+    dispatch::screen_dirty_tracker tracker;
+
+    const eka2l1::rect first({ 10, 10 }, { 20, 20 });
+    const eka2l1::rect second({ 100, 200 }, { 10, 10 });
+
+    REQUIRE(tracker.submit(SCREEN_SIZE, &first, 1) == dispatch::screen_dirty_tracker::submit_schedule);
+    REQUIRE(tracker.scheduled());
+
+    // Only one upload for both updates
+    REQUIRE(tracker.submit(SCREEN_SIZE, &second, 1) == dispatch::screen_dirty_tracker::submit_superseded);
+
+    const eka2l1::rect dirty = tracker.take();
+
+    REQUIRE(dirty.top == eka2l1::vec2(10, 10));
+    REQUIRE(dirty.size == eka2l1::vec2(100, 200));
+    REQUIRE_FALSE(tracker.scheduled());
+
+    // The next update schedules a new upload, with only its own area
+    REQUIRE(tracker.submit(SCREEN_SIZE, &second, 1) == dispatch::screen_dirty_tracker::submit_schedule);
+    const eka2l1::rect next = tracker.take();
+
+    REQUIRE(next.top == second.top);
+    REQUIRE(next.size == second.size);
+}
+
+TEST_CASE("present_dirty_tracker_clips_to_screen", "dispatch") {
+    dispatch::screen_dirty_tracker tracker;
+
+    const eka2l1::rect offscreen({ 300, 400 }, { 20, 20 });
+    REQUIRE(tracker.submit(SCREEN_SIZE, &offscreen, 1) == dispatch::screen_dirty_tracker::submit_nothing_dirty);
+    REQUIRE_FALSE(tracker.scheduled());
+
+    const eka2l1::rect partial({ 230, -5 }, { 20, 20 });
+    REQUIRE(tracker.submit(SCREEN_SIZE, &partial, 1) == dispatch::screen_dirty_tracker::submit_schedule);
+
+    const eka2l1::rect dirty = tracker.take();
+
+    REQUIRE(dirty.top == eka2l1::vec2(230, 0));
+    REQUIRE(dirty.size == eka2l1::vec2(10, 15));
+
+    // No rectangles means the whole screen
+    REQUIRE(tracker.submit(SCREEN_SIZE, nullptr, 0) == dispatch::screen_dirty_tracker::submit_schedule);
+    const eka2l1::rect whole = tracker.take();
+
+    REQUIRE(whole.top == eka2l1::vec2(0, 0));
+    REQUIRE(whole.size == SCREEN_SIZE);
+}
+
+TEST_CASE("present_upload_region_byte_modes", "dispatch") {
+    REQUIRE(dispatch::get_screen_buffer_pitch(240, 16) == 480);
+    REQUIRE(dispatch::get_screen_buffer_pitch(240, 24) == 720);
+    REQUIRE(dispatch::get_screen_buffer_pitch(240, 32) == 960);
+
+    const eka2l1::rect dirty({ 10, 20 }, { 30, 40 });
+    const dispatch::screen_upload_region region = dispatch::get_screen_upload_region(dirty, SCREEN_SIZE, 16);
+
+    REQUIRE(region.area.top == dirty.top);
+    REQUIRE(region.area.size == dirty.size);
+    REQUIRE(region.offset == 20 * 480 + 10 * 2);
+    REQUIRE(region.size == 39 * 480 + 30 * 2);
+    REQUIRE(region.pixels_per_line == 240);
+}
+
+TEST_CASE("present_upload_region_sub_byte_modes", "dispatch") {
+    // Lines are padded to 32 bits
+    REQUIRE(dispatch::get_screen_buffer_pitch(240, 1) == 32);
+    REQUIRE(dispatch::get_screen_buffer_pitch(250, 1) == 32);
+    REQUIRE(dispatch::get_screen_buffer_pitch(250, 2) == 64);
+    REQUIRE(dispatch::get_screen_buffer_pitch(250, 4) == 128);
+
+    const eka2l1::vec2 screen_size = { 250, 320 };
+    const eka2l1::rect dirty({ 13, 20 }, { 30, 40 });
+    const dispatch::screen_upload_region region = dispatch::get_screen_upload_region(dirty, screen_size, 4);
+
+    // Whole lines, since a pixel may not start on a byte
+    REQUIRE(region.area.top == eka2l1::vec2(0, 20));
+    REQUIRE(region.area.size == eka2l1::vec2(250, 40));
+    REQUIRE(region.offset == 20 * 128);
+    REQUIRE(region.size == 40 * 128);
+    REQUIRE(region.pixels_per_line == 256);
+}
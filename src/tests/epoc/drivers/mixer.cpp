@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <drivers/audio/audio.h>
+#include <drivers/audio/mixer.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+// Host stream that is pulled by the test instead of a real audio device
+struct test_host_stream : public drivers::audio_output_stream {
+    drivers::data_callback callback_;
+    bool playing_ = false;
+
+    explicit test_host_stream(drivers::data_callback callback)
+        : callback_(callback) {
+    }
+
+    bool start() override {
+        playing_ = true;
+        return true;
+    }
+
+    bool stop() override {
+        playing_ = false;
+        return true;
+    }
+
+    bool is_playing() override {
+        return playing_;
+    }
+
+    bool set_volume(const float volume) override {
+        return true;
+    }
+
+    std::vector<std::int16_t> pull(const std::size_t frames) {
+        std::vector<std::int16_t> result(frames * 2);
+        callback_(result.data(), frames);
+
+        return result;
+    }
+};
+
+struct test_audio_driver : public drivers::audio_driver {
+    test_host_stream *host_ = nullptr;
+
+    std::unique_ptr<drivers::audio_output_stream> new_host_output_stream(const std::uint32_t sample_rate,
+        const std::uint8_t channels, drivers::data_callback callback) override {
+        auto stream = std::make_unique<test_host_stream>(callback);
+        host_ = stream.get();
+
+        return stream;
+    }
+
+    std::uint32_t native_sample_rate() override {
+        return 44100;
+    }
+};
+
+static drivers::data_callback make_constant_source(const std::int16_t left, const std::int16_t right) {
+    return [left, right](std::int16_t *buffer, const std::size_t frames) {
+        for (std::size_t i = 0; i < frames; i++) {
+            buffer[i * 2] = left;
+            buffer[i * 2 + 1] = right;
+        }
+
+        return frames;
+    };
+}
+
+TEST_CASE("mixer_sum_and_saturate", "audio") {
+    test_audio_driver driver;
+
+    auto first = driver.new_output_stream(44100, 2, make_constant_source(1000, -1000));
+    auto second = driver.new_output_stream(44100, 2, make_constant_source(2000, -2000));
+
+    REQUIRE(first->start());
+    REQUIRE(second->start());
+    REQUIRE(driver.host_);
+
+    std::vector<std::int16_t> output = driver.host_->pull(256);
+    REQUIRE(output[0] == 3000);
+    REQUIRE(output[1] == -3000);
+    REQUIRE(output[511] == -3000);
+
+    second->set_volume(0.5f);
+    output = driver.host_->pull(256);
+    REQUIRE(output[0] == 2000);
+    REQUIRE(output[1] == -2000);
+
+    auto loud = driver.new_output_stream(44100, 2, make_constant_source(32000, -32000));
+    REQUIRE(loud->start());
+
+    output = driver.host_->pull(256);
+    REQUIRE(output[0] == 32767);
+    REQUIRE(output[1] == -32768);
+
+    const std::vector<drivers::audio_mixer_stream_stats> stats = driver.get_mixer()->stream_stats();
+    REQUIRE(stats.size() == 3);
+    REQUIRE(stats[0].frames_mixed_ == 768);
+    REQUIRE(stats[2].frames_mixed_ == 256);
+    REQUIRE(stats[0].underruns_ == 0);
+}
+
+TEST_CASE("mixer_resample_mono", "audio") {
+    test_audio_driver driver;
+    std::size_t source_frames = 0;
+
+    auto stream = driver.new_output_stream(22050, 1, [&](std::int16_t *buffer, const std::size_t frames) {
+        std::fill(buffer, buffer + frames, static_cast<std::int16_t>(500));
+        source_frames += frames;
+
+        return frames;
+    });
+
+    REQUIRE(stream->start());
+
+    const std::vector<std::int16_t> output = driver.host_->pull(1000);
+
+    // Interpolation starts from silence, then settles on the source value on both channels
+    for (std::size_t i = 4; i < output.size(); i++) {
+        REQUIRE(output[i] == 500);
+    }
+
+    // Half the host rate, so one source block covers the whole pass
+    REQUIRE(source_frames == 512);
+}
+
+TEST_CASE("mixer_underrun_keeps_stream", "audio") {
+    test_audio_driver driver;
+
+    auto stream = driver.new_output_stream(44100, 2, [](std::int16_t *buffer, const std::size_t frames) {
+        const std::size_t supplied = std::min<std::size_t>(frames, 100);
+        std::fill(buffer, buffer + supplied * 2, static_cast<std::int16_t>(100));
+
+        return supplied;
+    });
+
+    REQUIRE(stream->start());
+
+    std::vector<std::int16_t> output = driver.host_->pull(256);
+    REQUIRE(output[199] == 100);
+    REQUIRE(output[200] == 0);
+    REQUIRE(stream->is_playing());
+
+    // Still pulled on the next pass
+    output = driver.host_->pull(256);
+    REQUIRE(output[0] == 100);
+
+    const std::vector<drivers::audio_mixer_stream_stats> stats = driver.get_mixer()->stream_stats();
+    REQUIRE(stats[0].underruns_ == 2);
+    REQUIRE(stats[0].frames_mixed_ == 200);
+}
+
+TEST_CASE("mixer_stream_ends_by_stopping_itself", "audio") {
+    test_audio_driver driver;
+    std::unique_ptr<drivers::audio_output_stream> stream;
+    bool ended = false;
+
+    // Resampled, so the end is noticed while fetching a source block
+    stream = driver.new_output_stream(22050, 2, [&](std::int16_t *buffer, const std::size_t frames) -> std::size_t {
+        if (ended) {
+            return 0;
+        }
+
+        std::fill(buffer, buffer + 100 * 2, static_cast<std::int16_t>(100));
+
+        // Last data of the source, like a player reaching the end of its file
+        ended = true;
+        stream->stop();
+
+        return 100;
+    });
+
+    REQUIRE(stream->start());
+
+    driver.host_->pull(512);
+    REQUIRE(!stream->is_playing());
+
+    const std::vector<drivers::audio_mixer_stream_stats> stats = driver.get_mixer()->stream_stats();
+    REQUIRE(stats[0].underruns_ == 0);
+    REQUIRE(stats[0].frames_mixed_ == 200);
+}
+
+TEST_CASE("mixer_restart_resets_resampler", "audio") {
+    test_audio_driver driver;
+
+    auto stream = driver.new_output_stream(22050, 1, [](std::int16_t *buffer, const std::size_t frames) {
+        std::fill(buffer, buffer + frames, static_cast<std::int16_t>(500));
+        return frames;
+    });
+
+    REQUIRE(stream->start());
+
+    std::vector<std::int16_t> output = driver.host_->pull(64);
+    REQUIRE(output[0] == 0);
+    REQUIRE(output[126] == 500);
+
+    // The reset is done by the next render, and interpolation starts from silence again
+    REQUIRE(stream->stop());
+    REQUIRE(stream->start());
+
+    output = driver.host_->pull(64);
+    REQUIRE(output[0] == 0);
+    REQUIRE(output[126] == 500);
+}
+
+TEST_CASE("mixer_stops_host_stream_with_last_stream", "audio") {
+    test_audio_driver driver;
+
+    auto first = driver.new_output_stream(44100, 2, make_constant_source(1000, -1000));
+    auto second = driver.new_output_stream(44100, 2, make_constant_source(2000, -2000));
+
+    REQUIRE(first->start());
+    REQUIRE(driver.host_->is_playing());
+
+    first.reset();
+    REQUIRE(driver.host_->is_playing());
+
+    second.reset();
+    REQUIRE(!driver.host_->is_playing());
+
+    // Started again by the next stream
+    auto third = driver.new_output_stream(44100, 2, make_constant_source(1000, -1000));
+    REQUIRE(third->start());
+    REQUIRE(driver.host_->is_playing());
+}
+
+TEST_CASE("mixer_stop_while_callback_waits_on_lock", "audio") {
+    test_audio_driver driver;
+
+    // Stands in for the kernel lock, which guest stream callbacks take to complete requests
+    std::mutex kern_lock;
+    std::atomic<bool> in_callback(false);
+    std::atomic<int> calls(0);
+
+    auto stream = driver.new_output_stream(44100, 2, [&](std::int16_t *buffer, const std::size_t frames) {
+        calls++;
+        in_callback = true;
+
+        const std::lock_guard<std::mutex> guard(kern_lock);
+        std::fill(buffer, buffer + frames * 2, static_cast<std::int16_t>(0));
+
+        return frames;
+    });
+
+    REQUIRE(stream->start());
+
+    std::unique_lock<std::mutex> guard(kern_lock);
+    std::thread audio_thread([&]() {
+        driver.host_->pull(256);
+    });
+
+    while (!in_callback) {
+        std::this_thread::yield();
+    }
+
+    // The callback is blocked on the lock we hold. Stopping must not wait for it.
+    REQUIRE(stream->stop());
+    REQUIRE(!stream->is_playing());
+
+    guard.unlock();
+    audio_thread.join();
+
+    driver.host_->pull(256);
+    REQUIRE(calls == 1);
+
+    // Nothing is being mixed anymore, so this does not wait either
+    stream.reset();
+    REQUIRE(driver.get_mixer()->stream_stats().empty());
+}
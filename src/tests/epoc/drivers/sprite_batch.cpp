@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <drivers/graphics/backend/sprite_batch.h>
+
+#include <cstdint>
+
+using namespace eka2l1;
+
+static const float WHITE[] = { 255.0f, 255.0f, 255.0f, 255.0f };
+static const float RED[] = { 255.0f, 0.0f, 0.0f, 255.0f };
+
+// Feeds draws to a batch the way a backend executor does, counting what reaches the graphics API
+struct batch_counter {
+    drivers::sprite_batch batch_;
+    std::uint32_t draw_calls_ = 0;
+    std::uint32_t batched_draws_ = 0;
+
+    void flush() {
+        if (!batch_.empty()) {
+            draw_calls_++;
+            batch_.clear();
+        }
+    }
+
+    void draw(const std::uint64_t texture, const float *color, const float flip = -1.0f) {
+        if (!batch_.empty()) {
+            if (batch_.can_join(texture, color, flip)) {
+                batched_draws_++;
+            } else {
+                flush();
+            }
+        }
+
+        batch_.push(texture, eka2l1::vec2(64, 64), eka2l1::rect(eka2l1::vec2(0, 0), eka2l1::vec2(16, 16)),
+            eka2l1::rect{}, color, flip);
+    }
+};
+
+TEST_CASE("sprite_batch_merges_same_state", "sprite_batch") {
+    batch_counter counter;
+
+    for (int i = 0; i < 64; i++) {
+        counter.draw(1, WHITE);
+    }
+
+    REQUIRE(counter.batch_.sprite_count() == 64);
+    counter.flush();
+
+    REQUIRE(counter.draw_calls_ == 1);
+    REQUIRE(counter.batched_draws_ == 63);
+}
+
+TEST_CASE("sprite_batch_breaks_on_state_change", "sprite_batch") {
+    batch_counter counter;
+
+    // Alternating textures can never share a draw call
+    for (int i = 0; i < 64; i++) {
+        counter.draw((i & 1) ? 1 : 2, WHITE);
+    }
+
+    counter.flush();
+
+    REQUIRE(counter.draw_calls_ == 64);
+    REQUIRE(counter.batched_draws_ == 0);
+
+    batch_counter state_counter;
+
+    state_counter.draw(1, WHITE);
+    state_counter.draw(1, WHITE);
+    state_counter.draw(1, RED);
+    state_counter.draw(1, RED, 1.0f);
+    state_counter.flush();
+
+    REQUIRE(state_counter.draw_calls_ == 3);
+    REQUIRE(state_counter.batched_draws_ == 1);
+}
+
+TEST_CASE("sprite_batch_splits_when_full", "sprite_batch") {
+    batch_counter counter;
+
+    for (std::size_t i = 0; i < drivers::sprite_batch::MAX_SPRITES + 1; i++) {
+        counter.draw(1, WHITE);
+    }
+
+    counter.flush();
+
+    REQUIRE(counter.draw_calls_ == 2);
+    REQUIRE(counter.batched_draws_ == drivers::sprite_batch::MAX_SPRITES - 1);
+}
+
+TEST_CASE("sprite_batch_vertices", "sprite_batch") {
+    drivers::sprite_batch batch;
+
+    // Half of a 64x32 texture, drawn at its own size
+    batch.push(7, eka2l1::vec2(64, 32), eka2l1::rect(eka2l1::vec2(10, 20), eka2l1::vec2(0, 0)),
+        eka2l1::rect(eka2l1::vec2(32, 0), eka2l1::vec2(32, 32)), RED, 1.0f);
+
+    REQUIRE(batch.texture() == 7);
+    REQUIRE(batch.flip() == 1.0f);
+    REQUIRE(batch.color()[1] == 0.0f);
+
+    const auto &verts = batch.vertices();
+    REQUIRE(verts.size() == 4);
+
+    // Bottom left, top right, top left, bottom right
+    REQUIRE(verts[0].top[0] == 10.0f);
+    REQUIRE(verts[0].top[1] == 52.0f);
+    REQUIRE(verts[0].coord[0] == 0.5f);
+    REQUIRE(verts[0].coord[1] == 1.0f);
+
+    REQUIRE(verts[1].top[0] == 42.0f);
+    REQUIRE(verts[1].top[1] == 20.0f);
+    REQUIRE(verts[1].coord[0] == 1.0f);
+    REQUIRE(verts[1].coord[1] == 0.0f);
+
+    REQUIRE(verts[2].top[0] == 10.0f);
+    REQUIRE(verts[2].top[1] == 20.0f);
+    REQUIRE(verts[3].top[0] == 42.0f);
+    REQUIRE(verts[3].top[1] == 52.0f);
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/platform.h>
+#include <gdbstub/gdbstub.h>
+#include <gdbstub/transport.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#if !EKA2L1_PLATFORM(WIN32)
+
+using namespace eka2l1;
+
+// Plays the debugger side of the remote protocol over a loopback connection
+struct gdb_loopback_client {
+    int server_socket_ = -1;
+    int client_socket_ = -1;
+
+    gdb_loopback_client() {
+        const int listener = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+
+        bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        listen(listener, 1);
+
+        socklen_t addr_len = sizeof(addr);
+        getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+
+        client_socket_ = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+        connect(client_socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+        server_socket_ = static_cast<int>(accept(listener, nullptr, nullptr));
+        close(listener);
+    }
+
+    // Debugger side of a connection made elsewhere
+    explicit gdb_loopback_client(const int client_socket)
+        : client_socket_(client_socket) {
+    }
+
+    ~gdb_loopback_client() {
+        close(client_socket_);
+
+        if (server_socket_ != -1) {
+            close(server_socket_);
+        }
+    }
+
+    void send_raw(const std::string &data) {
+        ::send(client_socket_, data.data(), data.size(), 0);
+    }
+
+    void send_packet(const std::string &payload) {
+        std::uint8_t checksum = 0;
+        for (const char c : payload) {
+            checksum += static_cast<std::uint8_t>(c);
+        }
+
+        char checksum_str[3];
+        std::snprintf(checksum_str, sizeof(checksum_str), "%02x", checksum);
+
+        send_raw("$" + payload + "#" + checksum_str);
+    }
+
+    char read_byte() {
+        char c = 0;
+        recv(client_socket_, &c, 1, MSG_WAITALL);
+        return c;
+    }
+
+    // Read a reply packet and acknowledge it, returning its payload
+    std::string read_packet() {
+        while (read_byte() != GDB_STUB_START) {
+        }
+
+        std::string payload;
+        for (char c = read_byte(); c != GDB_STUB_END; c = read_byte()) {
+            payload += c;
+        }
+
+        read_byte();
+        read_byte();
+
+        send_raw(std::string(1, GDB_STUB_ACK));
+        return payload;
+    }
+};
+
+static bool wait_for_packet(gdb_transport &transport, std::string &payload) {
+    std::uint8_t buffer[GDB_BUFFER_SIZE];
+    std::uint32_t size = 0;
+
+    for (int i = 0; i < 2000; i++) {
+        if (transport.pop_packet(buffer, sizeof(buffer), size)) {
+            payload.assign(reinterpret_cast<const char *>(buffer), size);
+            return true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+}
+
+TEST_CASE("gdb_transport_acks_and_queues_packets", "gdbstub") {
+    gdb_loopback_client client;
+    gdb_transport transport;
+
+    transport.start(client.server_socket_);
+
+    client.send_packet("qSupported:multiprocess+");
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+
+    std::string payload;
+    REQUIRE(wait_for_packet(transport, payload));
+    REQUIRE(payload == "qSupported:multiprocess+");
+
+    // Two packets in one write must come out separately and in order
+    client.send_packet("g");
+    client.send_packet("m1000,4");
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+
+    REQUIRE(wait_for_packet(transport, payload));
+    REQUIRE(payload == "g");
+    REQUIRE(wait_for_packet(transport, payload));
+    REQUIRE(payload == "m1000,4");
+
+    // Replies go back untouched
+    const std::string reply = "$OK#9a";
+    REQUIRE(transport.send(reinterpret_cast<const std::uint8_t *>(reply.data()), reply.size()));
+
+    for (const char c : reply) {
+        REQUIRE(client.read_byte() == c);
+    }
+
+    transport.stop();
+}
+
+TEST_CASE("gdb_transport_rejects_bad_checksum", "gdbstub") {
+    gdb_loopback_client client;
+    gdb_transport transport;
+
+    transport.start(client.server_socket_);
+
+    client.send_raw("$g#00");
+    REQUIRE(client.read_byte() == GDB_STUB_NACK);
+
+    std::uint8_t buffer[16];
+    std::uint32_t size = 0;
+    REQUIRE(!transport.pop_packet(buffer, sizeof(buffer), size));
+
+    transport.stop();
+}
+
+TEST_CASE("gdb_transport_break_and_disconnect", "gdbstub") {
+    gdb_loopback_client client;
+    gdb_transport transport;
+
+    transport.start(client.server_socket_);
+    REQUIRE(!transport.take_break_request());
+
+    client.send_raw("\x03");
+
+    bool break_seen = false;
+    for (int i = 0; (i < 2000) && !break_seen; i++) {
+        break_seen = transport.take_break_request();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    REQUIRE(break_seen);
+    REQUIRE(!transport.take_break_request());
+
+    shutdown(client.client_socket_, SHUT_RDWR);
+
+    for (int i = 0; (i < 2000) && transport.is_alive(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    REQUIRE(!transport.is_alive());
+    transport.stop();
+}
+
+// Stub that listens without a kernel attached, for commands that don't need one
+struct kernelless_gdbstub : public gdbstub {
+    void listen(const std::uint16_t port) {
+        server_enabled = true;
+        init(port);
+    }
+};
+
+TEST_CASE("gdbstub_handles_packets_from_reader_thread", "gdbstub") {
+    // Find a free port for the stub to listen on
+    const int probe = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    bind(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(probe, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+    close(probe);
+
+    kernelless_gdbstub stub;
+    std::atomic<bool> stub_connected(false);
+
+    // Plays the emulator thread: waits for the debugger, then polls for packets every time slice
+    std::thread emulator_thread([&]() {
+        stub.listen(ntohs(addr.sin_port));
+        stub_connected = stub.is_connected();
+
+        while (stub.is_connected()) {
+            stub.handle_packet();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    const int client_socket = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+
+    bool connected = false;
+    for (int i = 0; (i < 2000) && !connected; i++) {
+        connected = (connect(client_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+        if (!connected) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    REQUIRE(connected);
+
+    gdb_loopback_client client(client_socket);
+
+    // Received by the transport's reader thread, handled on the emulator thread
+    client.send_packet("qSupported:multiprocess+");
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+    REQUIRE(client.read_packet() == "PacketSize=2000;qXfer:features:read+;qXfer:threads:read+;qXfer:libraries:read+");
+
+    client.send_packet("qsThreadInfo");
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+    REQUIRE(client.read_packet() == "l");
+
+    // The break byte halts the CPU loop, and is answered with a trap signal
+    client.send_raw("\x03");
+    REQUIRE(client.read_packet() == "T05");
+
+    client.send_packet("k");
+    REQUIRE(client.read_byte() == GDB_STUB_ACK);
+
+    emulator_thread.join();
+
+    REQUIRE(stub_connected);
+    REQUIRE(stub.get_cpu_halt_flag());
+    REQUIRE(!stub.is_connected());
+}
+
+#endif
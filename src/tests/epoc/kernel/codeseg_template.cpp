@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/virtualmem.h>
+#include <kernel/codeseg.h>
+
+#include <cstring>
+#include <memory>
+
+using namespace eka2l1;
+
+static const std::u16string CODESEG_PATH = u"z:\\sys\\bin\\euser.dll";
+static constexpr std::uint64_t CODESEG_HASH = 0x1234ABCD;
+
+// Host memory standing in for the code and data chunk of one process
+struct fake_codeseg_load {
+    std::size_t size_;
+    std::uint8_t *code_;
+    std::uint8_t *data_;
+
+    explicit fake_codeseg_load(const std::size_t size)
+        : size_(size) {
+        code_ = reinterpret_cast<std::uint8_t *>(common::map_memory(size_ * 2));
+        data_ = code_ + size_;
+
+        common::commit(code_, size_ * 2, prot_read_write);
+    }
+
+    ~fake_codeseg_load() {
+        common::unmap_memory(code_, size_ * 2);
+    }
+
+    // Copy and patch, like a load that found no template
+    void load_normally() {
+        for (std::size_t i = 0; i < size_; i++) {
+            code_[i] = static_cast<std::uint8_t>(i * 7);
+            data_[i] = static_cast<std::uint8_t>(i * 13);
+        }
+
+        // Relocated words
+        *reinterpret_cast<std::uint32_t *>(code_ + 16) = 0x70001000;
+        *reinterpret_cast<std::uint32_t *>(data_ + 32) = 0x00400040;
+    }
+
+    kernel::codeseg_template make_template() const {
+        kernel::codeseg_template templ;
+        templ.source_hash_ = CODESEG_HASH;
+        templ.code_run_addr_ = 0x70000000;
+        templ.data_run_addr_ = 0x00400000;
+        templ.code_ = std::make_unique<mem::cow_template>(code_, size_);
+        templ.data_ = std::make_unique<mem::cow_template>(data_, size_);
+
+        return templ;
+    }
+};
+
+static kernel::codeseg_template make_sized_template(const std::size_t size) {
+    std::vector<std::uint8_t> content(size, 0xEE);
+
+    kernel::codeseg_template templ;
+    templ.source_hash_ = CODESEG_HASH;
+    templ.code_ = std::make_unique<mem::cow_template>(content.data(), content.size());
+
+    return templ;
+}
+
+TEST_CASE("codeseg_template_second_load_maps_identical_pages", "kernel") {
+    const std::size_t page_size = static_cast<std::size_t>(common::get_host_page_size());
+    kernel::codeseg_template_cache cache;
+
+    // First load: nothing cached, so the codeseg is copied and patched, then saved
+    fake_codeseg_load first(page_size * 2);
+
+    REQUIRE(cache.find(CODESEG_PATH, CODESEG_HASH) == nullptr);
+    cache.record(false);
+
+    first.load_normally();
+
+    kernel::codeseg_template fresh = first.make_template();
+    REQUIRE(fresh.code_->valid());
+    REQUIRE(fresh.data_->valid());
+
+    cache.add(CODESEG_PATH, std::move(fresh));
+
+    REQUIRE(cache.count() == 1);
+    REQUIRE(cache.size() == page_size * 4);
+
+    // Second load: the pages come from the template
+    fake_codeseg_load second(page_size * 2);
+    std::shared_ptr<kernel::codeseg_template> templ = cache.find(CODESEG_PATH, CODESEG_HASH);
+
+    REQUIRE(templ != nullptr);
+    cache.record(true);
+
+    REQUIRE(templ->code_->map(second.code_, prot_read_write));
+    REQUIRE(templ->data_->map(second.data_, prot_read_write));
+
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+
+    REQUIRE(std::memcmp(first.code_, second.code_, first.size_) == 0);
+    REQUIRE(std::memcmp(first.data_, second.data_, first.size_) == 0);
+
+    // Writes stay private to the process that made them
+    second.data_[32] = 0xFF;
+    REQUIRE(first.data_[32] == 0x40);
+
+    fake_codeseg_load third(page_size * 2);
+
+    REQUIRE(cache.find(CODESEG_PATH, CODESEG_HASH)->data_->map(third.data_, prot_read_write));
+    REQUIRE(third.data_[32] == 0x40);
+
+    // Different content under the same path is not reused
+    REQUIRE(cache.find(CODESEG_PATH, CODESEG_HASH + 1) == nullptr);
+}
+
+TEST_CASE("codeseg_template_cache_bounded", "kernel") {
+    const std::size_t page_size = static_cast<std::size_t>(common::get_host_page_size());
+
+    SECTION("By count, least recently used first") {
+        kernel::codeseg_template_cache cache(2, page_size * 16);
+
+        cache.add(u"a.dll", make_sized_template(page_size));
+        cache.add(u"b.dll", make_sized_template(page_size));
+
+        // Make b the oldest
+        REQUIRE(cache.find(u"a.dll", CODESEG_HASH) != nullptr);
+
+        cache.add(u"c.dll", make_sized_template(page_size));
+
+        REQUIRE(cache.count() == 2);
+        REQUIRE(cache.evictions() == 1);
+        REQUIRE(cache.find(u"a.dll", CODESEG_HASH) != nullptr);
+        REQUIRE(cache.find(u"b.dll", CODESEG_HASH) == nullptr);
+        REQUIRE(cache.find(u"c.dll", CODESEG_HASH) != nullptr);
+    }
+
+    SECTION("By size") {
+        kernel::codeseg_template_cache cache(16, page_size * 4);
+
+        cache.add(u"a.dll", make_sized_template(page_size * 2));
+        cache.add(u"b.dll", make_sized_template(page_size * 2));
+        cache.add(u"c.dll", make_sized_template(page_size * 3));
+
+        REQUIRE(cache.count() == 1);
+        REQUIRE(cache.size() == page_size * 3);
+        REQUIRE(cache.find(u"c.dll", CODESEG_HASH) != nullptr);
+
+        // Too big to ever fit
+        cache.add(u"d.dll", make_sized_template(page_size * 5));
+
+        REQUIRE(cache.count() == 1);
+        REQUIRE(cache.find(u"d.dll", CODESEG_HASH) == nullptr);
+    }
+
+    SECTION("Replacing a template") {
+        kernel::codeseg_template_cache cache(16, page_size * 4);
+
+        cache.add(u"a.dll", make_sized_template(page_size * 2));
+        cache.add(u"a.dll", make_sized_template(page_size * 3));
+
+        REQUIRE(cache.count() == 1);
+        REQUIRE(cache.size() == page_size * 3);
+        REQUIRE(cache.evictions() == 0);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <kernel/object_ix.h>
+
+#include <vector>
+
+using namespace eka2l1::kernel;
+
+// Process objects are never destroyed by the container, so no kernel is needed
+struct fake_handle_object : public kernel_obj {
+    explicit fake_handle_object()
+        : kernel_obj(nullptr) {
+        obj_type = object_type::process;
+    }
+};
+
+TEST_CASE("object_ix_grows_and_reuses_slots", "kernel") {
+    object_ix container;
+    fake_handle_object objs[3];
+
+    const std::size_t empty_usage = container.memory_usage();
+    std::vector<std::uint32_t> handles;
+
+    // Spill over a few pages
+    for (std::uint32_t i = 0; i < HANDLE_PAGE_SIZE * 3; i++) {
+        handles.push_back(container.add_object(&objs[i % 3]));
+        REQUIRE(handles.back() != INVALID_HANDLE);
+        REQUIRE((handles.back() & 0x7FFF) == i);
+    }
+
+    REQUIRE(container.total_open() == HANDLE_PAGE_SIZE * 3);
+    REQUIRE(container.memory_usage() < empty_usage + 4 * sizeof(object_ix_page));
+    REQUIRE(container.count(&objs[0]) == HANDLE_PAGE_SIZE);
+    REQUIRE(container.get_object(handles[HANDLE_PAGE_SIZE + 1]) == &objs[(HANDLE_PAGE_SIZE + 1) % 3]);
+
+    // A closed slot is handed out again, with new instance bits
+    const std::uint32_t closed = handles[5];
+    REQUIRE(container.close(closed) == 0);
+    REQUIRE(container.get_object(closed) == nullptr);
+
+    const std::uint32_t reopened = container.add_object(&objs[0]);
+    REQUIRE((reopened & 0x7FFF) == 5);
+    REQUIRE(reopened != closed);
+    REQUIRE(container.get_object(reopened) == &objs[0]);
+
+    // Handles past what has been allocated are simply invalid
+    REQUIRE(container.get_object(0x7FFF) == nullptr);
+    REQUIRE(container.close(0x7FFF) == -1);
+}
+
+TEST_CASE("object_ix_full", "kernel") {
+    object_ix container;
+    fake_handle_object obj;
+
+    for (std::uint32_t i = 0; i < MAX_HANDLE_COUNT; i++) {
+        REQUIRE(container.add_object(&obj) != INVALID_HANDLE);
+    }
+
+    REQUIRE(container.add_object(&obj) == INVALID_HANDLE);
+}
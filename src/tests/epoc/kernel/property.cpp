@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <kernel/property.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+static void count_data_change(void *userdata, service::property *prop) {
+    (*reinterpret_cast<int *>(userdata))++;
+}
+
+TEST_CASE("property_small_value", "kernel") {
+    service::property prop(nullptr);
+    prop.define(service::property_type::bin_data, 0);
+
+    int changes = 0;
+    prop.add_data_change_callback(&changes, count_data_change);
+
+    std::vector<std::uint8_t> value = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    REQUIRE(prop.set(value.data(), static_cast<std::uint32_t>(value.size())));
+    REQUIRE(prop.get_bin() == value);
+    REQUIRE(changes == 1);
+
+    // Same value again still notifies, like RProperty::Set
+    REQUIRE(prop.set(value.data(), static_cast<std::uint32_t>(value.size())));
+    REQUIRE(changes == 2);
+
+    value[9] = 11;
+
+    REQUIRE(prop.set(value.data(), static_cast<std::uint32_t>(value.size())));
+    REQUIRE(prop.get_bin() == value);
+    REQUIRE(changes == 3);
+
+    // Truncated to fit the buffer, with the full length returned
+    std::uint8_t dest[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+    REQUIRE(prop.get_bin(dest, 4) == 10);
+    REQUIRE(dest[0] == 1);
+    REQUIRE(dest[3] == 4);
+    REQUIRE(dest[4] == 0xFF);
+
+    // Wrong type
+    REQUIRE_FALSE(prop.set_int(1));
+    REQUIRE(prop.get_int() == -1);
+}
+
+TEST_CASE("property_int_value", "kernel") {
+    service::property prop(nullptr);
+    prop.define(service::property_type::int_data, 0);
+
+    int changes = 0;
+    prop.add_data_change_callback(&changes, count_data_change);
+
+    REQUIRE(prop.set_int(5));
+    REQUIRE(prop.get_int() == 5);
+    REQUIRE(prop.set_int(5));
+    REQUIRE(changes == 2);
+
+    REQUIRE(prop.set_int(6));
+    REQUIRE(prop.get_int() == 6);
+    REQUIRE(changes == 3);
+}
+
+TEST_CASE("property_large_value", "kernel") {
+    service::property prop(nullptr);
+    prop.define(service::property_type::bin_data, 0);
+
+    std::vector<std::uint8_t> large(service::PROPERTY_INPLACE_BIN_SIZE * 4);
+
+    for (std::size_t i = 0; i < large.size(); i++) {
+        large[i] = static_cast<std::uint8_t>(i * 3);
+    }
+
+    REQUIRE(prop.set(large.data(), static_cast<std::uint32_t>(large.size())));
+    REQUIRE(prop.get_bin() == large);
+
+    std::uint8_t dest[16] = {};
+
+    REQUIRE(prop.get_bin(dest, sizeof(dest)) == large.size());
+    REQUIRE(std::equal(dest, dest + sizeof(dest), large.begin()));
+
+    // Back to a value stored in place
+    std::vector<std::uint8_t> small = { 42, 43 };
+
+    REQUIRE(prop.set(small.data(), static_cast<std::uint32_t>(small.size())));
+    REQUIRE(prop.get_bin() == small);
+}
+
+TEST_CASE("property_readers_never_see_torn_value", "kernel") {
+    service::property prop(nullptr);
+    prop.define(service::property_type::bin_data, 0);
+
+    // Each value is filled with its own length, so a torn read shows mixed bytes
+    std::vector<std::uint8_t> values[3] = {
+        std::vector<std::uint8_t>(250, 250),
+        std::vector<std::uint8_t>(500, 500 & 0xFF),
+        std::vector<std::uint8_t>(600, 600 & 0xFF)
+    };
+
+    REQUIRE(prop.set(values[0].data(), static_cast<std::uint32_t>(values[0].size())));
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0);
+    std::atomic<int> reads(0);
+
+    std::thread reader([&]() {
+        std::vector<std::uint8_t> dest(service::PROPERTY_INPLACE_BIN_SIZE * 2);
+
+        while (!stop) {
+            const std::uint32_t length = prop.get_bin(dest.data(), static_cast<std::uint32_t>(dest.size()));
+
+            for (std::uint32_t i = 0; i < length; i++) {
+                if (dest[i] != static_cast<std::uint8_t>(length & 0xFF)) {
+                    torn++;
+                    break;
+                }
+            }
+
+            reads++;
+        }
+    });
+
+    // Keep writing until the reader had plenty of chances to overlap
+    for (int i = 0; (i < 200000) || (reads < 200000); i++) {
+        const std::vector<std::uint8_t> &value = values[i % 3];
+        prop.set(const_cast<std::uint8_t *>(value.data()), static_cast<std::uint32_t>(value.size()));
+    }
+
+    stop = true;
+    reader.join();
+
+    REQUIRE(torn == 0);
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <kernel/thread.h>
+#include <kernel/waitqueue.h>
+
+#include <memory>
+#include <vector>
+
+namespace eka2l1::kernel {
+    // Threads here are not backed by a kernel or a process, only their priority matters
+    struct thread_test_access {
+        static std::unique_ptr<thread> make(const int priority) {
+            auto thr = std::make_unique<thread>(nullptr, nullptr, nullptr);
+            thr->real_priority = priority;
+
+            return thr;
+        }
+
+        static void set_priority(thread *thr, const int priority) {
+            thr->real_priority = priority;
+        }
+    };
+}
+
+using namespace eka2l1;
+
+TEST_CASE("wait_queue_priority_order", "kernel") {
+    kernel::thread_wait_queue queue;
+
+    REQUIRE(queue.empty());
+    REQUIRE(queue.top() == nullptr);
+    REQUIRE(queue.pop(0) == nullptr);
+
+    // Both halves of the priority mask, and the edges of each
+    const int priorities[] = { 10, 0, 31, 32, 63, 10, 40 };
+    std::vector<std::unique_ptr<kernel::thread>> threads;
+
+    for (std::size_t i = 0; i < sizeof(priorities) / sizeof(priorities[0]); i++) {
+        threads.push_back(kernel::thread_test_access::make(priorities[i]));
+        queue.push(threads.back().get(), i * 10);
+    }
+
+    REQUIRE(queue.size() == threads.size());
+    REQUIRE(queue.stats().max_waiters == threads.size());
+
+    // Highest priority first, and the earliest one among equals
+    REQUIRE(queue.pop(100) == threads[4].get());
+    REQUIRE(queue.pop(100) == threads[6].get());
+    REQUIRE(queue.pop(100) == threads[3].get());
+    REQUIRE(queue.pop(100) == threads[2].get());
+    REQUIRE(queue.pop(100) == threads[0].get());
+    REQUIRE(queue.pop(100) == threads[5].get());
+    REQUIRE(queue.pop(100) == threads[1].get());
+
+    REQUIRE(queue.empty());
+    REQUIRE(queue.top() == nullptr);
+
+    // The first thread was pushed at 0us and waited the longest
+    REQUIRE(queue.stats().max_wait_us == 100);
+    REQUIRE(queue.stats().total_wait_us == 700 - 210);
+}
+
+TEST_CASE("wait_queue_low_half_only", "kernel") {
+    kernel::thread_wait_queue queue;
+
+    auto low = kernel::thread_test_access::make(3);
+    auto lower = kernel::thread_test_access::make(1);
+
+    queue.push(lower.get(), 0);
+    queue.push(low.get(), 0);
+
+    REQUIRE(queue.top() == low.get());
+    REQUIRE(queue.pop(0) == low.get());
+    REQUIRE(queue.pop(0) == lower.get());
+    REQUIRE(queue.top() == nullptr);
+}
+
+TEST_CASE("wait_queue_remove_and_requeue", "kernel") {
+    kernel::thread_wait_queue queue;
+
+    auto first = kernel::thread_test_access::make(20);
+    auto second = kernel::thread_test_access::make(20);
+    auto third = kernel::thread_test_access::make(50);
+
+    queue.push(first.get(), 0);
+    queue.push(second.get(), 0);
+    queue.push(third.get(), 0);
+
+    REQUIRE(queue.contains(third.get()));
+    REQUIRE(queue.remove(third.get(), 5));
+    REQUIRE_FALSE(queue.contains(third.get()));
+    REQUIRE_FALSE(queue.remove(third.get(), 5));
+
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.top() == first.get());
+
+    // A boosted thread moves ahead of the others
+    kernel::thread_test_access::set_priority(second.get(), 45);
+    queue.requeue(second.get());
+
+    REQUIRE(queue.top() == second.get());
+
+    // Dropping it back puts it behind the thread that was already there
+    kernel::thread_test_access::set_priority(second.get(), 20);
+    queue.requeue(second.get());
+
+    REQUIRE(queue.pop(0) == first.get());
+    REQUIRE(queue.pop(0) == second.get());
+
+    // Not in the queue, so nothing to move
+    queue.requeue(third.get());
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("wait_queue_destroyed_with_waiters", "kernel") {
+    auto waiter = kernel::thread_test_access::make(30);
+
+    {
+        kernel::thread_wait_queue queue;
+        queue.push(waiter.get(), 0);
+    }
+
+    // The waiter can join another queue without pointing to the freed one
+    kernel::thread_wait_queue other;
+    other.push(waiter.get(), 0);
+
+    REQUIRE(other.contains(waiter.get()));
+    REQUIRE(other.pop(0) == waiter.get());
+}
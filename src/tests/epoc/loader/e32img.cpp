@@ -18,7 +18,228 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <catch2/catch.hpp>
+#include <common/buffer.h>
+#include <common/chunkyseri.h>
+#include <common/crypt.h>
+#include <common/cvt.h>
+#include <common/fileutils.h>
+#include <common/path.h>
 #include <kernel/libmanager.h>
+#include <loader/e32cache.h>
 #include <loader/e32img.h>
 
 #include <vfs/vfs.h>
+
+#include <fmt/format.h>
+
+#include <cstring>
+
+using namespace eka2l1;
+
+TEST_CASE("e32img_cache_payload_roundtrip", "e32img") {
+    loader::e32img img{};
+    img.epoc_ver = epocver::epoc94;
+    img.header.uid1 = loader::e32_img_type::dll;
+    img.header.uid3 = 0x10203040;
+    img.header.code_size = 8;
+    img.header_extended.info.secure_id = 0x10203040;
+    img.has_extended_header = true;
+    img.uncompressed_size = 8;
+    img.data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    img.ed.syms = { 0x100, 0x104 };
+    img.iat.number_imports = 1;
+    img.iat.its = { 0x200 };
+
+    loader::e32img_import_block block;
+    block.dll_name_offset = 12;
+    block.number_of_imports = 1;
+    block.ordinals = { 5 };
+    block.dll_name = "euser{000a0000}.dll";
+
+    img.import_section.size = 32;
+    img.import_section.imports.push_back(block);
+
+    loader::e32_reloc_entry reloc;
+    reloc.base = 0x1000;
+    reloc.size = 12;
+    reloc.rels_info = { 0x3004, 0x3008 };
+
+    img.code_reloc_section.size = 20;
+    img.code_reloc_section.num_relocs = 2;
+    img.code_reloc_section.entries.push_back(reloc);
+    img.dll_names = { "euser{000a0000}.dll" };
+
+    common::chunkyseri measurer(nullptr, 0, common::SERI_MODE_MEASURE);
+    loader::absorb_e32img(measurer, img);
+
+    std::vector<std::uint8_t> payload(measurer.size());
+    common::chunkyseri writer(payload.data(), payload.size(), common::SERI_MODE_WRITE);
+    loader::absorb_e32img(writer, img);
+
+    REQUIRE(writer.size() == payload.size());
+
+    loader::e32img result{};
+    common::chunkyseri reader(payload.data(), payload.size(), common::SERI_MODE_READ);
+    loader::absorb_e32img(reader, result);
+
+    REQUIRE(reader.size() == payload.size());
+    REQUIRE(result.epoc_ver == epocver::epoc94);
+    REQUIRE(result.header.uid3 == 0x10203040);
+    REQUIRE(result.header_extended.info.secure_id == 0x10203040);
+    REQUIRE(result.has_extended_header);
+    REQUIRE(result.data == img.data);
+    REQUIRE(result.ed.syms == img.ed.syms);
+    REQUIRE(result.iat.its == img.iat.its);
+    REQUIRE(result.import_section.imports.size() == 1);
+    REQUIRE(result.import_section.imports[0].dll_name == block.dll_name);
+    REQUIRE(result.import_section.imports[0].ordinals == block.ordinals);
+    REQUIRE(result.code_reloc_section.entries.size() == 1);
+    REQUIRE(result.code_reloc_section.entries[0].rels_info == reloc.rels_info);
+    REQUIRE(result.data_reloc_section.entries.empty());
+    REQUIRE(result.dll_names == img.dll_names);
+}
+
+// Smallest uncompressed image the parser accepts: header, then 8 bytes of text and an empty import table
+static std::vector<std::uint8_t> make_test_e32img(const std::uint32_t text_word) {
+    loader::e32img_header header{};
+    header.uid1 = loader::e32_img_type::dll;
+    header.uid2 = 0x1000008D;
+    header.uid3 = 0x10203040;
+
+    const std::uint32_t uids[3] = { static_cast<std::uint32_t>(header.uid1), header.uid2, header.uid3 };
+    header.check = crypt::calculate_checked_uid_checksum(uids);
+    header.sig = 0x434F5045;
+    header.code_offset = sizeof(loader::e32img_header);
+    header.text_size = 8;
+    header.code_size = 12;
+
+    std::vector<std::uint8_t> image(sizeof(loader::e32img_header) + header.code_size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + header.code_offset, &text_word, sizeof(text_word));
+
+    return image;
+}
+
+static std::size_t count_cache_entries(const std::string &dir) {
+    common::dir_iterator ite(dir);
+    common::dir_entry entry;
+
+    std::size_t count = 0;
+
+    while (ite.next_entry(entry) == 0) {
+        if (eka2l1::path_extension(entry.name) == ".e32c") {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+TEST_CASE("e32img_cache_hit_miss_invalidation", "e32img") {
+    const std::string cache_dir = "e32img_cache_test/";
+    common::delete_folder(cache_dir);
+
+    {
+        loader::e32img_cache cache(cache_dir);
+        std::vector<std::uint8_t> image = make_test_e32img(0xE12FFF1E);
+
+        common::ro_buf_stream stream(image.data(), image.size());
+        auto first = cache.parse(&stream, u"C:\\sys\\bin\\test.dll", 100);
+
+        REQUIRE(first);
+        REQUIRE(cache.misses() == 1);
+        REQUIRE(cache.hits() == 0);
+
+        // Same path, size and time: served from the cache without looking at the content
+        std::vector<std::uint8_t> garbage(image.size(), 0xCC);
+        common::ro_buf_stream garbage_stream(garbage.data(), garbage.size());
+
+        auto second = cache.parse(&garbage_stream, u"c:\\SYS\\BIN\\TEST.DLL", 100);
+
+        REQUIRE(second);
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(second->header.uid3 == 0x10203040);
+        REQUIRE(second->data == first->data);
+
+        // The image was modified: the entry must be reparsed and replaced
+        std::vector<std::uint8_t> updated = make_test_e32img(0xE3A00000);
+        common::ro_buf_stream updated_stream(updated.data(), updated.size());
+
+        auto third = cache.parse(&updated_stream, u"C:\\sys\\bin\\test.dll", 200);
+
+        REQUIRE(third);
+        REQUIRE(cache.misses() == 2);
+        REQUIRE(std::memcmp(third->data.data(), updated.data(), updated.size()) == 0);
+        REQUIRE(count_cache_entries(cache_dir) == 1);
+    }
+
+    {
+        // Still valid on the next launch
+        loader::e32img_cache cache(cache_dir);
+        std::vector<std::uint8_t> image = make_test_e32img(0xE3A00000);
+
+        common::ro_buf_stream stream(image.data(), image.size());
+
+        REQUIRE(cache.parse(&stream, u"C:\\sys\\bin\\test.dll", 200));
+        REQUIRE(cache.hits() == 1);
+    }
+
+    common::delete_folder(cache_dir);
+}
+
+TEST_CASE("e32img_cache_size_bound", "e32img") {
+    const std::string cache_dir = "e32img_cache_bound_test/";
+    common::delete_folder(cache_dir);
+
+    {
+        // Only room for about one entry
+        loader::e32img_cache cache(cache_dir, 256);
+        std::vector<std::uint8_t> image = make_test_e32img(0xE12FFF1E);
+
+        for (int i = 0; i < 4; i++) {
+            common::ro_buf_stream stream(image.data(), image.size());
+            REQUIRE(cache.parse(&stream, common::utf8_to_ucs2(fmt::format("C:\\sys\\bin\\test{}.dll", i)), 100));
+        }
+
+        REQUIRE(cache.evictions() == 3);
+        REQUIRE(count_cache_entries(cache_dir) == 1);
+    }
+
+    common::delete_folder(cache_dir);
+}
+
+TEST_CASE("e32img_cache_rofs_offset", "e32img") {
+    const std::string cache_dir = "e32img_cache_rofs_test/";
+    common::delete_folder(cache_dir);
+
+    {
+        loader::e32img_cache cache(cache_dir);
+
+        std::vector<std::uint8_t> image = make_test_e32img(0xE12FFF1E);
+        common::ro_buf_stream stream(image.data(), image.size());
+
+        REQUIRE(cache.parse(&stream, u"Z:\\sys\\bin\\test.dll", 100, 0x800));
+        REQUIRE(cache.misses() == 1);
+
+        // A rebuilt ROFS image may keep the timestamp and the file size, but not where the file lies
+        std::vector<std::uint8_t> rebuilt = make_test_e32img(0xE3A00000);
+        common::ro_buf_stream rebuilt_stream(rebuilt.data(), rebuilt.size());
+
+        auto result = cache.parse(&rebuilt_stream, u"Z:\\sys\\bin\\test.dll", 100, 0x1000);
+
+        REQUIRE(result);
+        REQUIRE(cache.misses() == 2);
+        REQUIRE(std::memcmp(result->data.data(), rebuilt.data(), rebuilt.size()) == 0);
+
+        // No temporary file is left behind
+        common::dir_iterator ite(cache_dir);
+        common::dir_entry entry;
+
+        while (ite.next_entry(entry) == 0) {
+            REQUIRE(eka2l1::path_extension(entry.name) != ".tmp");
+        }
+    }
+
+    common::delete_folder(cache_dir);
+}
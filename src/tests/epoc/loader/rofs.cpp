@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project 
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/buffer.h>
+#include <common/fileutils.h>
+#include <loader/rofs.h>
+#include <loader/rom.h>
+#include <vfs/vfs.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace eka2l1;
+
+static void write_rofs_entry(std::vector<std::uint8_t> &image, const std::size_t offset, const std::u16string &name,
+    const std::uint32_t size, const std::uint32_t addr, const std::uint8_t att) {
+    // Modern layout: size, uids, uid check, name offset, attribute, file size, address, extra attribute, name length
+    static constexpr std::uint8_t NAME_OFFSET = 30;
+    const std::uint16_t struct_size = static_cast<std::uint16_t>((NAME_OFFSET + name.length() * 2 + 3) & ~3);
+
+    std::memcpy(&image[offset], &struct_size, 2);
+    image[offset + 18] = NAME_OFFSET;
+    image[offset + 19] = att;
+    std::memcpy(&image[offset + 20], &size, 4);
+    std::memcpy(&image[offset + 24], &addr, 4);
+    image[offset + 29] = static_cast<std::uint8_t>(name.length());
+    std::memcpy(&image[offset + NAME_OFFSET], name.data(), name.length() * 2);
+}
+
+static void write_rofs_dir(std::vector<std::uint8_t> &image, const std::size_t offset, const std::uint16_t struct_size,
+    const std::uint32_t file_block_addr, const std::uint32_t file_block_size) {
+    std::memcpy(&image[offset], &struct_size, 2);
+    image[offset + 3] = 12;
+    std::memcpy(&image[offset + 4], &file_block_addr, 4);
+    std::memcpy(&image[offset + 8], &file_block_size, 4);
+}
+
+static std::vector<std::uint8_t> make_test_image() {
+    std::vector<std::uint8_t> image(0x1000);
+
+    loader::rofs_header header {};
+    std::memcpy(header.magic_, "ROFS", 4);
+    header.header_size_ = sizeof(loader::rofs_header);
+    header.rofs_format_version_ = loader::ROFS_MODERN_VERSION;
+    header.dir_tree_offset_ = sizeof(loader::rofs_header);
+    header.img_size_ = static_cast<std::uint32_t>(image.size());
+
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    // Root: subdirectory Sys at 0x200, one file in the block at 0x300
+    write_rofs_dir(image, header.dir_tree_offset_, 12 + 36, 0x300, 48);
+    write_rofs_entry(image, header.dir_tree_offset_ + 12, u"Sys", 0, 0x200, 0x10);
+    write_rofs_entry(image, 0x300, u"Hello.TXT", 5, 0x800, 0);
+
+    // Sys: one file in the block at 0x400
+    write_rofs_dir(image, 0x200, 12, 0x400, 40);
+    write_rofs_entry(image, 0x400, u"a.dll", 3, 0x900, 0);
+
+    std::memcpy(&image[0x800], "hello", 5);
+    std::memcpy(&image[0x900], "dll", 3);
+
+    return image;
+}
+
+TEST_CASE("index_lookup", "rofs") {
+    std::vector<std::uint8_t> image = make_test_image();
+
+    common::ro_buf_stream stream(image.data(), image.size());
+    loader::rofs_index index;
+
+    REQUIRE(loader::build_rofs_index(stream, index));
+    REQUIRE(index.find(u"\\")->children_.size() == 2);
+
+    const loader::rofs_index_entry *hello = index.find(u"Z:\\hello.txt");
+    REQUIRE(hello);
+    REQUIRE(hello->size_ == 5);
+    REQUIRE(std::memcmp(&image[hello->offset_], "hello", 5) == 0);
+
+    const loader::rofs_index_entry *dll = index.find(u"z:/SYS/A.DLL");
+    REQUIRE(dll);
+    REQUIRE(std::memcmp(&image[dll->offset_], "dll", 3) == 0);
+
+    const loader::rofs_index_entry *sys = index.find(u"Z:\\sys\\");
+    REQUIRE(sys);
+    REQUIRE(sys->is_dir_);
+    REQUIRE(sys->children_.size() == 1);
+
+    REQUIRE_FALSE(index.find(u"Z:\\nothing"));
+}
+
+TEST_CASE("image_cache_shared_between_filesystems", "rofs") {
+    const std::vector<std::uint8_t> image = make_test_image();
+    std::ofstream("rofs_cache_test.img", std::ios::binary).write(reinterpret_cast<const char *>(image.data()), image.size());
+
+    {
+        loader::rom empty_rom {};
+        rofs_image_cache cache;
+
+        auto first = create_rom_filesystem(&empty_rom, nullptr, epocver::epoc94, "", &cache);
+        auto second = create_rom_filesystem(&empty_rom, nullptr, epocver::epoc94, "", &cache);
+
+        REQUIRE(first->mount_image(drive_z, u"rofs_cache_test.img"));
+        REQUIRE(second->mount_image(drive_z, u"rofs_cache_test.img"));
+
+        // Mapped and indexed once
+        REQUIRE(cache.size() == 1);
+        REQUIRE(first->exists(u"Z:\\hello.txt"));
+        REQUIRE(second->exists(u"Z:\\sys\\a.dll"));
+
+        // Alive as long as one filesystem still uses it
+        first.reset();
+        REQUIRE(cache.size() == 1);
+
+        second.reset();
+        REQUIRE(cache.size() == 0);
+
+        // Without a cache, the filesystem keeps the image for itself
+        auto lone = create_rom_filesystem(&empty_rom, nullptr, epocver::epoc94, "");
+        REQUIRE(lone->mount_image(drive_z, u"rofs_cache_test.img"));
+        REQUIRE(lone->exists(u"Z:\\hello.txt"));
+        REQUIRE(cache.size() == 0);
+    }
+
+    common::remove("rofs_cache_test.img");
+}
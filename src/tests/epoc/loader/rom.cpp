@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project 
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <loader/rom.h>
+
+static eka2l1::loader::rom_entry make_file_entry(const std::u16string &name, const std::uint32_t addr) {
+    eka2l1::loader::rom_entry entry;
+    entry.size = 0x100;
+    entry.address_lin = addr;
+    entry.attrib = 0;
+    entry.name_len = static_cast<std::uint8_t>(name.length());
+    entry.name = name;
+
+    return entry;
+}
+
+TEST_CASE("rom_file_index_lookup", "rom") {
+    eka2l1::loader::rom romf;
+
+    eka2l1::loader::rom_dir bin_dir;
+    bin_dir.name = u"Bin";
+    bin_dir.entries.push_back(make_file_entry(u"EUser.dll", 0x80001000));
+
+    eka2l1::loader::rom_dir sys_dir;
+    sys_dir.name = u"sys";
+    sys_dir.subdirs.push_back(bin_dir);
+
+    eka2l1::loader::root_dir root;
+    root.dir.entries.push_back(make_file_entry(u"readme.txt", 0x80000000));
+    root.dir.subdirs.push_back(sys_dir);
+
+    romf.root.num_root_dirs = 1;
+    romf.root.root_dirs.push_back(root);
+    romf.build_file_index();
+
+    REQUIRE(romf.file_index.size() == 2);
+
+    auto entry = romf.burn_tree_find_entry(u"Z:\\SYS\\bin\\euser.DLL");
+    REQUIRE(entry);
+    REQUIRE(entry->address_lin == 0x80001000);
+
+    REQUIRE(romf.burn_tree_find_entry(std::string("z:/sys//bin/euser.dll")));
+    REQUIRE(romf.burn_tree_find_entry(std::string("z:\\readme.txt")));
+    REQUIRE_FALSE(romf.burn_tree_find_entry(std::string("z:\\sys\\bin")));
+    REQUIRE_FALSE(romf.burn_tree_find_entry(std::string("z:\\sys\\bin\\efsrv.dll")));
+}
@@ -21,10 +21,16 @@
 #include <catch2/catch.hpp>
 #include <loader/rsc.h>
 
+#include <common/algorithm.h>
 #include <common/buffer.h>
+#include <common/fileutils.h>
+#include <common/path.h>
 #include <vfs/vfs.h>
 
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <vector>
 
@@ -146,3 +152,106 @@ TEST_CASE("no_compress_but_may_contain_unicode_3", "rsc_file") {
     REQUIRE(res_from_eka2l1.size() == res_size);
     REQUIRE(expected_res == res_from_eka2l1);
 }
+
+static std::vector<std::uint8_t> read_loader_asset(const char *name) {
+    std::ifstream fi(name, std::ios::binary);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(fi), std::istreambuf_iterator<char>());
+}
+
+static std::string resource_as_string(const std::vector<std::uint8_t> &data) {
+    return std::string(data.begin(), data.end());
+}
+
+// 5-bit dictionary tokens. One dictionary entry nests another, and literal runs cover every length code.
+// The second resource holds compressed Unicode.
+TEST_CASE("dictionary_compressed", "rsc_file") {
+    std::vector<std::uint8_t> buf = read_loader_asset("loaderassets//dictcomp.rsc");
+    REQUIRE(!buf.empty());
+
+    common::ro_buf_stream stream(buf.data(), buf.size());
+    loader::rsc_file test_rsc(reinterpret_cast<common::ro_stream *>(&stream));
+
+    REQUIRE(test_rsc.get_total_resources() == 2);
+    REQUIRE(resource_as_string(test_rsc.read(1)) == "ASymbian OS v9!xy@ABCDEFGHIJKLMNOPQRSSymbian OS");
+
+    const std::vector<std::uint8_t> expected_unicode = { 'H', 0, 'e', 0, 'l', 0, 'l', 0, 'o', 0, 1, 2 };
+    REQUIRE(test_rsc.read(2) == expected_unicode);
+}
+
+TEST_CASE("resource_cache_keyed_by_path", "rsc_file") {
+    const std::vector<std::uint8_t> original = read_loader_asset("loaderassets//dictcomp.rsc");
+    REQUIRE(original.size() > 23);
+
+    // Byte aligned start of the first dictionary entry, "Symbian "
+    std::vector<std::uint8_t> modified = original;
+    modified[23] = 's';
+
+    const std::u16string path = u"Z:\\resource\\cachekeytest.rsc";
+
+    auto read_first = [&](std::vector<std::uint8_t> &content, const std::uint64_t mtime, const std::uint64_t offset) {
+        common::ro_buf_stream stream(content.data(), content.size());
+        loader::rsc_file rsc(reinterpret_cast<common::ro_stream *>(&stream), path, mtime, offset);
+
+        return resource_as_string(rsc.read(1));
+    };
+
+    std::vector<std::uint8_t> content = original;
+    REQUIRE(read_first(content, 100, 0) == "ASymbian OS v9!xy@ABCDEFGHIJKLMNOPQRSSymbian OS");
+
+    // Same path, size and time: the content is not looked at, the cached resource is returned
+    REQUIRE(read_first(modified, 100, 0) == "ASymbian OS v9!xy@ABCDEFGHIJKLMNOPQRSSymbian OS");
+
+    // A new modification time, or a new place in the filesystem image, is another file
+    REQUIRE(read_first(modified, 200, 0) == "Asymbian OS v9!xy@ABCDEFGHIJKLMNOPQRSsymbian OS");
+    REQUIRE(read_first(modified, 100, 0x800) == "Asymbian OS v9!xy@ABCDEFGHIJKLMNOPQRSsymbian OS");
+}
+
+// Run with EKA2L1_RSC_BENCH_DIR pointing to a folder of real ROM resource files, for example Z:\\resource\\apps
+TEST_CASE("rsc_read_benchmark", "[.][benchmark]") {
+    const char *bench_dir = std::getenv("EKA2L1_RSC_BENCH_DIR");
+    if (!bench_dir) {
+        WARN("EKA2L1_RSC_BENCH_DIR is not set, skipping");
+        return;
+    }
+
+    std::vector<std::vector<std::uint8_t>> files;
+    common::dir_iterator iterator(std::string(bench_dir) + "/");
+    common::dir_entry entry;
+
+    while (iterator.next_entry(entry) == 0) {
+        if (common::lowercase_string(eka2l1::path_extension(entry.name)) != ".rsc") {
+            continue;
+        }
+
+        std::ifstream fi(eka2l1::add_path(bench_dir, entry.name), std::ios::binary);
+        files.emplace_back(std::istreambuf_iterator<char>(fi), std::istreambuf_iterator<char>());
+    }
+
+    REQUIRE(!files.empty());
+
+    auto read_all = [&]() {
+        std::size_t total = 0;
+
+        for (auto &content : files) {
+            common::ro_buf_stream stream(content.data(), content.size());
+            loader::rsc_file rsc(reinterpret_cast<common::ro_stream *>(&stream));
+
+            for (int i = 1; i <= rsc.get_total_resources(); i++) {
+                total += rsc.read(i).size();
+            }
+        }
+
+        return total;
+    };
+
+    // First pass decompresses everything, the second one should be served from the resource cache
+    loader::set_resource_cache_capacity(64 * 1024 * 1024);
+
+    for (const char *pass_name : { "cold", "warm" }) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t total = read_all();
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        WARN(pass_name << ": " << files.size() << " files, " << total << " bytes in " << duration.count() << " us");
+    }
+}
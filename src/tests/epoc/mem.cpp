@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/platform.h>
+#include <common/virtualmem.h>
+#include <mem/cow.h>
+#include <mem/trace.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+TEST_CASE("access_trace_ranges_parse", "mem") {
+    std::vector<mem::access_trace_range> ranges;
+
+    REQUIRE(mem::parse_access_trace_ranges("", ranges));
+    REQUIRE(ranges.empty());
+
+    REQUIRE(mem::parse_access_trace_ranges("400000-401000,0x70000000-100000000", ranges));
+    REQUIRE(ranges.size() == 2);
+    REQUIRE(ranges[0].start_ == 0x400000);
+    REQUIRE(ranges[0].end_ == 0x401000);
+    REQUIRE(ranges[1].start_ == 0x70000000);
+    REQUIRE(ranges[1].end_ == 0xFFFFFFFF);
+
+    ranges.clear();
+    REQUIRE(!mem::parse_access_trace_ranges("401000-400000", ranges));
+    REQUIRE(!mem::parse_access_trace_ranges("400000", ranges));
+    REQUIRE(!mem::parse_access_trace_ranges("40zz00-401000", ranges));
+}
+
+TEST_CASE("access_trace_record_and_analyse", "mem") {
+    const std::string path = "memtrace_test.bin";
+
+    {
+        mem::access_tracer tracer(path, { { 0x1000, 0x2000 } });
+        REQUIRE(tracer.is_open());
+
+        REQUIRE(tracer.should_trace(0x1000, 4));
+        REQUIRE(tracer.should_trace(0xFFE, 4));
+        REQUIRE(!tracer.should_trace(0x2000, 4));
+        REQUIRE(!tracer.should_trace(0xFFC, 4));
+
+        // Two guest threads updating neighbouring words of the same line, from two host threads
+        auto hammer = [&](const std::uint32_t thread_id, const mem::vm_address addr) {
+            for (std::uint32_t i = 0; i < 100; i++) {
+                tracer.record(0x80000000, addr, i, 1, thread_id, 4, true);
+            }
+        };
+
+        std::thread first(hammer, 7, 0x1000);
+        std::thread second(hammer, 8, 0x1004);
+
+        first.join();
+        second.join();
+
+        // Both threads only read this one
+        tracer.record(0x80000004, 0x1040, 0, 1, 7, 4, false);
+        tracer.record(0x80000008, 0x1044, 0, 1, 8, 4, false);
+
+        // Both threads write the same word, which is true sharing
+        tracer.record(0x8000000C, 0x1080, 1, 1, 7, 4, true);
+        tracer.record(0x8000000C, 0x1080, 2, 1, 8, 4, true);
+
+        tracer.flush();
+        REQUIRE(tracer.written() == 204);
+        REQUIRE(tracer.dropped() == 0);
+    }
+
+    std::vector<mem::access_trace_record> records;
+    REQUIRE(mem::read_access_trace(path, records));
+    REQUIRE(records.size() == 204);
+
+    const auto hot = mem::find_hot_addresses(records, 2);
+    REQUIRE(hot.size() == 2);
+    REQUIRE(hot[0].addr_ == 0x1000);
+    REQUIRE(hot[0].writes_ == 100);
+    REQUIRE(hot[1].addr_ == 0x1004);
+
+    const auto shared = mem::find_false_sharing(records, 32);
+    REQUIRE(shared.size() == 1);
+    REQUIRE(shared[0].line_addr_ == 0x1000);
+    REQUIRE(shared[0].threads_ == std::vector<std::uint32_t>{ 7, 8 });
+    REQUIRE(shared[0].writes_ == 200);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("access_trace_drops_when_full", "mem") {
+    const std::string path = "memtrace_drop_test.bin";
+
+    {
+        mem::access_tracer tracer(path, {}, 16);
+
+        // The writer may drain in between, but it can never keep up with a tight burst this large
+        for (std::uint32_t i = 0; i < 1000000; i++) {
+            tracer.record(0, i * 4, i, 1, 1, 4, false);
+        }
+
+        tracer.flush();
+        REQUIRE(tracer.written() + tracer.dropped() == 1000000);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("access_trace_producer_lifetime", "mem") {
+    const std::string first_path = "memtrace_first_test.bin";
+    const std::string second_path = "memtrace_second_test.bin";
+
+    {
+        mem::access_tracer first(first_path, {});
+        mem::access_tracer second(second_path, {});
+
+        // Switching between tracers keeps one buffer per thread in each
+        for (std::uint32_t i = 0; i < 100; i++) {
+            first.record(0, i * 4, i, 1, 1, 4, false);
+            second.record(0, i * 4, i, 1, 1, 4, false);
+        }
+
+        REQUIRE(first.producer_count() == 1);
+        REQUIRE(second.producer_count() == 1);
+
+        // Buffers of exited threads are freed once drained, without losing their records
+        for (int i = 0; i < 8; i++) {
+            std::thread worker([&]() {
+                first.record(0, 0x1000, 0, 1, 2, 4, true);
+            });
+
+            worker.join();
+        }
+
+        first.flush();
+        REQUIRE(first.producer_count() == 1);
+        REQUIRE(first.written() == 108);
+        REQUIRE(first.dropped() == 0);
+    }
+
+    std::remove(first_path.c_str());
+    std::remove(second_path.c_str());
+}
+
+TEST_CASE("cow_template_private_views", "mem") {
+    const std::size_t size = common::get_host_page_size() * 2;
+
+    std::vector<std::uint8_t> source(size);
+    for (std::size_t i = 0; i < size; i++) {
+        source[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    mem::cow_template templ(source.data(), size);
+
+    if (!templ.valid()) {
+        // Not supported on this host, chunks fill the memory normally
+        return;
+    }
+
+    std::uint8_t *first = reinterpret_cast<std::uint8_t *>(common::map_memory(size));
+    std::uint8_t *second = reinterpret_cast<std::uint8_t *>(common::map_memory(size));
+
+    REQUIRE(templ.map(first, prot_read_write));
+    REQUIRE(templ.map(second, prot_read_write));
+    REQUIRE(!templ.map(first + 1, prot_read_write));
+
+    REQUIRE(std::memcmp(first, source.data(), size) == 0);
+
+    // Writes stay private to each view
+    first[5] = 0xAA;
+    second[size - 1] = 0xBB;
+
+    REQUIRE(second[5] == source[5]);
+    REQUIRE(first[size - 1] == source[size - 1]);
+
+    // Decommitting drops the view, and does not bring the template content back
+    REQUIRE(common::decommit(first, size, true));
+    REQUIRE(common::commit(first, size, prot_read_write));
+    REQUIRE(first[5] == 0);
+    REQUIRE(first[size - 1] == 0);
+
+    common::unmap_memory(first, size);
+    common::unmap_memory(second, size);
+}
+
+TEST_CASE("host_memory_commit_resident", "mem") {
+    const std::size_t size = 0x400000;
+    std::uint8_t *region = reinterpret_cast<std::uint8_t *>(common::map_memory(size));
+
+    REQUIRE(region);
+
+#if EKA2L1_PLATFORM(POSIX)
+    // Reservations only start at a huge page boundary there
+    REQUIRE(reinterpret_cast<std::uintptr_t>(region) % 0x200000 == 0);
+#endif
+
+    // Committing alone does not take physical memory
+    REQUIRE(common::commit(region, size, prot_read_write));
+    const std::size_t resident_before = common::get_resident_size(region, size);
+
+    std::memset(region, 0xCD, size / 2);
+
+#if EKA2L1_PLATFORM(POSIX)
+    REQUIRE(common::get_resident_size(region, size) >= resident_before + size / 2);
+#endif
+
+    // Decommitted pages go back to the host, and read as zero once committed again
+    REQUIRE(common::decommit(region, size));
+    REQUIRE(common::get_resident_size(region, size) == 0);
+
+    REQUIRE(common::commit(region, size, prot_read_write));
+    REQUIRE(region[0] == 0);
+
+    common::unmap_memory(region, size);
+}
+
+#if defined(__linux__)
+// Read the flags of the host mapping holding the address
+static bool has_huge_page_hint(const void *ptr) {
+    const std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_range = false;
+
+    while (std::getline(smaps, line)) {
+        unsigned long start = 0;
+        unsigned long end = 0;
+
+        if (std::sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2) {
+            in_range = (start <= addr) && (addr < end);
+            continue;
+        }
+
+        if (in_range && (line.rfind("VmFlags:", 0) == 0)) {
+            return line.find(" hg") != std::string::npos;
+        }
+    }
+
+    return false;
+}
+
+TEST_CASE("host_memory_decommit_keeps_huge_page_hint", "mem") {
+    const std::size_t size = 0x400000;
+    std::uint8_t *region = reinterpret_cast<std::uint8_t *>(common::map_memory(size));
+
+    REQUIRE(region);
+    REQUIRE(common::commit(region, size, prot_read_write));
+
+    if (!has_huge_page_hint(region)) {
+        // No transparent huge pages on this host
+        common::unmap_memory(region, size);
+        return;
+    }
+
+    std::memset(region, 0xCD, size);
+
+    // Plain memory keeps its mapping
+    REQUIRE(common::decommit(region, size / 2));
+    REQUIRE(has_huge_page_hint(region));
+
+    REQUIRE(common::commit(region, size / 2, prot_read_write));
+    REQUIRE(region[0] == 0);
+    REQUIRE(region[size / 2] == 0xCD);
+
+    // Replaced, and hinted again
+    REQUIRE(common::decommit(region, size, true));
+    REQUIRE(has_huge_page_hint(region));
+    REQUIRE(has_huge_page_hint(region + size - 1));
+
+    REQUIRE(common::commit(region, size, prot_read_write));
+    REQUIRE(region[size / 2] == 0);
+
+    common::unmap_memory(region, size);
+}
+#endif
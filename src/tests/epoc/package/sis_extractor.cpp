@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project 
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/buffer.h>
+#include <common/fileutils.h>
+#include <common/path.h>
+#include <loader/sis_fields.h>
+#include <package/sis_extractor.h>
+
+#include <miniz.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+using namespace eka2l1;
+
+// Append a record to the package buffer, the same way it's laid out in a SIS file
+static loader::sis_compressed append_record(std::vector<std::uint8_t> &package, const std::vector<std::uint8_t> &data,
+    const bool deflate) {
+    std::vector<std::uint8_t> payload = data;
+
+    if (deflate) {
+        mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(data.size()));
+        payload.resize(compressed_size);
+
+        REQUIRE(mz_compress(payload.data(), &compressed_size, data.data(), static_cast<mz_ulong>(data.size())) == MZ_OK);
+        payload.resize(compressed_size);
+    }
+
+    loader::sis_compressed record{};
+    record.algorithm = deflate ? loader::sis_compressed_algorithm::deflated : loader::sis_compressed_algorithm::none;
+    record.uncompressed_size = data.size();
+    record.offset = package.size();
+
+    // The length also counts the algorithm and uncompressed size fields
+    const std::uint64_t len = payload.size() + 12;
+    record.len_low = static_cast<std::uint32_t>(len);
+    record.len_high = static_cast<std::uint32_t>(len >> 32);
+
+    package.insert(package.end(), payload.begin(), payload.end());
+    return record;
+}
+
+static std::vector<std::uint8_t> make_pattern(const std::size_t size, const std::uint8_t seed) {
+    std::vector<std::uint8_t> data(size);
+
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = static_cast<std::uint8_t>((i * 31 + seed) ^ (i >> 9));
+    }
+
+    return data;
+}
+
+static std::vector<std::uint8_t> read_whole_file(const std::string &path) {
+    std::vector<std::uint8_t> data;
+    FILE *f = std::fopen(path.c_str(), "rb");
+
+    if (!f) {
+        return data;
+    }
+
+    std::fseek(f, 0, SEEK_END);
+    data.resize(std::ftell(f));
+    std::fseek(f, 0, SEEK_SET);
+
+    if (std::fread(data.data(), 1, data.size(), f) != data.size()) {
+        data.clear();
+    }
+
+    std::fclose(f);
+    return data;
+}
+
+TEST_CASE("sis_extractor_extracts_records", "sis_extractor") {
+    const std::string folder = "sis_extractor_test/";
+    common::delete_folder(folder);
+    eka2l1::create_directories(folder);
+
+    std::vector<std::uint8_t> package;
+    std::vector<std::vector<std::uint8_t>> contents;
+    std::vector<loader::sis_compressed> records;
+
+    for (std::uint8_t i = 0; i < 6; i++) {
+        contents.push_back(make_pattern(0x30000 + i * 0x11000, i));
+    }
+
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        records.push_back(append_record(package, contents[i], (i % 2) == 0));
+    }
+
+    std::uint64_t total_size = 0;
+    for (const auto &content : contents) {
+        total_size += content.size();
+    }
+
+    std::atomic<int> progress(50);
+    std::atomic<bool> watching(true);
+    std::atomic<bool> went_backward(false);
+
+    {
+        common::ro_buf_stream stream(package.data(), package.size());
+        loader::sis_file_extractor extractor(&stream, 4);
+
+        extractor.set_progress(&progress, total_size);
+        REQUIRE(progress == 0);
+
+        std::thread watcher([&]() {
+            int last = 0;
+            while (watching) {
+                const int now = progress.load();
+                if (now < last) {
+                    went_backward = true;
+                }
+
+                last = now;
+                std::this_thread::yield();
+            }
+        });
+
+        for (std::size_t i = 0; i < records.size(); i++) {
+            extractor.queue(folder + "file" + std::to_string(i) + ".bin", records[i]);
+        }
+
+        extractor.wait_all();
+
+        watching = false;
+        watcher.join();
+    }
+
+    REQUIRE_FALSE(went_backward);
+    REQUIRE(progress == 100);
+
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        REQUIRE(read_whole_file(folder + "file" + std::to_string(i) + ".bin") == contents[i]);
+    }
+
+    common::delete_folder(folder);
+}
+
+TEST_CASE("sis_extractor_wait_ignores_case", "sis_extractor") {
+    const std::string folder = "sis_extractor_case_test/";
+    common::delete_folder(folder);
+    eka2l1::create_directories(folder);
+
+    std::vector<std::uint8_t> package;
+    const std::vector<std::uint8_t> big = make_pattern(0x800000, 7);
+    loader::sis_compressed record = append_record(package, big, true);
+
+    common::ro_buf_stream stream(package.data(), package.size());
+    loader::sis_file_extractor extractor(&stream, 2);
+
+    extractor.queue(folder + "Install.SIS", record);
+
+    // The installer waits with whatever case the script gave it. The wait must still match
+    extractor.wait(folder + "install.sis");
+    REQUIRE(read_whole_file(folder + "Install.SIS") == big);
+
+    extractor.wait_all();
+    common::delete_folder(folder);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <services/context.h>
+#include <utils/des.h>
+
+#include <cstdint>
+
+using namespace eka2l1;
+
+TEST_CASE("ipc_arguments_descriptor_type_mismatch", "services") {
+    // Types are checked before client memory is touched, so no process is needed
+    const service::ipc_arg_decode_state state = { nullptr, false };
+
+    // (0) 16-bit descriptor, (1) handle, (2) and (3) unspecified
+    ipc_arg args(0x1000, 0x2000, 42, 7, static_cast<int>(ipc_arg_type::des16) | (static_cast<int>(ipc_arg_type::handle) << 3));
+
+    REQUIRE_FALSE(service::decode_ipc_arguments<service::ipc_des8_arg>(args, state));
+    REQUIRE_FALSE(service::decode_ipc_arguments<service::ipc_unused_arg, service::ipc_des8_arg>(args, state));
+    REQUIRE_FALSE(service::decode_ipc_arguments<service::ipc_unused_arg, service::ipc_unused_arg, service::ipc_des16_arg>(args, state));
+
+    // Integer slots are taken as they are
+    auto values = service::decode_ipc_arguments<service::ipc_unused_arg, std::int32_t, std::int32_t, std::int32_t>(args, state);
+
+    REQUIRE(values);
+    REQUIRE(std::get<1>(*values) == 0x2000);
+    REQUIRE(std::get<2>(*values) == 42);
+    REQUIRE(std::get<3>(*values) == 7);
+
+    REQUIRE(service::is_descriptor_argument_type(ipc_arg_type::des8, false));
+    REQUIRE(service::is_descriptor_argument_type(ipc_arg_type::desc16, true));
+    REQUIRE_FALSE(service::is_descriptor_argument_type(ipc_arg_type::desc16, false));
+    REQUIRE_FALSE(service::is_descriptor_argument_type(ipc_arg_type::desc8, true));
+    REQUIRE_FALSE(service::is_descriptor_argument_type(ipc_arg_type::handle, false));
+    REQUIRE_FALSE(service::is_descriptor_argument_type(ipc_arg_type::unspecified, false));
+}
+
+TEST_CASE("ipc_arguments_descriptor_lengths", "services") {
+    // Buffer descriptors hold their data inline, so they resolve without a process
+    epoc::buf_static<std::uint8_t, 16> buffer;
+    buffer.set_length(nullptr, 5);
+
+    service::ipc_des8_arg arg;
+
+    REQUIRE(service::fill_descriptor_argument(&buffer, nullptr, arg));
+    REQUIRE(arg.data == buffer.data);
+    REQUIRE(arg.length == 5);
+    REQUIRE(arg.max_length == 16);
+
+    // Reading a file into the descriptor is capped at its capacity
+    REQUIRE(arg.clamp_write_length(100) == 16);
+    REQUIRE(arg.clamp_write_length(10) == 10);
+    REQUIRE(arg.clamp_write_length(-1) == 0);
+
+    // Writing the descriptor to a file is capped at its length
+    REQUIRE(arg.clamp_read_length(100) == 5);
+    REQUIRE(arg.clamp_read_length(3) == 3);
+    REQUIRE(arg.clamp_read_length(-1) == 0);
+
+    arg.set_length(9);
+    REQUIRE(buffer.get_length() == 9);
+    REQUIRE(arg.clamp_read_length(100) == 9);
+
+    // Constant descriptors have no room past their data
+    epoc::bufc_static<char16_t, 8> constant;
+    service::ipc_des16_arg constant_arg;
+
+    REQUIRE(service::fill_descriptor_argument(&constant, nullptr, constant_arg));
+    REQUIRE(constant_arg.length == 8);
+    REQUIRE(constant_arg.max_length == 8);
+    REQUIRE(constant_arg.clamp_write_length(100) == 8);
+
+    epoc::buf_static<std::uint8_t, 4> broken;
+    broken.info = 0xF0000000;
+
+    REQUIRE_FALSE(service::fill_descriptor_argument(&broken, nullptr, arg));
+}
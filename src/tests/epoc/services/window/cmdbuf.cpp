@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <services/window/opheader.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace eka2l1;
+
+static void write_ws_command(std::vector<std::uint8_t> &buffer, std::uint16_t op, const std::uint32_t *handle,
+    const std::vector<std::uint32_t> &args) {
+    if (handle) {
+        op |= WS_CMD_HANDLE_FLAG;
+    }
+
+    const ws_cmd_header header{ op, static_cast<std::uint16_t>(args.size() * sizeof(std::uint32_t)) };
+    const std::size_t offset = buffer.size();
+
+    buffer.resize(offset + sizeof(ws_cmd_header) + (handle ? sizeof(std::uint32_t) : 0) + header.cmd_len);
+    std::uint8_t *ptr = buffer.data() + offset;
+
+    std::memcpy(ptr, &header, sizeof(ws_cmd_header));
+    ptr += sizeof(ws_cmd_header);
+
+    if (handle) {
+        std::memcpy(ptr, handle, sizeof(std::uint32_t));
+        ptr += sizeof(std::uint32_t);
+    }
+
+    std::memcpy(ptr, args.data(), header.cmd_len);
+}
+
+TEST_CASE("ws_cmd_buffer_reader_carries_handle", "window") {
+    const std::uint32_t gc_handle = 0x10003;
+    const std::uint32_t win_handle = 0x20005;
+
+    std::vector<std::uint8_t> buffer;
+    write_ws_command(buffer, 10, &gc_handle, { 1, 2 });
+    write_ws_command(buffer, 11, nullptr, { 3 });
+    write_ws_command(buffer, 12, &win_handle, {});
+    write_ws_command(buffer, 13, nullptr, { 4, 5, 6 });
+
+    ws_cmd_buffer_reader reader(buffer.data(), buffer.size());
+    ws_cmd cmd;
+
+    REQUIRE(reader.next(cmd));
+    REQUIRE(cmd.header.op == 10);
+    REQUIRE(cmd.obj_handle == gc_handle);
+    REQUIRE(reinterpret_cast<std::uint32_t *>(cmd.data_ptr)[1] == 2);
+
+    // The data is read in place
+    REQUIRE(cmd.data_ptr == buffer.data() + sizeof(ws_cmd_header) + sizeof(std::uint32_t));
+
+    REQUIRE(reader.next(cmd));
+    REQUIRE(cmd.header.op == 11);
+    REQUIRE(cmd.obj_handle == gc_handle);
+    REQUIRE(*reinterpret_cast<std::uint32_t *>(cmd.data_ptr) == 3);
+
+    REQUIRE(reader.next(cmd));
+    REQUIRE(cmd.header.op == 12);
+    REQUIRE(cmd.obj_handle == win_handle);
+    REQUIRE(cmd.header.cmd_len == 0);
+
+    REQUIRE(reader.next(cmd));
+    REQUIRE(cmd.header.op == 13);
+    REQUIRE(cmd.obj_handle == win_handle);
+
+    REQUIRE(!reader.next(cmd));
+    REQUIRE(reader.empty());
+}
+
+TEST_CASE("ws_cmd_buffer_reader_stops_on_truncated_command", "window") {
+    const std::uint32_t handle = 0x10001;
+
+    std::vector<std::uint8_t> buffer;
+    write_ws_command(buffer, 1, &handle, { 7 });
+    write_ws_command(buffer, 2, nullptr, { 8, 9 });
+
+    // Chop the last argument off
+    buffer.resize(buffer.size() - 2);
+
+    ws_cmd_buffer_reader reader(buffer.data(), buffer.size());
+    ws_cmd cmd;
+
+    REQUIRE(reader.next(cmd));
+    REQUIRE(cmd.header.op == 1);
+    REQUIRE(!reader.next(cmd));
+    REQUIRE(!reader.empty());
+}
+
+// Replays a buffer shaped like a typical draw flush: runs of graphics context commands, with the odd window command
+TEST_CASE("ws_cmd_buffer_replay_benchmark", "[.][benchmark]") {
+    static constexpr std::uint32_t REPLAY_COUNT = 200000;
+
+    const std::uint32_t handles[] = { 0x10001, 0x10002, 0x10003 };
+    std::vector<std::uint8_t> buffer;
+    std::size_t commands_per_buffer = 0;
+
+    for (int run = 0; run < 16; run++) {
+        const std::uint32_t handle = handles[run % 3];
+
+        for (int i = 0; i < 8; i++) {
+            write_ws_command(buffer, static_cast<std::uint16_t>(i), (i == 0) ? &handle : nullptr, { 1, 2, 3, 4 });
+            commands_per_buffer++;
+        }
+    }
+
+    std::uint64_t checksum = 0;
+    std::uint64_t resolves = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::uint32_t i = 0; i < REPLAY_COUNT; i++) {
+        ws_cmd_buffer_reader reader(buffer.data(), buffer.size());
+        ws_cmd cmd;
+        std::uint32_t cached_handle = 0;
+
+        while (reader.next(cmd)) {
+            if (cmd.obj_handle != cached_handle) {
+                cached_handle = cmd.obj_handle;
+                resolves++;
+            }
+
+            checksum += cmd.header.op + *reinterpret_cast<std::uint32_t *>(cmd.data_ptr);
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    REQUIRE(checksum != 0);
+    REQUIRE(resolves == 16ULL * REPLAY_COUNT);
+
+    WARN("Command buffer replay: " << (commands_per_buffer * REPLAY_COUNT / seconds / 1000000.0) << " M commands/s");
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <services/window/damage.h>
+
+using namespace eka2l1;
+
+TEST_CASE("damage_tracker_accumulate", "window") {
+    epoc::damage_tracker tracker;
+
+    // Nothing was ever composed, so everything is damaged
+    REQUIRE(tracker.is_full());
+    REQUIRE(!tracker.empty());
+
+    tracker.clear();
+    REQUIRE(tracker.empty());
+
+    tracker.add(eka2l1::rect({ 0, 0 }, { 0, 10 }));
+    REQUIRE(tracker.empty());
+
+    tracker.add(eka2l1::rect({ 10, 10 }, { 20, 20 }));
+    tracker.add(eka2l1::rect({ 15, 15 }, { 5, 5 }));
+    REQUIRE(tracker.rects().size() == 1);
+
+    // Swallows the existing one
+    tracker.add(eka2l1::rect({ 0, 0 }, { 40, 40 }));
+    REQUIRE(tracker.rects().size() == 1);
+    REQUIRE(tracker.rects()[0].size == eka2l1::vec2(40, 40));
+
+    tracker.add(eka2l1::rect({ 100, 100 }, { 10, 10 }));
+    REQUIRE(tracker.rects().size() == 2);
+
+    tracker.add_all();
+    REQUIRE(tracker.is_full());
+    REQUIRE(tracker.rects().empty());
+
+    tracker.add(eka2l1::rect({ 100, 100 }, { 10, 10 }));
+    REQUIRE(tracker.rects().empty());
+}
+
+TEST_CASE("damage_tracker_collapse", "window") {
+    epoc::damage_tracker tracker;
+    tracker.clear();
+
+    for (int i = 0; i <= epoc::damage_tracker::MAX_DAMAGE_RECTS; i++) {
+        tracker.add(eka2l1::rect({ i * 10, 0 }, { 5, 5 }));
+    }
+
+    REQUIRE(tracker.rects().size() == 1);
+    REQUIRE(tracker.rects()[0].top == eka2l1::vec2(0, 0));
+    REQUIRE(tracker.rects()[0].size == eka2l1::vec2(epoc::damage_tracker::MAX_DAMAGE_RECTS * 10 + 5, 5));
+}
+
+TEST_CASE("compose_layer_culling", "window") {
+    std::vector<epoc::compose_layer> layers = {
+        { eka2l1::rect({ 0, 0 }, { 240, 320 }), true },
+        { eka2l1::rect({ 0, 0 }, { 240, 160 }), false },
+        { eka2l1::rect({ 0, 0 }, { 240, 200 }), true }
+    };
+
+    const eka2l1::rect top_half({ 0, 0 }, { 240, 160 });
+    const eka2l1::rect bottom({ 0, 280 }, { 240, 40 });
+
+    // Hidden behind the last window in the top half, but not in the bottom
+    REQUIRE(epoc::is_layer_covered(layers, 0, top_half));
+    REQUIRE(!epoc::is_layer_covered(layers, 0, bottom));
+
+    // Does not even reach the bottom
+    REQUIRE(epoc::is_layer_covered(layers, 1, bottom));
+    REQUIRE(epoc::is_layer_covered(layers, 1, top_half));
+
+    // Frontmost window is never covered where it is
+    REQUIRE(!epoc::is_layer_covered(layers, 2, top_half));
+
+    // Transparent windows on top do not hide anything
+    layers[2].opaque = false;
+    REQUIRE(!epoc::is_layer_covered(layers, 0, top_half));
+    REQUIRE(!epoc::is_layer_covered(layers, 1, top_half));
+}
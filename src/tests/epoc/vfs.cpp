@@ -1,9 +1,15 @@
 #include <catch2/catch.hpp>
 #include <common/algorithm.h>
+#include <common/fileutils.h>
 #include <common/path.h>
+#include <common/platform.h>
 #include <common/types.h>
 #include <vfs/vfs.h>
 
+#include <chrono>
+#include <fstream>
+#include <thread>
+
 struct io_scope_guard {
     eka2l1::io_system *io;
 
@@ -37,3 +43,107 @@ TEST_CASE("get_physical", "vfs") {
 
     REQUIRE(eka2l1::common::compare_ignore_case(*actual_path_b, std::u16string(u"drive_b") + static_cast<char16_t>(eka2l1::get_separator()) + u"despacito3leak") == 0);
 }
+
+#if EKA2L1_PLATFORM(UNIX)
+// The host notifies changes asynchronously. Give it some time before failing.
+static bool wait_for_existence(eka2l1::io_system &io, const std::u16string &path, const bool should_exist) {
+    for (int i = 0; i < 200; i++) {
+        if (io.exist(path) == should_exist) {
+            return true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return false;
+}
+
+TEST_CASE("physical_listing_invalidation", "vfs") {
+    eka2l1::common::delete_folder("listing_drive");
+    eka2l1::create_directories("listing_drive/sub");
+
+    {
+        eka2l1::io_system io;
+        io_scope_guard guard(io);
+
+        io.mount_physical_path(drive_number::drive_a, drive_media::physical, io_attrib_internal,
+            u"listing_drive");
+
+        // Lists the directories, which are then answered from the cache
+        REQUIRE(io.exist(u"A:\\sub\\"));
+        REQUIRE(!io.exist(u"A:\\sub\\file.txt"));
+
+        // Changes made behind the filesystem's back must be noticed
+        std::ofstream("listing_drive/sub/file.txt") << "hello";
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\file.txt", true));
+
+        eka2l1::common::remove("listing_drive/sub/file.txt");
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\file.txt", false));
+
+        // Deleting the listed directory itself
+        std::ofstream("listing_drive/sub/other.txt") << "hello";
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\other.txt", true));
+
+        eka2l1::common::delete_folder("listing_drive/sub");
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\other.txt", false));
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\", false));
+
+        // And recreating it, which must be watched again
+        eka2l1::create_directories("listing_drive/sub");
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\", true));
+        REQUIRE(!io.exist(u"A:\\sub\\other.txt"));
+
+        std::ofstream("listing_drive/sub/other.txt") << "hello";
+        REQUIRE(wait_for_existence(io, u"A:\\sub\\other.txt", true));
+
+        // Mutations through the filesystem are seen right away
+        REQUIRE(io.delete_entry(u"A:\\sub\\other.txt"));
+        REQUIRE(!io.exist(u"A:\\sub\\other.txt"));
+    }
+
+    eka2l1::common::delete_folder("listing_drive");
+}
+
+TEST_CASE("physical_listing_sync_invalidation", "vfs") {
+    eka2l1::common::delete_folder("listing_sync_drive");
+    eka2l1::create_directories("listing_sync_drive/a/b");
+
+    {
+        eka2l1::io_system io;
+        io_scope_guard guard(io);
+
+        io.mount_physical_path(drive_number::drive_a, drive_media::physical, io_attrib_internal,
+            u"listing_sync_drive");
+
+        // Cache listings at several levels
+        REQUIRE(io.exist(u"A:\\a\\b\\"));
+        REQUIRE(!io.exist(u"A:\\a\\b\\file.txt"));
+        REQUIRE(!io.exist(u"A:\\x\\y\\"));
+
+        // No waiting anywhere below: mutations through the filesystem must be visible on return
+        REQUIRE(io.create_directories(u"A:\\x\\y\\"));
+        REQUIRE(io.exist(u"A:\\x\\"));
+        REQUIRE(io.exist(u"A:\\x\\y\\"));
+
+        {
+            auto created = io.open_file(u"A:\\a\\b\\file.txt", WRITE_MODE | BIN_MODE);
+            REQUIRE(created);
+        }
+
+        REQUIRE(io.exist(u"A:\\a\\b\\file.txt"));
+
+        REQUIRE(io.rename(u"A:\\a\\b\\file.txt", u"A:\\x\\y\\file.txt"));
+        REQUIRE(!io.exist(u"A:\\a\\b\\file.txt"));
+        REQUIRE(io.exist(u"A:\\x\\y\\file.txt"));
+
+        // Dropping a directory drops the listings below it too
+        REQUIRE(io.delete_entry(u"A:\\x\\y\\file.txt"));
+        REQUIRE(io.delete_entry(u"A:\\x\\y\\"));
+        REQUIRE(!io.exist(u"A:\\x\\y\\"));
+        REQUIRE(!io.exist(u"A:\\x\\y\\file.txt"));
+        REQUIRE(io.exist(u"A:\\x\\"));
+    }
+
+    eka2l1::common::delete_folder("listing_sync_drive");
+}
+#endif
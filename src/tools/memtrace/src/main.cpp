@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mem/trace.h>
+
+#include <common/log.h>
+
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char **argv) {
+    eka2l1::log::setup_log(nullptr);
+
+    if (argc <= 1) {
+        LOG_ERROR(eka2l1::SYSTEM, "No trace file provided!");
+        LOG_INFO(eka2l1::SYSTEM, "Usage: memtrace [trace file] [hot address count = 20] [cache line size = 32].");
+
+        return -1;
+    }
+
+    const std::size_t hot_count = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+    const std::uint32_t line_size = (argc > 3) ? static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 32;
+
+    std::vector<eka2l1::mem::access_trace_record> records;
+
+    if (!eka2l1::mem::read_access_trace(argv[1], records)) {
+        LOG_ERROR(eka2l1::SYSTEM, "{} is not a memory access trace!", argv[1]);
+        return -1;
+    }
+
+    LOG_INFO(eka2l1::SYSTEM, "Total accesses: {}", records.size());
+
+    const auto hot_addresses = eka2l1::mem::find_hot_addresses(records, hot_count);
+    std::string hot_list = "Hot addresses: \n";
+
+    for (const auto &hot : hot_addresses) {
+        hot_list += fmt::format("\t- 0x{:08X}: {} reads, {} writes\n", hot.addr_, hot.reads_, hot.writes_);
+    }
+
+    LOG_INFO(eka2l1::SYSTEM, "{}", hot_list);
+
+    const auto shared_lines = eka2l1::mem::find_false_sharing(records, line_size);
+
+    if (shared_lines.empty()) {
+        LOG_INFO(eka2l1::SYSTEM, "No false sharing found with {}-byte cache lines", line_size);
+        return 0;
+    }
+
+    std::string shared_list = fmt::format("Falsely shared {}-byte cache lines: \n", line_size);
+
+    for (const auto &line : shared_lines) {
+        std::string threads;
+
+        for (const std::uint32_t thread_id : line.threads_) {
+            threads += fmt::format("{}{}", threads.empty() ? "" : ", ", thread_id);
+        }
+
+        shared_list += fmt::format("\t- 0x{:08X}: {} writes, threads {}\n", line.line_addr_, line.writes_, threads);
+    }
+
+    LOG_INFO(eka2l1::SYSTEM, "{}", shared_list);
+
+    return 0;
+}